@@ -44,6 +44,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "snd_local.h"
 #include "qcommon/stringed_ingame.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CIN_SSE2
+#include <emmintrin.h>
+#endif
+
 #define MAXSIZE				8
 #define MINSIZE				4
 
@@ -341,13 +346,23 @@ static long RllDecodeStereoToMono(unsigned char *from,short *to,unsigned int siz
 *
 ******************************************************************************/
 
+static inline void copy16( byte *dst, const byte *src )
+{
+#ifdef CIN_SSE2
+	_mm_storeu_si128( (__m128i *)dst, _mm_loadu_si128( (const __m128i *)src ) );
+#else
+	memcpy(dst, src, 16);
+#endif
+}
+
 static void move8_32( byte *src, byte *dst, int spl )
 {
 	int i;
 
 	for(i = 0; i < 8; ++i)
 	{
-		memcpy(dst, src, 32);
+		copy16(dst, src);
+		copy16(dst+16, src+16);
 		src += spl;
 		dst += spl;
 	}
@@ -367,7 +382,7 @@ static void move4_32( byte *src, byte *dst, int spl  )
 
 	for(i = 0; i < 4; ++i)
 	{
-		memcpy(dst, src, 16);
+		copy16(dst, src);
 		src += spl;
 		dst += spl;
 	}
@@ -387,7 +402,8 @@ static void blit8_32( byte *src, byte *dst, int spl  )
 
 	for(i = 0; i < 8; ++i)
 	{
-		memcpy(dst, src, 32);
+		copy16(dst, src);
+		copy16(dst+16, src+16);
 		src += 32;
 		dst += spl;
 	}
@@ -406,7 +422,7 @@ static void blit4_32( byte *src, byte *dst, int spl  )
 
 	for(i = 0; i < 4; ++i)
 	{
-		memmove(dst, src, 16);
+		copy16(dst, src);
 		src += 16;
 		dst += spl;
 	}
@@ -640,6 +656,36 @@ static unsigned int yuv_to_rgb24( long y, long u, long v )
 	return LittleLong ((r)|(g<<8)|(b<<16)|(255<<24));
 }
 
+/******************************************************************************
+*
+* Function:		yuv4_to_rgb24
+*
+* Description:	yuv_to_rgb24 for four lumas sharing one chroma pair
+*
+******************************************************************************/
+
+static void yuv4_to_rgb24( long y0, long y1, long y2, long y3, long u, long v, unsigned int *out )
+{
+#ifdef CIN_SSE2
+	const __m128i yy = _mm_setr_epi32( (int)ROQ_YY_tab[y0], (int)ROQ_YY_tab[y1], (int)ROQ_YY_tab[y2], (int)ROQ_YY_tab[y3] );
+	const __m128i r = _mm_srai_epi32( _mm_add_epi32( yy, _mm_set1_epi32( (int)ROQ_VR_tab[v] ) ), 6 );
+	const __m128i g = _mm_srai_epi32( _mm_add_epi32( yy, _mm_set1_epi32( (int)(ROQ_UG_tab[u] + ROQ_VG_tab[v]) ) ), 6 );
+	const __m128i b = _mm_srai_epi32( _mm_add_epi32( yy, _mm_set1_epi32( (int)ROQ_UB_tab[u] ) ), 6 );
+
+	// the saturating packs do the 0..255 clamp, leaving rrrr bbbb gggg aaaa
+	__m128i pixels = _mm_packus_epi16( _mm_packs_epi32( r, b ), _mm_packs_epi32( g, _mm_set1_epi32( 255 ) ) );
+	// rgrgrgrg babababa, then rgba rgba rgba rgba
+	pixels = _mm_unpacklo_epi8( pixels, _mm_srli_si128( pixels, 8 ) );
+	pixels = _mm_unpacklo_epi16( pixels, _mm_srli_si128( pixels, 8 ) );
+	_mm_storeu_si128( (__m128i *)out, pixels );
+#else
+	out[0] = yuv_to_rgb24( y0, u, v );
+	out[1] = yuv_to_rgb24( y1, u, v );
+	out[2] = yuv_to_rgb24( y2, u, v );
+	out[3] = yuv_to_rgb24( y3, u, v );
+#endif
+}
+
 /******************************************************************************
 *
 * Function:
@@ -708,10 +754,8 @@ static void decodeCodeBook( byte *input, unsigned short roq_flags )
 					y3 = (long)*input++;
 					cr = (long)*input++;
 					cb = (long)*input++;
-					*ibptr.i++ = yuv_to_rgb24( y0, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y1, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y2, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y3, cr, cb );
+					yuv4_to_rgb24( y0, y1, y2, y3, cr, cb, ibptr.i );
+					ibptr.i += 4;
 				}
 
 				icptr.s = vq4;
@@ -786,14 +830,9 @@ static void decodeCodeBook( byte *input, unsigned short roq_flags )
 					y3 = (long)*input++;
 					cr = (long)*input++;
 					cb = (long)*input++;
-					*ibptr.i++ = yuv_to_rgb24( y0, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y1, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( ((y0*3)+y2)/4, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( ((y1*3)+y3)/4, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( (y0+(y2*3))/4, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( (y1+(y3*3))/4, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y2, cr, cb );
-					*ibptr.i++ = yuv_to_rgb24( y3, cr, cb );
+					yuv4_to_rgb24( y0, y1, ((y0*3)+y2)/4, ((y1*3)+y3)/4, cr, cb, ibptr.i );
+					yuv4_to_rgb24( (y0+(y2*3))/4, (y1+(y3*3))/4, y2, y3, cr, cb, ibptr.i + 4 );
+					ibptr.i += 8;
 				}
 
 				icptr.s = vq4;
@@ -1703,10 +1742,29 @@ void CIN_ResampleCinematic(int handle, int *buf2) {
 	buf3 = (int*)buf;
 	if (xm==2 && ym==2) {
 		byte *bc2, *bc3;
-		int	ic, iiy;
+		int	iiy;
 
 		bc2 = (byte *)buf2;
 		bc3 = (byte *)buf3;
+#ifdef CIN_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (iy = 0; iy<256; iy++) {
+			iiy = iy<<12;
+			for (ix = 0; ix<2048; ix+=16) {
+				// four source pixels on each of two rows give two output pixels
+				__m128i top = _mm_loadu_si128( (const __m128i *)( bc3 + iiy + ix ) );
+				__m128i bottom = _mm_loadu_si128( (const __m128i *)( bc3 + iiy + 2048 + ix ) );
+				__m128i left = _mm_add_epi16( _mm_unpacklo_epi8( top, zero ), _mm_unpacklo_epi8( bottom, zero ) );
+				__m128i right = _mm_add_epi16( _mm_unpackhi_epi8( top, zero ), _mm_unpackhi_epi8( bottom, zero ) );
+				left = _mm_add_epi16( left, _mm_srli_si128( left, 8 ) );
+				right = _mm_add_epi16( right, _mm_srli_si128( right, 8 ) );
+				__m128i result = _mm_srli_epi16( _mm_unpacklo_epi64( left, right ), 2 );
+				_mm_storel_epi64( (__m128i *)bc2, _mm_packus_epi16( result, result ) );
+				bc2 += 8;
+			}
+		}
+#else
+		int	ic;
 		for (iy = 0; iy<256; iy++) {
 			iiy = iy<<12;
 			for (ix = 0; ix<2048; ix+=8) {
@@ -1716,12 +1774,30 @@ void CIN_ResampleCinematic(int handle, int *buf2) {
 				}
 			}
 		}
+#endif
 	} else if (xm==2 && ym==1) {
 		byte *bc2, *bc3;
-		int	ic, iiy;
+		int	iiy;
 
 		bc2 = (byte *)buf2;
 		bc3 = (byte *)buf3;
+#ifdef CIN_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (iy = 0; iy<256; iy++) {
+			iiy = iy<<11;
+			for (ix = 0; ix<2048; ix+=16) {
+				__m128i row = _mm_loadu_si128( (const __m128i *)( bc3 + iiy + ix ) );
+				__m128i left = _mm_unpacklo_epi8( row, zero );
+				__m128i right = _mm_unpackhi_epi8( row, zero );
+				left = _mm_add_epi16( left, _mm_srli_si128( left, 8 ) );
+				right = _mm_add_epi16( right, _mm_srli_si128( right, 8 ) );
+				__m128i result = _mm_srli_epi16( _mm_unpacklo_epi64( left, right ), 1 );
+				_mm_storel_epi64( (__m128i *)bc2, _mm_packus_epi16( result, result ) );
+				bc2 += 8;
+			}
+		}
+#else
+		int	ic;
 		for (iy = 0; iy<256; iy++) {
 			iiy = iy<<11;
 			for (ix = 0; ix<2048; ix+=8) {
@@ -1731,6 +1807,7 @@ void CIN_ResampleCinematic(int handle, int *buf2) {
 				}
 			}
 		}
+#endif
 	} else {
 		for (iy = 0; iy<256; iy++) {
 			for (ix = 0; ix<256; ix++) {
@@ -1133,11 +1133,13 @@ void CL_InitRef( void ) {
 	RIT(Cvar_VariableValue);
 	RIT(FS_FCloseFile);
 	RIT(FS_FileIsInPAK);
+	RIT(FS_LoadedPakChecksums);
 	RIT(FS_FOpenFileByMode);
 	RIT(FS_FOpenFileRead);
 	RIT(FS_FOpenFileWrite);
 	RIT(FS_FreeFile);
 	RIT(FS_FreeFileList);
+	RIT(FS_HomeRemove);
 	RIT(FS_ListFiles);
 	RIT(FS_Read);
 	RIT(FS_ReadFile);
@@ -1180,6 +1182,7 @@ void CL_InitRef( void ) {
 	rit.gbUsingCachedMapDataRightNow = get_gbUsingCachedMapDataRightNow;
 	rit.gbAlreadyDoingLoad = get_gbAlreadyDoingLoad;
 	rit.com_frameTime = get_com_frameTime;
+	rit.GL_MakeCurrent = WIN_GL_MakeCurrent;
 
 	rit.SV_PointContents = SV_PointContents;
 
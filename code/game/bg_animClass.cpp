@@ -0,0 +1,706 @@
+/*
+===========================================================================
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// bg_animClass.cpp -- saber move and animation class tables
+
+#include "bg_animClass.h"
+
+std::uint32_t bg_saberMoveClasses[LS_MOVE_MAX];
+std::uint32_t bg_animClasses[MAX_ANIMATIONS];
+
+// an inclusive run of moves or anims; leave last out for just first
+struct animClassRange_t
+{
+	int first;
+	int last;
+};
+
+// Each list below is the switch or range check of the function it's named after.
+
+//PM_SaberInAttack
+static const animClassRange_t saberAttackMoves[] =
+{
+	{ LS_A_TL2BR, LS_A_T2B },
+	{ LS_A_BACK },
+	{ LS_A_BACK_CR },
+	{ LS_A_BACKSTAB },
+	{ LS_ROLL_STAB },
+	{ LS_A_LUNGE },
+	{ LS_A_JUMP_T__B_ },
+	{ LS_A_FLIP_STAB },
+	{ LS_A_FLIP_SLASH },
+	{ LS_JUMPATTACK_DUAL },
+	{ LS_JUMPATTACK_ARIAL_LEFT },
+	{ LS_JUMPATTACK_ARIAL_RIGHT },
+	{ LS_JUMPATTACK_CART_LEFT },
+	{ LS_JUMPATTACK_CART_RIGHT },
+	{ LS_JUMPATTACK_STAFF_LEFT },
+	{ LS_JUMPATTACK_STAFF_RIGHT },
+	{ LS_BUTTERFLY_LEFT },
+	{ LS_BUTTERFLY_RIGHT },
+	{ LS_A_BACKFLIP_ATK },
+	{ LS_SPINATTACK_DUAL },
+	{ LS_SPINATTACK },
+	{ LS_LEAP_ATTACK },
+	{ LS_SWOOP_ATTACK_RIGHT },
+	{ LS_SWOOP_ATTACK_LEFT },
+	{ LS_TAUNTAUN_ATTACK_RIGHT },
+	{ LS_TAUNTAUN_ATTACK_LEFT },
+	{ LS_KICK_F },
+	{ LS_KICK_F_MD },
+	{ LS_KICK_B },
+	{ LS_KICK_SWEEP },
+	{ LS_KICK_R },
+	{ LS_SMACK_R },
+	{ LS_KICK_L },
+	{ LS_SMACK_L },
+	{ LS_KICK_S },
+	{ LS_KICK_BF },
+	{ LS_KICK_RL },
+	{ LS_KICK_F_AIR },
+	{ LS_FLYING_KICK },
+	{ LS_KICK_B_AIR },
+	{ LS_KICK_R_AIR },
+	{ LS_KICK_L_AIR },
+	{ LS_STABDOWN },
+	{ LS_STABDOWN_STAFF },
+	{ LS_STABDOWN_DUAL },
+	{ LS_DUAL_SPIN_PROTECT },
+	{ LS_STAFF_SOULCAL },
+	{ LS_A1_SPECIAL },
+	{ LS_A2_SPECIAL },
+	{ LS_A3_SPECIAL },
+	{ LS_UPSIDE_DOWN_ATTACK },
+	{ LS_PULL_ATTACK_STAB },
+	{ LS_PULL_ATTACK_SWING },
+	{ LS_SPINATTACK_ALORA },
+	{ LS_DUAL_FB },
+	{ LS_DUAL_LR },
+	{ LS_HILT_BASH },
+	{ LS_SLAP_R },
+	{ LS_SLAP_L },
+};
+
+//PM_SaberInAttackPure
+static const animClassRange_t saberAttackPureMoves[] =
+{
+	{ LS_A_TL2BR, LS_A_T2B },
+};
+
+//PM_SaberInDamageMove
+static const animClassRange_t saberDamageMoves[] =
+{
+	{ LS_A_TL2BR, LS_A_T2B },
+	{ LS_A_BACK },
+	{ LS_A_BACK_CR },
+	{ LS_A_BACKSTAB },
+	{ LS_ROLL_STAB },
+	{ LS_A_LUNGE },
+	{ LS_A_JUMP_T__B_ },
+	{ LS_A_FLIP_STAB },
+	{ LS_A_FLIP_SLASH },
+	{ LS_JUMPATTACK_DUAL },
+	{ LS_JUMPATTACK_ARIAL_LEFT },
+	{ LS_JUMPATTACK_ARIAL_RIGHT },
+	{ LS_JUMPATTACK_CART_LEFT },
+	{ LS_JUMPATTACK_CART_RIGHT },
+	{ LS_JUMPATTACK_STAFF_LEFT },
+	{ LS_JUMPATTACK_STAFF_RIGHT },
+	{ LS_BUTTERFLY_LEFT },
+	{ LS_BUTTERFLY_RIGHT },
+	{ LS_A_BACKFLIP_ATK },
+	{ LS_SPINATTACK_DUAL },
+	{ LS_SPINATTACK },
+	{ LS_LEAP_ATTACK },
+	{ LS_SWOOP_ATTACK_RIGHT },
+	{ LS_SWOOP_ATTACK_LEFT },
+	{ LS_TAUNTAUN_ATTACK_RIGHT },
+	{ LS_TAUNTAUN_ATTACK_LEFT },
+	{ LS_STABDOWN },
+	{ LS_STABDOWN_STAFF },
+	{ LS_STABDOWN_DUAL },
+	{ LS_DUAL_SPIN_PROTECT },
+	{ LS_STAFF_SOULCAL },
+	{ LS_A1_SPECIAL },
+	{ LS_A2_SPECIAL },
+	{ LS_A3_SPECIAL },
+	{ LS_UPSIDE_DOWN_ATTACK },
+	{ LS_PULL_ATTACK_STAB },
+	{ LS_PULL_ATTACK_SWING },
+	{ LS_SPINATTACK_ALORA },
+	{ LS_DUAL_FB },
+	{ LS_DUAL_LR },
+	{ LS_HILT_BASH },
+	{ LS_SLAP_R },
+	{ LS_SLAP_L },
+};
+
+//PM_SaberInTransition
+static const animClassRange_t saberTransitionMoves[] =
+{
+	{ LS_T1_BR__R, LS_T1_BL__L },
+};
+
+//PM_SaberInStart
+static const animClassRange_t saberStartMoves[] =
+{
+	{ LS_S_TL2BR, LS_S_T2B },
+};
+
+//PM_SaberInReturn
+static const animClassRange_t saberReturnMoves[] =
+{
+	{ LS_R_TL2BR, LS_R_T2B },
+};
+
+//PM_SaberInBounce
+static const animClassRange_t saberBounceMoves[] =
+{
+	{ LS_B1_BR, LS_B1_BL },
+	{ LS_D1_BR, LS_D1_BL },
+};
+
+//PM_SaberInBrokenParry
+static const animClassRange_t saberBrokenParryMoves[] =
+{
+	{ LS_V1_BR, LS_V1_B_ },
+	{ LS_H1_T_, LS_H1_BL },
+};
+
+//PM_SaberInDeflect
+static const animClassRange_t saberDeflectMoves[] =
+{
+	{ LS_D1_BR, LS_D1_B_ },
+};
+
+//PM_SaberInParry
+static const animClassRange_t saberParryMoves[] =
+{
+	{ LS_PARRY_UP },
+	{ LS_PARRY_UR },
+	{ LS_PARRY_UL },
+	{ LS_PARRY_LR },
+	{ LS_PARRY_LL },
+	{ LS_PARRY_UP_MD },
+	{ LS_PARRY_UR_MD },
+	{ LS_PARRY_UL_MD },
+	{ LS_PARRY_LR_MD },
+	{ LS_PARRY_LL_MD },
+	{ LS_PARRY_BACK },
+};
+
+//PM_SaberInKnockaway
+static const animClassRange_t saberKnockawayMoves[] =
+{
+	{ LS_K1_T_ },
+	{ LS_K1_TR },
+	{ LS_K1_TR_MD },
+	{ LS_K1_TR_PB },
+	{ LS_K1_TL },
+	{ LS_K1_TL_MD },
+	{ LS_K1_TL_PB },
+	{ LS_K1_BR },
+	{ LS_K1_BL },
+};
+
+//PM_SaberInReflect
+static const animClassRange_t saberReflectMoves[] =
+{
+	{ LS_REFLECT_UP },
+	{ LS_REFLECT_UR },
+	{ LS_REFLECT_UL },
+	{ LS_REFLECT_LR },
+	{ LS_REFLECT_LL },
+	{ LS_REFLECT_UP_MD },
+	{ LS_REFLECT_UR_MD },
+	{ LS_REFLECT_UL_MD },
+	{ LS_REFLECT_LR_MD },
+	{ LS_REFLECT_LL_MD },
+};
+
+//PM_SaberInSpecial
+static const animClassRange_t saberSpecialMoves[] =
+{
+	{ LS_A_BACK },
+	{ LS_A_BACK_CR },
+	{ LS_A_BACKSTAB },
+	{ LS_ROLL_STAB },
+	{ LS_A_LUNGE },
+	{ LS_A_JUMP_T__B_ },
+	{ LS_A_FLIP_STAB },
+	{ LS_A_FLIP_SLASH },
+	{ LS_JUMPATTACK_DUAL },
+	{ LS_JUMPATTACK_ARIAL_LEFT },
+	{ LS_JUMPATTACK_ARIAL_RIGHT },
+	{ LS_JUMPATTACK_CART_LEFT },
+	{ LS_JUMPATTACK_CART_RIGHT },
+	{ LS_JUMPATTACK_STAFF_LEFT },
+	{ LS_JUMPATTACK_STAFF_RIGHT },
+	{ LS_BUTTERFLY_LEFT },
+	{ LS_BUTTERFLY_RIGHT },
+	{ LS_A_BACKFLIP_ATK },
+	{ LS_SPINATTACK_DUAL },
+	{ LS_SPINATTACK },
+	{ LS_LEAP_ATTACK },
+	{ LS_SWOOP_ATTACK_RIGHT },
+	{ LS_SWOOP_ATTACK_LEFT },
+	{ LS_TAUNTAUN_ATTACK_RIGHT },
+	{ LS_TAUNTAUN_ATTACK_LEFT },
+	{ LS_KICK_F },
+	{ LS_KICK_F_MD },
+	{ LS_KICK_B },
+	{ LS_KICK_SWEEP },
+	{ LS_KICK_R },
+	{ LS_SMACK_R },
+	{ LS_KICK_L },
+	{ LS_SMACK_L },
+	{ LS_KICK_S },
+	{ LS_KICK_BF },
+	{ LS_KICK_RL },
+	{ LS_KICK_F_AIR },
+	{ LS_FLYING_KICK },
+	{ LS_KICK_B_AIR },
+	{ LS_KICK_R_AIR },
+	{ LS_KICK_L_AIR },
+	{ LS_STABDOWN },
+	{ LS_STABDOWN_STAFF },
+	{ LS_STABDOWN_DUAL },
+	{ LS_DUAL_SPIN_PROTECT },
+	{ LS_STAFF_SOULCAL },
+	{ LS_A1_SPECIAL },
+	{ LS_A2_SPECIAL },
+	{ LS_A3_SPECIAL },
+	{ LS_UPSIDE_DOWN_ATTACK },
+	{ LS_PULL_ATTACK_STAB },
+	{ LS_PULL_ATTACK_SWING },
+	{ LS_SPINATTACK_ALORA },
+	{ LS_DUAL_FB },
+	{ LS_DUAL_LR },
+	{ LS_HILT_BASH },
+	{ LS_SLAP_R },
+	{ LS_SLAP_L },
+};
+
+//PM_SaberInIdle
+static const animClassRange_t saberIdleMoves[] =
+{
+	{ LS_NONE },
+	{ LS_READY },
+	{ LS_DRAW },
+	{ LS_PUTAWAY },
+};
+
+//PM_KickMove
+static const animClassRange_t saberKickMoves[] =
+{
+	{ LS_KICK_F },
+	{ LS_KICK_F_MD },
+	{ LS_KICK_B },
+	{ LS_KICK_SWEEP },
+	{ LS_KICK_R },
+	{ LS_SMACK_R },
+	{ LS_KICK_L },
+	{ LS_SMACK_L },
+	{ LS_KICK_S },
+	{ LS_KICK_BF },
+	{ LS_KICK_RL },
+	{ LS_HILT_BASH },
+	{ LS_SLAP_R },
+	{ LS_SLAP_L },
+	{ LS_KICK_F_AIR },
+	{ LS_FLYING_KICK },
+	{ LS_KICK_B_AIR },
+	{ LS_KICK_R_AIR },
+	{ LS_KICK_L_AIR },
+};
+
+//PM_SaberDoDamageAnim
+static const animClassRange_t saberDamageAnims[] =
+{
+	{ BOTH_A2_STABBACK1 },
+	{ BOTH_ATTACK_BACK },
+	{ BOTH_CROUCHATTACKBACK1 },
+	{ BOTH_ROLL_STAB },
+	{ BOTH_BUTTERFLY_LEFT },
+	{ BOTH_BUTTERFLY_RIGHT },
+	{ BOTH_BUTTERFLY_FL1 },
+	{ BOTH_BUTTERFLY_FR1 },
+	{ BOTH_FJSS_TR_BL },
+	{ BOTH_FJSS_TL_BR },
+	{ BOTH_LUNGE2_B__T_ },
+	{ BOTH_FORCELEAP2_T__B_ },
+	{ BOTH_JUMPFLIPSLASHDOWN1 },
+	{ BOTH_JUMPFLIPSTABDOWN },
+	{ BOTH_JUMPATTACK6 },
+	{ BOTH_JUMPATTACK7 },
+	{ BOTH_SPINATTACK6 },
+	{ BOTH_SPINATTACK7 },
+	{ BOTH_FORCELONGLEAP_ATTACK },
+	{ BOTH_VS_ATR_S },
+	{ BOTH_VS_ATL_S },
+	{ BOTH_VT_ATR_S },
+	{ BOTH_VT_ATL_S },
+	{ BOTH_STABDOWN },
+	{ BOTH_STABDOWN_STAFF },
+	{ BOTH_STABDOWN_DUAL },
+	{ BOTH_A6_SABERPROTECT },
+	{ BOTH_A7_SOULCAL },
+	{ BOTH_A1_SPECIAL },
+	{ BOTH_A2_SPECIAL },
+	{ BOTH_A3_SPECIAL },
+	{ BOTH_FLIP_ATTACK7 },
+	{ BOTH_PULL_IMPALE_STAB },
+	{ BOTH_PULL_IMPALE_SWING },
+	{ BOTH_ALORA_SPIN_SLASH },
+	{ BOTH_A6_FB },
+	{ BOTH_A6_LR },
+	{ BOTH_A7_HILT },
+	{ BOTH_SLAP_L },
+	{ BOTH_SLAP_R },
+	{ BOTH_LK_S_DL_S_SB_1_W },
+	{ BOTH_LK_S_DL_T_SB_1_W },
+	{ BOTH_LK_S_ST_S_SB_1_W },
+	{ BOTH_LK_S_ST_T_SB_1_W },
+	{ BOTH_LK_S_S_S_SB_1_W },
+	{ BOTH_LK_S_S_T_SB_1_W },
+	{ BOTH_LK_DL_DL_S_SB_1_W },
+	{ BOTH_LK_DL_DL_T_SB_1_W },
+	{ BOTH_LK_DL_ST_S_SB_1_W },
+	{ BOTH_LK_DL_ST_T_SB_1_W },
+	{ BOTH_LK_DL_S_S_SB_1_W },
+	{ BOTH_LK_DL_S_T_SB_1_W },
+	{ BOTH_LK_ST_DL_S_SB_1_W },
+	{ BOTH_LK_ST_DL_T_SB_1_W },
+	{ BOTH_LK_ST_ST_S_SB_1_W },
+	{ BOTH_LK_ST_ST_T_SB_1_W },
+	{ BOTH_LK_ST_S_S_SB_1_W },
+	{ BOTH_LK_ST_S_T_SB_1_W },
+	{ BOTH_HANG_ATTACK },
+};
+
+//PM_SaberInSpecialAttack
+static const animClassRange_t saberSpecialAttackAnims[] =
+{
+	{ BOTH_A2_STABBACK1 },
+	{ BOTH_ATTACK_BACK },
+	{ BOTH_CROUCHATTACKBACK1 },
+	{ BOTH_ROLL_STAB },
+	{ BOTH_BUTTERFLY_LEFT },
+	{ BOTH_BUTTERFLY_RIGHT },
+	{ BOTH_BUTTERFLY_FL1 },
+	{ BOTH_BUTTERFLY_FR1 },
+	{ BOTH_FJSS_TR_BL },
+	{ BOTH_FJSS_TL_BR },
+	{ BOTH_LUNGE2_B__T_ },
+	{ BOTH_FORCELEAP2_T__B_ },
+	{ BOTH_JUMPFLIPSLASHDOWN1 },
+	{ BOTH_JUMPFLIPSTABDOWN },
+	{ BOTH_JUMPATTACK6 },
+	{ BOTH_JUMPATTACK7 },
+	{ BOTH_SPINATTACK6 },
+	{ BOTH_SPINATTACK7 },
+	{ BOTH_FORCELONGLEAP_ATTACK },
+	{ BOTH_VS_ATR_S },
+	{ BOTH_VS_ATL_S },
+	{ BOTH_VT_ATR_S },
+	{ BOTH_VT_ATL_S },
+	{ BOTH_A7_KICK_F },
+	{ BOTH_KICK_F_MD },
+	{ BOTH_A7_KICK_B },
+	{ BOTH_SWEEP_KICK },
+	{ BOTH_A7_KICK_R },
+	{ BOTH_A7_KICK_L },
+	{ BOTH_A7_KICK_S },
+	{ BOTH_A7_KICK_BF },
+	{ BOTH_A7_KICK_RL },
+	{ BOTH_A7_KICK_F_AIR },
+	{ BOTH_FLYING_KICK },
+	{ BOTH_A7_KICK_B_AIR },
+	{ BOTH_A7_KICK_R_AIR },
+	{ BOTH_A7_KICK_L_AIR },
+	{ BOTH_STABDOWN },
+	{ BOTH_STABDOWN_STAFF },
+	{ BOTH_STABDOWN_DUAL },
+	{ BOTH_A6_SABERPROTECT },
+	{ BOTH_A7_SOULCAL },
+	{ BOTH_A1_SPECIAL },
+	{ BOTH_A2_SPECIAL },
+	{ BOTH_A3_SPECIAL },
+	{ BOTH_FLIP_ATTACK7 },
+	{ BOTH_PULL_IMPALE_STAB },
+	{ BOTH_PULL_IMPALE_SWING },
+	{ BOTH_ALORA_SPIN_SLASH },
+	{ BOTH_A6_FB },
+	{ BOTH_A6_LR },
+	{ BOTH_A7_HILT },
+	{ BOTH_SLAP_L },
+	{ BOTH_SLAP_R },
+	{ BOTH_A7_SLAP_R },
+	{ BOTH_A7_SLAP_L },
+	{ BOTH_LK_S_DL_S_SB_1_W },
+	{ BOTH_LK_S_DL_T_SB_1_W },
+	{ BOTH_LK_S_ST_S_SB_1_W },
+	{ BOTH_LK_S_ST_T_SB_1_W },
+	{ BOTH_LK_S_S_S_SB_1_W },
+	{ BOTH_LK_S_S_T_SB_1_W },
+	{ BOTH_LK_DL_DL_S_SB_1_W },
+	{ BOTH_LK_DL_DL_T_SB_1_W },
+	{ BOTH_LK_DL_ST_S_SB_1_W },
+	{ BOTH_LK_DL_ST_T_SB_1_W },
+	{ BOTH_LK_DL_S_S_SB_1_W },
+	{ BOTH_LK_DL_S_T_SB_1_W },
+	{ BOTH_LK_ST_DL_S_SB_1_W },
+	{ BOTH_LK_ST_DL_T_SB_1_W },
+	{ BOTH_LK_ST_ST_S_SB_1_W },
+	{ BOTH_LK_ST_ST_T_SB_1_W },
+	{ BOTH_LK_ST_S_S_SB_1_W },
+	{ BOTH_LK_ST_S_T_SB_1_W },
+	{ BOTH_HANG_ATTACK },
+};
+
+//PM_SaberInnonblockableAttack
+static const animClassRange_t saberNonblockableAnims[] =
+{
+	{ BOTH_ATTACK_BACK },
+	{ BOTH_A2_STABBACK1 },
+	{ BOTH_CROUCHATTACKBACK1 },
+	{ BOTH_BUTTERFLY_LEFT },
+	{ BOTH_BUTTERFLY_RIGHT },
+	{ BOTH_BUTTERFLY_FL1 },
+	{ BOTH_BUTTERFLY_FR1 },
+	{ BOTH_FJSS_TR_BL },
+	{ BOTH_FJSS_TL_BR },
+	{ BOTH_FORCELEAP2_T__B_ },
+	{ BOTH_JUMPFLIPSLASHDOWN1 },
+	{ BOTH_JUMPFLIPSTABDOWN },
+	{ BOTH_JUMPATTACK6 },
+	{ BOTH_JUMPATTACK7 },
+	{ BOTH_SPINATTACK6 },
+	{ BOTH_SPINATTACK7 },
+	{ BOTH_FORCELONGLEAP_ATTACK },
+	{ BOTH_STABDOWN },
+	{ BOTH_STABDOWN_STAFF },
+	{ BOTH_STABDOWN_DUAL },
+	{ BOTH_A6_SABERPROTECT },
+	{ BOTH_A7_SOULCAL },
+	{ BOTH_A1_SPECIAL },
+	{ BOTH_A2_SPECIAL },
+	{ BOTH_A3_SPECIAL },
+	{ BOTH_FLIP_ATTACK7 },
+	{ BOTH_PULL_IMPALE_STAB },
+	{ BOTH_PULL_IMPALE_SWING },
+	{ BOTH_ALORA_SPIN_SLASH },
+	{ BOTH_A6_FB },
+	{ BOTH_A6_LR },
+};
+
+//PM_BounceAnim
+static const animClassRange_t saberBounceAnims[] =
+{
+	{ BOTH_B1_BR___, BOTH_B1_BL___ },
+	{ BOTH_B2_BR___, BOTH_B2_BL___ },
+	{ BOTH_B3_BR___, BOTH_B3_BL___ },
+	{ BOTH_B4_BR___, BOTH_B4_BL___ },
+	{ BOTH_B5_BR___, BOTH_B5_BL___ },
+	{ BOTH_B6_BR___, BOTH_B6_BL___ },
+	{ BOTH_B7_BR___, BOTH_B7_BL___ },
+};
+
+//PM_SaberReturnAnim
+static const animClassRange_t saberReturnAnims[] =
+{
+	{ BOTH_R1_B__S1, BOTH_R1_TR_S1 },
+	{ BOTH_R2_B__S1, BOTH_R2_TR_S1 },
+	{ BOTH_R3_B__S1, BOTH_R3_TR_S1 },
+	{ BOTH_R4_B__S1, BOTH_R4_TR_S1 },
+	{ BOTH_R5_B__S1, BOTH_R5_TR_S1 },
+	{ BOTH_R6_B__S6, BOTH_R6_TR_S6 },
+	{ BOTH_R7_B__S7, BOTH_R7_TR_S7 },
+};
+
+//BG_HopAnim
+static const animClassRange_t hopAnims[] =
+{
+	{ BOTH_HOP_F },
+	{ BOTH_HOP_R },
+	{ BOTH_HOP_L },
+	{ BOTH_HOP_B },
+	{ BOTH_DASH_F },
+	{ BOTH_DASH_R },
+	{ BOTH_DASH_L },
+	{ BOTH_DASH_B },
+};
+
+//PM_RollingAnim
+static const animClassRange_t rollingAnims[] =
+{
+	{ BOTH_ROLL_F },
+	{ BOTH_ROLL_B },
+	{ BOTH_ROLL_L },
+	{ BOTH_ROLL_R },
+	{ BOTH_GETUP_BROLL_B },
+	{ BOTH_GETUP_BROLL_F },
+	{ BOTH_GETUP_BROLL_L },
+	{ BOTH_GETUP_BROLL_R },
+	{ BOTH_GETUP_FROLL_B },
+	{ BOTH_GETUP_FROLL_F },
+	{ BOTH_GETUP_FROLL_L },
+	{ BOTH_GETUP_FROLL_R },
+};
+
+//BG_InKnockDown
+static const animClassRange_t knockdownAnims[] =
+{
+	{ BOTH_KNOCKDOWN1 },
+	{ BOTH_KNOCKDOWN2 },
+	{ BOTH_KNOCKDOWN3 },
+	{ BOTH_KNOCKDOWN4 },
+	{ BOTH_KNOCKDOWN5 },
+	{ BOTH_SLAPDOWNRIGHT },
+	{ BOTH_SLAPDOWNLEFT },
+	{ BOTH_GETUP1 },
+	{ BOTH_GETUP2 },
+	{ BOTH_GETUP3 },
+	{ BOTH_GETUP4 },
+	{ BOTH_GETUP5 },
+	{ BOTH_FORCE_GETUP_F1 },
+	{ BOTH_FORCE_GETUP_F2 },
+	{ BOTH_FORCE_GETUP_B1 },
+	{ BOTH_FORCE_GETUP_B2 },
+	{ BOTH_FORCE_GETUP_B3 },
+	{ BOTH_FORCE_GETUP_B4 },
+	{ BOTH_FORCE_GETUP_B5 },
+	{ BOTH_GETUP_BROLL_B },
+	{ BOTH_GETUP_BROLL_F },
+	{ BOTH_GETUP_BROLL_L },
+	{ BOTH_GETUP_BROLL_R },
+	{ BOTH_GETUP_FROLL_B },
+	{ BOTH_GETUP_FROLL_F },
+	{ BOTH_GETUP_FROLL_L },
+	{ BOTH_GETUP_FROLL_R },
+};
+
+//PM_InKnockDown
+static const animClassRange_t knockedDownAnims[] =
+{
+	{ BOTH_KNOCKDOWN1 },
+	{ BOTH_KNOCKDOWN2 },
+	{ BOTH_KNOCKDOWN3 },
+	{ BOTH_KNOCKDOWN4 },
+	{ BOTH_KNOCKDOWN5 },
+	{ BOTH_SLAPDOWNRIGHT },
+	{ BOTH_SLAPDOWNLEFT },
+	{ BOTH_RELEASED },
+};
+
+//PM_InGetUp
+static const animClassRange_t getUpAnims[] =
+{
+	{ BOTH_GETUP1 },
+	{ BOTH_GETUP2 },
+	{ BOTH_GETUP3 },
+	{ BOTH_GETUP4 },
+	{ BOTH_GETUP5 },
+	{ BOTH_GETUP_CROUCH_F1 },
+	{ BOTH_GETUP_CROUCH_B1 },
+	{ BOTH_GETUP_BROLL_B },
+	{ BOTH_GETUP_BROLL_F },
+	{ BOTH_GETUP_BROLL_L },
+	{ BOTH_GETUP_BROLL_R },
+	{ BOTH_GETUP_FROLL_B },
+	{ BOTH_GETUP_FROLL_F },
+	{ BOTH_GETUP_FROLL_L },
+	{ BOTH_GETUP_FROLL_R },
+};
+
+struct animClassDef_t
+{
+	std::uint32_t classBit;
+	const animClassRange_t *ranges;
+	int numRanges;
+};
+
+#define ANIMCLASS_DEF( classBit, ranges ) { classBit, ranges, sizeof( ranges ) / sizeof( ranges[0] ) }
+
+static const animClassDef_t saberMoveClassDefs[] =
+{
+	ANIMCLASS_DEF( SMC_ATTACK, saberAttackMoves ),
+	ANIMCLASS_DEF( SMC_ATTACK_PURE, saberAttackPureMoves ),
+	ANIMCLASS_DEF( SMC_DAMAGE, saberDamageMoves ),
+	ANIMCLASS_DEF( SMC_TRANSITION, saberTransitionMoves ),
+	ANIMCLASS_DEF( SMC_START, saberStartMoves ),
+	ANIMCLASS_DEF( SMC_RETURN, saberReturnMoves ),
+	ANIMCLASS_DEF( SMC_BOUNCE, saberBounceMoves ),
+	ANIMCLASS_DEF( SMC_BROKEN_PARRY, saberBrokenParryMoves ),
+	ANIMCLASS_DEF( SMC_DEFLECT, saberDeflectMoves ),
+	ANIMCLASS_DEF( SMC_PARRY, saberParryMoves ),
+	ANIMCLASS_DEF( SMC_KNOCKAWAY, saberKnockawayMoves ),
+	ANIMCLASS_DEF( SMC_REFLECT, saberReflectMoves ),
+	ANIMCLASS_DEF( SMC_SPECIAL, saberSpecialMoves ),
+	ANIMCLASS_DEF( SMC_IDLE, saberIdleMoves ),
+	ANIMCLASS_DEF( SMC_KICK, saberKickMoves ),
+};
+
+static const animClassDef_t animClassDefs[] =
+{
+	ANIMCLASS_DEF( AC_SABER_DAMAGE, saberDamageAnims ),
+	ANIMCLASS_DEF( AC_SABER_SPECIAL_ATTACK, saberSpecialAttackAnims ),
+	ANIMCLASS_DEF( AC_SABER_NONBLOCKABLE, saberNonblockableAnims ),
+	ANIMCLASS_DEF( AC_SABER_BOUNCE, saberBounceAnims ),
+	ANIMCLASS_DEF( AC_SABER_RETURN, saberReturnAnims ),
+	ANIMCLASS_DEF( AC_HOP, hopAnims ),
+	ANIMCLASS_DEF( AC_ROLLING, rollingAnims ),
+	ANIMCLASS_DEF( AC_KNOCKDOWN, knockdownAnims ),
+	ANIMCLASS_DEF( AC_KNOCKED_DOWN, knockedDownAnims ),
+	ANIMCLASS_DEF( AC_GETUP, getUpAnims ),
+};
+
+#undef ANIMCLASS_DEF
+
+static void BG_FillClasses( std::uint32_t *classes, const int numIds, const animClassDef_t *defs, const int numDefs )
+{
+	for ( int i = 0; i < numDefs; i++ )
+	{
+		for ( int j = 0; j < defs[i].numRanges; j++ )
+		{
+			const animClassRange_t &range = defs[i].ranges[j];
+			const int last = range.last > range.first ? range.last : range.first;
+			for ( int id = range.first; id <= last; id++ )
+			{
+				if ( id >= 0 && id < numIds )
+				{
+					classes[id] |= defs[i].classBit;
+				}
+			}
+		}
+	}
+}
+
+// built once at load, before anything can run a pmove
+static struct animClassInit_t
+{
+	animClassInit_t()
+	{
+		BG_FillClasses( bg_saberMoveClasses, LS_MOVE_MAX, saberMoveClassDefs, sizeof( saberMoveClassDefs ) / sizeof( saberMoveClassDefs[0] ) );
+		BG_FillClasses( bg_animClasses, MAX_ANIMATIONS, animClassDefs, sizeof( animClassDefs ) / sizeof( animClassDefs[0] ) );
+	}
+} animClassInit;
@@ -0,0 +1,84 @@
+/*
+===========================================================================
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#ifndef __BG_ANIMCLASS_H
+#define __BG_ANIMCLASS_H
+
+// Per saber move and per animation class bits, so the PM_Saber*, PM_*Anim and knockdown checks
+// are a single table lookup instead of a long switch.
+
+#include <cstdint>
+
+#include "anims.h"
+#include "wp_saberMoves.h"
+
+// saber move classes, bits of bg_saberMoveClasses
+enum
+{
+	SMC_ATTACK			= 1 << 0,	//PM_SaberInAttack
+	SMC_ATTACK_PURE		= 1 << 1,	//PM_SaberInAttackPure
+	SMC_DAMAGE			= 1 << 2,	//PM_SaberInDamageMove
+	SMC_TRANSITION		= 1 << 3,	//PM_SaberInTransition
+	SMC_START			= 1 << 4,	//PM_SaberInStart
+	SMC_RETURN			= 1 << 5,	//PM_SaberInReturn
+	SMC_BOUNCE			= 1 << 6,	//PM_SaberInBounce
+	SMC_BROKEN_PARRY	= 1 << 7,	//PM_SaberInBrokenParry
+	SMC_DEFLECT			= 1 << 8,	//PM_SaberInDeflect
+	SMC_PARRY			= 1 << 9,	//PM_SaberInParry
+	SMC_KNOCKAWAY		= 1 << 10,	//PM_SaberInKnockaway
+	SMC_REFLECT			= 1 << 11,	//PM_SaberInReflect
+	SMC_SPECIAL			= 1 << 12,	//PM_SaberInSpecial
+	SMC_IDLE			= 1 << 13,	//PM_SaberInIdle
+	SMC_KICK			= 1 << 14,	//PM_KickMove
+};
+
+// animation classes, bits of bg_animClasses
+enum
+{
+	AC_SABER_DAMAGE			= 1 << 0,	//PM_SaberDoDamageAnim
+	AC_SABER_SPECIAL_ATTACK	= 1 << 1,	//PM_SaberInSpecialAttack
+	AC_SABER_NONBLOCKABLE	= 1 << 2,	//PM_SaberInnonblockableAttack
+	AC_SABER_BOUNCE			= 1 << 3,	//PM_BounceAnim
+	AC_SABER_RETURN			= 1 << 4,	//PM_SaberReturnAnim
+	AC_HOP					= 1 << 5,	//BG_HopAnim
+	AC_ROLLING				= 1 << 6,	//PM_RollingAnim
+	AC_KNOCKDOWN			= 1 << 7,	//BG_InKnockDown
+	AC_KNOCKED_DOWN			= 1 << 8,	//PM_InKnockDown, the anims that don't depend on the timer
+	AC_GETUP				= 1 << 9,	//PM_InGetUp, while legsAnimTimer is running
+};
+
+extern std::uint32_t bg_saberMoveClasses[LS_MOVE_MAX];
+extern std::uint32_t bg_animClasses[MAX_ANIMATIONS];
+
+// true if move is in any of the SMC_* classes
+inline bool BG_SaberMoveInClasses( const int move, const std::uint32_t classes )
+{
+	return static_cast<unsigned>( move ) < LS_MOVE_MAX && ( bg_saberMoveClasses[move] & classes ) != 0;
+}
+
+// true if anim is in any of the AC_* classes
+inline bool BG_AnimInClasses( const int anim, const std::uint32_t classes )
+{
+	return static_cast<unsigned>( anim ) < MAX_ANIMATIONS && ( bg_animClasses[anim] & classes ) != 0;
+}
+
+#endif //__BG_ANIMCLASS_H
@@ -46,6 +46,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "Q3_Interface.h"
 #include "g_local.h"
 #include "wp_saber.h"
+#include "bg_animClass.h"
 #include "g_vehicles.h"
 
 extern pmove_t	*pm;
@@ -1240,312 +1241,41 @@ qboolean PM_InAnimForSaberMove( int anim, int saberMove )
 
 qboolean PM_SaberInDamageMove(int move)
 {
-	if (move >= LS_A_TL2BR && move <= LS_A_T2B)
-	{
-		return qtrue;
-	}
-	switch (move)
-	{
-	case LS_A_BACK:
-	case LS_A_BACK_CR:
-	case LS_A_BACKSTAB:
-	case LS_ROLL_STAB:
-	case LS_A_LUNGE:
-	case LS_A_JUMP_T__B_:
-	case LS_A_FLIP_STAB:
-	case LS_A_FLIP_SLASH:
-	case LS_JUMPATTACK_DUAL:
-	case LS_JUMPATTACK_ARIAL_LEFT:
-	case LS_JUMPATTACK_ARIAL_RIGHT:
-	case LS_JUMPATTACK_CART_LEFT:
-	case LS_JUMPATTACK_CART_RIGHT:
-	case LS_JUMPATTACK_STAFF_LEFT:
-	case LS_JUMPATTACK_STAFF_RIGHT:
-	case LS_BUTTERFLY_LEFT:
-	case LS_BUTTERFLY_RIGHT:
-	case LS_A_BACKFLIP_ATK:
-	case LS_SPINATTACK_DUAL:
-	case LS_SPINATTACK:
-	case LS_LEAP_ATTACK:
-	case LS_SWOOP_ATTACK_RIGHT:
-	case LS_SWOOP_ATTACK_LEFT:
-	case LS_TAUNTAUN_ATTACK_RIGHT:
-	case LS_TAUNTAUN_ATTACK_LEFT:
-	case LS_STABDOWN:
-	case LS_STABDOWN_STAFF:
-	case LS_STABDOWN_DUAL:
-	case LS_DUAL_SPIN_PROTECT:
-	case LS_STAFF_SOULCAL:
-	case LS_A1_SPECIAL:
-	case LS_A2_SPECIAL:
-	case LS_A3_SPECIAL:
-	case LS_UPSIDE_DOWN_ATTACK:
-	case LS_PULL_ATTACK_STAB:
-	case LS_PULL_ATTACK_SWING:
-	case LS_SPINATTACK_ALORA:
-	case LS_DUAL_FB:
-	case LS_DUAL_LR:
-	case LS_HILT_BASH:
-	case LS_SLAP_R:
-	case LS_SLAP_L:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_DAMAGE );
 }
 
 qboolean PM_SaberDoDamageAnim(int anim)
 {
-	switch (anim)
-	{
-	case BOTH_A2_STABBACK1:
-	case BOTH_ATTACK_BACK:
-	case BOTH_CROUCHATTACKBACK1:
-	case BOTH_ROLL_STAB:
-	case BOTH_BUTTERFLY_LEFT:
-	case BOTH_BUTTERFLY_RIGHT:
-	case BOTH_BUTTERFLY_FL1:
-	case BOTH_BUTTERFLY_FR1:
-	case BOTH_FJSS_TR_BL:
-	case BOTH_FJSS_TL_BR:
-	case BOTH_LUNGE2_B__T_:
-	case BOTH_FORCELEAP2_T__B_:
-	case BOTH_JUMPFLIPSLASHDOWN1://#
-	case BOTH_JUMPFLIPSTABDOWN://#
-	case BOTH_JUMPATTACK6:
-	case BOTH_JUMPATTACK7:
-	case BOTH_SPINATTACK6:
-	case BOTH_SPINATTACK7:
-	case BOTH_FORCELONGLEAP_ATTACK:
-	case BOTH_VS_ATR_S:
-	case BOTH_VS_ATL_S:
-	case BOTH_VT_ATR_S:
-	case BOTH_VT_ATL_S:
-	case BOTH_STABDOWN:
-	case BOTH_STABDOWN_STAFF:
-	case BOTH_STABDOWN_DUAL:
-	case BOTH_A6_SABERPROTECT:
-	case BOTH_A7_SOULCAL:
-	case BOTH_A1_SPECIAL:
-	case BOTH_A2_SPECIAL:
-	case BOTH_A3_SPECIAL:
-	case BOTH_FLIP_ATTACK7:
-	case BOTH_PULL_IMPALE_STAB:
-	case BOTH_PULL_IMPALE_SWING:
-	case BOTH_ALORA_SPIN_SLASH:
-	case BOTH_A6_FB:
-	case BOTH_A6_LR:
-	case BOTH_A7_HILT:
-	case BOTH_SLAP_L:
-	case BOTH_SLAP_R:
-	case BOTH_LK_S_DL_S_SB_1_W:
-	case BOTH_LK_S_DL_T_SB_1_W:
-	case BOTH_LK_S_ST_S_SB_1_W:
-	case BOTH_LK_S_ST_T_SB_1_W:
-	case BOTH_LK_S_S_S_SB_1_W:
-	case BOTH_LK_S_S_T_SB_1_W:
-	case BOTH_LK_DL_DL_S_SB_1_W:
-	case BOTH_LK_DL_DL_T_SB_1_W:
-	case BOTH_LK_DL_ST_S_SB_1_W:
-	case BOTH_LK_DL_ST_T_SB_1_W:
-	case BOTH_LK_DL_S_S_SB_1_W:
-	case BOTH_LK_DL_S_T_SB_1_W:
-	case BOTH_LK_ST_DL_S_SB_1_W:
-	case BOTH_LK_ST_DL_T_SB_1_W:
-	case BOTH_LK_ST_ST_S_SB_1_W:
-	case BOTH_LK_ST_ST_T_SB_1_W:
-	case BOTH_LK_ST_S_S_SB_1_W:
-	case BOTH_LK_ST_S_T_SB_1_W:
-	case BOTH_HANG_ATTACK:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_SABER_DAMAGE );
 }
 
 qboolean PM_SaberInIdle( int move )
 {
-	switch ( move )
-	{
-	case LS_NONE:
-	case LS_READY:
-	case LS_DRAW:
-	case LS_PUTAWAY:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_IDLE );
 }
 
 qboolean BG_HopAnim(int anim)
 {//check to see if anim is a hop animation.
-
-	switch (anim)
-	{
-	case BOTH_HOP_F:
-	case BOTH_HOP_R:
-	case BOTH_HOP_L:
-	case BOTH_HOP_B:
-	case BOTH_DASH_F:
-	case BOTH_DASH_R:
-	case BOTH_DASH_L:
-	case BOTH_DASH_B:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_HOP );
 }
 
 qboolean PM_BounceAnim(int anim)
 {//check for saber bounce animation
-	if ((anim >= BOTH_B1_BR___ && anim <= BOTH_B1_BL___)
-		|| (anim >= BOTH_B2_BR___ && anim <= BOTH_B2_BL___)
-		|| (anim >= BOTH_B3_BR___ && anim <= BOTH_B3_BL___)
-		|| (anim >= BOTH_B4_BR___ && anim <= BOTH_B4_BL___)
-		|| (anim >= BOTH_B5_BR___ && anim <= BOTH_B5_BL___)
-		|| (anim >= BOTH_B6_BR___ && anim <= BOTH_B6_BL___)
-		|| (anim >= BOTH_B7_BR___ && anim <= BOTH_B7_BL___))
-	{
-		return qtrue;
-	}
-
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_SABER_BOUNCE );
 }
 
 qboolean PM_SaberReturnAnim(int anim)
 {
-	if ((anim >= BOTH_R1_B__S1 && anim <= BOTH_R1_TR_S1)
-		|| (anim >= BOTH_R2_B__S1 && anim <= BOTH_R2_TR_S1)
-		|| (anim >= BOTH_R3_B__S1 && anim <= BOTH_R3_TR_S1)
-		|| (anim >= BOTH_R4_B__S1 && anim <= BOTH_R4_TR_S1)
-		|| (anim >= BOTH_R5_B__S1 && anim <= BOTH_R5_TR_S1)
-		|| (anim >= BOTH_R6_B__S6 && anim <= BOTH_R6_TR_S6)
-		|| (anim >= BOTH_R7_B__S7 && anim <= BOTH_R7_TR_S7))
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_SABER_RETURN );
 }
 qboolean PM_SaberInSpecialAttack( int anim )
 {
-	switch ( anim )
-	{
-	case BOTH_A2_STABBACK1:
-	case BOTH_ATTACK_BACK:
-	case BOTH_CROUCHATTACKBACK1:
-	case BOTH_ROLL_STAB:
-	case BOTH_BUTTERFLY_LEFT:
-	case BOTH_BUTTERFLY_RIGHT:
-	case BOTH_BUTTERFLY_FL1:
-	case BOTH_BUTTERFLY_FR1:
-	case BOTH_FJSS_TR_BL:
-	case BOTH_FJSS_TL_BR:
-	case BOTH_LUNGE2_B__T_:
-	case BOTH_FORCELEAP2_T__B_:
-	case BOTH_JUMPFLIPSLASHDOWN1://#
-	case BOTH_JUMPFLIPSTABDOWN://#
-	case BOTH_JUMPATTACK6:
-	case BOTH_JUMPATTACK7:
-	case BOTH_SPINATTACK6:
-	case BOTH_SPINATTACK7:
-	case BOTH_FORCELONGLEAP_ATTACK:
-	case BOTH_VS_ATR_S:
-	case BOTH_VS_ATL_S:
-	case BOTH_VT_ATR_S:
-	case BOTH_VT_ATL_S:
-	case BOTH_A7_KICK_F:
-	case BOTH_KICK_F_MD:
-	case BOTH_A7_KICK_B:
-	case BOTH_SWEEP_KICK:
-	case BOTH_A7_KICK_R:
-	case BOTH_A7_KICK_L:
-	case BOTH_A7_KICK_S:
-	case BOTH_A7_KICK_BF:
-	case BOTH_A7_KICK_RL:
-	case BOTH_A7_KICK_F_AIR:
-	case BOTH_FLYING_KICK:
-	case BOTH_A7_KICK_B_AIR:
-	case BOTH_A7_KICK_R_AIR:
-	case BOTH_A7_KICK_L_AIR:
-	case BOTH_STABDOWN:
-	case BOTH_STABDOWN_STAFF:
-	case BOTH_STABDOWN_DUAL:
-	case BOTH_A6_SABERPROTECT:
-	case BOTH_A7_SOULCAL:
-	case BOTH_A1_SPECIAL:
-	case BOTH_A2_SPECIAL:
-	case BOTH_A3_SPECIAL:
-	case BOTH_FLIP_ATTACK7:
-	case BOTH_PULL_IMPALE_STAB:
-	case BOTH_PULL_IMPALE_SWING:
-	case BOTH_ALORA_SPIN_SLASH:
-	case BOTH_A6_FB:
-	case BOTH_A6_LR:
-	case BOTH_A7_HILT:
-	case BOTH_SLAP_L:
-	case BOTH_SLAP_R:
-	case BOTH_A7_SLAP_R:
-	case BOTH_A7_SLAP_L:
-	case BOTH_LK_S_DL_S_SB_1_W:
-	case BOTH_LK_S_DL_T_SB_1_W:
-	case BOTH_LK_S_ST_S_SB_1_W:
-	case BOTH_LK_S_ST_T_SB_1_W:
-	case BOTH_LK_S_S_S_SB_1_W:
-	case BOTH_LK_S_S_T_SB_1_W:
-	case BOTH_LK_DL_DL_S_SB_1_W:
-	case BOTH_LK_DL_DL_T_SB_1_W:
-	case BOTH_LK_DL_ST_S_SB_1_W:
-	case BOTH_LK_DL_ST_T_SB_1_W:
-	case BOTH_LK_DL_S_S_SB_1_W:
-	case BOTH_LK_DL_S_T_SB_1_W:
-	case BOTH_LK_ST_DL_S_SB_1_W:
-	case BOTH_LK_ST_DL_T_SB_1_W:
-	case BOTH_LK_ST_ST_S_SB_1_W:
-	case BOTH_LK_ST_ST_T_SB_1_W:
-	case BOTH_LK_ST_S_S_SB_1_W:
-	case BOTH_LK_ST_S_T_SB_1_W:
-	case BOTH_HANG_ATTACK:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_SABER_SPECIAL_ATTACK );
 }
 
 qboolean PM_SaberInnonblockableAttack(int anim)
 {
-	switch (anim)
-	{
-	case BOTH_ATTACK_BACK:
-	case BOTH_A2_STABBACK1:
-	case BOTH_CROUCHATTACKBACK1:
-	case BOTH_BUTTERFLY_LEFT:
-	case BOTH_BUTTERFLY_RIGHT:
-	case BOTH_BUTTERFLY_FL1:
-	case BOTH_BUTTERFLY_FR1:
-	case BOTH_FJSS_TR_BL:
-	case BOTH_FJSS_TL_BR:
-	case BOTH_FORCELEAP2_T__B_:
-	case BOTH_JUMPFLIPSLASHDOWN1://#
-	case BOTH_JUMPFLIPSTABDOWN://#
-	case BOTH_JUMPATTACK6:
-	case BOTH_JUMPATTACK7:
-	case BOTH_SPINATTACK6:
-	case BOTH_SPINATTACK7:
-	case BOTH_FORCELONGLEAP_ATTACK:
-	case BOTH_STABDOWN:
-	case BOTH_STABDOWN_STAFF:
-	case BOTH_STABDOWN_DUAL:
-	case BOTH_A6_SABERPROTECT:
-	case BOTH_A7_SOULCAL:
-	case BOTH_A1_SPECIAL:
-	case BOTH_A2_SPECIAL:
-	case BOTH_A3_SPECIAL:
-	case BOTH_FLIP_ATTACK7:
-	case BOTH_PULL_IMPALE_STAB:
-	case BOTH_PULL_IMPALE_SWING:
-	case BOTH_ALORA_SPIN_SLASH:
-	case BOTH_A6_FB:
-	case BOTH_A6_LR:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_SABER_NONBLOCKABLE );
 }
 
 int BG_InGrappleMove(int anim)
@@ -1572,307 +1302,62 @@ int BG_InGrappleMove(int anim)
 
 qboolean PM_SaberInAttack( int move )
 {
-	if ( move >= LS_A_TL2BR && move <= LS_A_T2B )
-	{
-		return qtrue;
-	}
-	switch ( move )
-	{
-	case LS_A_BACK:
-	case LS_A_BACK_CR:
-	case LS_A_BACKSTAB:
-	case LS_ROLL_STAB:
-	case LS_A_LUNGE:
-	case LS_A_JUMP_T__B_:
-	case LS_A_FLIP_STAB:
-	case LS_A_FLIP_SLASH:
-	case LS_JUMPATTACK_DUAL:
-	case LS_JUMPATTACK_ARIAL_LEFT:
-	case LS_JUMPATTACK_ARIAL_RIGHT:
-	case LS_JUMPATTACK_CART_LEFT:
-	case LS_JUMPATTACK_CART_RIGHT:
-	case LS_JUMPATTACK_STAFF_LEFT:
-	case LS_JUMPATTACK_STAFF_RIGHT:
-	case LS_BUTTERFLY_LEFT:
-	case LS_BUTTERFLY_RIGHT:
-	case LS_A_BACKFLIP_ATK:
-	case LS_SPINATTACK_DUAL:
-	case LS_SPINATTACK:
-	case LS_LEAP_ATTACK:
-	case LS_SWOOP_ATTACK_RIGHT:
-	case LS_SWOOP_ATTACK_LEFT:
-	case LS_TAUNTAUN_ATTACK_RIGHT:
-	case LS_TAUNTAUN_ATTACK_LEFT:
-	case LS_KICK_F:
-	case LS_KICK_F_MD:
-	case LS_KICK_B:
-	case LS_KICK_SWEEP:
-	case LS_KICK_R:
-	case LS_SMACK_R:
-	case LS_KICK_L:
-	case LS_SMACK_L:
-	case LS_KICK_S:
-	case LS_KICK_BF:
-	case LS_KICK_RL:
-	case LS_KICK_F_AIR:
-	case LS_FLYING_KICK:
-	case LS_KICK_B_AIR:
-	case LS_KICK_R_AIR:
-	case LS_KICK_L_AIR:
-	case LS_STABDOWN:
-	case LS_STABDOWN_STAFF:
-	case LS_STABDOWN_DUAL:
-	case LS_DUAL_SPIN_PROTECT:
-	case LS_STAFF_SOULCAL:
-	case LS_A1_SPECIAL:
-	case LS_A2_SPECIAL:
-	case LS_A3_SPECIAL:
-	case LS_UPSIDE_DOWN_ATTACK:
-	case LS_PULL_ATTACK_STAB:
-	case LS_PULL_ATTACK_SWING:
-	case LS_SPINATTACK_ALORA:
-	case LS_DUAL_FB:
-	case LS_DUAL_LR:
-	case LS_HILT_BASH:
-	case LS_SLAP_R:
-	case LS_SLAP_L:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_ATTACK );
 }
 
 qboolean PM_SaberInAttackPure(int move)
 {
-	if (move >= LS_A_TL2BR && move <= LS_A_T2B)
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_ATTACK_PURE );
 }
 qboolean PM_SaberInTransition( int move )
 {
-	if ( move >= LS_T1_BR__R && move <= LS_T1_BL__L )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_TRANSITION );
 }
 qboolean PM_SaberInStart( int move )
 {
-	if ( move >= LS_S_TL2BR && move <= LS_S_T2B )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_START );
 }
 qboolean PM_SaberInReturn( int move )
 {
-	if ( move >= LS_R_TL2BR && move <= LS_R_T2B )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_RETURN );
 }
 qboolean PM_SaberInTransitionAny( int move )
 {
-	if ( PM_SaberInStart( move ) )
-	{
-		return qtrue;
-	}
-	else if ( PM_SaberInTransition( move ) )
-	{
-		return qtrue;
-	}
-	else if ( PM_SaberInReturn( move ) )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_START | SMC_TRANSITION | SMC_RETURN );
 }
 qboolean PM_SaberInBounce( int move )
 {
-	if ( move >= LS_B1_BR && move <= LS_B1_BL )
-	{
-		return qtrue;
-	}
-	if ( move >= LS_D1_BR && move <= LS_D1_BL )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_BOUNCE );
 }
 qboolean PM_SaberInBrokenParry( int move )
 {
-	if ( move >= LS_V1_BR && move <= LS_V1_B_ )
-	{
-		return qtrue;
-	}
-	if ( move >= LS_H1_T_ && move <= LS_H1_BL )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_BROKEN_PARRY );
 }
 qboolean PM_SaberInDeflect( int move )
 {
-	if ( move >= LS_D1_BR && move <= LS_D1_B_ )
-	{
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_DEFLECT );
 }
 qboolean PM_SaberInParry( int move )
 {
-	switch (move)
-	{
-	case LS_PARRY_UP:
-	case LS_PARRY_UR:
-	case LS_PARRY_UL:
-	case LS_PARRY_LR:
-	case LS_PARRY_LL:
-	case LS_PARRY_UP_MD:
-	case LS_PARRY_UR_MD:
-	case LS_PARRY_UL_MD:
-	case LS_PARRY_LR_MD:
-	case LS_PARRY_LL_MD:
-	case LS_PARRY_BACK:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_PARRY );
 }
 qboolean PM_SaberInKnockaway( int move )
 {
-	switch (move)
-	{
-	case LS_K1_T_:
-	case LS_K1_TR:
-	case LS_K1_TR_MD:
-	case LS_K1_TR_PB:
-	case LS_K1_TL:
-	case LS_K1_TL_MD:
-	case LS_K1_TL_PB:
-	case LS_K1_BR:
-	case LS_K1_BL:
-		//
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_KNOCKAWAY );
 }
 qboolean PM_SaberInReflect( int move )
 {
-	switch (move)
-	{
-	case LS_REFLECT_UP:
-	case LS_REFLECT_UR:
-	case LS_REFLECT_UL:
-	case LS_REFLECT_LR:
-	case LS_REFLECT_LL:
-	case LS_REFLECT_UP_MD:
-	case LS_REFLECT_UR_MD:
-	case LS_REFLECT_UL_MD:
-	case LS_REFLECT_LR_MD:
-	case LS_REFLECT_LL_MD:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_REFLECT );
 }
 
 qboolean PM_SaberInSpecial( int move )
 {
-	switch( move )
-	{
-	case LS_A_BACK:
-	case LS_A_BACK_CR:
-	case LS_A_BACKSTAB:
-	case LS_ROLL_STAB:
-	case LS_A_LUNGE:
-	case LS_A_JUMP_T__B_:
-	case LS_A_FLIP_STAB:
-	case LS_A_FLIP_SLASH:
-	case LS_JUMPATTACK_DUAL:
-	case LS_JUMPATTACK_ARIAL_LEFT:
-	case LS_JUMPATTACK_ARIAL_RIGHT:
-	case LS_JUMPATTACK_CART_LEFT:
-	case LS_JUMPATTACK_CART_RIGHT:
-	case LS_JUMPATTACK_STAFF_LEFT:
-	case LS_JUMPATTACK_STAFF_RIGHT:
-	case LS_BUTTERFLY_LEFT:
-	case LS_BUTTERFLY_RIGHT:
-	case LS_A_BACKFLIP_ATK:
-	case LS_SPINATTACK_DUAL:
-	case LS_SPINATTACK:
-	case LS_LEAP_ATTACK:
-	case LS_SWOOP_ATTACK_RIGHT:
-	case LS_SWOOP_ATTACK_LEFT:
-	case LS_TAUNTAUN_ATTACK_RIGHT:
-	case LS_TAUNTAUN_ATTACK_LEFT:
-	case LS_KICK_F:
-	case LS_KICK_F_MD:
-	case LS_KICK_B:
-	case LS_KICK_SWEEP:
-	case LS_KICK_R:
-	case LS_SMACK_R:
-	case LS_KICK_L:
-	case LS_SMACK_L:
-	case LS_KICK_S:
-	case LS_KICK_BF:
-	case LS_KICK_RL:
-	case LS_KICK_F_AIR:
-	case LS_FLYING_KICK:
-	case LS_KICK_B_AIR:
-	case LS_KICK_R_AIR:
-	case LS_KICK_L_AIR:
-	case LS_STABDOWN:
-	case LS_STABDOWN_STAFF:
-	case LS_STABDOWN_DUAL:
-	case LS_DUAL_SPIN_PROTECT:
-	case LS_STAFF_SOULCAL:
-	case LS_A1_SPECIAL:
-	case LS_A2_SPECIAL:
-	case LS_A3_SPECIAL:
-	case LS_UPSIDE_DOWN_ATTACK:
-	case LS_PULL_ATTACK_STAB:
-	case LS_PULL_ATTACK_SWING:
-	case LS_SPINATTACK_ALORA:
-	case LS_DUAL_FB:
-	case LS_DUAL_LR:
-	case LS_HILT_BASH:
-	case LS_SLAP_R:
-	case LS_SLAP_L:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_SPECIAL );
 }
 
 qboolean PM_KickMove( int move )
 {
-	switch( move )
-	{
-	case LS_KICK_F:
-	case LS_KICK_F_MD:
-	case LS_KICK_B:
-	case LS_KICK_SWEEP:
-	case LS_KICK_R:
-	case LS_SMACK_R:
-	case LS_KICK_L:
-	case LS_SMACK_L:
-	case LS_KICK_S:
-	case LS_KICK_BF:
-	case LS_KICK_RL:
-	case LS_HILT_BASH:
-	case LS_SLAP_R:
-	case LS_SLAP_L:
-	case LS_KICK_F_AIR:
-	case LS_FLYING_KICK:
-	case LS_KICK_B_AIR:
-	case LS_KICK_R_AIR:
-	case LS_KICK_L_AIR:
-		return qtrue;
-	}
-	return qfalse;
+	return (qboolean)BG_SaberMoveInClasses( move, SMC_KICK );
 }
 
 qboolean PM_SaberCanInterruptMove( int move, int anim )
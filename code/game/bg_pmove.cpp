@@ -53,6 +53,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../cgame/cg_local.h"	// yeah I know this is naughty, but we're shipping soon...
 
 #include "wp_saber.h"
+#include "bg_animClass.h"
 #include "g_vehicles.h"
 #include <float.h>
 
@@ -6166,34 +6167,11 @@ qboolean PM_InForceGetUp( playerState_t *ps )
 
 qboolean PM_InGetUp( playerState_t *ps )
 {
-	switch ( ps->legsAnim )
+	if ( BG_AnimInClasses( ps->legsAnim, AC_GETUP ) )
 	{
-	case BOTH_GETUP1:
-	case BOTH_GETUP2:
-	case BOTH_GETUP3:
-	case BOTH_GETUP4:
-	case BOTH_GETUP5:
-	case BOTH_GETUP_CROUCH_F1:
-	case BOTH_GETUP_CROUCH_B1:
-	case BOTH_GETUP_BROLL_B:
-	case BOTH_GETUP_BROLL_F:
-	case BOTH_GETUP_BROLL_L:
-	case BOTH_GETUP_BROLL_R:
-	case BOTH_GETUP_FROLL_B:
-	case BOTH_GETUP_FROLL_F:
-	case BOTH_GETUP_FROLL_L:
-	case BOTH_GETUP_FROLL_R:
-		if ( ps->legsAnimTimer )
-		{
-			return qtrue;
-		}
-		break;
-	default:
-		return PM_InForceGetUp( ps );
-		break;
+		return (qboolean)( ps->legsAnimTimer != 0 );
 	}
-	//what the hell, redundant, but...
-	return qfalse;
+	return PM_InForceGetUp( ps );
 }
 
 qboolean PM_InGetUpNoRoll( playerState_t *ps )
@@ -6226,75 +6204,24 @@ qboolean PM_InGetUpNoRoll( playerState_t *ps )
 
 qboolean PM_InKnockDown( playerState_t *ps )
 {
-	switch ( ps->legsAnim )
+	if ( BG_AnimInClasses( ps->legsAnim, AC_KNOCKED_DOWN ) )
 	{
-	case BOTH_KNOCKDOWN1:
-	case BOTH_KNOCKDOWN2:
-	case BOTH_KNOCKDOWN3:
-	case BOTH_KNOCKDOWN4:
-	case BOTH_KNOCKDOWN5:
-	case BOTH_SLAPDOWNRIGHT:
-	case BOTH_SLAPDOWNLEFT:
-	//special anims:
-	case BOTH_RELEASED:
 		return qtrue;
-		break;
+	}
+	switch ( ps->legsAnim )
+	{
 	case BOTH_LK_DL_ST_T_SB_1_L:
-		if ( ps->legsAnimTimer < 550 )
-		{
-			return qtrue;
-		}
-		break;
+		return (qboolean)( ps->legsAnimTimer < 550 );
 	case BOTH_PLAYER_PA_3_FLY:
-		if ( ps->legsAnimTimer < 300 )
-		{
-			return qtrue;
-		}
-		break;
+		return (qboolean)( ps->legsAnimTimer < 300 );
 	default:
 		return PM_InGetUp( ps );
-		break;
 	}
-	return qfalse;
 }
 
 qboolean BG_InKnockDown(int anim)
 {
-	switch ((anim))
-	{
-	case BOTH_KNOCKDOWN1:
-	case BOTH_KNOCKDOWN2:
-	case BOTH_KNOCKDOWN3:
-	case BOTH_KNOCKDOWN4:
-	case BOTH_KNOCKDOWN5:
-	case BOTH_SLAPDOWNRIGHT:
-	case BOTH_SLAPDOWNLEFT:
-		return qtrue;
-		break;
-	case BOTH_GETUP1:
-	case BOTH_GETUP2:
-	case BOTH_GETUP3:
-	case BOTH_GETUP4:
-	case BOTH_GETUP5:
-	case BOTH_FORCE_GETUP_F1:
-	case BOTH_FORCE_GETUP_F2:
-	case BOTH_FORCE_GETUP_B1:
-	case BOTH_FORCE_GETUP_B2:
-	case BOTH_FORCE_GETUP_B3:
-	case BOTH_FORCE_GETUP_B4:
-	case BOTH_FORCE_GETUP_B5:
-	case BOTH_GETUP_BROLL_B:
-	case BOTH_GETUP_BROLL_F:
-	case BOTH_GETUP_BROLL_L:
-	case BOTH_GETUP_BROLL_R:
-	case BOTH_GETUP_FROLL_B:
-	case BOTH_GETUP_FROLL_F:
-	case BOTH_GETUP_FROLL_L:
-	case BOTH_GETUP_FROLL_R:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_KNOCKDOWN );
 }
 
 qboolean PM_InSlapDown(playerState_t* ps)
@@ -7593,24 +7520,7 @@ qboolean PM_RunningAnim( int anim )
 
 qboolean PM_RollingAnim( int anim )
 {
-	switch ( anim )
-	{
-	case BOTH_ROLL_F:			//# Roll forward
-	case BOTH_ROLL_B:			//# Roll backward
-	case BOTH_ROLL_L:			//# Roll left
-	case BOTH_ROLL_R:			//# Roll right
-	case BOTH_GETUP_BROLL_B:
-	case BOTH_GETUP_BROLL_F:
-	case BOTH_GETUP_BROLL_L:
-	case BOTH_GETUP_BROLL_R:
-	case BOTH_GETUP_FROLL_B:
-	case BOTH_GETUP_FROLL_F:
-	case BOTH_GETUP_FROLL_L:
-	case BOTH_GETUP_FROLL_R:
-		return qtrue;
-		break;
-	}
-	return qfalse;
+	return (qboolean)BG_AnimInClasses( anim, AC_ROLLING );
 }
 
 qboolean PM_SaberWalkAnim(int anim)
@@ -1689,11 +1689,12 @@ CONVENIENCE FUNCTIONS FOR ENTIRE FILES
 ======================================================================================
 */
 
-int	FS_FileIsInPAK(const char *filename ) {
+int	FS_FileIsInPAK(const char *filename, int *pChecksum ) {
 	searchpath_t	*search;
 	pack_t			*pak;
 	fileInPack_t	*pakFile;
 	long			hash = 0;
+	FILE			*f;
 
 	FS_AssertInitialised();
 
@@ -1730,10 +1731,20 @@ int	FS_FileIsInPAK(const char *filename ) {
 			do {
 				// case and separator insensitive comparisons
 				if ( !FS_FilenameCompare( pakFile->name, filename ) ) {
+					if ( pChecksum ) {
+						*pChecksum = pak->checksum;
+					}
 					return 1;
 				}
 				pakFile = pakFile->next;
 			} while(pakFile != NULL);
+		} else if ( search->dir ) {
+			// a loose file earlier in the search path is what FS_FOpenFileRead would open
+			f = fopen( FS_BuildOSPath( search->dir->path, search->dir->gamedir, filename ), "rb" );
+			if ( f ) {
+				fclose( f );
+				return -1;
+			}
 		}
 	}
 	return -1;
@@ -3139,6 +3150,31 @@ void FS_FilenameCompletion( const char *dir, const char *ext, qboolean stripExt,
 	FS_FreeFileList( filenames );
 }
 
+/*
+=====================
+FS_LoadedPakChecksums
+
+Returns a space separated string containing the checksums of all loaded pk3 files.
+=====================
+*/
+const char *FS_LoadedPakChecksums( void ) {
+	static char	info[BIG_INFO_STRING];
+	searchpath_t	*search;
+
+	info[0] = 0;
+
+	for ( search = fs_searchpaths ; search ; search = search->next ) {
+		// is the element a pak file?
+		if ( !search->pack ) {
+			continue;
+		}
+
+		Q_strcat( info, sizeof( info ), va("%i ", search->pack->checksum ) );
+	}
+
+	return info;
+}
+
 const char *FS_GetCurrentGameDir(bool emptybase)
 {
 	if(fs_gamedirvar->string[0])
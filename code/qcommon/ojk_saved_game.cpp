@@ -25,7 +25,16 @@ SavedGame::SavedGame() :
 		rle_buffer_(),
 		is_readable_(),
 		is_writable_(),
-		is_failed_()
+		is_failed_(),
+		delta_write_base_(),
+		delta_read_base_(),
+		delta_read_base_name_(),
+		delta_read_base_checksum_(),
+		delta_counters_(),
+		is_delta_recording_(),
+		is_delta_writing_(),
+		is_delta_reading_(),
+		is_delta_base_loaded_()
 {
 }
 
@@ -100,6 +109,61 @@ bool SavedGame::open(
 		}
 	}
 
+	// Check for a delta header...
+	// The base itself is only loaded once a chunk refers to it,
+	// so reading just the comment or the screenshot doesn't need it.
+	//
+	if (is_succeed)
+	{
+		const int position = ::FS_FTell(
+			file_handle_);
+
+		uint32_t next_chunk_id = 0;
+
+		const int read_size = ::FS_Read(
+			&next_chunk_id,
+			static_cast<int>(sizeof(next_chunk_id)),
+			file_handle_);
+
+		static_cast<void>(::FS_Seek(
+			file_handle_,
+			position,
+			FS_SEEK_SET));
+
+		if (read_size == static_cast<int>(sizeof(next_chunk_id)) &&
+			next_chunk_id == INT_ID('D', 'L', 'T', 'A'))
+		{
+			SavedGameHelper saved_game(
+				this);
+
+			uint32_t base_checksum = 0;
+			char base_file_name[MAX_QPATH] = {};
+
+			if (saved_game.try_read_chunk(
+				INT_ID('D', 'L', 'T', 'A')) &&
+				saved_game.try_read<uint32_t>(
+					base_checksum) &&
+				saved_game.try_read<char>(
+					base_file_name))
+			{
+				base_file_name[MAX_QPATH - 1] = '\0';
+
+				delta_read_base_name_ = base_file_name;
+				delta_read_base_checksum_ = base_checksum;
+				delta_counters_.clear();
+
+				is_delta_reading_ = true;
+			}
+			else
+			{
+				is_succeed = false;
+
+				::Com_Printf(
+					S_COLOR_RED "Failed to read a delta header.\n");
+			}
+		}
+	}
+
 	if (!is_succeed)
 	{
 		close();
@@ -172,8 +236,84 @@ void SavedGame::close()
 
 	rle_buffer_.clear();
 
+	delta_read_base_.clear();
+	delta_read_base_name_.clear();
+	delta_read_base_checksum_ = 0;
+	delta_counters_.clear();
+
 	is_readable_ = false;
 	is_writable_ = false;
+
+	is_delta_recording_ = false;
+	is_delta_writing_ = false;
+	is_delta_reading_ = false;
+	is_delta_base_loaded_ = false;
+}
+
+void SavedGame::begin_delta_base()
+{
+	delta_write_base_.clear();
+	delta_counters_.clear();
+
+	is_delta_recording_ = true;
+	is_delta_writing_ = false;
+}
+
+bool SavedGame::begin_delta(
+	const std::string& base_file_name)
+{
+	if (!has_delta_base())
+	{
+		is_failed_ = true;
+		error_message_ = "No delta base.";
+		return false;
+	}
+
+	is_delta_recording_ = false;
+	is_delta_writing_ = false;
+
+	char base_file_name_buffer[MAX_QPATH];
+
+	::Q_strncpyz(
+		base_file_name_buffer,
+		base_file_name.c_str(),
+		sizeof(base_file_name_buffer));
+
+	SavedGameHelper saved_game(
+		this);
+
+	saved_game.reset_buffer();
+
+	saved_game.write<uint32_t>(
+		get_delta_base_checksum(delta_write_base_));
+
+	saved_game.write<char>(
+		base_file_name_buffer);
+
+	if (!write_chunk(
+		INT_ID('D', 'L', 'T', 'A')))
+	{
+		return false;
+	}
+
+	delta_counters_.clear();
+
+	is_delta_writing_ = true;
+
+	return true;
+}
+
+bool SavedGame::has_delta_base() const
+{
+	return !delta_write_base_.empty();
+}
+
+void SavedGame::clear_delta_base()
+{
+	delta_write_base_.clear();
+
+	is_delta_recording_ = false;
+	is_delta_writing_ = false;
 }
 
 bool SavedGame::read_chunk(
@@ -191,8 +331,6 @@ bool SavedGame::read_chunk(
 		return false;
 	}
 
-	io_buffer_offset_ = 0;
-
 	const std::string chunk_id_string = get_chunk_id_string(
 		chunk_id);
 
@@ -201,23 +339,11 @@ bool SavedGame::read_chunk(
 		chunk_id_string.c_str());
 
 	uint32_t loaded_chunk_id = 0;
-	uint32_t loaded_data_size = 0;
-
-	int loaded_chunk_size = ::FS_Read(
-		&loaded_chunk_id,
-		static_cast<int>(sizeof(loaded_chunk_id)),
-		file_handle_);
 
-	loaded_chunk_size += ::FS_Read(
-		&loaded_data_size,
-		static_cast<int>(sizeof(loaded_data_size)),
-		file_handle_);
-
-	const bool is_compressed = (static_cast<int32_t>(loaded_data_size) < 0);
-
-	if (is_compressed)
+	if (!read_next_chunk(
+		loaded_chunk_id))
 	{
-		loaded_data_size = -static_cast<int32_t>(loaded_data_size);
+		return false;
 	}
 
 	// Make sure we are loading the correct chunk...
@@ -239,8 +365,106 @@ bool SavedGame::read_chunk(
 		return false;
 	}
 
+	return true;
+}
+
+bool SavedGame::read_next_chunk(
+	uint32_t& chunk_id)
+{
+	io_buffer_offset_ = 0;
+
+	uint32_t loaded_chunk_id = 0;
+	uint32_t loaded_data_size = 0;
+
+	int loaded_chunk_size = ::FS_Read(
+		&loaded_chunk_id,
+		static_cast<int>(sizeof(loaded_chunk_id)),
+		file_handle_);
+
+	loaded_chunk_size += ::FS_Read(
+		&loaded_data_size,
+		static_cast<int>(sizeof(loaded_data_size)),
+		file_handle_);
+
+	chunk_id = loaded_chunk_id;
+
+	const std::string chunk_id_string = get_chunk_id_string(
+		loaded_chunk_id);
+
+	const DeltaChunks::size_type delta_index = advance_delta_counter(
+		loaded_chunk_id);
+
 	uint32_t loaded_checksum = 0;
 
+	// Unchanged chunk of a delta file...
+	//
+	if (loaded_data_size == get_delta_reference_size())
+	{
+		loaded_chunk_size += ::FS_Read(
+			&loaded_checksum,
+			static_cast<int>(sizeof(loaded_checksum)),
+			file_handle_);
+
+		if (!is_delta_reading_)
+		{
+			is_failed_ = true;
+
+			error_message_ =
+				"Unexpected delta reference in chunk " + chunk_id_string + ".";
+
+			return false;
+		}
+
+		if (!resolve_delta_base())
+		{
+			is_failed_ = true;
+
+			return false;
+		}
+
+		const DeltaChunk* const delta_chunk = find_delta_chunk(
+			delta_read_base_,
+			loaded_chunk_id,
+			delta_index);
+
+		if (!delta_chunk ||
+			delta_chunk->checksum != loaded_checksum)
+		{
+			is_failed_ = true;
+
+			error_message_ =
+				"Missing delta base data for chunk " + chunk_id_string + ".";
+
+			return false;
+		}
+
+		const std::size_t ref_chunk_size =
+			sizeof(loaded_chunk_id) +
+			sizeof(loaded_data_size) +
+			sizeof(loaded_checksum);
+
+		if (loaded_chunk_size != static_cast<int>(ref_chunk_size))
+		{
+			is_failed_ = true;
+
+			error_message_ =
+				"Error during loading chunk " + chunk_id_string + ".";
+
+			return false;
+		}
+
+		io_buffer_ = delta_chunk->data;
+
+		return true;
+	}
+
+	const bool is_compressed = (static_cast<int32_t>(loaded_data_size) < 0);
+
+	if (is_compressed)
+	{
+		loaded_data_size = -static_cast<int32_t>(loaded_data_size);
+	}
+
 #ifdef JK2_MODE
 	// Get checksum...
 	//
@@ -413,11 +637,64 @@ bool SavedGame::write_chunk(
 		io_buffer_.data(),
 		src_size);
 
+	const DeltaChunks::size_type delta_index = advance_delta_counter(
+		chunk_id);
+
+	if (is_delta_recording_)
+	{
+		delta_write_base_[chunk_id].push_back(
+			DeltaChunk{checksum, io_buffer_});
+	}
+
 	uint32_t saved_chunk_size = ::FS_Write(
 		&chunk_id,
 		static_cast<int>(sizeof(chunk_id)),
 		file_handle_);
 
+	// Store a reference if the chunk did not change since the base...
+	//
+	const DeltaChunk* const delta_chunk = (is_delta_writing_ ?
+		find_delta_chunk(delta_write_base_, chunk_id, delta_index) :
+		nullptr);
+
+	if (delta_chunk &&
+		delta_chunk->checksum == checksum &&
+		delta_chunk->data == io_buffer_)
+	{
+		const uint32_t size = get_delta_reference_size();
+
+		saved_chunk_size += ::FS_Write(
+			&size,
+			static_cast<int>(sizeof(size)),
+			file_handle_);
+
+		saved_chunk_size += ::FS_Write(
+			&checksum,
+			static_cast<int>(sizeof(checksum)),
+			file_handle_);
+
+		const std::size_t ref_chunk_size =
+			sizeof(chunk_id) +
+			sizeof(size) +
+			sizeof(checksum);
+
+		if (saved_chunk_size != ref_chunk_size)
+		{
+			is_failed_ = true;
+
+			error_message_ = "Failed to write " + chunk_id_string + " chunk.";
+
+			::Com_Printf(
+				"%s%s\n",
+				S_COLOR_RED,
+				error_message_.c_str());
+
+			return false;
+		}
+
+		return true;
+	}
+
 	int compressed_size = -1;
 
 	if (::sv_compress_saved_games->integer != 0)
@@ -796,6 +1073,51 @@ void SavedGame::remove(
 		path.c_str());
 }
 
+bool SavedGame::store_delta(
+	const std::string& delta_file_name,
+	const std::string& base_file_name)
+{
+	const std::string delta_path = generate_path(
+		delta_file_name);
+
+	const std::string base_path = generate_path(
+		base_file_name);
+
+	const std::string delta_base_path = generate_delta_base_path(
+		base_file_name);
+
+	if (::FS_MoveUserGenFile(
+		base_path.c_str(),
+		delta_base_path.c_str()) == 0)
+	{
+		return false;
+	}
+
+	if (::FS_MoveUserGenFile(
+		delta_path.c_str(),
+		base_path.c_str()) == 0)
+	{
+		// put the full saved game back, the delta is useless without it
+		::FS_MoveUserGenFile(
+			delta_base_path.c_str(),
+			base_path.c_str());
+
+		return false;
+	}
+
+	return true;
+}
+
+void SavedGame::remove_delta_base(
+	const std::string& base_file_name)
+{
+	const std::string path = generate_delta_base_path(
+		base_file_name);
+
+	::FS_DeleteUserGenFile(
+		path.c_str());
+}
+
 SavedGame& SavedGame::get_instance()
 {
 	static SavedGame result;
@@ -940,6 +1262,149 @@ std::string SavedGame::generate_path(
 	return "Saved-Missions-MovieDuels/" + normalized_file_name + ".sav";
 }
 
+std::string SavedGame::generate_delta_base_path(
+	const std::string& base_file_name)
+{
+	std::string normalized_file_name = base_file_name;
+
+	std::replace(
+		normalized_file_name.begin(),
+		normalized_file_name.end(),
+		'/',
+		'_');
+
+	return "Saved-Missions-MovieDuels/" + normalized_file_name + ".sdb";
+}
+
+bool SavedGame::load_delta_base(
+	const std::string& base_file_name,
+	const uint32_t base_checksum)
+{
+	delta_read_base_.clear();
+
+	SavedGame base_game;
+
+	const std::string file_path = generate_delta_base_path(
+		base_file_name);
+
+	const long file_size = ::FS_FOpenFileRead(
+		file_path.c_str(),
+		&base_game.file_handle_,
+		qtrue);
+
+	if (base_game.file_handle_ == 0)
+	{
+		error_message_ = "Failed to open \"" + file_path + "\".";
+		return false;
+	}
+
+	base_game.is_readable_ = true;
+
+	if (!base_game.read_chunk(
+		INT_ID('_', 'V', 'E', 'R')))
+	{
+		error_message_ = base_game.error_message_;
+		return false;
+	}
+
+	while (::FS_FTell(base_game.file_handle_) < file_size)
+	{
+		uint32_t chunk_id = 0;
+
+		if (!base_game.read_next_chunk(
+			chunk_id))
+		{
+			error_message_ = base_game.error_message_;
+			return false;
+		}
+
+		const uint32_t checksum = ::Com_BlockChecksum(
+			base_game.io_buffer_.data(),
+			static_cast<int>(base_game.io_buffer_.size()));
+
+		delta_read_base_[chunk_id].push_back(
+			DeltaChunk{checksum, base_game.io_buffer_});
+	}
+
+	if (get_delta_base_checksum(delta_read_base_) != base_checksum)
+	{
+		delta_read_base_.clear();
+
+		error_message_ = "Delta base \"" + file_path + "\" does not match.";
+		return false;
+	}
+
+	is_delta_base_loaded_ = true;
+
+	return true;
+}
+
+bool SavedGame::resolve_delta_base()
+{
+	if (is_delta_base_loaded_)
+	{
+		return true;
+	}
+
+	if (!load_delta_base(
+		delta_read_base_name_,
+		delta_read_base_checksum_))
+	{
+		::Com_Printf(
+			S_COLOR_RED "Failed to read a delta base of \"%s\": %s\n",
+			delta_read_base_name_.c_str(),
+			error_message_.c_str());
+
+		return false;
+	}
+
+	return true;
+}
+
+const SavedGame::DeltaChunk* SavedGame::find_delta_chunk(
+	const DeltaBase& delta_base,
+	const uint32_t chunk_id,
+	const DeltaChunks::size_type index)
+{
+	const auto it = delta_base.find(
+		chunk_id);
+
+	if (it == delta_base.cend() || index >= it->second.size())
+	{
+		return nullptr;
+	}
+
+	return &it->second[index];
+}
+
+SavedGame::DeltaChunks::size_type SavedGame::advance_delta_counter(
+	const uint32_t chunk_id)
+{
+	return delta_counters_[chunk_id]++;
+}
+
+uint32_t SavedGame::get_delta_base_checksum(
+	const DeltaBase& delta_base)
+{
+	std::vector<uint32_t> checksums;
+
+	for (const auto& chunks : delta_base)
+	{
+		checksums.push_back(
+			chunks.first);
+
+		for (const auto& chunk : chunks.second)
+		{
+			checksums.push_back(
+				chunk.checksum);
+		}
+	}
+
+	return ::Com_BlockChecksum(
+		checksums.data(),
+		static_cast<int>(checksums.size() * sizeof(uint32_t)));
+}
+
 std::string SavedGame::get_chunk_id_string(
 	uint32_t chunk_id)
 {
@@ -969,5 +1434,10 @@ const uint32_t SavedGame::get_jo_magic_value()
 	return 0x1234ABCD;
 }
 
+uint32_t SavedGame::get_delta_reference_size()
+{
+	return 0x80000000;
+}
+
 
 } // ojk
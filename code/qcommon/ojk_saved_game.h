@@ -8,6 +8,7 @@
 
 
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 #include "ojk_i_saved_game.h"
@@ -37,6 +38,7 @@ public:
 		const std::string& base_file_name);
 
 	// Opens an existing saved game file for reading.
+	// The base of a delta file is loaded by the first chunk read which refers to it.
 	bool open(
 		const std::string& base_file_name);
 
@@ -44,6 +46,23 @@ public:
 	void close();
 
 
+	// Starts recording every written chunk as a base for delta saves.
+	// Call right after create.
+	void begin_delta_base();
+
+	// Writes a delta header referencing the recorded base.
+	// Subsequent chunks identical to the base are stored as references.
+	// Call right after create.
+	bool begin_delta(
+		const std::string& base_file_name);
+
+	// Returns true if a delta base was recorded.
+	bool has_delta_base() const;
+
+	// Forgets the recorded delta base.
+	void clear_delta_base();
+
+
 	// Reads a chunk from the file into the internal buffer.
 	bool read_chunk(
 		const uint32_t chunk_id) override;
@@ -123,6 +142,17 @@ public:
 	static void remove(
 		const std::string& base_file_name);
 
+	// Replaces a full saved game file with a delta written against it,
+	// keeping the full one as its delta base file.
+	// Returns true on success or false otherwise, leaving the full saved game in place.
+	static bool store_delta(
+		const std::string& delta_file_name,
+		const std::string& base_file_name);
+
+	// Removes a delta base file.
+	static void remove_delta_base(
+		const std::string& base_file_name);
+
 	// Returns a default instance of the class.
 	static SavedGame& get_instance();
 
@@ -132,6 +162,16 @@ private:
 	using BufferOffset = Buffer::size_type;
 	using Paths = std::vector<std::string>;
 
+	struct DeltaChunk
+	{
+		uint32_t checksum;
+		Buffer data;
+	}; // DeltaChunk
+
+	using DeltaChunks = std::vector<DeltaChunk>;
+	using DeltaBase = std::map<uint32_t, DeltaChunks>;
+	using DeltaCounters = std::map<uint32_t, DeltaChunks::size_type>;
+
 
 	// Last error message.
 	std::string error_message_;
@@ -163,6 +203,58 @@ private:
 	// Error flag.
 	bool is_failed_;
 
+	// Chunks of the last full saved game written with begin_delta_base.
+	DeltaBase delta_write_base_;
+
+	// Chunks of the base referenced by the delta file being read.
+	DeltaBase delta_read_base_;
+
+	// Name and checksum of the base from the delta header.
+	std::string delta_read_base_name_;
+	uint32_t delta_read_base_checksum_;
+
+	// Number of chunks read or written so far for each chunk id.
+	DeltaCounters delta_counters_;
+
+	// True if written chunks are recorded into the delta base.
+	bool is_delta_recording_;
+
+	// True if unchanged chunks are written as references to the base.
+	bool is_delta_writing_;
+
+	// True if the file being read is a delta file.
+	bool is_delta_reading_;
+
+	// True if delta_read_base_ holds the base of the delta file being read.
+	bool is_delta_base_loaded_;
+
+
+	// Reads the next chunk of any id into the internal buffer.
+	bool read_next_chunk(
+		uint32_t& chunk_id);
+
+	// Loads the base of the delta file being read, unless it is loaded already.
+	bool resolve_delta_base();
+
+	// Loads all chunks of a delta base file.
+	bool load_delta_base(
+		const std::string& base_file_name,
+		const uint32_t base_checksum);
+
+	// Returns a base chunk for the specified occurrence of the chunk id or null.
+	static const DeltaChunk* find_delta_chunk(
+		const DeltaBase& delta_base,
+		const uint32_t chunk_id,
+		const DeltaChunks::size_type index);
+
+	// Returns the occurrence index of the chunk id and advances the counter.
+	DeltaChunks::size_type advance_delta_counter(
+		const uint32_t chunk_id);
+
+	// Returns a checksum of all chunk checksums of the base.
+	static uint32_t get_delta_base_checksum(
+		const DeltaBase& delta_base);
+
 
 	// Compresses data.
 	static void compress(
@@ -178,12 +270,18 @@ private:
 	static std::string generate_path(
 		const std::string& base_file_name);
 
+	static std::string generate_delta_base_path(
+		const std::string& base_file_name);
+
 
 	// Returns a string representation of a chunk id.
 	static std::string get_chunk_id_string(
 		uint32_t chunk_id);
 
 	static const uint32_t get_jo_magic_value();
+
+	// Returns a chunk size value which marks an unchanged delta chunk.
+	static uint32_t get_delta_reference_size();
 }; // SavedGame
 
 
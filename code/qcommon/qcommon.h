@@ -485,12 +485,12 @@ long		FS_FOpenFileRead( const char *qpath, fileHandle_t *file, qboolean uniqueFI
 // It is generally safe to always set uniqueFILE to true, because the majority of
 // file IO goes through FS_ReadFile, which Does The Right Thing already.
 
-// returns 1 if a file is in the PAK file, otherwise -1
-int	FS_FileIsInPAK(const char *filename );
-static inline int FS_FileIsInPAK( const char *filename, int *checksum )
-{
-	return FS_FileIsInPAK( filename );
-}
+// returns 1 if a file would be read from a PAK file, otherwise -1
+// pChecksum, if given, receives the checksum of that PAK file
+int	FS_FileIsInPAK(const char *filename, int *pChecksum );
+
+const char *FS_LoadedPakChecksums( void );
+// Returns a space separated string containing the checksums of all loaded pk3 files.
 
 int	FS_Write( const void *buffer, int len, fileHandle_t f );
 
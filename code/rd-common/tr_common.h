@@ -59,6 +59,9 @@ qboolean R_ImageLoader_Add( const char *extension, ImageLoaderFn imageLoader );
 // Load an image from file.
 void R_LoadImage( const char *shortname, byte **pic, int *width, int *height );
 
+// Find the file R_LoadImage would load, if it comes from a pk3 file.
+qboolean R_FindImageInPak( const char *shortname, char *filename, int filenameSize, int *pakChecksum );
+
 // Load raw image data from TGA image.
 void LoadTGA( const char *name, byte **pic, int *width, int *height );
 
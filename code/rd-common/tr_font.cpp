@@ -23,7 +23,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../server/exe_headers.h"
 
 #include <limits.h>
+#include <list>
 #include <string>
+#include <unordered_map>
 #include "../qcommon/sstring.h"	// stl string class won't compile in here (MS shite), so use Gil's.
 #include "tr_local.h"
 #include "tr_font.h"
@@ -1461,20 +1463,135 @@ CFontInfo *GetFont(int index)
 }
 
 
-int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float fScale)
+#ifndef JK2_MODE
+// laid out strings, so the UI and HUD don't re-parse the same text every frame
+//
+struct FontLayoutItem
 {
-#ifdef JK2_MODE
-	// Yes..even this func is a little different, to the point where it doesn't work. --eez
-	float		fMaxWidth = 0.0f;
-	float		fThisWidth = 0.0f;
-	CFontInfo	*curfont;
+	int			colour;		// -1 for a glyph, else the colour code this switches to
+	qhandle_t	hShader;
+	float		x, y, w, h;	// relative to the draw position
+	float		s1, t1, s2, t2;
+};
 
-	curfont = GetFont(iFontHandle);
-	if(!curfont)
+class CFontLayout
+{
+public:
+	std::vector<FontLayoutItem>	m_items;
+	float						m_fWidth;	// only set for the measuring keys
+
+	CFontLayout() : m_fWidth( 0.0f ) {}
+
+	void AddColour( int colour )
 	{
-		return(0);
+		FontLayoutItem item = {};
+		item.colour = colour;
+		m_items.push_back( item );
+	}
+
+	void AddGlyph( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader )
+	{
+		FontLayoutItem item = { -1, hShader, x, y, w, h, s1, t1, s2, t2 };
+		m_items.push_back( item );
+	}
+};
+
+#define FONT_LAYOUT_CACHE_SIZE		512
+#define FONT_LAYOUT_MAX_TEXT		1024	// longer strings (text crawls etc) are laid out every time
+
+class CFontLayoutCache
+{
+public:
+	// NULL if missing, else the entry moved to the front
+	CFontLayout *Find( const std::string &key )
+	{
+		LayoutIndex_t::iterator it = m_index.find( key );
+		if ( it == m_index.end() )
+		{
+			return NULL;
+		}
+		m_layouts.splice( m_layouts.begin(), m_layouts, it->second );
+		return &it->second->second;
+	}
+
+	CFontLayout &Insert( const std::string &key )
+	{
+		if ( m_layouts.size() >= FONT_LAYOUT_CACHE_SIZE )
+		{
+			m_index.erase( m_layouts.back().first );
+			m_layouts.pop_back();
+		}
+		m_layouts.push_front( LayoutEntry_t( key, CFontLayout() ) );
+		m_index[key] = m_layouts.begin();
+		return m_layouts.front().second;
+	}
+
+	void Clear()
+	{
+		m_index.clear();
+		m_layouts.clear();
+	}
+
+private:
+	typedef std::pair<std::string, CFontLayout>					LayoutEntry_t;
+	typedef std::list<LayoutEntry_t>							LayoutList_t;	// most recently used first
+	typedef std::unordered_map<std::string, LayoutList_t::iterator>	LayoutIndex_t;
+
+	LayoutList_t	m_layouts;
+	LayoutIndex_t	m_index;
+};
+
+static CFontLayoutCache	g_FontLayoutCache;
+static CFontLayout		g_FontLayoutScratch;
+
+enum
+{
+	FONT_LAYOUT_DRAW,
+	FONT_LAYOUT_WIDTH
+};
+
+// everything a layout depends on besides the font data itself
+static const std::string &RE_Font_LayoutKey( int iKind, const int iFontHandle, const float fScale, int iMaxPixelWidth, const char *psText )
+{
+	static std::string key;
+	byteAlias_t header[5];
+
+	header[0].i = iKind;
+	header[1].i = iFontHandle & SET_MASK;
+	header[2].f = fScale;
+	header[3].i = iMaxPixelWidth;
+	header[4].i = se_language->modificationCount;
+
+	key.assign( (const char *)header, sizeof( header ) );
+	key.append( psText );
+	return key;
+}
+
+static void RE_Font_BuildLayout( CFontInfo *curfont, const char *psText, int iMaxPixelWidth, const float fScale, CFontLayout &layout );
+
+static const CFontLayout &RE_Font_GetLayout( CFontInfo *curfont, const int iFontHandle, const char *psText, int iMaxPixelWidth, const float fScale )
+{
+	if ( strlen( psText ) > FONT_LAYOUT_MAX_TEXT )
+	{
+		RE_Font_BuildLayout( curfont, psText, iMaxPixelWidth, fScale, g_FontLayoutScratch );
+		return g_FontLayoutScratch;
 	}
 
+	const std::string &key = RE_Font_LayoutKey( FONT_LAYOUT_DRAW, iFontHandle, fScale, iMaxPixelWidth, psText );
+	CFontLayout *layout = g_FontLayoutCache.Find( key );
+	if ( !layout )
+	{
+		layout = &g_FontLayoutCache.Insert( key );
+		RE_Font_BuildLayout( curfont, psText, iMaxPixelWidth, fScale, *layout );
+	}
+	return *layout;
+}
+
+static float RE_Font_MeasureString(CFontInfo *curfont, const char *psText, const float fScale)
+{
+	float		fMaxWidth = 0.0f;
+	float		fThisWidth = 0.0f;
+
 	float fScaleAsian = fScale;
 	if (Language_IsAsian() && fScale > 0.7f )
 	{
@@ -1483,7 +1600,21 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 
 	while(*psText)
 	{
-		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char **)&psText );
+		int iAdvanceCount;
+		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
+		psText += iAdvanceCount;
+
+		if (uiLetter == '^' )
+		{
+			if (*psText >= '0' &&
+				*psText <= '9')
+			{
+				uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
+				psText += iAdvanceCount;
+				continue;
+			}
+		}
+
 		if (uiLetter == 0x0A)
 		{
 			fThisWidth = 0.0f;
@@ -1492,7 +1623,7 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 		{
 			int iPixelAdvance = curfont->GetLetterHorizAdvance( uiLetter );
 
-			float fValue = iPixelAdvance * ((uiLetter > 255) ? fScaleAsian : fScale);
+			float fValue = iPixelAdvance * ((uiLetter > (unsigned)g_iNonScaledCharRange) ? fScaleAsian : fScale);
 			fThisWidth += curfont->mbRoundCalcs ? Round( fValue ) : fValue;
 			if (fThisWidth > fMaxWidth)
 			{
@@ -1501,9 +1632,14 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 		}
 	}
 
-	// using ceil because we need to make sure that all the text is contained within the integer pixel width we're returning
-	return (int)ceilf(fMaxWidth);
-#else
+	return fMaxWidth;
+}
+#endif
+
+int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float fScale)
+{
+#ifdef JK2_MODE
+	// Yes..even this func is a little different, to the point where it doesn't work. --eez
 	float		fMaxWidth = 0.0f;
 	float		fThisWidth = 0.0f;
 	CFontInfo	*curfont;
@@ -1522,21 +1658,7 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 
 	while(*psText)
 	{
-		int iAdvanceCount;
-		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
-		psText += iAdvanceCount;
-
-		if (uiLetter == '^' )
-		{
-			if (*psText >= '0' &&
-				*psText <= '9')
-			{
-				uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
-				psText += iAdvanceCount;
-				continue;
-			}
-		}
-
+		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char **)&psText );
 		if (uiLetter == 0x0A)
 		{
 			fThisWidth = 0.0f;
@@ -1545,7 +1667,7 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 		{
 			int iPixelAdvance = curfont->GetLetterHorizAdvance( uiLetter );
 
-			float fValue = iPixelAdvance * ((uiLetter > (unsigned)g_iNonScaledCharRange) ? fScaleAsian : fScale);
+			float fValue = iPixelAdvance * ((uiLetter > 255) ? fScaleAsian : fScale);
 			fThisWidth += curfont->mbRoundCalcs ? Round( fValue ) : fValue;
 			if (fThisWidth > fMaxWidth)
 			{
@@ -1554,6 +1676,34 @@ int RE_Font_StrLenPixels(const char *psText, const int iFontHandle, const float
 		}
 	}
 
+	// using ceil because we need to make sure that all the text is contained within the integer pixel width we're returning
+	return (int)ceilf(fMaxWidth);
+#else
+	CFontInfo	*curfont;
+	float		fMaxWidth;
+
+	curfont = GetFont(iFontHandle);
+	if(!curfont)
+	{
+		return(0);
+	}
+
+	if (strlen(psText) > FONT_LAYOUT_MAX_TEXT)
+	{
+		fMaxWidth = RE_Font_MeasureString(curfont, psText, fScale);
+	}
+	else
+	{
+		const std::string &key = RE_Font_LayoutKey(FONT_LAYOUT_WIDTH, iFontHandle, fScale, -1, psText);
+		CFontLayout *layout = g_FontLayoutCache.Find(key);
+		if (!layout)
+		{
+			layout = &g_FontLayoutCache.Insert(key);
+			layout->m_fWidth = RE_Font_MeasureString(curfont, psText, fScale);
+		}
+		fMaxWidth = layout->m_fWidth;
+	}
+
 	// using ceil because we need to make sure that all the text is contained within the integer pixel width we're returning
 	return (int)ceilf(fMaxWidth);
 #endif
@@ -1611,6 +1761,182 @@ int RE_Font_HeightPixels(const int iFontHandle, const float fScale)
 	return(0);
 }
 
+#ifndef JK2_MODE
+/*
+=================
+RE_Font_BuildLayout
+
+Works out where every glyph of psText goes, relative to the draw position.
+Anything that changes the result (language, scale, width limit) has to be part of the cache key
+=================
+*/
+static void RE_Font_BuildLayout( CFontInfo *curfont, const char *psText, int iMaxPixelWidth, const float fScale, CFontLayout &layout )
+{
+	float				fox, foy, fx, fy;
+	const glyphInfo_t	*pLetter;
+	qhandle_t			hShader;
+
+	layout.m_items.clear();
+
+	float fScaleAsian = fScale;
+	float fAsianYAdjust = 0.0f;
+	if (Language_IsAsian() && fScale > 0.7f)
+	{
+		fScaleAsian = fScale * 0.75f;
+		fAsianYAdjust = ((curfont->GetPointSize() * fScale) - (curfont->GetPointSize() * fScaleAsian)) / 2.0f;
+	}
+
+	// Now we take off the training wheels and become a big font renderer
+	// It's all floats from here on out
+	fox = 0.0f;
+	foy = 0.0f;
+
+	fx = fox;
+	foy += curfont->mbRoundCalcs ? Round((curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale) : (curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale;
+
+	qboolean bNextTextWouldOverflow = qfalse;
+	while (*psText && !bNextTextWouldOverflow)
+	{
+		int iAdvanceCount;
+		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
+		psText += iAdvanceCount;
+
+		switch( uiLetter )
+		{
+		case 10:						//linefeed
+			fx = fox;
+			foy += curfont->mbRoundCalcs ? Round(curfont->GetPointSize() * fScale) : curfont->GetPointSize() * fScale;
+			if (Language_IsAsian())
+			{
+				foy += 4.0f;	// this only comes into effect when playing in asian for "A long time ago in a galaxy" etc, all other text is line-broken in feeder functions
+			}
+			break;
+		case 13:						// Return
+			break;
+		case 32:						// Space
+			pLetter = curfont->GetLetter(' ');
+			fx += curfont->mbRoundCalcs ? Round(pLetter->horizAdvance * fScale) : pLetter->horizAdvance * fScale;
+			bNextTextWouldOverflow = ( iMaxPixelWidth != -1 && ((fx-fox) > (float)iMaxPixelWidth) ) ? qtrue : qfalse; // yeuch
+			break;
+		case '_':	// has a special word-break usage if in Thai (and followed by a thai char), and should not be displayed, else treat as normal
+			if (GetLanguageEnum()== eThai && ((unsigned char *)psText)[0] >= TIS_GLYPHS_START)
+			{
+				break;
+			}
+			// else drop through and display as normal...
+		case '^':
+			if (uiLetter != '_')	// necessary because of fallthrough above
+			{
+				if (*psText >= '0' &&
+					*psText <= '9')
+				{
+					layout.AddColour( ColorIndex(*psText++) );
+					break;
+				}
+			}
+			//purposely falls thrugh
+		default:
+			pLetter = curfont->GetLetter( uiLetter, &hShader );			// Description of pLetter
+			if(!pLetter->width)
+			{
+				pLetter = curfont->GetLetter('.');
+			}
+
+			float fThisScale = uiLetter > (unsigned)g_iNonScaledCharRange ? fScaleAsian : fScale;
+
+			// sigh, super-language-specific hack...
+			//
+			if (uiLetter == TIS_SARA_AM && GetLanguageEnum() == eThai)
+			{
+				fx -= curfont->mbRoundCalcs ? Round(7.0f * fThisScale) : 7.0f * fThisScale;
+			}
+
+			float fAdvancePixels = curfont->mbRoundCalcs ? Round(pLetter->horizAdvance * fThisScale) : pLetter->horizAdvance * fThisScale;
+			bNextTextWouldOverflow = ( iMaxPixelWidth != -1 && (((fx+fAdvancePixels)-fox) > (float)iMaxPixelWidth) ) ? qtrue : qfalse; // yeuch
+			if (!bNextTextWouldOverflow)
+			{
+				// this 'mbRoundCalcs' stuff is crap, but the only way to make the font code work. Sigh...
+				//
+				fy = foy - (curfont->mbRoundCalcs ? Round(pLetter->baseline * fThisScale) : pLetter->baseline * fThisScale);
+				if (curfont->m_fAltSBCSFontScaleFactor != -1)
+				{
+					fy += 3.0f; // I'm sick and tired of going round in circles trying to do this legally, so bollocks to it
+				}
+
+				layout.AddGlyph(curfont->mbRoundCalcs ? fx + Round(pLetter->horizOffset * fThisScale) : fx + pLetter->horizOffset * fThisScale, // float x
+								(uiLetter > (unsigned)g_iNonScaledCharRange) ? fy - fAsianYAdjust : fy,	// float y
+								curfont->mbRoundCalcs ? Round(pLetter->width * fThisScale) : pLetter->width * fThisScale,	// float w
+								curfont->mbRoundCalcs ? Round(pLetter->height * fThisScale) : pLetter->height * fThisScale, // float h
+								pLetter->s,						// float s1
+								pLetter->t,						// float t1
+								pLetter->s2,					// float s2
+								pLetter->t2,					// float t2
+								//lastcolour.c,
+								hShader							// qhandle_t hShader
+								);
+
+				fx += fAdvancePixels;
+			}
+			break;
+		}
+	}
+}
+
+/*
+=================
+RE_Font_SubmitLayout
+
+Each run of glyphs between colour codes goes to the back end as a single command
+=================
+*/
+static void RE_Font_SubmitLayout( const CFontLayout &layout, int ox, int oy, const float *rgba, qboolean bInShadow )
+{
+	const FontLayoutItem *item = layout.m_items.data();
+	const FontLayoutItem *end = item + layout.m_items.size();
+
+	while ( item != end )
+	{
+		if ( item->colour >= 0 )
+		{
+			if ( !bInShadow )
+			{
+				vec4_t color;
+				Com_Memcpy( color, g_color_table[item->colour], sizeof( color ) );
+				color[3] = rgba ? rgba[3] : 1.0f;
+				RE_SetColor( color );
+			}
+			item++;
+			continue;
+		}
+
+		int numPics = 0;
+		while ( item + numPics != end && item[numPics].colour < 0 && numPics < MAX_STRETCH_PICS_PER_COMMAND )
+		{
+			numPics++;
+		}
+
+		stretchPic_t *pic = R_AddStretchPics( numPics );
+		if ( !pic )
+		{
+			return;	// command buffer is full, same as RE_StretchPic dropping it
+		}
+		for ( ; numPics; numPics--, item++, pic++ )
+		{
+			pic->shader = R_GetShaderByHandle( item->hShader );
+			pic->x = ox + item->x;
+			pic->y = oy + item->y;
+			pic->w = item->w;
+			pic->h = item->h;
+			pic->s1 = item->s1;
+			pic->t1 = item->t1;
+			pic->s2 = item->s2;
+			pic->t2 = item->t2;
+		}
+	}
+}
+
+#endif
+
 // iMaxPixelWidth is -1 for "all of string", else pixel display count...
 //
 void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, const int iFontHandle, int iMaxPixelWidth, const float fScale)
@@ -1764,10 +2090,7 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 	//let it remember the old color //RE_SetColor(NULL);
 #else
 	static qboolean gbInShadow = qfalse;	// MUST default to this
-	float				fox, foy, fx, fy;
-	int					colour, offset;
-	const glyphInfo_t	*pLetter;
-	qhandle_t			hShader;
+	int					offset;
 
 	assert (psText);
 
@@ -1830,14 +2153,6 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 		return;
 	}
 
-	float fScaleAsian = fScale;
-	float fAsianYAdjust = 0.0f;
-	if (Language_IsAsian() && fScale > 0.7f)
-	{
-		fScaleAsian = fScale * 0.75f;
-		fAsianYAdjust = ((curfont->GetPointSize() * fScale) - (curfont->GetPointSize() * fScaleAsian)) / 2.0f;
-	}
-
 	// Draw a dropshadow if required
 	if(iFontHandle & STYLE_DROPSHADOW)
 	{
@@ -1852,107 +2167,7 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 
 	RE_SetColor( rgba );
 
-	// Now we take off the training wheels and become a big font renderer
-	// It's all floats from here on out
-	fox = ox;
-	foy = oy;
-
-	fx = fox;
-	foy += curfont->mbRoundCalcs ? Round((curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale) : (curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale;
-
-	qboolean bNextTextWouldOverflow = qfalse;
-	while (*psText && !bNextTextWouldOverflow)
-	{
-		int iAdvanceCount;
-		unsigned int uiLetter = AnyLanguage_ReadCharFromString( (char *)psText, &iAdvanceCount, NULL );
-		psText += iAdvanceCount;
-
-		switch( uiLetter )
-		{
-		case 10:						//linefeed
-			fx = fox;
-			foy += curfont->mbRoundCalcs ? Round(curfont->GetPointSize() * fScale) : curfont->GetPointSize() * fScale;
-			if (Language_IsAsian())
-			{
-				foy += 4.0f;	// this only comes into effect when playing in asian for "A long time ago in a galaxy" etc, all other text is line-broken in feeder functions
-			}
-			break;
-		case 13:						// Return
-			break;
-		case 32:						// Space
-			pLetter = curfont->GetLetter(' ');
-			fx += curfont->mbRoundCalcs ? Round(pLetter->horizAdvance * fScale) : pLetter->horizAdvance * fScale;
-			bNextTextWouldOverflow = ( iMaxPixelWidth != -1 && ((fx-fox) > (float)iMaxPixelWidth) ) ? qtrue : qfalse; // yeuch
-			break;
-		case '_':	// has a special word-break usage if in Thai (and followed by a thai char), and should not be displayed, else treat as normal
-			if (GetLanguageEnum()== eThai && ((unsigned char *)psText)[0] >= TIS_GLYPHS_START)
-			{
-				break;
-			}
-			// else drop through and display as normal...
-		case '^':
-			if (uiLetter != '_')	// necessary because of fallthrough above
-			{
-				if (*psText >= '0' &&
-					*psText <= '9')
-				{
-					colour = ColorIndex(*psText++);
-					if (!gbInShadow)
-					{
-						vec4_t color;
-						Com_Memcpy( color, g_color_table[colour], sizeof( color ) );
-						color[3] = rgba ? rgba[3] : 1.0f;
-						RE_SetColor( color );
-					}
-					break;
-				}
-			}
-			//purposely falls thrugh
-		default:
-			pLetter = curfont->GetLetter( uiLetter, &hShader );			// Description of pLetter
-			if(!pLetter->width)
-			{
-				pLetter = curfont->GetLetter('.');
-			}
-
-			float fThisScale = uiLetter > (unsigned)g_iNonScaledCharRange ? fScaleAsian : fScale;
-
-			// sigh, super-language-specific hack...
-			//
-			if (uiLetter == TIS_SARA_AM && GetLanguageEnum() == eThai)
-			{
-				fx -= curfont->mbRoundCalcs ? Round(7.0f * fThisScale) : 7.0f * fThisScale;
-			}
-
-			float fAdvancePixels = curfont->mbRoundCalcs ? Round(pLetter->horizAdvance * fThisScale) : pLetter->horizAdvance * fThisScale;
-			bNextTextWouldOverflow = ( iMaxPixelWidth != -1 && (((fx+fAdvancePixels)-fox) > (float)iMaxPixelWidth) ) ? qtrue : qfalse; // yeuch
-			if (!bNextTextWouldOverflow)
-			{
-				// this 'mbRoundCalcs' stuff is crap, but the only way to make the font code work. Sigh...
-				//
-				fy = foy - (curfont->mbRoundCalcs ? Round(pLetter->baseline * fThisScale) : pLetter->baseline * fThisScale);
-				if (curfont->m_fAltSBCSFontScaleFactor != -1)
-				{
-					fy += 3.0f; // I'm sick and tired of going round in circles trying to do this legally, so bollocks to it
-				}
-
-				RE_StretchPic(curfont->mbRoundCalcs ? fx + Round(pLetter->horizOffset * fThisScale) : fx + pLetter->horizOffset * fThisScale, // float x
-								(uiLetter > (unsigned)g_iNonScaledCharRange) ? fy - fAsianYAdjust : fy,	// float y
-								curfont->mbRoundCalcs ? Round(pLetter->width * fThisScale) : pLetter->width * fThisScale,	// float w
-								curfont->mbRoundCalcs ? Round(pLetter->height * fThisScale) : pLetter->height * fThisScale, // float h
-								pLetter->s,						// float s1
-								pLetter->t,						// float t1
-								pLetter->s2,					// float s2
-								pLetter->t2,					// float t2
-								//lastcolour.c,
-								hShader							// qhandle_t hShader
-								);
-
-				fx += fAdvancePixels;
-			}
-			break;
-		}
-	}
+	RE_Font_SubmitLayout( RE_Font_GetLayout( curfont, iFontHandle, psText, iMaxPixelWidth, fScale ), ox, oy, rgba, gbInShadow );
 	//let it remember the old color //RE_SetColor(NULL);
 #endif
 }
@@ -2026,6 +2241,9 @@ void R_ShutdownFonts(void)
 	g_iCurrentFontIndex = 1;	// entry 0 is reserved for "missing/invalid"
 
 	g_ThaiCodes.Clear();
+#ifndef JK2_MODE
+	g_FontLayoutCache.Clear();
+#endif
 }
 
 // this is only really for debugging while tinkering with fonts, but harmless to leave in...
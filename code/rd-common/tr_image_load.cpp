@@ -140,3 +140,57 @@ void R_LoadImage( const char *shortname, byte **pic, int *width, int *height ) {
 		}
 	}
 }
+
+// returns 1 if the file is read from a pk3 file, 0 if it's a loose file and -1 if there's no such file
+static int ImageFileSource( const char *filename, int *pakChecksum )
+{
+	if ( ri.FS_FileIsInPAK (filename, pakChecksum) == 1 )
+	{
+		return 1;
+	}
+
+	return ri.FS_ReadFile (filename, NULL) > 0 ? 0 : -1;
+}
+
+/*
+=================
+Finds the file R_LoadImage would load for the given name, trying the
+extensions in the same order. Returns qfalse if there is no such file
+or it isn't in a pk3 file, else fills in its name and pk3 checksum.
+=================
+*/
+qboolean R_FindImageInPak( const char *shortname, char *filename, int filenameSize, int *pakChecksum )
+{
+	const char *extension = COM_GetExtension (shortname);
+	const ImageLoaderMap *imageLoader = FindImageLoader (extension);
+	if ( imageLoader != NULL )
+	{
+		const int source = ImageFileSource (shortname, pakChecksum);
+		if ( source >= 0 )
+		{
+			Q_strncpyz (filename, shortname, filenameSize);
+			return (qboolean)(source == 1);
+		}
+	}
+
+	char extensionlessName[MAX_QPATH];
+	COM_StripExtension(shortname, extensionlessName, sizeof( extensionlessName ));
+	for ( int i = 0; i < numImageLoaders; i++ )
+	{
+		const ImageLoaderMap *tryLoader = &imageLoaders[i];
+		if ( tryLoader == imageLoader )
+		{
+			continue;
+		}
+
+		const char *name = va ("%s.%s", extensionlessName, tryLoader->extension);
+		const int source = ImageFileSource (name, pakChecksum);
+		if ( source >= 0 )
+		{
+			Q_strncpyz (filename, name, filenameSize);
+			return (qboolean)(source == 1);
+		}
+	}
+
+	return qfalse;
+}
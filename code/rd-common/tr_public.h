@@ -30,7 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../ghoul2/G2.h"
 #include "../ghoul2/ghoul2_gore.h"
 
-#define	REF_API_VERSION		18
+#define	REF_API_VERSION		21
 
 typedef struct {
 	void				(QDECL *Printf)						( int printLevel, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
@@ -75,10 +75,12 @@ typedef struct {
 	fileHandle_t		(*FS_FOpenFileWrite)				( const char *qpath, qboolean safe );
 	int					(*FS_FOpenFileByMode)				( const char *qpath, fileHandle_t *f, fsMode_t mode );
 	qboolean			(*FS_FileExists)					( const char *file );
-	int					(*FS_FileIsInPAK)					( const char *filename );
+	int					(*FS_FileIsInPAK)					( const char *filename, int *pChecksum );
+	const char *		(*FS_LoadedPakChecksums)			( void );
 	char **				(*FS_ListFiles)						( const char *directory, const char *extension, int *numfiles );
 	int					(*FS_Write)							( const void *buffer, int len, fileHandle_t f );
 	void				(*FS_WriteFile)						( const char *qpath, const void *buffer, int size );
+	void				(*FS_HomeRemove)					( const char *homePath );
 
 	void				(*CM_DrawDebugSurface)				( void (*drawPoly)( int color, int numPoints, float *points ) );
 	bool				(*CM_CullWorldBox)					( const cplane_t *frustrum, const vec3pair_t bounds );
@@ -126,6 +128,8 @@ typedef struct {
 	qboolean			*(*gbUsingCachedMapDataRightNow)	( void );
 	qboolean			*(*gbAlreadyDoingLoad)				( void );
 	int					(*com_frameTime)					( void );
+	// binds (or, with qfalse, releases) the GL context on the calling thread, for the r_smp render thread
+	qboolean			(*GL_MakeCurrent)					( qboolean current );
 
 } refimport_t;
 
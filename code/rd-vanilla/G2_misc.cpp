@@ -74,6 +74,7 @@ static inline void DestroyGoreTexCoordinates(int tag)
 	{
 		return;
 	}
+	R_SyncRenderThread(); // the render thread may still be drawing with these
 	(*gTC).~GoreTextureCoordinates();
 	//I don't know what's going on here, it should call the destructor for
 	//this when it erases the record but sometimes it doesn't. -rww
@@ -86,6 +87,7 @@ int AllocGoreRecord()
 {
 	while (GoreRecords.size()>MAX_GORE_RECORDS)
 	{
+		R_SyncRenderThread(); // the render thread may still be drawing with these
 		int tagHigh=(*GoreRecords.begin()).first&GORE_TAG_MASK;
 		std::map<int,GoreTextureCoordinates>::iterator it;
 		GoreTextureCoordinates *gTC;
@@ -42,7 +42,9 @@ extern void			SetViewportAndScissor( void );
 #include "tr_WorldEffects.h"
 #include "../Ravl/CVec.h"
 #include "../Ratl/vector_vs.h"
-#include "../Ratl/bits_vs.h"
+#include "qcommon/q_weather.h"
+
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Defines
@@ -163,66 +165,6 @@ struct	SVecRange
 		V[1] = Q_flrand(mMins[1], mMaxs[1]);
 		V[2] = Q_flrand(mMins[2], mMaxs[2]);
 	}
-	inline void Wrap(CVec3& V)
-	{
-		if (V[0]<=mMins[0])
-		{
-			if ((mMins[0]-V[0])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[0] = mMaxs[0] - 10.0f;
-		}
-		if (V[0]>=mMaxs[0])
-		{
-			if ((V[0]-mMaxs[0])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[0] = mMins[0] + 10.0f;
-		}
-
-		if (V[1]<=mMins[1])
-		{
-			if ((mMins[1]-V[1])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[1] = mMaxs[1] - 10.0f;
-		}
-		if (V[1]>=mMaxs[1])
-		{
-			if ((V[1]-mMaxs[1])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[1] = mMins[1] + 10.0f;
-		}
-
-		if (V[2]<=mMins[2])
-		{
-			if ((mMins[2]-V[2])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[2] = mMaxs[2] - 10.0f;
-		}
-		if (V[2]>=mMaxs[2])
-		{
-			if ((V[2]-mMaxs[2])>500)
-			{
-				Pick(V);
-				return;
-			}
-			V[2] = mMins[2] + 10.0f;
-		}
-	}
-
 	inline bool In(const CVec3& V)
 	{
 		return (V>mMins && V<mMaxs);
@@ -274,28 +216,54 @@ struct	SIntRange
 
 
 ////////////////////////////////////////////////////////////////////////////////////////
-// The Particle Class
+// The Particles - One Array Per Component, So Q::weatherStep Works On Four At Once
 ////////////////////////////////////////////////////////////////////////////////////////
-class	WFXParticle
+class	WFXParticles
 {
 public:
-	enum
+	std::vector<float>			mX;
+	std::vector<float>			mY;
+	std::vector<float>			mZ;
+	std::vector<float>			mVX;
+	std::vector<float>			mVY;
+	std::vector<float>			mVZ;
+	std::vector<float>			mMass;			// A higher number will more greatly resist force and result in greater gravity
+	std::vector<float>			mAlpha;
+	std::vector<std::uint8_t>	mFlags;			// Q::WEATHER_RENDER, Q::WEATHER_FADE_IN...
+
+	void	Resize(int count)
 	{
-		FLAG_RENDER = 0,
+		mX.assign(count, 0.0f);
+		mY.assign(count, 0.0f);
+		mZ.assign(count, 0.0f);
+		mVX.assign(count, 0.0f);
+		mVY.assign(count, 0.0f);
+		mVZ.assign(count, 0.0f);
+		mMass.assign(count, 0.0f);
+		mAlpha.assign(count, 0.0f);
+		mFlags.assign(count, 0);
+	}
 
-		FLAG_FADEIN,
-		FLAG_FADEOUT,
-		FLAG_RESPAWN,
+	void	Free()
+	{
+		*this = WFXParticles();
+	}
 
-		FLAG_MAX
-	};
-	typedef		ratl::bits_vs<FLAG_MAX>		TFlags;
+	void	SetPosition(int particleNum, const CVec3& pos)
+	{
+		mX[particleNum] = pos[0];
+		mY[particleNum] = pos[1];
+		mZ[particleNum] = pos[2];
+	}
 
-	float	mAlpha;
-	TFlags	mFlags;
-	CVec3	mPosition;
-	CVec3	mVelocity;
-	float	mMass;			// A higher number will more greatly resist force and result in greater gravity
+	Q::WeatherParticles	Kernel()
+	{
+		Q::WeatherParticles	particles = {
+			mX.data(), mY.data(), mZ.data(),
+			mVX.data(), mVY.data(), mVZ.data(),
+			mMass.data(), mAlpha.data(), mFlags.data(), mX.size() };
+		return particles;
+	}
 };
 
 
@@ -499,22 +467,7 @@ private:
 		}
 	};
 	ratl::vector_vs<SWeatherZone, MAX_WEATHER_ZONES>	mWeatherZones;
-
-
-private:
-	////////////////////////////////////////////////////////////////////////////////////
-	// Iteration Variables
-	////////////////////////////////////////////////////////////////////////////////////
-	int				mWCells;
-	int				mHCells;
-
-	int				mXCell;
-	int				mYCell;
-	int				mZBit;
-
-	int				mXMax;
-	int				mYMax;
-	int				mZMax;
+	Q::WeatherZone	mStepZones[MAX_WEATHER_ZONES];		// mWeatherZones, as Q::weatherStep sees them
 
 
 private:
@@ -837,46 +790,42 @@ public:
 
 
 	////////////////////////////////////////////////////////////////////////////////////
-	// PointOutside - Test to see if a given bounded plane is outside
+	// SetupStep - Hands the cache to Q::weatherStep, which tests a bounded plane of
+	// the given size against it for every particle
 	////////////////////////////////////////////////////////////////////////////////////
-	inline	bool	PointOutside(const CVec3& pos, float width, float height)
+	void	SetupStep(Q::WeatherStep& step, float width, float height)
 	{
 		for (int zone=0; zone<mWeatherZones.size(); zone++)
 		{
-			SWeatherZone	wz = mWeatherZones[zone];
-			if (wz.mExtents.In(pos))
+			const SWeatherZone&	wz = mWeatherZones[zone];
+			Q::WeatherZone&		sz = mStepZones[zone];
+			for (int dim=0; dim<3; dim++)
 			{
-				int		bit, x, y, z;
-				wz.ConvertToCell(pos, x, y, z, bit);
-				if (width<POINTCACHE_CELL_SIZE || height<POINTCACHE_CELL_SIZE)
-				{
- 					return (wz.CellOutside(x, y, z, bit));
-				}
-
-				mWCells = ((int)width  / POINTCACHE_CELL_SIZE);
-				mHCells = ((int)height / POINTCACHE_CELL_SIZE);
-
-				mXMax = x + mWCells;
-				mYMax = y + mWCells;
-				mZMax = bit + mHCells;
-
-				for (mXCell=x-mWCells; mXCell<=mXMax; mXCell++)
-				{
-					for (mYCell=y-mWCells; mYCell<=mYMax; mYCell++)
-					{
-						for (mZBit=bit-mHCells; mZBit<=mZMax; mZBit++)
-						{
-							if (!wz.CellOutside(mXCell, mYCell, z, mZBit))
-							{
-								return false;
-							}
-						}
-					}
-				}
-				return true;
+				sz.mins[dim]		= wz.mExtents.mMins[dim];
+				sz.maxs[dim]		= wz.mExtents.mMaxs[dim];
+				sz.cellMins[dim]	= wz.mSize.mMins[dim];
 			}
+			sz.width	= wz.mWidth;
+			sz.height	= wz.mHeight;
+			sz.depth	= wz.mDepth;
+			sz.cells	= wz.mPointCache;
+		}
+		step.zones			= mStepZones;
+		step.numZones		= mWeatherZones.size();
+		step.markedOutside	= SWeatherZone::mMarkedOutside;
+
+		// Planes Smaller Than A Cell Just Test The Cell They Are In
+		//-----------------------------------------------------------
+		if (width<POINTCACHE_CELL_SIZE || height<POINTCACHE_CELL_SIZE)
+		{
+			step.cellSpread	= 0;
+			step.bitSpread	= 0;
+		}
+		else
+		{
+			step.cellSpread	= (int)((int)width  / POINTCACHE_CELL_SIZE);
+			step.bitSpread	= (int)((int)height / POINTCACHE_CELL_SIZE);
 		}
-		return !(SWeatherZone::mMarkedOutside);
 	}
 };
 COutside			mOutside;
@@ -957,7 +906,10 @@ private:
 	// DYNAMIC MEMORY
 	////////////////////////////////////////////////////////////////////////////////////
 	image_t*	mImage;
-	WFXParticle*	mParticles;
+	WFXParticles	mParticles;
+	std::vector<float>	mVertexes;			// 3 floats per vertex, mVertexCount vertexes per particle
+	std::vector<float>	mVertexColors;		// 4 floats per vertex
+	std::vector<float>	mTexCoords;			// 2 floats per vertex, the same for every particle
 
 private:
 	////////////////////////////////////////////////////////////////////////////////////
@@ -973,8 +925,6 @@ private:
 	CVec3		mCameraForward;
 	CVec3		mCameraLeft;
 	CVec3		mCameraDown;
-	CVec3		mCameraLeftPlusUp;
-	CVec3		mCameraLeftMinusUp;
 
 
 	int			mParticleCountRender;
@@ -1028,7 +978,7 @@ public:
 	void	Initialize(int count, const char* texturePath, int VertexCount=4)
 	{
 		Reset();
-		assert(mParticleCount==0 && mParticles==0);
+		assert(mParticleCount==0 && mParticles.mX.empty());
 		assert(mImage==0);
 
 		// Create The Image
@@ -1046,22 +996,30 @@ public:
 		// Create The Particles
 		//----------------------
 		mParticleCount	= count;
-		mParticles		= new WFXParticle[mParticleCount];
-
-
-
-		WFXParticle*	part=0;
+		mParticles.Resize(mParticleCount);
 		for (int particleNum=0; particleNum<mParticleCount; particleNum++)
 		{
-			part = &(mParticles[particleNum]);
-			part->mPosition.Clear();
-			part->mVelocity.Clear();
-			part->mAlpha	= 0.0f;
-			mMass.Pick(part->mMass);
+			mMass.Pick(mParticles.mMass[particleNum]);
 		}
 
 		mVertexCount = VertexCount;
 		mGLModeEnum = (mVertexCount==3)?(GL_TRIANGLES):(GL_QUADS);
+
+
+		// Create The Vertex Arrays
+		//--------------------------
+		mVertexes.resize(mParticleCount * mVertexCount * 3);
+		mVertexColors.resize(mParticleCount * mVertexCount * 4);
+
+		static const float	triangleTexCoords[3][2]	= { {1.0f, 0.0f}, {0.0f, 1.0f}, {0.0f, 0.0f} };
+		static const float	quadTexCoords[4][2]		= { {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f} };
+		const float			(*texCoords)[2] = (mVertexCount==3)?(triangleTexCoords):(quadTexCoords);
+		mTexCoords.resize(mParticleCount * mVertexCount * 2);
+		for (int vert=0; vert<mParticleCount * mVertexCount; vert++)
+		{
+			mTexCoords[vert*2 + 0] = texCoords[vert % mVertexCount][0];
+			mTexCoords[vert*2 + 1] = texCoords[vert % mVertexCount][1];
+		}
 	}
 
 
@@ -1075,12 +1033,11 @@ public:
 			// TODO: Free Image?
 		}
 		mImage				= 0;
-		if (mParticleCount)
-		{
-			delete [] mParticles;
-		}
 		mParticleCount		= 0;
-		mParticles			= 0;
+		mParticles.Free();
+		mVertexes			= std::vector<float>();
+		mVertexColors		= std::vector<float>();
+		mTexCoords			= std::vector<float>();
 
 		mPopulated			= 0;
 
@@ -1158,18 +1115,8 @@ public:
 	////////////////////////////////////////////////////////////////////////////////////
 	void		Update()
 	{
-		WFXParticle*	part=0;
-		CVec3		partForce;
-		CVec3		partMoved;
-		CVec3		partToCamera;
-		bool		partRendering;
-		bool		partOutside;
-		bool		partInRange;
-		bool		partInView;
+		CVec3		partPosition;
 		int			particleNum;
-		float		particleFade = (mFade * mSecondsElapsed);
-		int			numLocalWindZones = mLocalWindZones.size();
-		int			curLocalWindZone;
 
 
 		// Compute Camera
@@ -1259,18 +1206,6 @@ public:
 				mSpawnSpeed		= VectorNormalize(mSpawnPlaneNorm.v);
 				MakeNormalVectors(mSpawnPlaneNorm.v, mSpawnPlaneRight.v, mSpawnPlaneUp.v);
 			}
-
-			// Optimization For Quad Position Calculation
-			//--------------------------------------------
-			if (mVertexCount==4)
-			{
-		 		mCameraLeftPlusUp  = (mCameraLeft - mCameraDown);
-				mCameraLeftMinusUp = (mCameraLeft + mCameraDown);
-			}
-			else
-			{
-				mCameraLeftPlusUp  = (mCameraDown + mCameraLeft);		// should really be called mCamera Left + Down
-			}
 		}
 
 		// Stop All Additional Processing
@@ -1282,144 +1217,77 @@ public:
 
 
 
+		// First Time Spawn Locations
+		//----------------------------
+		if (!mPopulated)
+		{
+			for (particleNum=0; particleNum<mParticleCount; particleNum++)
+			{
+				mRange.Pick(partPosition);
+				mParticles.SetPosition(particleNum, partPosition);
+			}
+		}
+
+
 		// Now Update All Particles
 		//--------------------------
-		mParticleCountRender = 0;
-		for (particleNum=0; particleNum<mParticleCount; particleNum++)
 		{
-			part			= &(mParticles[particleNum]);
+			Q::WeatherStep	step;
+			Q::WeatherWind	winds[MAX_WIND_ZONES];
 
-			if (!mPopulated)
+			for (int dim=0; dim<3; dim++)
 			{
-				mRange.Pick(part->mPosition);		// First Time Spawn Location
+				step.force[dim]			= force[dim];
+				step.rangeMins[dim]		= mRange.mMins[dim];
+				step.rangeMaxs[dim]		= mRange.mMaxs[dim];
+				step.viewOrigin[dim]	= mCameraPosition[dim];
+				step.viewForward[dim]	= mCameraForward[dim];
 			}
+			step.friction	= mFrictionInverse;
+			step.seconds	= mSecondsElapsed;
+			step.fade		= (mFade * mSecondsElapsed);
+			step.maxAlpha	= mColor[3];
+			step.wrap		= !UseSpawnPlane();
 
-			// Grab The Force And Apply Non Global Wind
-			//------------------------------------------
-			partForce = force;
-
-			if (numLocalWindZones)
+			for (int wz=0; wz<mLocalWindZones.size(); wz++)
 			{
-				for (curLocalWindZone=0; curLocalWindZone<numLocalWindZones; curLocalWindZone++)
+				for (int dim=0; dim<3; dim++)
 				{
-					if (mLocalWindZones[curLocalWindZone]->mRBounds.In(part->mPosition))
-					{
-						partForce += mLocalWindZones[curLocalWindZone]->mCurrentVelocity;
-					}
+					winds[wz].mins[dim]		= mLocalWindZones[wz]->mRBounds.mMins[dim];
+					winds[wz].maxs[dim]		= mLocalWindZones[wz]->mRBounds.mMaxs[dim];
+					winds[wz].velocity[dim]	= mLocalWindZones[wz]->mCurrentVelocity[dim];
 				}
 			}
+			step.winds		= winds;
+			step.numWinds	= mLocalWindZones.size();
 
-			partForce /= part->mMass;
-
+			mOutside.SetupStep(step, mWidth, mHeight);
 
-			// Apply The Force
-			//-----------------
-			part->mVelocity		+= partForce;
-			part->mVelocity		*= mFrictionInverse;
-
-			part->mPosition.ScaleAdd(part->mVelocity, mSecondsElapsed);
+			mParticleCountRender = (int)Q::weatherStep(mParticles.Kernel(), step);
+		}
 
-			partToCamera	= (part->mPosition - mCameraPosition);
-			partRendering	= part->mFlags.get_bit(WFXParticle::FLAG_RENDER);
-			partOutside		= mOutside.PointOutside(part->mPosition, mWidth, mHeight);
-			partInRange		= mRange.In(part->mPosition);
-			partInView		= (partOutside && partInRange && (partToCamera.Dot(mCameraForward)>0.0f));
 
-			// Process Respawn
-			//-----------------
-			if (!partInRange && !partRendering)
+		// Process Respawn - Reselect A Position On The Spawn Plane, Or Anywhere In Range
+		// For Particles That Went Too Far Out To Wrap Around
+		//--------------------------------------------------------------------------------
+		for (particleNum=0; particleNum<mParticleCount; particleNum++)
+		{
+			if (!(mParticles.mFlags[particleNum] & Q::WEATHER_RESPAWN))
 			{
-				part->mVelocity.Clear();
-
-				// Reselect A Position On The Spawn Plane
-				//----------------------------------------
-				if (UseSpawnPlane())
-				{
-					part->mPosition		= mCameraPosition;
-					part->mPosition		-= (mSpawnPlaneNorm* mSpawnPlaneDistance);
-					part->mPosition		+= (mSpawnPlaneRight*Q_flrand(-mSpawnPlaneSize, mSpawnPlaneSize));
-					part->mPosition		+= (mSpawnPlaneUp*   Q_flrand(-mSpawnPlaneSize, mSpawnPlaneSize));
-				}
-
-				// Otherwise, Just Wrap Around To The Other End Of The Range
-				//-----------------------------------------------------------
-				else
-				{
-					mRange.Wrap(part->mPosition);
-				}
-				partInRange = true;
+				continue;
 			}
-
-			// Process Fade
-			//--------------
+			if (UseSpawnPlane())
 			{
-				// Start A Fade Out
-				//------------------
-				if		(partRendering && !partInView)
-				{
-					part->mFlags.clear_bit(WFXParticle::FLAG_FADEIN);
-					part->mFlags.set_bit(WFXParticle::FLAG_FADEOUT);
-				}
-
-				// Switch From Fade Out To Fade In
-				//---------------------------------
-				else if (partRendering && partInView && part->mFlags.get_bit(WFXParticle::FLAG_FADEOUT))
-				{
-					part->mFlags.set_bit(WFXParticle::FLAG_FADEIN);
-					part->mFlags.clear_bit(WFXParticle::FLAG_FADEOUT);
-				}
-
-				// Start A Fade In
-				//-----------------
-				else if (!partRendering && partInView)
-				{
-					partRendering = true;
-					part->mAlpha = 0.0f;
-					part->mFlags.set_bit(WFXParticle::FLAG_RENDER);
-					part->mFlags.set_bit(WFXParticle::FLAG_FADEIN);
-					part->mFlags.clear_bit(WFXParticle::FLAG_FADEOUT);
-				}
-
-				// Update Fade
-				//-------------
-				if (partRendering)
-				{
-
-					// Update Fade Out
-					//-----------------
-					if (part->mFlags.get_bit(WFXParticle::FLAG_FADEOUT))
-					{
-						part->mAlpha -= particleFade;
-						if (part->mAlpha<=0.0f)
-						{
-							part->mAlpha = 0.0f;
-							part->mFlags.clear_bit(WFXParticle::FLAG_FADEOUT);
-							part->mFlags.clear_bit(WFXParticle::FLAG_FADEIN);
-							part->mFlags.clear_bit(WFXParticle::FLAG_RENDER);
-							partRendering = false;
-						}
-					}
-
-					// Update Fade In
-					//----------------
-					else if (part->mFlags.get_bit(WFXParticle::FLAG_FADEIN))
-					{
-						part->mAlpha += particleFade;
-						if (part->mAlpha>=mColor[3])
-						{
-							part->mFlags.clear_bit(WFXParticle::FLAG_FADEIN);
-							part->mAlpha = mColor[3];
-						}
-					}
-				}
+				partPosition	= mCameraPosition;
+				partPosition	-= (mSpawnPlaneNorm* mSpawnPlaneDistance);
+				partPosition	+= (mSpawnPlaneRight*Q_flrand(-mSpawnPlaneSize, mSpawnPlaneSize));
+				partPosition	+= (mSpawnPlaneUp*   Q_flrand(-mSpawnPlaneSize, mSpawnPlaneSize));
 			}
-
-			// Keep Track Of The Number Of Particles To Render
-			//-------------------------------------------------
-			if (part->mFlags.get_bit(WFXParticle::FLAG_RENDER))
+			else
 			{
-				mParticleCountRender ++;
+				mRange.Pick(partPosition);
 			}
+			mParticles.SetPosition(particleNum, partPosition);
 		}
 		mPopulated = true;
 	}
@@ -1429,11 +1297,6 @@ public:
 	////////////////////////////////////////////////////////////////////////////////////
 	void		Render()
 	{
-		WFXParticle*	part=0;
-		int			particleNum;
-		CVec3		partDirection;
-
-
 		// Set The GL State And Image Binding
 		//------------------------------------
 		GL_State((mBlendMode==0)?(GLS_ALPHA):(GLS_SRCBLEND_ONE | GLS_DSTBLEND_ONE));
@@ -1455,101 +1318,43 @@ public:
 		qglPushMatrix();
 
 
-		// Begin
-		//-------
-		qglBegin(mGLModeEnum);
-		for (particleNum=0; particleNum<mParticleCount; particleNum++)
+		// Build A Triangle Or Quad For Every Rendering Particle
+		//-------------------------------------------------------
+		Q::WeatherSprite	sprite;
+		for (int dim=0; dim<4; dim++)
 		{
-			part = &(mParticles[particleNum]);
-			if (!part->mFlags.get_bit(WFXParticle::FLAG_RENDER))
-			{
-				continue;
-			}
+			sprite.color[dim]	= mColor[dim];
+		}
+		for (int dim=0; dim<3; dim++)
+		{
+			sprite.left[dim]	= mCameraLeft[dim];
+			sprite.down[dim]	= mCameraDown[dim];
+		}
+		sprite.alphaOnly			= (mBlendMode==0);		// Blend Mode Zero -> Apply Alpha Just To Alpha Channel
+		sprite.vertexCount			= mVertexCount;
+		sprite.orientWithVelocity	= mOrientWithVelocity;
+		sprite.height				= mHeight;
 
-			// If Oriented With Velocity, We Want To Calculate Vertx Offsets Differently For Each Particle
-			//---------------------------------------------------------------------------------------------
-			if (mOrientWithVelocity)
-			{
-				partDirection = part->mVelocity;
-				VectorNormalize(partDirection.v);
-				mCameraDown = partDirection;
-				mCameraDown *= (mHeight * -1);
-				if (mVertexCount==4)
-				{
-		 			mCameraLeftPlusUp  = (mCameraLeft - mCameraDown);
-					mCameraLeftMinusUp = (mCameraLeft + mCameraDown);
-				}
-				else
-				{
-					mCameraLeftPlusUp  = (mCameraDown + mCameraLeft);
-				}
-			}
+		const int numVertexes = (int)Q::weatherVertexes(
+			mParticles.Kernel(), sprite,
+			reinterpret_cast<float(*)[3]>(mVertexes.data()),
+			reinterpret_cast<float(*)[4]>(mVertexColors.data()));
 
-			// Blend Mode Zero -> Apply Alpha Just To Alpha Channel
-			//------------------------------------------------------
-			if (mBlendMode==0)
-			{
-				qglColor4f(mColor[0], mColor[1], mColor[2], part->mAlpha);
-			}
 
-			// Otherwise Apply Alpha To All Channels
-			//---------------------------------------
-			else
-			{
-				qglColor4f(mColor[0]*part->mAlpha, mColor[1]*part->mAlpha, mColor[2]*part->mAlpha, mColor[3]*part->mAlpha);
-			}
+		// Draw Them All At Once
+		//-----------------------
+		if (numVertexes)
+		{
+			qglEnableClientState(GL_TEXTURE_COORD_ARRAY);
+			qglTexCoordPointer(2, GL_FLOAT, 0, mTexCoords.data());
 
+			qglEnableClientState(GL_COLOR_ARRAY);
+			qglColorPointer(4, GL_FLOAT, 0, mVertexColors.data());
 
-			// Render A Triangle
-			//-------------------
-			if (mVertexCount==3)
-			{
- 				qglTexCoord2f(1.0, 0.0);
-				qglVertex3f(part->mPosition[0],
-							part->mPosition[1],
-							part->mPosition[2]);
-
-				qglTexCoord2f(0.0, 1.0);
-				qglVertex3f(part->mPosition[0] + mCameraLeft[0],
-							part->mPosition[1] + mCameraLeft[1],
-							part->mPosition[2] + mCameraLeft[2]);
-
-				qglTexCoord2f(0.0, 0.0);
-				qglVertex3f(part->mPosition[0] + mCameraLeftPlusUp[0],
-							part->mPosition[1] + mCameraLeftPlusUp[1],
-							part->mPosition[2] + mCameraLeftPlusUp[2]);
-			}
+			qglVertexPointer(3, GL_FLOAT, 0, mVertexes.data());
 
-			// Render A Quad
-			//---------------
-			else
-			{
-				// Left bottom.
-				qglTexCoord2f( 0.0, 0.0 );
-				qglVertex3f(part->mPosition[0] - mCameraLeftMinusUp[0],
-							part->mPosition[1] - mCameraLeftMinusUp[1],
-							part->mPosition[2] - mCameraLeftMinusUp[2] );
-
-				// Right bottom.
-				qglTexCoord2f( 1.0, 0.0 );
-				qglVertex3f(part->mPosition[0] - mCameraLeftPlusUp[0],
-							part->mPosition[1] - mCameraLeftPlusUp[1],
-							part->mPosition[2] - mCameraLeftPlusUp[2] );
-
-				// Right top.
-				qglTexCoord2f( 1.0, 1.0 );
-				qglVertex3f(part->mPosition[0] + mCameraLeftMinusUp[0],
-							part->mPosition[1] + mCameraLeftMinusUp[1],
-							part->mPosition[2] + mCameraLeftMinusUp[2] );
-
-				// Left top.
-				qglTexCoord2f( 0.0, 1.0 );
-				qglVertex3f(part->mPosition[0] + mCameraLeftPlusUp[0],
-							part->mPosition[1] + mCameraLeftPlusUp[1],
-							part->mPosition[2] + mCameraLeftPlusUp[2] );
-			}
+			qglDrawArrays(mGLModeEnum, 0, numVertexes);
 		}
-		qglEnd();
 
 		qglEnable(GL_CULL_FACE);
 		qglPopMatrix();
@@ -1594,7 +1399,7 @@ void R_ShutdownWorldEffects(void)
 void RB_RenderWorldEffects(void)
 {
 	if (!tr.world ||
-		(tr.refdef.rdflags & RDF_NOWORLDMODEL) ||
+		(backEnd.refdef.rdflags & RDF_NOWORLDMODEL) ||
 		(backEnd.refdef.rdflags & RDF_SKYBOXPORTAL) ||
 		!mParticleClouds.size() ||
 		ri.CL_IsRunningInGameCinematic())
@@ -1715,6 +1520,9 @@ void R_WorldEffectCommand(const char *command)
 		return;
 	}
 
+	// the render thread draws the weather from the same state
+	R_SyncRenderThread();
+
 	const char	*token;//, *origCommand;
 
 	COM_BeginParseSession();
@@ -26,7 +26,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_local.h"
 #include "tr_common.h"
 
-backEndData_t	*backEndData;
+backEndData_t	*backEndData[SMP_FRAMES];
 backEndState_t	backEnd;
 
 bool tr_stencilled = false;
@@ -63,6 +63,9 @@ void GL_Bind( image_t *image ) {
 		ri.Printf( PRINT_WARNING, "GL_Bind: NULL image\n" );
 		texnum = tr.defaultImage->texnum;
 	} else {
+		if ( image->pendingUpload ) {
+			R_Images_FlushPendingUploads();
+		}
 		texnum = image->texnum;
 	}
 
@@ -583,11 +586,11 @@ static inline bool R_WorldCoordToScreenCoordFloat(vec3_t worldCoord, float *x, f
 	ycenter = glConfig.vidHeight / 2;
 
 	//AngleVectors (tr.refdef.viewangles, vfwd, vright, vup);
-	VectorCopy(tr.refdef.viewaxis[0], vfwd);
-	VectorCopy(tr.refdef.viewaxis[1], vright);
-	VectorCopy(tr.refdef.viewaxis[2], vup);
+	VectorCopy(backEnd.refdef.viewaxis[0], vfwd);
+	VectorCopy(backEnd.refdef.viewaxis[1], vright);
+	VectorCopy(backEnd.refdef.viewaxis[2], vup);
 
-	VectorSubtract (worldCoord, tr.refdef.vieworg, local);
+	VectorSubtract (worldCoord, backEnd.refdef.vieworg, local);
 
 	transformed[0] = DotProduct(local,vright);
 	transformed[1] = DotProduct(local,vup);
@@ -599,8 +602,8 @@ static inline bool R_WorldCoordToScreenCoordFloat(vec3_t worldCoord, float *x, f
 		return false;
 	}
 
-	xzi = xcenter / transformed[2] * (90.0/tr.refdef.fov_x);
-	yzi = ycenter / transformed[2] * (90.0/tr.refdef.fov_y);
+	xzi = xcenter / transformed[2] * (90.0/backEnd.refdef.fov_x);
+	yzi = ycenter / transformed[2] * (90.0/backEnd.refdef.fov_y);
 
 	*x = xcenter + xzi * transformed[0];
 	*y = ycenter - yzi * transformed[1];
@@ -1018,21 +1021,13 @@ const void	*RB_SetColor( const void *data ) {
 
 /*
 =============
-RB_StretchPic
+RB_AddStretchPic
 =============
 */
-const void *RB_StretchPic ( const void *data ) {
-	const stretchPicCommand_t	*cmd;
-	shader_t *shader;
+static void RB_AddStretchPic ( shader_t *shader, float x, float y, float w, float h,
+					  float s1, float t1, float s2, float t2 ) {
 	int		numVerts, numIndexes;
 
-	cmd = (const stretchPicCommand_t *)data;
-
-	if ( !backEnd.projection2D ) {
-		RB_SetGL2D();
-	}
-
-	shader = cmd->shader;
 	if ( shader != tess.shader ) {
 		if ( tess.numIndexes ) {
 			RB_EndSurface();
@@ -1061,37 +1056,77 @@ const void *RB_StretchPic ( const void *data ) {
 	baDest = (byteAlias_t *)&tess.vertexColors[numVerts + 2]; baDest->ui = baSource->ui;
 	baDest = (byteAlias_t *)&tess.vertexColors[numVerts + 3]; baDest->ui = baSource->ui;
 
-	tess.xyz[ numVerts ][0] = cmd->x;
-	tess.xyz[ numVerts ][1] = cmd->y;
+	tess.xyz[ numVerts ][0] = x;
+	tess.xyz[ numVerts ][1] = y;
 	tess.xyz[ numVerts ][2] = 0;
 
-	tess.texCoords[ numVerts ][0][0] = cmd->s1;
-	tess.texCoords[ numVerts ][0][1] = cmd->t1;
+	tess.texCoords[ numVerts ][0][0] = s1;
+	tess.texCoords[ numVerts ][0][1] = t1;
 
-	tess.xyz[ numVerts + 1 ][0] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 1 ][1] = cmd->y;
+	tess.xyz[ numVerts + 1 ][0] = x + w;
+	tess.xyz[ numVerts + 1 ][1] = y;
 	tess.xyz[ numVerts + 1 ][2] = 0;
 
-	tess.texCoords[ numVerts + 1 ][0][0] = cmd->s2;
-	tess.texCoords[ numVerts + 1 ][0][1] = cmd->t1;
+	tess.texCoords[ numVerts + 1 ][0][0] = s2;
+	tess.texCoords[ numVerts + 1 ][0][1] = t1;
 
-	tess.xyz[ numVerts + 2 ][0] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 2 ][1] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 2 ][0] = x + w;
+	tess.xyz[ numVerts + 2 ][1] = y + h;
 	tess.xyz[ numVerts + 2 ][2] = 0;
 
-	tess.texCoords[ numVerts + 2 ][0][0] = cmd->s2;
-	tess.texCoords[ numVerts + 2 ][0][1] = cmd->t2;
+	tess.texCoords[ numVerts + 2 ][0][0] = s2;
+	tess.texCoords[ numVerts + 2 ][0][1] = t2;
 
-	tess.xyz[ numVerts + 3 ][0] = cmd->x;
-	tess.xyz[ numVerts + 3 ][1] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 3 ][0] = x;
+	tess.xyz[ numVerts + 3 ][1] = y + h;
 	tess.xyz[ numVerts + 3 ][2] = 0;
 
-	tess.texCoords[ numVerts + 3 ][0][0] = cmd->s1;
-	tess.texCoords[ numVerts + 3 ][0][1] = cmd->t2;
+	tess.texCoords[ numVerts + 3 ][0][0] = s1;
+	tess.texCoords[ numVerts + 3 ][0][1] = t2;
+}
+
+/*
+=============
+RB_StretchPic
+=============
+*/
+const void *RB_StretchPic ( const void *data ) {
+	const stretchPicCommand_t	*cmd;
+
+	cmd = (const stretchPicCommand_t *)data;
+
+	if ( !backEnd.projection2D ) {
+		RB_SetGL2D();
+	}
+
+	RB_AddStretchPic( cmd->shader, cmd->x, cmd->y, cmd->w, cmd->h, cmd->s1, cmd->t1, cmd->s2, cmd->t2 );
 
 	return (const void *)(cmd + 1);
 }
 
+/*
+=============
+RB_StretchPics
+=============
+*/
+const void *RB_StretchPics ( const void *data ) {
+	const stretchPicsCommand_t	*cmd;
+	const stretchPic_t	*pic;
+	int		i;
+
+	cmd = (const stretchPicsCommand_t *)data;
+
+	if ( !backEnd.projection2D ) {
+		RB_SetGL2D();
+	}
+
+	for ( i = 0, pic = cmd->pics; i < cmd->numPics; i++, pic++ ) {
+		RB_AddStretchPic( pic->shader, pic->x, pic->y, pic->w, pic->h, pic->s1, pic->t1, pic->s2, pic->t2 );
+	}
+
+	return (const void *)(cmd->pics + cmd->numPics);
+}
+
 
 /*
 =============
@@ -1406,7 +1441,7 @@ const void	*RB_DrawBuffer( const void *data ) {
 	qglDrawBuffer( cmd->buffer );
 
 		// clear screen for debugging
-	if (!( backEnd.refdef.rdflags & RDF_NOWORLDMODEL ) && tr.world && tr.refdef.rdflags & RDF_doLAGoggles)
+	if (!( backEnd.refdef.rdflags & RDF_NOWORLDMODEL ) && tr.world && backEnd.refdef.rdflags & RDF_doLAGoggles)
 	{
 		const fog_t		*fog = &tr.world->fogs[tr.world->numfogs];
 
@@ -1606,6 +1641,12 @@ void RB_ExecuteRenderCommands( const void *data ) {
 
 	t1 = ri.Milliseconds ();
 
+	if ( !tr.smpActive || data == backEndData[0]->commands.cmds ) {
+		backEnd.smpFrame = 0;
+	} else {
+		backEnd.smpFrame = 1;
+	}
+
 	while ( 1 ) {
 		data = PADP(data, sizeof(void *));
 
@@ -1616,6 +1657,9 @@ void RB_ExecuteRenderCommands( const void *data ) {
 		case RC_STRETCH_PIC:
 			data = RB_StretchPic( data );
 			break;
+		case RC_STRETCH_PICS:
+			data = RB_StretchPics( data );
+			break;
 		case RC_ROTATE_PIC:
 			data = RB_RotatePic( data );
 			break;
@@ -560,7 +560,8 @@ static void ParseTriSurf( dsurface_t *ds, mapVert_t *verts, msurface_t *surf, in
 	}
 
 	tri = (srfTriangles_t *) R_Malloc( sizeof( *tri ) + numVerts * sizeof( tri->verts[0] ) + numIndexes * sizeof( tri->indexes[0] ), TAG_HUNKMISCMODELS, qfalse );
-	tri->dlightBits = 0; //JIC
+	memset( tri->dlightBits, 0, sizeof( tri->dlightBits ) ); //JIC
+	memset( &tri->vbo, 0, sizeof( tri->vbo ) );
 	tri->surfaceType = SF_TRIANGLES;
 	tri->numVerts = numVerts;
 	tri->numIndexes = numIndexes;
@@ -1435,6 +1436,10 @@ void RE_LoadWorldMap_Actual( const char *name, world_t &worldData, int index ) {
 
 		// only set tr.world now that we know the entire level has loaded properly
 		tr.world = &worldData;
+
+		R_BuildWorldLeafs( tr.world );
+		R_BuildWorldVBO( tr.world );
+		R_ClearSurfaceSpriteCache();
 	}
 
 
@@ -26,6 +26,241 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+With r_smp the back end runs on its own thread, a frame behind the front end:
+while it draws the commands in backEndData[n] the front end builds the next
+frame in backEndData[n^1]. The GL context stays with the render thread, the
+front end only takes it back (after waiting for the thread to go idle) when
+something has to touch GL directly, which is what R_IssuePendingRenderCommands
+already means everywhere it's called.
+*/
+static struct renderThread_s {
+	std::thread					thread;
+	std::mutex					mutex;
+	std::condition_variable		wake;
+	std::condition_variable		done;
+
+	// all of these are guarded by mutex
+	const void	*commands;			// the list the thread should run next, cleared once it has
+	bool		releaseContext;		// the front end wants the GL context back
+	bool		shutdown;
+	bool		errorPending;		// an ri.Error on the render thread, raised again by the front end
+	int			errorCode;
+	char		errorMessage[1024];
+	int			glError;			// the last qglGetError the thread saw, checked in RE_BeginFrame
+
+	// only touched by the front end
+	bool		frontEndHasContext;
+	void		(QDECL *engineError)( int errorLevel, const char *fmt, ... ) NORETURN_PTR;	// ri.Error while the thread isn't running
+	int			lastBackEndMsec;
+
+	// r_speeds 8, in milliseconds
+	double		frontEndWaitMsec;
+	double		renderIdleMsec;
+	double		backEndMsec;
+} smp;
+
+int	c_blockedOnRender;
+int	c_blockedOnMain;
+
+// thrown by R_RenderThreadError to unwind the back end
+struct renderThreadError_t {};
+
+static double R_ElapsedMsec( std::chrono::steady_clock::time_point start ) {
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+}
+
+static void R_RenderThread( void ) {
+	bool hasContext = false;
+	std::unique_lock<std::mutex> lock( smp.mutex );
+
+	for ( ;; ) {
+		const std::chrono::steady_clock::time_point idleStart = std::chrono::steady_clock::now();
+		if ( !smp.commands && !smp.releaseContext && !smp.shutdown ) {
+			c_blockedOnMain++;
+		}
+		smp.wake.wait( lock, []{ return smp.commands || smp.releaseContext || smp.shutdown; } );
+		smp.renderIdleMsec += R_ElapsedMsec( idleStart );
+
+		if ( smp.releaseContext || ( smp.shutdown && !smp.commands ) ) {
+			if ( hasContext ) {
+				qglFlush();
+				ri.GL_MakeCurrent( qfalse );
+				hasContext = false;
+			}
+			smp.releaseContext = false;
+			smp.done.notify_all();
+			if ( smp.shutdown ) {
+				return;
+			}
+			continue;
+		}
+
+		const void *commands = smp.commands;
+		lock.unlock();
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		bool error = false;
+		if ( !hasContext ) {
+			hasContext = ri.GL_MakeCurrent( qtrue ) ? true : false;
+		}
+		try {
+			RB_ExecuteRenderCommands( commands );
+		} catch ( const renderThreadError_t & ) {
+			// errorCode and errorMessage were filled in by R_RenderThreadError
+			error = true;
+		}
+		const int glError = r_ignoreGLErrors->integer ? GL_NO_ERROR : qglGetError();
+		const double msec = R_ElapsedMsec( start );
+
+		lock.lock();
+		smp.backEndMsec += msec;
+		if ( glError != GL_NO_ERROR ) {
+			smp.glError = glError;
+		}
+		if ( error ) {
+			smp.errorPending = true;
+		}
+		smp.commands = NULL;
+		smp.done.notify_all();
+	}
+}
+
+/*
+====================
+R_OnRenderThread
+====================
+*/
+qboolean R_OnRenderThread( void ) {
+	return ( tr.smpActive && std::this_thread::get_id() == smp.thread.get_id() ) ? qtrue : qfalse;
+}
+
+/*
+====================
+R_RenderThreadError
+
+Takes the place of ri.Error while the render thread runs. Com_Error shuts the
+client and the renderer down for anything worse than ERR_DROP, which would
+wait on and join the render thread from the render thread itself, so on that
+thread the error is only recorded and the back end unwound. R_SyncRenderThread
+raises it again on the front end.
+====================
+*/
+static void NORETURN QDECL R_RenderThreadError( int errorLevel, const char *fmt, ... ) {
+	va_list		argptr;
+	char		text[sizeof( smp.errorMessage )];
+
+	va_start( argptr, fmt );
+	Q_vsnprintf( text, sizeof( text ), fmt, argptr );
+	va_end( argptr );
+
+	if ( !R_OnRenderThread() ) {
+		smp.engineError( errorLevel, "%s", text );
+	}
+
+	// the front end only reads these once the thread has published the error under the lock
+	smp.errorCode = errorLevel;
+	Q_strncpyz( smp.errorMessage, text, sizeof( smp.errorMessage ) );
+	throw renderThreadError_t();
+}
+
+/*
+====================
+R_SyncRenderThread
+
+Waits for the render thread to finish the commands it was last given. Errors
+the back end raised are raised again here, on the front end.
+====================
+*/
+void R_SyncRenderThread( void ) {
+	if ( !tr.smpActive || R_OnRenderThread() ) {
+		return;
+	}
+
+	int		errorLevel;
+	char	text[sizeof( smp.errorMessage )];
+	{
+		std::unique_lock<std::mutex> lock( smp.mutex );
+		if ( smp.commands ) {
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			c_blockedOnRender++;
+			smp.done.wait( lock, []{ return !smp.commands; } );
+			smp.frontEndWaitMsec += R_ElapsedMsec( start );
+		}
+		if ( !smp.errorPending ) {
+			return;
+		}
+		smp.errorPending = false;
+		errorLevel = smp.errorCode;
+		Q_strncpyz( text, smp.errorMessage, sizeof( text ) );
+	}
+
+	// the thread is idle now, so Com_Error is free to shut it down
+	smp.engineError( errorLevel, "%s", text );
+}
+
+/*
+====================
+R_AcquireContext
+
+Takes the GL context back from an idle render thread.
+====================
+*/
+static void R_AcquireContext( void ) {
+	if ( smp.frontEndHasContext ) {
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock( smp.mutex );
+		smp.releaseContext = true;
+		smp.wake.notify_one();
+		smp.done.wait( lock, []{ return !smp.releaseContext; } );
+	}
+	ri.GL_MakeCurrent( qtrue );
+	smp.frontEndHasContext = true;
+}
+
+/*
+====================
+R_ReleaseContext
+====================
+*/
+static void R_ReleaseContext( void ) {
+	if ( !smp.frontEndHasContext ) {
+		return;
+	}
+	qglFlush();
+	ri.GL_MakeCurrent( qfalse );
+	smp.frontEndHasContext = false;
+}
+
+/*
+====================
+R_UpdateVideoMaps
+
+The cinematic callbacks upload with GL on whatever thread calls them and
+share their state with the client, so the render thread only marks which
+video maps it drew and the front end advances them between frames.
+====================
+*/
+static void R_UpdateVideoMaps( void ) {
+	if ( !backEnd.smpVideoMaps ) {
+		return;
+	}
+	R_AcquireContext();
+	for ( int handle = 0; handle < NUM_SCRATCH_IMAGES; handle++ ) {
+		if ( backEnd.smpVideoMaps & ( 1 << handle ) ) {
+			ri.CIN_RunCinematic( handle );
+			ri.CIN_UploadCinematic( handle );
+		}
+	}
+	backEnd.smpVideoMaps = 0;
+}
 
 /*
 =====================
@@ -42,10 +277,10 @@ void R_PerformanceCounters( void ) {
 
 	if (r_speeds->integer == 1) {
 		const float texSize = R_SumOfUsedImages( qfalse )/(8*1048576.0f)*(r_texturebits->integer?r_texturebits->integer:glConfig.colorBits);
-		ri.Printf (PRINT_ALL, "%i/%i shdrs/srfs %i leafs %i vrts %i/%i tris %.2fMB tex %.2f dc\n",
+		ri.Printf (PRINT_ALL, "%i/%i shdrs/srfs %i leafs %i vrts %i/%i tris %.2fMB tex %.2f dc %i vbo\n",
 			backEnd.pc.c_shaders, backEnd.pc.c_surfaces, tr.pc.c_leafs, backEnd.pc.c_vertexes,
 			backEnd.pc.c_indexes/3, backEnd.pc.c_totalIndexes/3,
-			texSize, backEnd.pc.c_overDraw / (float)(glConfig.vidWidth * glConfig.vidHeight) );
+			texSize, backEnd.pc.c_overDraw / (float)(glConfig.vidWidth * glConfig.vidHeight), backEnd.pc.c_vboDraws );
 	} else if (r_speeds->integer == 2) {
 		ri.Printf (PRINT_ALL, "(patch) %i sin %i sclip  %i sout %i bin %i bclip %i bout\n",
 			tr.pc.c_sphere_cull_patch_in, tr.pc.c_sphere_cull_patch_clip, tr.pc.c_sphere_cull_patch_out,
@@ -79,7 +314,20 @@ void R_PerformanceCounters( void ) {
 		ri.Printf (PRINT_ALL, "Tex MB %.2f + buffers %.2f MB = Total %.2fMB\n",
 			texSize, backBuff*2+depthBuff+stencilBuff, texSize+backBuff*2+depthBuff+stencilBuff);
 	}
+	else if (r_speeds->integer == 8) {
+		if ( tr.smpActive ) {
+			// how much of the back end's time the front end spent doing something else
+			const double overlapped = smp.backEndMsec > 0.0 ? 100.0 * ( smp.backEndMsec - smp.frontEndWaitMsec ) / smp.backEndMsec : 0.0;
+			ri.Printf( PRINT_ALL, "smp: back end %.2fms, front end waited %.2fms (%i), render thread idle %.2fms (%i), %.0f%% overlapped\n",
+				smp.backEndMsec, smp.frontEndWaitMsec, c_blockedOnRender, smp.renderIdleMsec, c_blockedOnMain,
+				overlapped < 0.0 ? 0.0 : overlapped );
+		} else {
+			ri.Printf( PRINT_ALL, "smp: off\n" );
+		}
+	}
 
+	smp.backEndMsec = smp.frontEndWaitMsec = smp.renderIdleMsec = 0.0;
+	c_blockedOnRender = c_blockedOnMain = 0;
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
 	memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
 }
@@ -89,13 +337,10 @@ void R_PerformanceCounters( void ) {
 R_IssueRenderCommands
 ====================
 */
-int	c_blockedOnRender;
-int	c_blockedOnMain;
-
 void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	renderCommandList_t	*cmdList;
 
-	cmdList = &backEndData->commands;
+	cmdList = &backEndData[tr.smpFrame]->commands;
 
 	// add an end-of-list command
 	byteAlias_t *ba = (byteAlias_t *)&cmdList->cmds[cmdList->used];
@@ -104,6 +349,13 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	// clear it out, in case this is a sync and not a buffer flip
 	cmdList->used = 0;
 
+	if ( tr.smpActive ) {
+		// wait for the last batch, which also makes backEnd safe to read
+		R_SyncRenderThread();
+		smp.lastBackEndMsec = backEnd.pc.msec;
+		R_UpdateVideoMaps();
+	}
+
 	// at this point, the back end thread is idle, so it is ok
 	// to look at it's performance counters
 	if ( runPerformanceCounters ) {
@@ -113,7 +365,14 @@ void R_IssueRenderCommands( qboolean runPerformanceCounters ) {
 	// actually start the commands going
 	if ( !r_skipBackEnd->integer ) {
 		// let it start on the new batch
-		RB_ExecuteRenderCommands( cmdList->cmds );
+		if ( tr.smpActive ) {
+			R_ReleaseContext();
+			std::lock_guard<std::mutex> lock( smp.mutex );
+			smp.commands = cmdList->cmds;
+			smp.wake.notify_one();
+		} else {
+			RB_ExecuteRenderCommands( cmdList->cmds );
+		}
 	}
 }
 
@@ -129,7 +388,84 @@ void R_IssuePendingRenderCommands( void ) {
 	if ( !tr.registered ) {
 		return;
 	}
-	R_IssueRenderCommands( qfalse );
+	if ( !tr.smpActive ) {
+		R_IssueRenderCommands( qfalse );
+		return;
+	}
+	if ( R_OnRenderThread() ) {
+		// the back end already owns the context and runs everything in order
+		return;
+	}
+	if ( backEndData[tr.smpFrame]->commands.used ) {
+		R_IssueRenderCommands( qfalse );
+	}
+	R_SyncRenderThread();
+	R_AcquireContext();
+}
+
+/*
+====================
+R_InitRenderThread
+====================
+*/
+void R_InitRenderThread( void ) {
+	if ( tr.smpActive ) {
+		return;
+	}
+	if ( !ri.GL_MakeCurrent || !backEndData[1] ) {
+		ri.Printf( PRINT_WARNING, "r_smp: no render thread support, drawing on the main thread\n" );
+		return;
+	}
+
+	smp.commands = NULL;
+	smp.releaseContext = false;
+	smp.shutdown = false;
+	smp.errorPending = false;
+	smp.glError = GL_NO_ERROR;
+	smp.frontEndHasContext = true;
+	smp.lastBackEndMsec = 0;
+	smp.backEndMsec = smp.frontEndWaitMsec = smp.renderIdleMsec = 0.0;
+	backEnd.smpVideoMaps = 0;
+	R_AllocRenderBones();
+
+	smp.engineError = ri.Error;
+	ri.Error = R_RenderThreadError;
+
+	tr.smpActive = qtrue;
+	smp.thread = std::thread( R_RenderThread );
+}
+
+/*
+====================
+R_ShutdownRenderThread
+
+Lets the render thread finish, then gives the GL context back to the caller.
+====================
+*/
+void R_ShutdownRenderThread( void ) {
+	if ( !tr.smpActive ) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock( smp.mutex );
+		smp.done.wait( lock, []{ return !smp.commands; } );
+		smp.shutdown = true;
+		smp.wake.notify_one();
+	}
+	smp.thread.join();
+	ri.Error = smp.engineError;
+	R_FreeRenderBones();
+
+	if ( !smp.frontEndHasContext ) {
+		ri.GL_MakeCurrent( qtrue );
+		smp.frontEndHasContext = true;
+	}
+	// we're shutting down anyway, an error from the last frame has nowhere to go
+	smp.errorPending = false;
+	backEnd.smpVideoMaps = 0;
+	tr.smpActive = qfalse;
+	tr.smpFrame = 0;
 }
 
 /*
@@ -142,7 +478,7 @@ make sure there is enough command space
 void *R_GetCommandBuffer( int bytes ) {
 	renderCommandList_t	*cmdList;
 
-	cmdList = &backEndData->commands;
+	cmdList = &backEndData[tr.smpFrame]->commands;
 	bytes = PAD(bytes, sizeof (void *));
 
 	assert(cmdList);
@@ -243,6 +579,29 @@ void RE_StretchPic ( float x, float y, float w, float h,
 	cmd->t2 = t2;
 }
 
+/*
+=============
+R_AddStretchPics
+
+Reserves one command for up to MAX_STRETCH_PICS_PER_COMMAND pics drawn with
+the current colour, the caller fills in the returned array. NULL once the
+command buffer is full, same as the single pic commands.
+=============
+*/
+stretchPic_t *R_AddStretchPics( int numPics ) {
+	stretchPicsCommand_t	*cmd;
+
+	assert( numPics > 0 && numPics <= MAX_STRETCH_PICS_PER_COMMAND );
+
+	cmd = (stretchPicsCommand_t *) R_GetCommandBuffer( sizeof( *cmd ) + ( numPics - 1 ) * sizeof( stretchPic_t ) );
+	if ( !cmd ) {
+		return NULL;
+	}
+	cmd->commandId = RC_STRETCH_PICS;
+	cmd->numPics = numPics;
+	return cmd->pics;
+}
+
 /*
 =============
 RE_RotatePic
@@ -422,8 +781,16 @@ void RE_BeginFrame( stereoFrame_t stereoFrame ) {
     if ( !r_ignoreGLErrors->integer ) {
         int	err;
 
-		R_IssuePendingRenderCommands();
-        if ( ( err = qglGetError() ) != GL_NO_ERROR ) {
+		if ( tr.smpActive ) {
+			// don't stall the render thread for this, it checks after every batch
+			std::lock_guard<std::mutex> lock( smp.mutex );
+			err = smp.glError;
+			smp.glError = GL_NO_ERROR;
+		} else {
+			R_IssuePendingRenderCommands();
+			err = qglGetError();
+		}
+        if ( err != GL_NO_ERROR ) {
             Com_Error( ERR_FATAL, "RE_BeginFrame() - glGetError() failed (0x%x)!\n", err );
         }
     }
@@ -486,10 +853,17 @@ void RE_EndFrame( int *frontEndMsec, int *backEndMsec ) {
 		*frontEndMsec = tr.frontEndMsec;
 	}
 	tr.frontEndMsec = 0;
-	if ( backEndMsec ) {
-		*backEndMsec = backEnd.pc.msec;
+	if ( tr.smpActive ) {
+		// the frame just issued is still drawing, report the one before it
+		if ( backEndMsec ) {
+			*backEndMsec = smp.lastBackEndMsec;
+		}
+	} else {
+		if ( backEndMsec ) {
+			*backEndMsec = backEnd.pc.msec;
+		}
+		backEnd.pc.msec = 0;
 	}
-	backEnd.pc.msec = 0;
 
 	for(int i=0;i<MAX_LIGHT_STYLES;i++)
 	{
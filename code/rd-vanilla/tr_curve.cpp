@@ -27,6 +27,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_common.h"
 #include "tr_local.h"
 
+#include <algorithm>
+
 /*
 
 This file does all of the processing necessary to turn a raw grid of points
@@ -40,6 +42,9 @@ Only a single entry point:
 srfGridMesh_t *R_SubdividePatchToGrid( int width, int height,
 								drawVert_t points[MAX_PATCH_SIZE*MAX_PATCH_SIZE] ) {
 
+R_GridLodTables turns one of the grid's levels of detail back into
+the rows and columns that are drawn.
+
 */
 
 
@@ -293,6 +298,78 @@ static void PutPointsOnCurve( drawVert_t	ctrl[MAX_GRID_SIZE][MAX_GRID_SIZE],
 	}
 }
 
+/*
+=================
+R_GridLodErrors
+
+Every distinct error of an inner row or column is a threshold where the
+grid changes level of detail, level n draws the rows and columns with an
+error no bigger than the nth threshold
+=================
+*/
+static void R_GridLodErrors( srfGridMesh_t *grid ) {
+	float	errors[MAX_GRID_SIZE * 2];
+	int		numErrors;
+	int		i;
+
+	numErrors = 0;
+	for ( i = 1 ; i < grid->width-1 ; i++ ) {
+		errors[numErrors++] = grid->widthLodError[i];
+	}
+	for ( i = 1 ; i < grid->height-1 ; i++ ) {
+		errors[numErrors++] = grid->heightLodError[i];
+	}
+	std::sort( errors, errors + numErrors );
+	numErrors = std::unique( errors, errors + numErrors ) - errors;
+
+	grid->numLods = numErrors + 1;
+	grid->lodErrors = NULL;
+	if ( numErrors ) {
+		grid->lodErrors = (float *) R_Hunk_Alloc( numErrors * sizeof( float ), qfalse );
+		memcpy( grid->lodErrors, errors, numErrors * sizeof( float ) );
+	}
+	grid->lod = 0;
+	grid->lodRanges = NULL;
+}
+
+/*
+=================
+R_GridLodTables
+
+Picks the rows and columns of the subdivision that are
+drawn at a level of detail
+=================
+*/
+void R_GridLodTables( const srfGridMesh_t *cv, int lod, int *widthTable, int *lodWidth, int *heightTable, int *lodHeight ) {
+	int		i;
+	float	lodError;
+
+	// the errors are never negative, so the lowest level only keeps the edges
+	lodError = lod ? cv->lodErrors[lod - 1] : -1;
+
+	widthTable[0] = 0;
+	*lodWidth = 1;
+	for ( i = 1 ; i < cv->width-1 ; i++ ) {
+		if ( cv->widthLodError[i] <= lodError ) {
+			widthTable[*lodWidth] = i;
+			(*lodWidth)++;
+		}
+	}
+	widthTable[*lodWidth] = cv->width-1;
+	(*lodWidth)++;
+
+	heightTable[0] = 0;
+	*lodHeight = 1;
+	for ( i = 1 ; i < cv->height-1 ; i++ ) {
+		if ( cv->heightLodError[i] <= lodError ) {
+			heightTable[*lodHeight] = i;
+			(*lodHeight)++;
+		}
+	}
+	heightTable[*lodHeight] = cv->height-1;
+	(*lodHeight)++;
+}
+
 /*
 =================
 R_SubdividePatchToGrid
@@ -463,6 +540,7 @@ srfGridMesh_t *R_SubdividePatchToGrid( int width, int height,
 	grid->width = width;
 	grid->height = height;
 	grid->surfaceType = SF_GRID;
+	R_GridLodErrors( grid );
 	ClearBounds( grid->meshBounds[0], grid->meshBounds[1] );
 	for ( i = 0 ; i < width ; i++ ) {
 		for ( j = 0 ; j < height ; j++ ) {
@@ -142,6 +142,7 @@ void RE_StretchRaw (int x, int y, int w, int h, int cols, int rows, const byte *
 
 void RE_UploadCinematic (int cols, int rows, const byte *data, int client, qboolean dirty) {
 
+	R_IssuePendingRenderCommands();
 	GL_Bind( tr.scratchImage[client] );
 
 	// if the scratchImage isn't in the format we want, specify it as a new texture
@@ -475,6 +476,7 @@ qboolean RE_ProcessDissolve(void)
 {
 	if (Dissolve.iStartTime)
 	{
+		R_IssuePendingRenderCommands();
 		if (Dissolve.bTouchNeeded)
 		{
 			// Stuff to avoid music stutter...
@@ -32,6 +32,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_common.h"
 
 #include "qcommon/matcomp.h"
+#include "qcommon/q_parallel.h"
+#include "qcommon/q_skinning.h"
 #if !defined(_QCOMMON_H_)
 	#include "../qcommon/qcommon.h"
 #endif
@@ -47,6 +49,13 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define	LS(x) x=LittleShort(x)
 #define	LF(x) x=LittleFloat(x)
 
+// surfaces with fewer vertices than this aren't worth handing to the worker threads
+#define GHOUL2_SKINNING_BATCH	1024
+
+static_assert( sizeof( Q::SkinVertex ) == sizeof( mdxmVertex_t ), "Q::SkinVertex must match mdxmVertex_t" );
+static_assert( offsetof( Q::SkinVertex, weightsAndBoneIndices ) == offsetof( mdxmVertex_t, uiNmWeightsAndBoneIndexes ), "Q::SkinVertex must match mdxmVertex_t" );
+static_assert( sizeof( Q::SkinBone ) == sizeof( mdxaBone_t ), "Q::SkinBone must match mdxaBone_t" );
+
 #ifdef G2_PERFORMANCE_ANALYSIS
 #include "../qcommon/timing.h"
 timing_c G2PerformanceTimer_RB_SurfaceGhoul;
@@ -79,6 +88,7 @@ extern	cvar_t	*r_Ghoul2AnimSmooth;
 extern	cvar_t	*r_Ghoul2NoLerp;
 extern	cvar_t	*r_Ghoul2NoBlend;
 extern	cvar_t	*r_Ghoul2UnSqashAfterSmooth;
+extern	cvar_t	*r_Ghoul2PoseCache;
 
 bool HackadelicOnClient=false; // means this is a render traversal
 
@@ -711,18 +721,80 @@ public:
 };
 
 #define MAX_RENDER_SURFACES (2048)
-static CRenderableSurface RSStorage[MAX_RENDER_SURFACES];
-static unsigned int NextRS=0;
+// one set per frame in flight, so the render thread never sees surfaces the front end is reusing
+static CRenderableSurface RSStorage[SMP_FRAMES][MAX_RENDER_SURFACES];
+static unsigned int NextRS[SMP_FRAMES];
 
 CRenderableSurface *AllocRS()
 {
-	CRenderableSurface *ret=&RSStorage[NextRS];
+	unsigned int &next=NextRS[tr.smpFrame];
+	CRenderableSurface *ret=&RSStorage[tr.smpFrame][next];
 	ret->Init();
-	NextRS++;
-	NextRS%=MAX_RENDER_SURFACES;
+	next++;
+	next%=MAX_RENDER_SURFACES;
 	return ret;
 }
 
+// the bone cache is evaluated lazily and changes as soon as the game animates again,
+// so with r_smp the front end copies each surface's bones while the frame is built;
+// the buffers only exist while the render thread does
+#define MAX_RENDER_BONES (MAX_RENDER_SURFACES*iMAX_G2_BONEREFS_PER_SURFACE)
+static mdxaBone_t *RSBones[SMP_FRAMES];
+static unsigned int NextRSBone[SMP_FRAMES];
+
+void R_AllocRenderBones( void )
+{
+	for ( int i = 0; i < SMP_FRAMES; i++ )
+	{
+		if ( !RSBones[i] )
+		{
+			RSBones[i] = (mdxaBone_t *)R_Malloc( sizeof( mdxaBone_t ) * MAX_RENDER_BONES, TAG_GHOUL2, qfalse );
+		}
+		NextRSBone[i] = 0;
+	}
+}
+
+void R_FreeRenderBones( void )
+{
+	for ( int i = 0; i < SMP_FRAMES; i++ )
+	{
+		if ( RSBones[i] )
+		{
+			R_Free( RSBones[i] );
+			RSBones[i] = NULL;
+		}
+	}
+}
+
+static void RS_SnapshotBones( CRenderableSurface *surf )
+{
+	if ( !tr.smpActive )
+	{
+		return;
+	}
+
+	const mdxmSurface_t *surface = surf->surfaceData;
+	const int numBones = Q_min( surface->numBoneReferences, iMAX_G2_BONEREFS_PER_SURFACE );
+	unsigned int &next = NextRSBone[tr.smpFrame];
+	if ( next + numBones > MAX_RENDER_BONES )
+	{
+		next = 0;
+	}
+	mdxaBone_t *bones = &RSBones[tr.smpFrame][next];
+	next += numBones;
+
+	const int *piBoneReferences = (const int *)((const byte *)surface + surface->ofsBoneReferences);
+	for ( int k = 0; k < numBones; k++ )
+	{
+#ifdef JK2_MODE
+		bones[k] = surf->boneCache->Eval( piBoneReferences[k] );
+#else
+		bones[k] = surf->boneCache->EvalRender( piBoneReferences[k] );
+#endif // JK2_MODE
+	}
+	surf->bones = bones;
+}
+
 /*
 
 All bones should be an identity orientation to display the mesh exactly
@@ -943,10 +1015,170 @@ static int G2_GetBonePoolIndex(	const mdxaHeader_t *pMDXAHeader, int iFrame, int
 }
 
 
+// Decompressed bone poses, shared by every model playing the same animation file.
+// The compressed bone pool already merges identical poses, so entries are keyed
+// by pool index instead of frame and bone, which lets repeated poses share an entry.
+// Only used from the renderer thread.
+#define G2_POSE_CACHE_SIZE	16384	// entries, ~1MB
+#define G2_POSE_CACHE_HASH	(G2_POSE_CACHE_SIZE*2)
+
+typedef struct
+{
+	mdxaBone_t			bone;
+	const mdxaHeader_t	*header;
+	int					poolIndex;
+	int					hashNext;
+	int					lruPrev;	// towards the most recently used
+	int					lruNext;
+} g2PoseCacheEntry_t;
+
+static struct
+{
+	qboolean			initialized;
+	g2PoseCacheEntry_t	entries[G2_POSE_CACHE_SIZE];
+	int					hash[G2_POSE_CACHE_HASH];
+	int					numEntries;
+	int					lruHead;	// most recently used
+	int					lruTail;	// least recently used, the next to be evicted
+	unsigned int		hits;
+	unsigned int		misses;
+	unsigned int		evictions;
+} g2PoseCache;
+
+static inline int G2_PoseCacheHash( const mdxaHeader_t *pMDXAHeader, int iPoolIndex )
+{
+	const unsigned int h = (unsigned int)((size_t)pMDXAHeader >> 4) * 2654435761u ^ (unsigned int)iPoolIndex * 40503u;
+	return (h ^ (h >> 16)) & (G2_POSE_CACHE_HASH - 1);
+}
+
+static void G2_PoseCacheUnlink( int entry )
+{
+	g2PoseCacheEntry_t &e = g2PoseCache.entries[entry];
+	if (e.lruPrev != -1)
+	{
+		g2PoseCache.entries[e.lruPrev].lruNext = e.lruNext;
+	}
+	else
+	{
+		g2PoseCache.lruHead = e.lruNext;
+	}
+	if (e.lruNext != -1)
+	{
+		g2PoseCache.entries[e.lruNext].lruPrev = e.lruPrev;
+	}
+	else
+	{
+		g2PoseCache.lruTail = e.lruPrev;
+	}
+}
+
+static void G2_PoseCachePushFront( int entry )
+{
+	g2PoseCacheEntry_t &e = g2PoseCache.entries[entry];
+	e.lruPrev = -1;
+	e.lruNext = g2PoseCache.lruHead;
+	if (g2PoseCache.lruHead != -1)
+	{
+		g2PoseCache.entries[g2PoseCache.lruHead].lruPrev = entry;
+	}
+	g2PoseCache.lruHead = entry;
+	if (g2PoseCache.lruTail == -1)
+	{
+		g2PoseCache.lruTail = entry;
+	}
+}
+
+// has to be called whenever animation files are freed, since entries point at their headers
+void G2_PoseCache_Clear( void )
+{
+	for (int i = 0; i < G2_POSE_CACHE_HASH; i++)
+	{
+		g2PoseCache.hash[i] = -1;
+	}
+	g2PoseCache.numEntries = 0;
+	g2PoseCache.lruHead = -1;
+	g2PoseCache.lruTail = -1;
+	g2PoseCache.initialized = qtrue;
+}
+
+void G2_PoseCache_Info_f( void )
+{
+	const unsigned int lookups = g2PoseCache.hits + g2PoseCache.misses;
+	ri.Printf( PRINT_ALL, "Ghoul2 pose cache: %d/%d entries (%d bytes)\n", g2PoseCache.numEntries, G2_POSE_CACHE_SIZE, (int)sizeof(g2PoseCache) );
+	ri.Printf( PRINT_ALL, "%u hits, %u misses (%.1f%% hit rate), %u evictions\n",
+		g2PoseCache.hits, g2PoseCache.misses, lookups ? 100.0f * g2PoseCache.hits / lookups : 0.0f, g2PoseCache.evictions );
+	if (ri.Cmd_Argc() > 1 && !Q_stricmp(ri.Cmd_Argv(1), "reset"))
+	{
+		g2PoseCache.hits = g2PoseCache.misses = g2PoseCache.evictions = 0;
+	}
+}
+
+static const mdxaBone_t &G2_CachedPose( const mdxaHeader_t *pMDXAHeader, const mdxaCompQuatBone_t *pCompBonePool, int iPoolIndex )
+{
+	if (!g2PoseCache.initialized)
+	{
+		G2_PoseCache_Clear();
+	}
+
+	int &bucket = g2PoseCache.hash[G2_PoseCacheHash(pMDXAHeader, iPoolIndex)];
+	for (int entry = bucket; entry != -1; entry = g2PoseCache.entries[entry].hashNext)
+	{
+		g2PoseCacheEntry_t &e = g2PoseCache.entries[entry];
+		if (e.poolIndex == iPoolIndex && e.header == pMDXAHeader)
+		{
+			g2PoseCache.hits++;
+			if (g2PoseCache.lruHead != entry)
+			{
+				G2_PoseCacheUnlink(entry);
+				G2_PoseCachePushFront(entry);
+			}
+			return e.bone;
+		}
+	}
+
+	g2PoseCache.misses++;
+	int entry;
+	if (g2PoseCache.numEntries < G2_POSE_CACHE_SIZE)
+	{
+		entry = g2PoseCache.numEntries++;
+	}
+	else
+	{
+		// evict the least recently used pose and take it out of its hash chain
+		entry = g2PoseCache.lruTail;
+		g2PoseCacheEntry_t &old = g2PoseCache.entries[entry];
+		int *link = &g2PoseCache.hash[G2_PoseCacheHash(old.header, old.poolIndex)];
+		while (*link != entry)
+		{
+			link = &g2PoseCache.entries[*link].hashNext;
+		}
+		*link = old.hashNext;
+		G2_PoseCacheUnlink(entry);
+		g2PoseCache.evictions++;
+	}
+
+	g2PoseCacheEntry_t &e = g2PoseCache.entries[entry];
+	MC_UnCompressQuat(e.bone.matrix, pCompBonePool[iPoolIndex].Comp);
+	e.header = pMDXAHeader;
+	e.poolIndex = iPoolIndex;
+	e.hashNext = bucket;
+	bucket = entry;
+	G2_PoseCachePushFront(entry);
+	return e.bone;
+}
+
 /*static inline*/ void UnCompressBone(float mat[3][4], int iBoneIndex, const mdxaHeader_t *pMDXAHeader, int iFrame)
 {
 	mdxaCompQuatBone_t *pCompBonePool = (mdxaCompQuatBone_t *) ((byte *)pMDXAHeader + pMDXAHeader->ofsCompBonePool);
-	MC_UnCompressQuat(mat, pCompBonePool[ G2_GetBonePoolIndex( pMDXAHeader, iFrame, iBoneIndex ) ].Comp);
+	const int iPoolIndex = G2_GetBonePoolIndex( pMDXAHeader, iFrame, iBoneIndex );
+	if (r_Ghoul2PoseCache->integer)
+	{
+		memcpy(mat, G2_CachedPose(pMDXAHeader, pCompBonePool, iPoolIndex).matrix, sizeof(mdxaBone_t));
+	}
+	else
+	{
+		MC_UnCompressQuat(mat, pCompBonePool[ iPoolIndex ].Comp);
+	}
 }
 
 
@@ -2310,16 +2542,20 @@ void RenderSurfaces(CRenderSurface &RS)
 			&& shader->sort == SS_OPAQUE )
 		{		// set the surface info to point at the where the transformed bone list is going to be for when the surface gets rendered out
 			CRenderableSurface *newSurf = AllocRS();
+			int shadowLod = RS.lod;
 			if (surface->numVerts >= SHADER_MAX_VERTEXES/2)
 			{ //we need numVerts*2 xyz slots free in tess to do shadow, if this surf is going to exceed that then let's try the lowest lod -rww
-				mdxmSurface_t *lowsurface = (mdxmSurface_t *)G2_FindSurface(RS.currentModel, RS.surfaceNum, RS.currentModel->numLods-1);
+				shadowLod = RS.currentModel->numLods-1;
+				mdxmSurface_t *lowsurface = (mdxmSurface_t *)G2_FindSurface(RS.currentModel, RS.surfaceNum, shadowLod);
 				newSurf->surfaceData = lowsurface;
 			}
 			else
 			{
 				newSurf->surfaceData = surface;
 			}
+			newSurf->shadowEdges = RS.currentModel->mdxmShadowEdges[shadowLod * RS.currentModel->mdxm->numSurfaces + RS.surfaceNum];
 			newSurf->boneCache = RS.boneCache;
+			RS_SnapshotBones( newSurf );
 			R_AddDrawSurf( (surfaceType_t *)newSurf, tr.shadowShader, 0, qfalse );
 		}
 
@@ -2333,6 +2569,7 @@ void RenderSurfaces(CRenderSurface &RS)
 			CRenderableSurface *newSurf = AllocRS();
 			newSurf->surfaceData = surface;
 			newSurf->boneCache = RS.boneCache;
+			RS_SnapshotBones( newSurf );
 			R_AddDrawSurf( (surfaceType_t *)newSurf, tr.projectionShadowShader, 0, qfalse );
 		}
 
@@ -2342,6 +2579,7 @@ void RenderSurfaces(CRenderSurface &RS)
 			CRenderableSurface *newSurf = AllocRS();
 			newSurf->surfaceData = surface;
 			newSurf->boneCache = RS.boneCache;
+			RS_SnapshotBones( newSurf );
 			R_AddDrawSurf( (surfaceType_t *)newSurf, shader, RS.fogNum, qfalse );
 
 #ifdef _G2_GORE
@@ -2362,6 +2600,7 @@ void RenderSurfaces(CRenderSurface &RS)
 					{
 						if (tex)
 						{
+							R_SyncRenderThread(); // the render thread may still be drawing with these
 							(*tex).~GoreTextureCoordinates();
 							//I don't know what's going on here, it should call the destructor for
 							//this when it erases the record but sometimes it doesn't. -rww
@@ -2936,6 +3175,11 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 	tess.numIndexes += indexes*3;
 #endif
 
+	if ( tess.shader == tr.shadowShader )
+	{
+		RB_AddShadowEdges( surf->shadowEdges, surface->numTriangles );
+	}
+
 	numVerts = surface->numVerts;
 
 	piBoneReferences = (int*) ((byte*)surface + surface->ofsBoneReferences);
@@ -2989,98 +3233,35 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 	else
 	{
 #endif
-		float fTotalWeight;
-		float fBoneWeight;
-		float t1;
-		float t2;
-		const mdxaBone_t *bone;
-		const mdxaBone_t *bone2;
-		for ( j = 0; j < numVerts; j++, baseVertex++,v++ )
+		// evaluate the bones up front, the lazy evaluation in the bone cache isn't safe to run on the workers
+		Q::SkinBone palette[iMAX_G2_BONEREFS_PER_SURFACE];
+		assert( surface->numBoneReferences <= (int)ARRAY_LEN( palette ) );
+		const int numPaletteBones = Q_min( surface->numBoneReferences, (int)ARRAY_LEN( palette ) );
+		for ( k = 0; k < numPaletteBones; k++ )
 		{
-#ifdef JK2_MODE
-			bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex( v, 0 )]);
-#else
-			bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, 0 )]);
-#endif // JK2_MODE
-			int iNumWeights = G2_GetVertWeights( v );
-			tess.normal[baseVertex][0] = DotProduct( bone->matrix[0], v->normal );
-			tess.normal[baseVertex][1] = DotProduct( bone->matrix[1], v->normal );
-			tess.normal[baseVertex][2] = DotProduct( bone->matrix[2], v->normal );
-
-			if (iNumWeights==1)
+			if ( surf->bones )
 			{
-				tess.xyz[baseVertex][0] = ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-				tess.xyz[baseVertex][1] = ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-				tess.xyz[baseVertex][2] = ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
+				memcpy( palette[k].matrix, surf->bones[k].matrix, sizeof( palette[k].matrix ) );
+				continue;
 			}
-			else
-			{
-				fBoneWeight = G2_GetVertBoneWeightNotSlow( v, 0);
-				if (iNumWeights==2)
-				{
 #ifdef JK2_MODE
-					bone2 = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex( v, 1 )]);
+			memcpy( palette[k].matrix, bones->Eval( piBoneReferences[k] ).matrix, sizeof( palette[k].matrix ) );
 #else
-					bone2 = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, 1 )]);
+			memcpy( palette[k].matrix, bones->EvalRender( piBoneReferences[k] ).matrix, sizeof( palette[k].matrix ) );
 #endif // JK2_MODE
-					/*
-					useless transposition
-					tess.xyz[baseVertex][0] =
-					v[0]*(w*(bone->matrix[0][0]-bone2->matrix[0][0])+bone2->matrix[0][0])+
-					v[1]*(w*(bone->matrix[0][1]-bone2->matrix[0][1])+bone2->matrix[0][1])+
-					v[2]*(w*(bone->matrix[0][2]-bone2->matrix[0][2])+bone2->matrix[0][2])+
-					w*(bone->matrix[0][3]-bone2->matrix[0][3]) + bone2->matrix[0][3];
-					*/
-					t1 = ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					t2 = ( DotProduct( bone2->matrix[0], v->vertCoords ) + bone2->matrix[0][3] );
-					tess.xyz[baseVertex][0] = fBoneWeight * (t1-t2) + t2;
-					t1 = ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					t2 = ( DotProduct( bone2->matrix[1], v->vertCoords ) + bone2->matrix[1][3] );
-					tess.xyz[baseVertex][1] = fBoneWeight * (t1-t2) + t2;
-					t1 = ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-					t2 = ( DotProduct( bone2->matrix[2], v->vertCoords ) + bone2->matrix[2][3] );
-					tess.xyz[baseVertex][2] = fBoneWeight * (t1-t2) + t2;
-				}
-				else
-				{
-
-					tess.xyz[baseVertex][0] = fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					tess.xyz[baseVertex][1] = fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					tess.xyz[baseVertex][2] = fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-
-					fTotalWeight=fBoneWeight;
-					for (k=1; k < iNumWeights-1 ; k++)
-					{
-#ifdef JK2_MODE
-						bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-#else
-						bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-#endif // JK2_MODE
-
-						fBoneWeight = G2_GetVertBoneWeightNotSlow( v, k);
-						fTotalWeight += fBoneWeight;
-
-						tess.xyz[baseVertex][0] += fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-						tess.xyz[baseVertex][1] += fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-						tess.xyz[baseVertex][2] += fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-					}
-
-#ifdef JK2_MODE
-					bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-#else
-					bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex( v, k )]);
-#endif // JK2_MODE
-					fBoneWeight	= 1.0f-fTotalWeight;
+		}
 
-					tess.xyz[baseVertex][0] += fBoneWeight * ( DotProduct( bone->matrix[0], v->vertCoords ) + bone->matrix[0][3] );
-					tess.xyz[baseVertex][1] += fBoneWeight * ( DotProduct( bone->matrix[1], v->vertCoords ) + bone->matrix[1][3] );
-					tess.xyz[baseVertex][2] += fBoneWeight * ( DotProduct( bone->matrix[2], v->vertCoords ) + bone->matrix[2][3] );
-				}
+		const Q::SkinVertex *skinVerts = reinterpret_cast<const Q::SkinVertex *>( v );
+		const int firstVertex = baseVertex;
+		Q::parallelFor( numVerts, GHOUL2_SKINNING_BATCH, [&]( std::size_t begin, std::size_t end )
+		{
+			Q::skinVertices( skinVerts + begin, end - begin, palette, &tess.xyz[firstVertex + begin], &tess.normal[firstVertex + begin] );
+			for ( std::size_t i = begin; i < end; i++ )
+			{
+				tess.texCoords[firstVertex + i][0][0] = pTexCoords[i].texCoords[0];
+				tess.texCoords[firstVertex + i][0][1] = pTexCoords[i].texCoords[1];
 			}
-
-			tess.texCoords[baseVertex][0][0] = pTexCoords[j].texCoords[0];
-			tess.texCoords[baseVertex][0][1] = pTexCoords[j].texCoords[1];
-		}
+		} );
 #if 0
 	}
 #endif
@@ -3140,6 +3321,37 @@ void RB_SurfaceGhoul( CRenderableSurface *surf )
 #endif
 }
 
+/*
+=================
+R_LoadMDXMShadowEdges
+
+The stencil shadow edges of every surface, worked out once here instead of
+every frame. The model binary stays cached between levels, these go on the
+level's hunk along with the model_t.
+=================
+*/
+static void R_LoadMDXMShadowEdges( model_t *mod ) {
+	mdxmHeader_t	*mdxm = mod->mdxm;
+	mdxmLOD_t		*lod;
+	mdxmSurface_t	*surf;
+	int				l, i;
+
+	mod->mdxmShadowEdges = (byte **)R_Hunk_Alloc( mdxm->numLODs * mdxm->numSurfaces * sizeof( byte * ), qtrue );
+
+	lod = (mdxmLOD_t *) ( (byte *)mdxm + mdxm->ofsLODs );
+	for ( l = 0 ; l < mdxm->numLODs ; l++ )
+	{
+		surf = (mdxmSurface_t *) ( (byte *)lod + sizeof (mdxmLOD_t) + (mdxm->numSurfaces * sizeof(mdxmLODSurfOffset_t)) );
+		for ( i = 0 ; i < mdxm->numSurfaces ; i++ )
+		{
+			mod->mdxmShadowEdges[l * mdxm->numSurfaces + surf->thisSurfaceIndex] =
+				R_BuildShadowEdges( (int *)( (byte *)surf + surf->ofsTriangles ), surf->numTriangles, surf->numVerts );
+			surf = (mdxmSurface_t *)( (byte *)surf + surf->ofsEnd );
+		}
+		lod = (mdxmLOD_t *)( (byte *)lod + lod->ofsEnd );
+	}
+}
+
 /*
 =================
 R_LoadMDXM - load a Ghoul 2 Mesh file
@@ -3644,6 +3856,7 @@ qboolean R_LoadMDXM( model_t *mod, void *buffer, const char *mod_name, qboolean
 
 	if (bAlreadyFound)
 	{
+		R_LoadMDXMShadowEdges( mod );
 		return qtrue;	// All done. Stop, go no further, do not LittleLong(), do not pass Go...
 	}
 
@@ -3812,6 +4025,8 @@ qboolean R_LoadMDXM( model_t *mod, void *buffer, const char *mod_name, qboolean
 		lod = (mdxmLOD_t *)( (byte *)lod + lod->ofsEnd );
 	}
 
+	R_LoadMDXMShadowEdges( mod );
+
 	return qtrue;
 }
 
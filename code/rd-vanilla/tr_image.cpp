@@ -30,6 +30,14 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../rd-common/tr_common.h"
 #include <png.h>
 #include <map>
+#include <vector>
+
+#include "qcommon/q_parallel.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define R_MIPMAP_SSE2
+#include <emmintrin.h>
+#endif
 
 static byte			 s_intensitytable[256];
 static unsigned char s_gammatable[256];
@@ -400,85 +408,113 @@ static void R_LightScaleTexture (unsigned *in, int inwidth, int inheight, qboole
 }
 
 
+// identifies an image in the image cache, see R_ImageCache_Key
+typedef struct {
+	unsigned int	key;			// 0 if the image isn't cached
+	char			filename[MAX_QPATH];
+	int				pakChecksum;
+	unsigned int	settings;
+} imageCacheKey_t;
+
+// an image ready for qglTexImage2D: the first level after picmip and clamping, followed by all of its mip levels
+typedef struct {
+	std::vector<byte>	data;
+	int					width, height;
+	int					numLevels;
+	int					samples;	// 4 if the alpha channel is used
+} mipChain_t;
+
 /*
 ================
 R_MipMap2
 
-Uses temp mem, but then copies back to input, quartering the size of the texture
-Proper linear filter
+Proper linear filter, quartering the size of the texture into out.
+The 4x4 kernel is separable, so every output row first sums its four
+source rows into rowTemp, which has a pixel of wrap-around padding on
+either side and room for inWidth + 2 pixels
 ================
 */
-static void R_MipMap2( unsigned *in, int inWidth, int inHeight ) {
-	int			i, j, k;
-	byte		*outpix;
-	int			inWidthMask, inHeightMask;
-	int			total;
+static void R_MipMap2( const unsigned *in, int inWidth, int inHeight, unsigned *out, unsigned short *rowTemp ) {
+	int			i, j, k, x;
+	int			inHeightMask;
 	int			outWidth, outHeight;
-	unsigned	*temp;
+	int			rowSize;
+	unsigned short	*column;
 
 	outWidth = inWidth >> 1;
 	outHeight = inHeight >> 1;
-	temp = (unsigned int *) R_Malloc( outWidth * outHeight * 4, TAG_TEMP_WORKSPACE, qfalse );
+	rowSize = inWidth * 4;
+	column = rowTemp + 4;
 
-	inWidthMask = inWidth - 1;
 	inHeightMask = inHeight - 1;
 
 	for ( i = 0 ; i < outHeight ; i++ ) {
-		for ( j = 0 ; j < outWidth ; j++ ) {
-			outpix = (byte *) ( temp + i * outWidth + j );
+		const byte *r0 = (const byte *)&in[ ((i*2-1)&inHeightMask)*inWidth ];
+		const byte *r1 = (const byte *)&in[ ((i*2)&inHeightMask)*inWidth ];
+		const byte *r2 = (const byte *)&in[ ((i*2+1)&inHeightMask)*inWidth ];
+		const byte *r3 = (const byte *)&in[ ((i*2+2)&inHeightMask)*inWidth ];
+		byte *outpix = (byte *)&out[ i*outWidth ];
+
+		// vertical 1 2 2 1
+		x = 0;
+#ifdef R_MIPMAP_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; x + 8 <= rowSize ; x += 8 ) {
+			__m128i a = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)( r0 + x ) ), zero );
+			__m128i b = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)( r1 + x ) ), zero );
+			__m128i c = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)( r2 + x ) ), zero );
+			__m128i d = _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)( r3 + x ) ), zero );
+			__m128i sum = _mm_add_epi16( _mm_add_epi16( a, d ), _mm_slli_epi16( _mm_add_epi16( b, c ), 1 ) );
+			_mm_storeu_si128( (__m128i *)( column + x ), sum );
+		}
+#endif
+		for ( ; x < rowSize ; x++ ) {
+			column[x] = r0[x] + 2*r1[x] + 2*r2[x] + r3[x];
+		}
+		for ( k = 0 ; k < 4 ; k++ ) {
+			rowTemp[k] = column[rowSize - 4 + k];
+			column[rowSize + k] = column[k];
+		}
+
+		// horizontal 1 2 2 1, rowTemp[j*8] is the first of the four source pixels for output pixel j
+		j = 0;
+#ifdef R_MIPMAP_SSE2
+		// total / 36 == ( total * 7282 ) >> 18 for every total up to 36 * 255
+		const __m128i divide = _mm_set1_epi16( 7282 );
+		for ( ; j + 2 <= outWidth ; j += 2 ) {
+			__m128i totals[2];
+			for ( k = 0 ; k < 2 ; k++ ) {
+				const unsigned short *p = rowTemp + ( j + k ) * 8;
+				__m128i outer = _mm_loadu_si128( (const __m128i *)p );
+				__m128i inner = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *)( p + 8 ) ), _MM_SHUFFLE( 1, 0, 3, 2 ) );
+				__m128i sum = _mm_add_epi16( outer, inner );
+				totals[k] = _mm_add_epi16( sum, _mm_slli_epi16( _mm_srli_si128( sum, 8 ), 1 ) );
+			}
+			__m128i result = _mm_srli_epi16( _mm_mulhi_epu16( _mm_unpacklo_epi64( totals[0], totals[1] ), divide ), 2 );
+			_mm_storel_epi64( (__m128i *)( outpix + j*4 ), _mm_packus_epi16( result, result ) );
+		}
+#endif
+		for ( ; j < outWidth ; j++ ) {
+			const unsigned short *p = rowTemp + j * 8;
 			for ( k = 0 ; k < 4 ; k++ ) {
-				total =
-					1 * ((byte *)&in[ ((i*2-1)&inHeightMask)*inWidth + ((j*2-1)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2-1)&inHeightMask)*inWidth + ((j*2)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2-1)&inHeightMask)*inWidth + ((j*2+1)&inWidthMask) ])[k] +
-					1 * ((byte *)&in[ ((i*2-1)&inHeightMask)*inWidth + ((j*2+2)&inWidthMask) ])[k] +
-
-					2 * ((byte *)&in[ ((i*2)&inHeightMask)*inWidth + ((j*2-1)&inWidthMask) ])[k] +
-					4 * ((byte *)&in[ ((i*2)&inHeightMask)*inWidth + ((j*2)&inWidthMask) ])[k] +
-					4 * ((byte *)&in[ ((i*2)&inHeightMask)*inWidth + ((j*2+1)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2)&inHeightMask)*inWidth + ((j*2+2)&inWidthMask) ])[k] +
-
-					2 * ((byte *)&in[ ((i*2+1)&inHeightMask)*inWidth + ((j*2-1)&inWidthMask) ])[k] +
-					4 * ((byte *)&in[ ((i*2+1)&inHeightMask)*inWidth + ((j*2)&inWidthMask) ])[k] +
-					4 * ((byte *)&in[ ((i*2+1)&inHeightMask)*inWidth + ((j*2+1)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2+1)&inHeightMask)*inWidth + ((j*2+2)&inWidthMask) ])[k] +
-
-					1 * ((byte *)&in[ ((i*2+2)&inHeightMask)*inWidth + ((j*2-1)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2+2)&inHeightMask)*inWidth + ((j*2)&inWidthMask) ])[k] +
-					2 * ((byte *)&in[ ((i*2+2)&inHeightMask)*inWidth + ((j*2+1)&inWidthMask) ])[k] +
-					1 * ((byte *)&in[ ((i*2+2)&inHeightMask)*inWidth + ((j*2+2)&inWidthMask) ])[k];
-				outpix[k] = total / 36;
+				outpix[j*4+k] = ( p[k] + 2*p[4+k] + 2*p[8+k] + p[12+k] ) / 36;
 			}
 		}
 	}
-
-	memcpy( in, temp, outWidth * outHeight * 4 );
-	R_Free( temp );
 }
 
 /*
 ================
-R_MipMap
+R_MipMapSimple
 
-Operates in place, quartering the size of the texture
+Box filter, quartering the size of the texture into out
 ================
 */
-static void R_MipMap (byte *in, int width, int height) {
+static void R_MipMapSimple( const byte *in, int width, int height, byte *out ) {
 	int		i, j;
-	byte	*out;
 	int		row;
 
-	if ( width == 1 && height == 1 ) {
-		return;
-	}
-
-	if ( !r_simpleMipMaps->integer ) {
-		R_MipMap2( (unsigned *)in, width, height );
-		return;
-	}
-
 	row = width * 4;
-	out = in;
 	width >>= 1;
 	height >>= 1;
 
@@ -494,7 +530,21 @@ static void R_MipMap (byte *in, int width, int height) {
 	}
 
 	for (i=0 ; i<height ; i++, in+=row) {
-		for (j=0 ; j<width ; j++, out+=4, in+=8) {
+		j = 0;
+#ifdef R_MIPMAP_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; j + 2 <= width ; j += 2, out+=8, in+=16 ) {
+			__m128i top = _mm_loadu_si128( (const __m128i *)in );
+			__m128i bottom = _mm_loadu_si128( (const __m128i *)( in + row ) );
+			__m128i left = _mm_add_epi16( _mm_unpacklo_epi8( top, zero ), _mm_unpacklo_epi8( bottom, zero ) );
+			__m128i right = _mm_add_epi16( _mm_unpackhi_epi8( top, zero ), _mm_unpackhi_epi8( bottom, zero ) );
+			left = _mm_add_epi16( left, _mm_srli_si128( left, 8 ) );
+			right = _mm_add_epi16( right, _mm_srli_si128( right, 8 ) );
+			__m128i result = _mm_srli_epi16( _mm_unpacklo_epi64( left, right ), 2 );
+			_mm_storel_epi64( (__m128i *)out, _mm_packus_epi16( result, result ) );
+		}
+#endif
+		for ( ; j<width ; j++, out+=4, in+=8) {
 			out[0] = (in[0] + in[4] + in[row+0] + in[row+4])>>2;
 			out[1] = (in[1] + in[5] + in[row+1] + in[row+5])>>2;
 			out[2] = (in[2] + in[6] + in[row+2] + in[row+6])>>2;
@@ -503,6 +553,33 @@ static void R_MipMap (byte *in, int width, int height) {
 	}
 }
 
+/*
+================
+R_MipMap
+
+Quarters the size of the texture into out, which must hold the next
+level down, ie. at least one pixel
+================
+*/
+static void R_MipMap( const byte *in, int width, int height, byte *out, unsigned short *rowTemp ) {
+	if ( width == 1 && height == 1 ) {
+		memcpy( out, in, 4 );
+		return;
+	}
+
+	if ( !r_simpleMipMaps->integer ) {
+		if ( width == 1 || height == 1 ) {
+			// the linear filter can't do a single row or column and leaves it as it was
+			memmove( out, in, Q_max( width >> 1, 1 ) * Q_max( height >> 1, 1 ) * 4 );
+			return;
+		}
+		R_MipMap2( (const unsigned *)in, width, height, (unsigned *)out, rowTemp );
+		return;
+	}
+
+	R_MipMapSimple( in, width, height, out );
+}
+
 
 /*
 ==================
@@ -550,190 +627,221 @@ byte	mipBlendColors[16][4] = {
 
 /*
 ===============
-Upload32
+R_UploadSize
 
+The size of the first mip level R_BuildMipChain will create for an image
 ===============
 */
-static void Upload32( unsigned *data,
-						  GLenum format,
-						  qboolean mipmap,
-						  qboolean picmip,
-						  qboolean isLightmap,
-						  qboolean allowTC,
-						  int *pformat,
-						  word *pUploadWidth, word *pUploadHeight )
-{
-	if (format == GL_RGBA)
+static void R_UploadSize( int *width, int *height, qboolean picmip ) {
+	int i;
+
+	if ( picmip ) {
+		for ( i = 0; i < r_picmip->integer; i++ ) {
+			*width = Q_max( *width >> 1, 1 );
+			*height = Q_max( *height >> 1, 1 );
+		}
+	}
+
+	while ( *width > glConfig.maxTextureSize || *height > glConfig.maxTextureSize ) {
+		*width >>= 1;
+		*height >>= 1;
+	}
+}
+
+/*
+===============
+R_MipChainSize
+
+The number of bytes and levels in a mip chain whose first level is width by height
+===============
+*/
+static size_t R_MipChainSize( int width, int height, qboolean mipmap, int *numLevels ) {
+	size_t size = 0;
+
+	*numLevels = 0;
+	while ( 1 ) {
+		size += (size_t)width * height * 4;
+		(*numLevels)++;
+		if ( !mipmap || ( width == 1 && height == 1 ) ) {
+			break;
+		}
+		width = Q_max( width >> 1, 1 );
+		height = Q_max( height >> 1, 1 );
+	}
+	return size;
+}
+
+/*
+===============
+R_BuildMipChain
+
+Does all of the CPU work of an upload without touching GL, so it may run
+on a worker thread: picmip and clamping, the alpha scan, light scaling
+and generating the mip levels. pic is left untouched
+===============
+*/
+static void R_BuildMipChain( const byte *pic, int width, int height, qboolean mipmap, qboolean picmip, mipChain_t *chain ) {
+	int		uploadWidth = width;
+	int		uploadHeight = height;
+	int		i, c;
+	byte	*scan;
+
+	R_UploadSize( &uploadWidth, &uploadHeight, picmip );
+
+	// room for every level, so each can be filtered straight out of the one before
+	chain->data.resize( R_MipChainSize( uploadWidth, uploadHeight, mipmap, &chain->numLevels ) );
+	chain->width = uploadWidth;
+	chain->height = uploadHeight;
+
+	std::vector<unsigned short> rowTemp( ( width + 2 ) * 4 );
+
+	//
+	// perform optional picmip operation, and clamp to the current upper
+	// OpenGL limit. scale both axis down equally so we don't have to
+	// deal with a half mip resampling
+	//
+	if ( width == uploadWidth && height == uploadHeight ) {
+		memcpy( chain->data.data(), pic, width * height * 4 );
+	}
+	else {
+		std::vector<byte> work[2];
+		const byte *in = pic;
+		int next = 0;
+		while ( width != uploadWidth || height != uploadHeight ) {
+			const int outWidth = Q_max( width >> 1, 1 );
+			const int outHeight = Q_max( height >> 1, 1 );
+			byte *out = chain->data.data();
+
+			if ( outWidth != uploadWidth || outHeight != uploadHeight ) {
+				work[next].resize( outWidth * outHeight * 4 );
+				out = work[next].data();
+			}
+			R_MipMap( in, width, height, out, rowTemp.data() );
+			in = out;
+			next ^= 1;
+			width = outWidth;
+			height = outHeight;
+		}
+	}
+
+	//
+	// scan the texture for each channel's max values
+	// and verify if the alpha channel is being used or not
+	//
+	c = width*height;
+	scan = chain->data.data();
+	chain->samples = 3;
+	for ( i = 0; i < c; i++ )
 	{
-	    int			samples;
-	    int			i, c;
-	    byte		*scan;
-	    float		rMax = 0, gMax = 0, bMax = 0;
-	    int			width = *pUploadWidth;
-	    int			height = *pUploadHeight;
-
-	    //
-	    // perform optional picmip operation
-	    //
-	    if ( picmip ) {
-		    for(i = 0; i < r_picmip->integer; i++) {
-			    R_MipMap( (byte *)data, width, height );
-			    width >>= 1;
-			    height >>= 1;
-			    if (width < 1) {
-				    width = 1;
-			    }
-			    if (height < 1) {
-				    height = 1;
-			    }
-		    }
-	    }
-
-	    //
-	    // clamp to the current upper OpenGL limit
-	    // scale both axis down equally so we don't have to
-	    // deal with a half mip resampling
-	    //
-	    while ( width > glConfig.maxTextureSize	|| height > glConfig.maxTextureSize ) {
-		    R_MipMap( (byte *)data, width, height );
-		    width >>= 1;
-		    height >>= 1;
-	    }
-
-	    //
-	    // scan the texture for each channel's max values
-	    // and verify if the alpha channel is being used or not
-	    //
-	    c = width*height;
-	    scan = ((byte *)data);
-	    samples = 3;
-	    for ( i = 0; i < c; i++ )
-	    {
-		    if ( scan[i*4+0] > rMax )
-		    {
-			    rMax = scan[i*4+0];
-		    }
-		    if ( scan[i*4+1] > gMax )
-		    {
-			    gMax = scan[i*4+1];
-		    }
-		    if ( scan[i*4+2] > bMax )
-		    {
-			    bMax = scan[i*4+2];
-		    }
-		    if ( scan[i*4 + 3] != 255 )
-		    {
-			    samples = 4;
-			    break;
-		    }
-	    }
-
-	    // select proper internal format
-	    if ( samples == 3 )
-	    {
-		    if ( glConfig.textureCompression == TC_S3TC && allowTC )
-		    {
-			    *pformat = GL_RGB4_S3TC;
-		    }
-		    else if ( glConfig.textureCompression == TC_S3TC_DXT && allowTC )
-		    {	// Compress purely color - no alpha
-			    if ( r_texturebits->integer == 16 ) {
-				    *pformat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	//this format cuts to 16 bit
-			    }
-			    else {//if we aren't using 16 bit then, use 32 bit compression
-				    *pformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-			    }
-		    }
-		    else if ( isLightmap && r_texturebitslm->integer > 0 )
-		    {
-			    // Allow different bit depth when we are a lightmap
-			    if ( r_texturebitslm->integer == 16 )
-			    {
-				    *pformat = GL_RGB5;
-			    }
-			    else if ( r_texturebitslm->integer == 32 )
-			    {
-				    *pformat = GL_RGB8;
-			    }
-		    }
-		    else if ( r_texturebits->integer == 16 )
-		    {
-			    *pformat = GL_RGB5;
-		    }
-		    else if ( r_texturebits->integer == 32 )
-		    {
-			    *pformat = GL_RGB8;
-		    }
-		    else
-		    {
-			    *pformat = 3;
-		    }
-	    }
-	    else if ( samples == 4 )
-	    {
-		    if ( glConfig.textureCompression == TC_S3TC_DXT && allowTC)
-		    {	// Compress both alpha and color
-			    *pformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-		    }
-		    else if ( r_texturebits->integer == 16 )
-		    {
-			    *pformat = GL_RGBA4;
-		    }
-		    else if ( r_texturebits->integer == 32 )
-		    {
-			    *pformat = GL_RGBA8;
-		    }
-		    else
-		    {
-			    *pformat = 4;
-		    }
-	    }
-
-		*pUploadWidth = width;
-		*pUploadHeight = height;
-
-	    // copy or resample data as appropriate for first MIP level
-	    if (!mipmap)
-	    {
-		    qglTexImage2D (GL_TEXTURE_2D, 0, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		    goto done;
-	    }
-
-		R_LightScaleTexture (data, width, height, (qboolean)!mipmap);
-
-	    qglTexImage2D (GL_TEXTURE_2D, 0, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data );
-
-	    if (mipmap)
-	    {
-		    int		miplevel;
-
-		    miplevel = 0;
-		    while (width > 1 || height > 1)
-		    {
-			    R_MipMap( (byte *)data, width, height );
-			    width >>= 1;
-			    height >>= 1;
-			    if (width < 1)
-				    width = 1;
-			    if (height < 1)
-				    height = 1;
-			    miplevel++;
-
-			    if ( r_colorMipLevels->integer )
-			    {
-				    R_BlendOverTexture( (byte *)data, width * height, mipBlendColors[miplevel] );
-			    }
-
-			    qglTexImage2D (GL_TEXTURE_2D, miplevel, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data );
-		    }
-	    }
+		if ( scan[i*4 + 3] != 255 )
+		{
+			chain->samples = 4;
+			break;
+		}
 	}
-	else
+
+	if ( !mipmap ) {
+		return;
+	}
+
+	R_LightScaleTexture( (unsigned *)scan, width, height, qfalse );
+
+	for ( i = 1; i < chain->numLevels; i++ ) {
+		byte *out = scan + width * height * 4;
+
+		R_MipMap( scan, width, height, out, rowTemp.data() );
+		width = Q_max( width >> 1, 1 );
+		height = Q_max( height >> 1, 1 );
+		scan = out;
+
+		if ( r_colorMipLevels->integer )
+		{
+			R_BlendOverTexture( scan, width * height, mipBlendColors[i] );
+		}
+	}
+}
+
+/*
+===============
+R_InternalFormat
+
+Picks the GL internal format for an image with the given number of samples
+===============
+*/
+static int R_InternalFormat( int samples, qboolean isLightmap, qboolean allowTC ) {
+	if ( samples == 3 )
 	{
+		if ( glConfig.textureCompression == TC_S3TC && allowTC )
+		{
+			return GL_RGB4_S3TC;
+		}
+		else if ( glConfig.textureCompression == TC_S3TC_DXT && allowTC )
+		{	// Compress purely color - no alpha
+			if ( r_texturebits->integer == 16 ) {
+				return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	//this format cuts to 16 bit
+			}
+			else {//if we aren't using 16 bit then, use 32 bit compression
+				return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			}
+		}
+		else if ( isLightmap && r_texturebitslm->integer > 0 )
+		{
+			// Allow different bit depth when we are a lightmap
+			if ( r_texturebitslm->integer == 16 )
+			{
+				return GL_RGB5;
+			}
+			else if ( r_texturebitslm->integer == 32 )
+			{
+				return GL_RGB8;
+			}
+		}
 
+		if ( r_texturebits->integer == 16 )
+		{
+			return GL_RGB5;
+		}
+		else if ( r_texturebits->integer == 32 )
+		{
+			return GL_RGB8;
+		}
+		return 3;
 	}
 
-done:
+	if ( glConfig.textureCompression == TC_S3TC_DXT && allowTC)
+	{	// Compress both alpha and color
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else if ( r_texturebits->integer == 16 )
+	{
+		return GL_RGBA4;
+	}
+	else if ( r_texturebits->integer == 32 )
+	{
+		return GL_RGBA8;
+	}
+	return 4;
+}
+
+/*
+===============
+R_UploadMipChain
+
+Hands a built mip chain to GL and sets the filtering, the image has to be bound already
+===============
+*/
+static void R_UploadMipChain( const mipChain_t *chain, qboolean mipmap, int format ) {
+	const byte	*data = chain->data.data();
+	int			width = chain->width;
+	int			height = chain->height;
+	int			miplevel;
+
+	for ( miplevel = 0; miplevel < chain->numLevels; miplevel++ ) {
+		qglTexImage2D (GL_TEXTURE_2D, miplevel, format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data );
+		data += width * height * 4;
+		width = Q_max( width >> 1, 1 );
+		height = Q_max( height >> 1, 1 );
+	}
 
 	if (mipmap)
 	{
@@ -753,6 +861,468 @@ done:
 	GL_CheckErrors();
 }
 
+/*
+===============
+R_FinishUpload
+
+Uploads a built mip chain into a new image and sets the image up for use
+===============
+*/
+static void R_FinishUpload( image_t *image, const mipChain_t *chain, qboolean allowTC ) {
+	const qboolean isLightmap = (qboolean)( image->imgName[0] == '$' );
+
+	image->pendingUpload = false;
+	image->internalFormat = R_InternalFormat( chain->samples, isLightmap, allowTC );
+	image->width = chain->width;
+	image->height = chain->height;
+
+	if ( qglActiveTextureARB ) {
+		GL_SelectTexture( 0 );
+	}
+
+	GL_Bind(image);
+
+	R_UploadMipChain( chain, (qboolean)image->mipmap, image->internalFormat );
+
+	qglTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, image->wrapClampMode );
+	qglTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, image->wrapClampMode );
+
+	qglBindTexture( GL_TEXTURE_2D, 0 );	//jfm: i don't know why this is here, but it breaks lightmaps when there's only 1
+	glState.currenttextures[glState.currenttmu] = 0;	//mark it not bound
+}
+
+/*
+=====================
+Image cache
+
+Images from pk3 files get their finished mip chains written to IMAGE_CACHE_DIR,
+one file per image, so later loads skip decoding and mip generation and just
+read the chain back. Entries are keyed by the file the image is loaded from,
+the checksum of its pk3 and everything else that goes into building the chain.
+IMAGE_CACHE_INDEX tracks the entries so the least recently used ones can be
+dropped once the cache grows past r_imageCacheMB.
+=====================
+*/
+#define IMAGE_CACHE_DIR			"imagecache"
+#define IMAGE_CACHE_EXT			".img"
+#define IMAGE_CACHE_INDEX		IMAGE_CACHE_DIR "/index.dat"
+#define IMAGE_CACHE_IDENT		(('C'<<24)+('I'<<16)+('J'<<8)+'O')
+#define IMAGE_CACHE_VERSION		1
+
+typedef struct imageCacheHeader_s {
+	int				ident;
+	int				version;
+	unsigned int	key;
+	char			filename[MAX_QPATH];	// to tell apart images whose keys collide
+	int				pakChecksum;
+	unsigned int	settings;
+	int				width, height;
+	int				numLevels;
+	int				samples;
+	int				dataSize;
+	// followed by the mip chain
+} imageCacheHeader_t;
+
+typedef struct imageCacheIndexHeader_s {
+	int				ident;
+	int				version;
+	unsigned int	useCount;
+	int				numEntries;
+	// followed by numEntries imageCacheEntry_t
+} imageCacheIndexHeader_t;
+
+typedef struct imageCacheEntry_s {
+	unsigned int	key;
+	int				size;
+	unsigned int	lastUsed;
+} imageCacheEntry_t;
+
+static std::map<unsigned int, imageCacheEntry_t>	imageCacheEntries;
+static size_t		imageCacheSize = 0;
+static unsigned int	imageCacheUseCount = 0;
+static qboolean		imageCacheIndexLoaded = qfalse;
+static qboolean		imageCacheIndexDirty = qfalse;
+
+static unsigned int R_ImageCacheHash( const void *data, size_t length, unsigned int hash )
+{
+	// FNV-1a
+	const byte *p = (const byte *)data;
+	for ( size_t i = 0; i < length; i++ )
+	{
+		hash ^= p[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static const char *R_ImageCacheFile( unsigned int key )
+{
+	return va( "%s/%08x%s", IMAGE_CACHE_DIR, key, IMAGE_CACHE_EXT );
+}
+
+static void R_ImageCache_RemoveEntry( std::map<unsigned int, imageCacheEntry_t>::iterator it )
+{
+	ri.FS_HomeRemove( R_ImageCacheFile( it->first ) );
+	imageCacheSize -= it->second.size;
+	imageCacheEntries.erase( it );
+	imageCacheIndexDirty = qtrue;
+}
+
+static void R_ImageCache_LoadIndex( void )
+{
+	byte *buffer;
+
+	if ( imageCacheIndexLoaded )
+	{
+		return;
+	}
+	imageCacheIndexLoaded = qtrue;
+
+	const long len = ri.FS_ReadFile( IMAGE_CACHE_INDEX, (void **)&buffer );
+	if ( buffer )
+	{
+		imageCacheIndexHeader_t header;
+		memset( &header, 0, sizeof( header ) );
+		if ( len >= (long)sizeof( header ) )
+		{
+			memcpy( &header, buffer, sizeof( header ) );
+		}
+
+		if ( header.ident == IMAGE_CACHE_IDENT
+			&& header.version == IMAGE_CACHE_VERSION
+			&& header.numEntries >= 0
+			&& len == (long)sizeof( header ) + header.numEntries * (long)sizeof( imageCacheEntry_t ) )
+		{
+			const imageCacheEntry_t *entries = (const imageCacheEntry_t *)( buffer + sizeof( header ) );
+
+			imageCacheUseCount = header.useCount;
+			for ( int i = 0; i < header.numEntries; i++ )
+			{
+				imageCacheEntries[entries[i].key] = entries[i];
+				imageCacheSize += entries[i].size;
+			}
+		}
+		ri.FS_FreeFile( buffer );
+	}
+
+	// files the index doesn't know about, say after a crash, would never be trimmed
+	int numFiles;
+	char **files = ri.FS_ListFiles( IMAGE_CACHE_DIR, IMAGE_CACHE_EXT, &numFiles );
+	for ( int i = 0; i < numFiles; i++ )
+	{
+		const unsigned int key = strtoul( files[i], NULL, 16 );
+		if ( imageCacheEntries.find( key ) == imageCacheEntries.end() )
+		{
+			ri.FS_HomeRemove( va( "%s/%s", IMAGE_CACHE_DIR, files[i] ) );
+		}
+	}
+	ri.FS_FreeFileList( files );
+}
+
+/*
+=====================
+R_ImageCache_SaveIndex
+=====================
+*/
+void R_ImageCache_SaveIndex( void )
+{
+	if ( !imageCacheIndexDirty )
+	{
+		return;
+	}
+	imageCacheIndexDirty = qfalse;
+
+	imageCacheIndexHeader_t header;
+	header.ident = IMAGE_CACHE_IDENT;
+	header.version = IMAGE_CACHE_VERSION;
+	header.useCount = imageCacheUseCount;
+	header.numEntries = (int)imageCacheEntries.size();
+
+	std::vector<byte> buffer( (const byte *)&header, (const byte *)&header + sizeof( header ) );
+	for ( auto it = imageCacheEntries.begin(); it != imageCacheEntries.end(); ++it )
+	{
+		buffer.insert( buffer.end(), (const byte *)&it->second, (const byte *)&it->second + sizeof( imageCacheEntry_t ) );
+	}
+
+	ri.FS_WriteFile( IMAGE_CACHE_INDEX, buffer.data(), (int)buffer.size() );
+}
+
+// drops the least recently used entries until the cache fits r_imageCacheMB
+static void R_ImageCache_Trim( void )
+{
+	const size_t budget = (size_t)Q_max( r_imageCacheMB->integer, 0 ) * 1024 * 1024;
+
+	while ( imageCacheSize > budget && !imageCacheEntries.empty() )
+	{
+		auto oldest = imageCacheEntries.begin();
+		for ( auto it = imageCacheEntries.begin(); it != imageCacheEntries.end(); ++it )
+		{
+			if ( it->second.lastUsed < oldest->second.lastUsed )
+			{
+				oldest = it;
+			}
+		}
+		R_ImageCache_RemoveEntry( oldest );
+	}
+}
+
+/*
+=====================
+R_ImageCache_Key
+
+Leaves key->key 0 if the image can't be cached
+=====================
+*/
+static void R_ImageCache_Key( const char *name, qboolean mipmap, qboolean allowPicmip, imageCacheKey_t *key )
+{
+	key->key = 0;
+
+	if ( r_imageCacheMB->integer <= 0 || !R_FindImageInPak( name, key->filename, sizeof( key->filename ), &key->pakChecksum ) )
+	{
+		return;
+	}
+
+	// everything R_BuildMipChain depends on besides the pic itself
+	const int settings[] = {
+		mipmap,
+		allowPicmip ? r_picmip->integer : 0,
+		glConfig.maxTextureSize,
+		glConfig.deviceSupportsGamma,
+		r_simpleMipMaps->integer,
+		r_colorMipLevels->integer,
+	};
+	unsigned int hash = R_ImageCacheHash( settings, sizeof( settings ), 2166136261u );
+	hash = R_ImageCacheHash( s_intensitytable, sizeof( s_intensitytable ), hash );
+	key->settings = R_ImageCacheHash( s_gammatable, sizeof( s_gammatable ), hash );
+
+	hash = R_ImageCacheHash( key->filename, strlen( key->filename ), key->settings );
+	hash = R_ImageCacheHash( &key->pakChecksum, sizeof( key->pakChecksum ), hash );
+	key->key = hash ? hash : 1;
+}
+
+// whether the header's level count and data size are what R_BuildMipChain makes for its size,
+// so a corrupt entry can't have R_UploadMipChain read past the data
+static qboolean R_ImageCache_ChainMatches( const imageCacheHeader_t *header, qboolean mipmap )
+{
+	int numLevels;
+	const size_t size = R_MipChainSize( header->width, header->height, mipmap, &numLevels );
+
+	return (qboolean)( header->numLevels == numLevels && header->dataSize >= 0 && (size_t)header->dataSize == size );
+}
+
+/*
+=====================
+R_ImageCache_Read
+
+Fills in chain from the cache, if it has the image
+=====================
+*/
+static qboolean R_ImageCache_Read( const imageCacheKey_t *key, qboolean mipmap, mipChain_t *chain )
+{
+	byte *buffer;
+
+	if ( !key->key )
+	{
+		return qfalse;
+	}
+
+	R_ImageCache_LoadIndex();
+
+	auto it = imageCacheEntries.find( key->key );
+	if ( it == imageCacheEntries.end() )
+	{
+		return qfalse;
+	}
+
+	const long len = ri.FS_ReadFile( R_ImageCacheFile( key->key ), (void **)&buffer );
+
+	imageCacheHeader_t header;
+	memset( &header, 0, sizeof( header ) );
+	if ( buffer && len >= (long)sizeof( header ) )
+	{
+		memcpy( &header, buffer, sizeof( header ) );
+	}
+
+	if ( header.ident != IMAGE_CACHE_IDENT
+		|| header.version != IMAGE_CACHE_VERSION
+		|| header.key != key->key
+		|| Q_stricmp( header.filename, key->filename )
+		|| header.pakChecksum != key->pakChecksum
+		|| header.settings != key->settings
+		|| header.width <= 0
+		|| header.height <= 0
+		|| header.width > glConfig.maxTextureSize
+		|| header.height > glConfig.maxTextureSize
+		|| ( header.samples != 3 && header.samples != 4 )
+		|| len != (long)sizeof( header ) + header.dataSize
+		|| !R_ImageCache_ChainMatches( &header, mipmap ) )
+	{
+		if ( buffer )
+		{
+			ri.FS_FreeFile( buffer );
+		}
+		// stale, a collision or never finished writing
+		R_ImageCache_RemoveEntry( it );
+		return qfalse;
+	}
+
+	chain->width = header.width;
+	chain->height = header.height;
+	chain->numLevels = header.numLevels;
+	chain->samples = header.samples;
+	chain->data.assign( buffer + sizeof( header ), buffer + len );
+	ri.FS_FreeFile( buffer );
+
+	it->second.lastUsed = ++imageCacheUseCount;
+	imageCacheIndexDirty = qtrue;
+	return qtrue;
+}
+
+static void R_ImageCache_Write( const imageCacheKey_t *key, const mipChain_t *chain )
+{
+	if ( !key->key )
+	{
+		return;
+	}
+
+	R_ImageCache_LoadIndex();
+
+	imageCacheHeader_t header;
+	memset( &header, 0, sizeof( header ) );
+	header.ident = IMAGE_CACHE_IDENT;
+	header.version = IMAGE_CACHE_VERSION;
+	header.key = key->key;
+	Q_strncpyz( header.filename, key->filename, sizeof( header.filename ) );
+	header.pakChecksum = key->pakChecksum;
+	header.settings = key->settings;
+	header.width = chain->width;
+	header.height = chain->height;
+	header.numLevels = chain->numLevels;
+	header.samples = chain->samples;
+	header.dataSize = (int)chain->data.size();
+
+	std::vector<byte> buffer( (const byte *)&header, (const byte *)&header + sizeof( header ) );
+	buffer.insert( buffer.end(), chain->data.begin(), chain->data.end() );
+	ri.FS_WriteFile( R_ImageCacheFile( key->key ), buffer.data(), (int)buffer.size() );
+
+	auto it = imageCacheEntries.find( key->key );
+	if ( it != imageCacheEntries.end() )
+	{
+		imageCacheSize -= it->second.size;
+	}
+
+	imageCacheEntry_t &entry = imageCacheEntries[key->key];
+	entry.key = key->key;
+	entry.size = (int)buffer.size();
+	entry.lastUsed = ++imageCacheUseCount;
+	imageCacheSize += entry.size;
+	imageCacheIndexDirty = qtrue;
+
+	R_ImageCache_Trim();
+}
+
+/*
+=====================
+R_ImageCache_Clear_f
+=====================
+*/
+void R_ImageCache_Clear_f( void )
+{
+	int numFiles;
+	char **files = ri.FS_ListFiles( IMAGE_CACHE_DIR, IMAGE_CACHE_EXT, &numFiles );
+	for ( int i = 0; i < numFiles; i++ )
+	{
+		ri.FS_HomeRemove( va( "%s/%s", IMAGE_CACHE_DIR, files[i] ) );
+	}
+	ri.FS_FreeFileList( files );
+	ri.FS_HomeRemove( IMAGE_CACHE_INDEX );
+
+	ri.Printf( PRINT_ALL, "Removed %d cached images\n", numFiles );
+
+	imageCacheEntries.clear();
+	imageCacheSize = 0;
+	imageCacheUseCount = 0;
+	imageCacheIndexLoaded = qtrue;
+	imageCacheIndexDirty = qfalse;
+}
+// images registered during a level load, waiting for R_Images_FlushPendingUploads
+typedef struct {
+	image_t		*image;
+	byte		*pic;			// as loaded, R_Malloc'd
+	int			width, height;	// of pic
+	qboolean	allowPicmip;
+	qboolean	allowTC;
+	imageCacheKey_t	cacheKey;
+	mipChain_t	chain;
+} pendingUpload_t;
+
+static std::vector<pendingUpload_t>	pendingUploads;
+static size_t						pendingUploadBytes = 0;
+static qboolean						deferImageUploads = qfalse;
+
+/*
+===============
+R_Images_FlushPendingUploads
+
+Builds the mip chains of all queued images on the worker threads,
+then uploads them from this one
+===============
+*/
+void R_Images_FlushPendingUploads( void ) {
+	if ( pendingUploads.empty() ) {
+		return;
+	}
+	R_IssuePendingRenderCommands();
+
+	Q::parallelFor( pendingUploads.size(), 1, []( size_t begin, size_t end ) {
+		for ( size_t i = begin; i < end; i++ ) {
+			pendingUpload_t &pending = pendingUploads[i];
+			R_BuildMipChain( pending.pic, pending.width, pending.height, (qboolean)pending.image->mipmap, pending.allowPicmip, &pending.chain );
+		}
+	} );
+
+	// this may be a GL_Bind halfway through drawing, so leave the texture unit as it was
+	const int oldTmu = glState.currenttmu;
+
+	for ( size_t i = 0; i < pendingUploads.size(); i++ ) {
+		pendingUpload_t &pending = pendingUploads[i];
+
+		R_Free( pending.pic );
+		assert( pending.image->width == pending.chain.width && pending.image->height == pending.chain.height );
+
+		R_FinishUpload( pending.image, &pending.chain, pending.allowTC );
+		R_ImageCache_Write( &pending.cacheKey, &pending.chain );
+	}
+
+	if ( qglActiveTextureARB ) {
+		GL_SelectTexture( oldTmu );
+	}
+
+	pendingUploads.clear();
+	pendingUploadBytes = 0;
+}
+
+// throws away queued uploads, for when the images themselves are about to go
+static void R_Images_DiscardPendingUploads( void ) {
+	for ( size_t i = 0; i < pendingUploads.size(); i++ ) {
+		R_Free( pendingUploads[i].pic );
+	}
+	pendingUploads.clear();
+	pendingUploadBytes = 0;
+}
+
+/*
+===============
+R_Images_LevelLoadBegin
+
+Images loaded from disk from here until RE_RegisterImages_LevelLoadEnd are
+queued and uploaded in batches, see r_imageUploadBatchMB
+===============
+*/
+void R_Images_LevelLoadBegin( void ) {
+	deferImageUploads = (qboolean)( r_imageUploadBatchMB->integer > 0 );
+}
+
 class CStringComparator
 {
 public:
@@ -788,6 +1358,11 @@ static void R_Images_DeleteImageContents( image_t *pImage )
 	assert(pImage);	// should never be called with NULL
 	if (pImage)
 	{
+		R_IssuePendingRenderCommands();
+		if ( pImage->pendingUpload )
+		{
+			R_Images_FlushPendingUploads();
+		}
 		qglDeleteTextures( 1, &pImage->texnum );
 		R_Free(pImage);
 	}
@@ -852,6 +1427,11 @@ void R_Images_DeleteImage(image_t *pImage)
 void R_Images_Clear(void)
 {
 	image_t *pImage;
+
+	R_Images_DiscardPendingUploads();
+	deferImageUploads = qfalse;
+	R_ImageCache_SaveIndex();
+
 	//	int iNumImages =
 	   				  R_Images_StartIteration();
 	while ( (pImage = R_Images_GetNextIteration()) != NULL)
@@ -890,6 +1470,10 @@ qboolean RE_RegisterImages_LevelLoadEnd(void)
 {
 	//ri.Printf( PRINT_DEVELOPER, "RE_RegisterImages_LevelLoadEnd():\n");
 
+	R_Images_FlushPendingUploads();
+	deferImageUploads = qfalse;
+	R_ImageCache_SaveIndex();
+
 	qboolean imageDeleted = qtrue;
 	for (AllocatedImages_t::iterator itImage = AllocatedImages.begin(); itImage != AllocatedImages.end(); /* blank */)
 	{
@@ -974,41 +1558,14 @@ static image_t *R_FindImageFile_NoLoad(const char *name, qboolean mipmap, qboole
 
 /*
 ================
-R_CreateImage
+R_NewImage
 
-This is the only way any image_t are created
+Allocates and registers a new image_t, which still has to be uploaded
 ================
 */
-image_t *R_CreateImage( const char *name, const byte *pic, int width, int height,
-					   GLenum format, qboolean mipmap, qboolean allowPicmip, qboolean allowTC, int glWrapClampMode)
+static image_t *R_NewImage( const char *name, int width, int height, qboolean mipmap, qboolean allowPicmip, int glWrapClampMode )
 {
-	image_t		*image;
-	qboolean	isLightmap = qfalse;
-
-	if (strlen(name) >= MAX_QPATH ) {
-		Com_Error (ERR_DROP, "R_CreateImage: \"%s\" is too long\n", name);
-	}
-
-	if(glConfig.clampToEdgeAvailable && glWrapClampMode == GL_CLAMP) {
-		glWrapClampMode = GL_CLAMP_TO_EDGE;
-	}
-
-	if (name[0] == '$')
-	{
-		isLightmap = qtrue;
-	}
-
-	if ( (width&(width-1)) || (height&(height-1)) )
-	{
-		Com_Error( ERR_FATAL, "R_CreateImage: %s dimensions (%i x %i) not power of 2!\n",name,width,height);
-	}
-
-	image = R_FindImageFile_NoLoad(name, mipmap, allowPicmip, allowTC, glWrapClampMode );
-	if (image) {
-		return image;
-	}
-
-	image = (image_t*) R_Malloc( sizeof( image_t ), TAG_IMAGE_T, qtrue );
+	image_t *image = (image_t*) R_Malloc( sizeof( image_t ), TAG_IMAGE_T, qtrue );
 
 	//image->imgfileSize=fileSize;
 
@@ -1021,36 +1578,67 @@ image_t *R_CreateImage( const char *name, const byte *pic, int width, int height
 	image->mipmap = !!mipmap;
 	image->allowPicmip = !!allowPicmip;
 
-	Q_strncpyz(image->imgName, name, sizeof(image->imgName));
-
 	image->width = width;
 	image->height = height;
 	image->wrapClampMode = glWrapClampMode;
 
-	if ( qglActiveTextureARB ) {
-		GL_SelectTexture( 0 );
+	const char *psNewName = GenerateImageMappingName(name);
+	Q_strncpyz(image->imgName, psNewName, sizeof(image->imgName));
+	AllocatedImages[ image->imgName ] = image;
+
+	return image;
+}
+
+static void R_CheckNewImage( const char *name, int width, int height )
+{
+	if (strlen(name) >= MAX_QPATH ) {
+		Com_Error (ERR_DROP, "R_CreateImage: \"%s\" is too long\n", name);
 	}
 
-	GL_Bind(image);
+	if ( (width&(width-1)) || (height&(height-1)) )
+	{
+		Com_Error( ERR_FATAL, "R_CreateImage: %s dimensions (%i x %i) not power of 2!\n",name,width,height);
+	}
+}
 
-	Upload32( (unsigned *)pic,	format,
-								(qboolean)image->mipmap,
-								allowPicmip,
-								isLightmap,
-								allowTC,
-								&image->internalFormat,
-								&image->width,
-								&image->height );
+/*
+================
+R_CreateImage
 
-	qglTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glWrapClampMode );
-	qglTexParameterf( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glWrapClampMode );
+This is the only way any image_t are created
+================
+*/
+image_t *R_CreateImage( const char *name, const byte *pic, int width, int height,
+					   GLenum format, qboolean mipmap, qboolean allowPicmip, qboolean allowTC, int glWrapClampMode)
+{
+	image_t		*image;
+	mipChain_t	chain;
 
-	qglBindTexture( GL_TEXTURE_2D, 0 );	//jfm: i don't know why this is here, but it breaks lightmaps when there's only 1
-	glState.currenttextures[glState.currenttmu] = 0;	//mark it not bound
+	if(glConfig.clampToEdgeAvailable && glWrapClampMode == GL_CLAMP) {
+		glWrapClampMode = GL_CLAMP_TO_EDGE;
+	}
 
-	const char *psNewName = GenerateImageMappingName(name);
-	Q_strncpyz(image->imgName, psNewName, sizeof(image->imgName));
-	AllocatedImages[ image->imgName ] = image;
+	R_IssuePendingRenderCommands();
+	R_CheckNewImage( name, width, height );
+
+	image = R_FindImageFile_NoLoad(name, mipmap, allowPicmip, allowTC, glWrapClampMode );
+	if (image) {
+		return image;
+	}
+
+	image = R_NewImage( name, width, height, mipmap, allowPicmip, glWrapClampMode );
+
+	if ( format == GL_RGBA ) {
+		R_BuildMipChain( pic, width, height, mipmap, allowPicmip, &chain );
+	}
+	else {
+		chain.width = width;
+		chain.height = height;
+		chain.numLevels = 0;
+		chain.samples = 4;
+	}
+
+	R_FinishUpload( image, &chain, allowTC );
 
 	return image;
 }
@@ -1067,6 +1655,7 @@ image_t	*R_FindImageFile( const char *name, qboolean mipmap, qboolean allowPicmi
 	image_t	*image;
 	int		width, height;
 	byte	*pic;
+	imageCacheKey_t	cacheKey;
 
 	if (!name) {
 		return NULL;
@@ -1084,16 +1673,61 @@ image_t	*R_FindImageFile( const char *name, qboolean mipmap, qboolean allowPicmi
 		return image;
 	}
 
+	R_ImageCache_Key( name, mipmap, allowPicmip, &cacheKey );
+
+	mipChain_t chain;
+	if ( R_ImageCache_Read( &cacheKey, mipmap, &chain ) ) {
+		image = R_NewImage( name, chain.width, chain.height, mipmap, allowPicmip, glWrapClampMode );
+		R_FinishUpload( image, &chain, allowTC );
+		return image;
+	}
+
 	//
 	// load the pic from disk
 	//
-	R_LoadImage( name, &pic, &width, &height );
+	R_LoadImage( cacheKey.key ? cacheKey.filename : name, &pic, &width, &height );
 	if ( !pic ) {
         return NULL;
 	}
 
-	image = R_CreateImage( ( char * ) name, pic, width, height, GL_RGBA, mipmap, allowPicmip, allowTC, glWrapClampMode );
+	R_CheckNewImage( name, width, height );
+	image = R_NewImage( name, width, height, mipmap, allowPicmip, glWrapClampMode );
+
+	if ( deferImageUploads )
+	{
+		pendingUpload_t pending = {};
+
+		pending.image = image;
+		pending.pic = pic;
+		pending.width = width;
+		pending.height = height;
+		pending.allowPicmip = allowPicmip;
+		pending.allowTC = allowTC;
+		pending.cacheKey = cacheKey;
+
+		// the size is known up front, only the internal format has to wait for the upload
+		int uploadWidth = width;
+		int uploadHeight = height;
+		R_UploadSize( &uploadWidth, &uploadHeight, allowPicmip );
+		image->width = uploadWidth;
+		image->height = uploadHeight;
+		image->pendingUpload = true;
+
+		pendingUploads.push_back( std::move( pending ) );
+		pendingUploadBytes += width * height * 4;
+		if ( pendingUploadBytes > (size_t)r_imageUploadBatchMB->integer * 1024 * 1024 )
+		{
+			R_Images_FlushPendingUploads();
+		}
+		return image;
+	}
+
+	R_BuildMipChain( pic, width, height, mipmap, allowPicmip, &chain );
 	R_Free( pic );
+
+	R_FinishUpload( image, &chain, allowTC );
+	R_ImageCache_Write( &cacheKey, &chain );
+
 	return image;
 }
 
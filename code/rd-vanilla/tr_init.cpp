@@ -31,6 +31,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_stl.h"
 #include "../rd-common/tr_font.h"
 #include "tr_WorldEffects.h"
+#include "qcommon/q_parallel.h"
 
 glconfig_t	glConfig;
 glstate_t	glState;
@@ -46,6 +47,7 @@ cvar_t	*r_detailTextures;
 cvar_t	*r_znear;
 
 cvar_t	*r_skipBackEnd;
+cvar_t	*r_smp;
 
 cvar_t	*r_measureOverdraw;
 
@@ -70,7 +72,9 @@ cvar_t	*r_showcluster;
 cvar_t	*r_nocurves;
 
 cvar_t	*r_dlightStyle;
+cvar_t	*r_dlightSurfaceMax;
 cvar_t	*r_surfaceSprites;
+cvar_t	*r_surfaceSpriteLodDist;
 cvar_t	*r_surfaceWeather;
 
 cvar_t	*r_windSpeed;
@@ -89,6 +93,7 @@ cvar_t	*r_ext_preferred_tc_method;
 cvar_t	*r_ext_gamma_control;
 cvar_t	*r_ext_multitexture;
 cvar_t	*r_ext_compiled_vertex_array;
+cvar_t	*r_ext_vertex_buffer_object;
 cvar_t	*r_ext_texture_env_add;
 cvar_t	*r_ext_texture_filter_anisotropic;
 
@@ -139,6 +144,9 @@ cvar_t	*r_mapOverBrightBits;
 
 cvar_t	*r_debugSurface;
 cvar_t	*r_simpleMipMaps;
+cvar_t	*r_shaderCache;
+cvar_t	*r_imageUploadBatchMB;
+cvar_t	*r_imageCacheMB;
 
 cvar_t	*r_showImages;
 
@@ -158,6 +166,7 @@ cvar_t	*r_Ghoul2NoLerp;
 cvar_t	*r_Ghoul2NoBlend;
 cvar_t	*r_Ghoul2BlendMultiplier=0;
 cvar_t	*r_Ghoul2UnSqashAfterSmooth;
+cvar_t	*r_Ghoul2PoseCache;
 
 cvar_t	*broadsword;
 cvar_t	*broadsword_kickbones;
@@ -228,6 +237,11 @@ PFNGLISPROGRAMARBPROC qglIsProgramARB;
 PFNGLLOCKARRAYSEXTPROC qglLockArraysEXT;
 PFNGLUNLOCKARRAYSEXTPROC qglUnlockArraysEXT;
 
+PFNGLGENBUFFERSARBPROC qglGenBuffersARB;
+PFNGLDELETEBUFFERSARBPROC qglDeleteBuffersARB;
+PFNGLBINDBUFFERARBPROC qglBindBufferARB;
+PFNGLBUFFERDATAARBPROC qglBufferDataARB;
+
 bool g_bTextureRectangleHack = false;
 
 void RE_SetLightStyle(int style, int color);
@@ -519,6 +533,42 @@ static void GLimp_InitExtensions( void )
 		Com_Printf ("...GL_EXT_compiled_vertex_array not found\n" );
 	}
 
+	// GL_ARB_vertex_buffer_object, for the static world geometry
+	qglGenBuffersARB = NULL;
+	qglDeleteBuffersARB = NULL;
+	qglBindBufferARB = NULL;
+	qglBufferDataARB = NULL;
+	if ( ri.GL_ExtensionSupported( "GL_ARB_vertex_buffer_object" ) )
+	{
+		if ( r_ext_vertex_buffer_object->integer )
+		{
+			qglGenBuffersARB = ( PFNGLGENBUFFERSARBPROC ) ri.GL_GetProcAddress( "glGenBuffersARB" );
+			qglDeleteBuffersARB = ( PFNGLDELETEBUFFERSARBPROC ) ri.GL_GetProcAddress( "glDeleteBuffersARB" );
+			qglBindBufferARB = ( PFNGLBINDBUFFERARBPROC ) ri.GL_GetProcAddress( "glBindBufferARB" );
+			qglBufferDataARB = ( PFNGLBUFFERDATAARBPROC ) ri.GL_GetProcAddress( "glBufferDataARB" );
+			if ( qglGenBuffersARB && qglDeleteBuffersARB && qglBindBufferARB && qglBufferDataARB )
+			{
+				Com_Printf ("...using GL_ARB_vertex_buffer_object\n" );
+			}
+			else
+			{
+				qglGenBuffersARB = NULL;
+				qglDeleteBuffersARB = NULL;
+				qglBindBufferARB = NULL;
+				qglBufferDataARB = NULL;
+				Com_Printf ("...GL_ARB_vertex_buffer_object failed\n" );
+			}
+		}
+		else
+		{
+			Com_Printf ("...ignoring GL_ARB_vertex_buffer_object\n" );
+		}
+	}
+	else
+	{
+		Com_Printf ("...GL_ARB_vertex_buffer_object not found\n" );
+	}
+
 	bool bNVRegisterCombiners = false;
 	// Register Combiners.
 	if ( ri.GL_ExtensionSupported( "GL_NV_register_combiners" ) )
@@ -800,6 +850,7 @@ byte *RB_ReadPixels(int x, int y, int width, int height, size_t *offset, int *pa
 	int padwidth, linelen;
 	GLint packAlign;
 
+	R_IssuePendingRenderCommands();
 	qglGetIntegerv(GL_PACK_ALIGNMENT, &packAlign);
 
 	linelen = width * 3;
@@ -1301,6 +1352,7 @@ void GfxInfo_f( void )
 		ri.Printf( PRINT_ALL, "lightmap texture bits: %d\n", r_texturebitslm->integer );
 	ri.Printf( PRINT_ALL, "multitexture: %s\n", enablestrings[qglActiveTextureARB != 0] );
 	ri.Printf( PRINT_ALL, "compiled vertex arrays: %s\n", enablestrings[qglLockArraysEXT != 0 ] );
+	ri.Printf( PRINT_ALL, "world vertex buffers: %s\n", enablestrings[qglBindBufferARB != 0 ] );
 	ri.Printf( PRINT_ALL, "texenv add: %s\n", enablestrings[glConfig.textureEnvAddAvailable != 0] );
 	ri.Printf( PRINT_ALL, "compressed textures: %s\n", enablestrings[glConfig.textureCompression != TC_NONE] );
 	ri.Printf( PRINT_ALL, "compressed lightmaps: %s\n", enablestrings[(r_ext_compressed_lightmaps->integer != 0 && glConfig.textureCompression != TC_NONE)] );
@@ -1324,6 +1376,7 @@ void GfxInfo_f( void )
 	if ( r_finish->integer ) {
 		ri.Printf( PRINT_ALL, "Forcing glFinish\n" );
 	}
+	ri.Printf( PRINT_ALL, "render thread: %s\n", enablestrings[r_smp->integer != 0] );
 
 	int displayRefresh = ri.Cvar_VariableIntegerValue("r_displayRefresh");
 	if ( displayRefresh ) {
@@ -1472,8 +1525,10 @@ static consoleCommand_t	commands[] = {
 	{ "r_atihack",			R_AtiHackToggle_f },
 	{ "r_we",				R_WorldEffect_f },
 	{ "imagecacheinfo",		RE_RegisterImages_Info_f },
+	{ "imagecache_clear",	R_ImageCache_Clear_f },
 	{ "modellist",			R_Modellist_f },
 	{ "modelcacheinfo",		RE_RegisterModels_Info_f },
+	{ "g2posecacheinfo",	G2_PoseCache_Info_f },
 	{ "r_fogDistance",		R_FogDistance_f },
 	{ "r_fogColor",			R_FogColor_f },
 	{ "r_reloadfonts",		R_ReloadFonts_f },
@@ -1507,6 +1562,7 @@ void R_Register( void )
 	r_ext_gamma_control = ri.Cvar_Get( "r_ext_gamma_control", "1", CVAR_ARCHIVE_ND | CVAR_LATCH );
 	r_ext_multitexture = ri.Cvar_Get( "r_ext_multitexture", "1", CVAR_ARCHIVE_ND | CVAR_LATCH );
 	r_ext_compiled_vertex_array = ri.Cvar_Get( "r_ext_compiled_vertex_array", "1", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	r_ext_vertex_buffer_object = ri.Cvar_Get( "r_ext_vertex_buffer_object", "1", CVAR_ARCHIVE_ND | CVAR_LATCH);
 	r_ext_texture_env_add = ri.Cvar_Get( "r_ext_texture_env_add", "1", CVAR_ARCHIVE_ND | CVAR_LATCH);
 	r_ext_texture_filter_anisotropic = ri.Cvar_Get( "r_ext_texture_filter_anisotropic", "16", CVAR_ARCHIVE_ND );
 
@@ -1527,10 +1583,14 @@ void R_Register( void )
 	r_overBrightBits = ri.Cvar_Get ("r_overBrightBits", "0", CVAR_ARCHIVE_ND | CVAR_LATCH );
 	r_mapOverBrightBits = ri.Cvar_Get( "r_mapOverBrightBits", "0", CVAR_ARCHIVE_ND|CVAR_LATCH );
 	r_simpleMipMaps = ri.Cvar_Get( "r_simpleMipMaps", "1", CVAR_ARCHIVE_ND | CVAR_LATCH );
+	r_shaderCache = ri.Cvar_Get( "r_shaderCache", "1", CVAR_ARCHIVE_ND );
+	r_imageUploadBatchMB = ri.Cvar_Get( "r_imageUploadBatchMB", "128", CVAR_ARCHIVE_ND );
+	r_imageCacheMB = ri.Cvar_Get( "r_imageCacheMB", "512", CVAR_ARCHIVE_ND );
 	r_vertexLight = ri.Cvar_Get( "r_vertexLight", "0", CVAR_ARCHIVE | CVAR_LATCH );
 	r_subdivisions = ri.Cvar_Get ("r_subdivisions", "4", CVAR_ARCHIVE_ND | CVAR_LATCH);
 	ri.Cvar_CheckRange( r_subdivisions, 0, 80, qfalse );
 	r_intensity = ri.Cvar_Get ("r_intensity", "1", CVAR_LATCH|CVAR_ARCHIVE_ND );
+	r_smp = ri.Cvar_Get( "r_smp", "0", CVAR_ARCHIVE_ND | CVAR_LATCH );
 
 	//
 	// temporary latched variables that can only change over a restart
@@ -1560,7 +1620,9 @@ void R_Register( void )
 	r_facePlaneCull = ri.Cvar_Get ("r_facePlaneCull", "1", CVAR_ARCHIVE_ND );
 
 	r_dlightStyle = ri.Cvar_Get ("r_dlightStyle", "1", CVAR_ARCHIVE_ND);
+	r_dlightSurfaceMax = ri.Cvar_Get ("r_dlightSurfaceMax", "8", CVAR_ARCHIVE_ND);
 	r_surfaceSprites = ri.Cvar_Get ("r_surfaceSprites", "1", CVAR_ARCHIVE_ND);
+	r_surfaceSpriteLodDist = ri.Cvar_Get ("r_surfaceSpriteLodDist", "1024", CVAR_ARCHIVE_ND);
 	r_surfaceWeather = ri.Cvar_Get ("r_surfaceWeather", "0", CVAR_TEMP);
 
 	r_windSpeed = ri.Cvar_Get ("r_windSpeed", "0", 0);
@@ -1633,6 +1695,7 @@ Ghoul2 Insert Start
 	r_Ghoul2NoBlend = ri.Cvar_Get( "r_ghoul2noblend", "0", 0);
 	r_Ghoul2BlendMultiplier = ri.Cvar_Get( "r_ghoul2blendmultiplier", "1", 0);
 	r_Ghoul2UnSqashAfterSmooth = ri.Cvar_Get( "r_ghoul2unsquashaftersmooth", "1", 0);
+	r_Ghoul2PoseCache = ri.Cvar_Get( "r_ghoul2posecache", "1", 0);
 
 	broadsword = ri.Cvar_Get( "broadsword", "1", 0);
 	broadsword_kickbones = ri.Cvar_Get( "broadsword_kickbones", "1", 0);
@@ -1739,7 +1802,12 @@ void R_Init( void ) {
 	R_NoiseInit();
 	R_Register();
 
-	backEndData = (backEndData_t *) R_Hunk_Alloc( sizeof( backEndData_t ), qtrue );
+	backEndData[0] = (backEndData_t *) R_Hunk_Alloc( sizeof( backEndData_t ), qtrue );
+	if ( r_smp->integer ) {
+		backEndData[1] = (backEndData_t *) R_Hunk_Alloc( sizeof( backEndData_t ), qtrue );
+	} else {
+		backEndData[1] = NULL;
+	}
 	R_InitNextFrame();
 
 	const color4ub_t color = {0xff, 0xff, 0xff, 0xff};
@@ -1764,6 +1832,10 @@ void R_Init( void ) {
 	// print info
 	GfxInfo_f();
 
+	if ( r_smp->integer ) {
+		R_InitRenderThread();
+	}
+
 	//ri.Printf( PRINT_ALL, "----- finished R_Init -----\n" );
 }
 
@@ -1774,6 +1846,9 @@ RE_Shutdown
 */
 extern void R_ShutdownWorldEffects(void);
 void RE_Shutdown( qboolean destroyWindow, qboolean restarting ) {
+	// everything below wants the GL context back on this thread
+	R_ShutdownRenderThread();
+
 	for ( size_t i = 0; i < numCommands; i++ )
 		ri.Cmd_RemoveCommand( commands[i].cmd );
 
@@ -1815,6 +1890,8 @@ void RE_Shutdown( qboolean destroyWindow, qboolean restarting ) {
 	if ( tr.registered )
 	{
 		R_IssuePendingRenderCommands();
+		R_DeleteWorldVBO();
+		R_ClearSurfaceSpriteCache();
 		if ( destroyWindow )
 		{
 			R_DeleteTextures();	// only do this for vid_restart now, not during things like map load
@@ -1829,6 +1906,9 @@ void RE_Shutdown( qboolean destroyWindow, qboolean restarting ) {
 	// shut down platform specific OpenGL stuff
 	if ( destroyWindow ) {
 		ri.WIN_Shutdown();
+
+		// the module may get unloaded now, so the worker threads can't stay around
+		Q::parallelShutdown();
 	}
 	tr.registered = qfalse;
 }
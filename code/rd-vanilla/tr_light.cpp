@@ -28,6 +28,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#include "qcommon/q_dlight.h"
+
 #define	DLIGHT_AT_RADIUS		16
 // at the edge of a dlight's influence, this amount of light will be added
 
@@ -56,6 +58,57 @@ void R_TransformDlights( int count, dlight_t *dl, orientationr_t *ori) {
 	}
 }
 
+/*
+=============================================================================
+
+DLIGHT CLUSTERS
+
+=============================================================================
+*/
+
+static Q::DlightClusters	dlightClusters;
+
+/*
+=============
+R_SetupDlightClusters
+
+Sorts the scene's dlights into the clusters of the current view
+=============
+*/
+void R_SetupDlightClusters( void ) {
+	Q::DlightClusterView	view;
+	float					lights[MAX_DLIGHTS][4];
+	int						i, numDlights;
+
+	numDlights = tr.refdef.num_dlights < MAX_DLIGHTS ? tr.refdef.num_dlights : MAX_DLIGHTS;
+	for ( i = 0 ; i < numDlights ; i++ ) {
+		VectorCopy( tr.refdef.dlights[i].origin, lights[i] );
+		lights[i][3] = tr.refdef.dlights[i].radius;
+	}
+
+	VectorCopy( tr.viewParms.ori.origin, view.origin );
+	VectorCopy( tr.viewParms.ori.axis[0], view.axis[0] );
+	VectorCopy( tr.viewParms.ori.axis[1], view.axis[1] );
+	VectorCopy( tr.viewParms.ori.axis[2], view.axis[2] );
+	view.tanX = tanf( tr.viewParms.fovX * M_PI / 360.0f );
+	view.tanY = tanf( tr.viewParms.fovY * M_PI / 360.0f );
+	view.zNear = r_znear->value;
+	view.zFar = tr.distanceCull * 1.02f;
+
+	Q::dlightClustersSetup( dlightClusters, view, lights, numDlights );
+}
+
+/*
+=============
+R_DlightClusterBits
+
+Returns the dlights that reach the clusters a world space box touches
+=============
+*/
+int R_DlightClusterBits( const vec3_t mins, const vec3_t maxs ) {
+	return (int)Q::dlightClusterBits( dlightClusters, mins, maxs );
+}
+
 /*
 =============
 R_DlightBmodel
@@ -96,6 +149,23 @@ void R_DlightBmodel( bmodel_t *bmodel, qboolean NoLight ) {
 		}
 	}
 
+	if ( mask ) {
+		vec3_t	center, extents, mins, maxs;
+
+		// world space box around the bmodel
+		for ( i = 0 ; i < 3 ; i++ ) {
+			center[i] = ( bmodel->bounds[0][i] + bmodel->bounds[1][i] ) * 0.5f;
+			extents[i] = ( bmodel->bounds[1][i] - bmodel->bounds[0][i] ) * 0.5f;
+		}
+		for ( i = 0 ; i < 3 ; i++ ) {
+			const float c = tr.ori.origin[i] + center[0] * tr.ori.axis[0][i] + center[1] * tr.ori.axis[1][i] + center[2] * tr.ori.axis[2][i];
+			const float e = extents[0] * Q_fabs( tr.ori.axis[0][i] ) + extents[1] * Q_fabs( tr.ori.axis[1][i] ) + extents[2] * Q_fabs( tr.ori.axis[2][i] );
+			mins[i] = c - e;
+			maxs[i] = c + e;
+		}
+		mask &= R_DlightClusterBits( mins, maxs );
+	}
+
 	tr.currentEntity->needDlights = (qboolean)(mask != 0);
 	tr.currentEntity->dlightBits = mask;
 
@@ -105,11 +175,11 @@ void R_DlightBmodel( bmodel_t *bmodel, qboolean NoLight ) {
 		surf = bmodel->firstSurface + i;
 
 		if ( *surf->data == SF_FACE ) {
-			((srfSurfaceFace_t *)surf->data)->dlightBits = mask;
+			((srfSurfaceFace_t *)surf->data)->dlightBits[ tr.smpFrame ] = mask;
 		} else if ( *surf->data == SF_GRID ) {
-			((srfGridMesh_t *)surf->data)->dlightBits = mask;
+			((srfGridMesh_t *)surf->data)->dlightBits[ tr.smpFrame ] = mask;
 		} else if ( *surf->data == SF_TRIANGLES ) {
-			((srfTriangles_t *)surf->data)->dlightBits = mask;
+			((srfTriangles_t *)surf->data)->dlightBits[ tr.smpFrame ] = mask;
 		}
 	}
 }
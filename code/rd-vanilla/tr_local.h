@@ -43,6 +43,9 @@ extern refimport_t ri;
 #define SHADERNUM_BITS	13
 #define MAX_SHADERS		(1<<SHADERNUM_BITS)
 
+// with r_smp the front end fills one set of per frame data while the render thread draws the other
+#define	SMP_FRAMES		2
+
 
 typedef struct dlight_s {
 	vec3_t	origin;
@@ -130,6 +133,8 @@ typedef struct image_s {
 
 	bool		allowPicmip;
 	short		iLastLevelUsedOn;
+
+	bool		pendingUpload;			// queued for R_Images_FlushPendingUploads, nothing in the texture yet
 } image_t;
 
 
@@ -614,11 +619,25 @@ typedef struct srfFlare_s {
 	vec3_t			color;
 } srfFlare_t;
 
+// where a static world surface sits in the world vertex buffer, numVerts is 0 if it isn't in there
+typedef struct {
+	int				firstVertex, numVerts;
+	int				firstIndex, numIndexes;		// grids keep a range per level of detail instead
+} worldVBORange_t;
+
+// one vertex of the world vertex buffer, with the first lightmap and vertex colour only
+typedef struct {
+	vec3_t			xyz;
+	vec2_t			st;
+	vec2_t			lightmap;
+	byte			color[4];
+} worldVBOVertex_t;
+
 typedef struct srfGridMesh_s {
 	surfaceType_t	surfaceType;
 
 	// dynamic lighting information
-	int				dlightBits;
+	int				dlightBits[SMP_FRAMES];
 
 	// culling information
 	vec3_t			meshBounds[2];
@@ -631,10 +650,20 @@ typedef struct srfGridMesh_s {
 	vec3_t			lodOrigin;
 	float			lodRadius;
 
+	worldVBORange_t	vbo;
+
 	// vertexes
 	int				width, height;
 	float			*widthLodError;
 	float			*heightLodError;
+
+	// the distinct lod errors are where the grid changes level of detail,
+	// lod is the level the back end picked the last time it drew the grid
+	int				numLods;
+	float			*lodErrors;		// numLods - 1 of them, sorted
+	int				lod;
+	worldVBORange_t	*lodRanges;		// numLods ranges of the world index buffer, NULL if built every frame
+
 	drawVert_t		verts[1];		// variable sized
 } srfGridMesh_t;
 
@@ -651,7 +680,9 @@ typedef struct {
 	cplane_t	plane;
 
 	// dynamic lighting information
-	int			dlightBits;
+	int			dlightBits[SMP_FRAMES];
+
+	worldVBORange_t	vbo;
 
 	// triangle definitions (no normals at points)
 	int			numPoints;
@@ -667,7 +698,7 @@ typedef struct {
 	surfaceType_t	surfaceType;
 
 	// dynamic lighting information
-	int				dlightBits;
+	int				dlightBits[SMP_FRAMES];
 
 	// culling information (FIXME: use this!)
 	vec3_t			bounds[2];
@@ -680,6 +711,8 @@ typedef struct {
 
 	int				numVerts;
 	drawVert_t		*verts;
+
+	worldVBORange_t	vbo;
 } srfTriangles_t;
 
 
@@ -788,6 +821,15 @@ typedef struct {
 	const byte	*vis;			// may be passed in by CM_LoadMap to save space
 
 	byte		*novis;			// clusterBytes of 0xff
+
+	int			numLeafs;
+	mnode_t		**leafs;		// in front child first order, the order surfaces are added in
+	int			*leafDlightBits;	// indexed like nodes - numDecisionNodes, valid for visLeafs
+
+	int			numVisLeafs;	// leafs in the pvs and areamask, rebuilt by R_MarkLeaves
+	mnode_t		**visLeafs;
+	float		*visLeafBounds;	// mins then maxs of visLeafs per axis, each axis padded to a multiple of 4
+	byte		*visLeafCulled;	// frustum cull result for visLeafs
 } world_t;
 
 //======================================================================
@@ -820,6 +862,7 @@ Ghoul2 Insert Start
 */
 	mdxmHeader_t *mdxm;				// only if type == MOD_GL2M which is a GHOUL II Mesh file NOT a GHOUL II animation file
 	mdxaHeader_t *mdxa;				// only if type == MOD_GL2A which is a GHOUL II Animation file
+	byte		**mdxmShadowEdges;	// per lod and surface, the shadow edge masks from R_BuildShadowEdges
 /*
 Ghoul2 Insert End
 */
@@ -920,6 +963,8 @@ typedef struct {
 	int		c_dlightVertexes;
 	int		c_dlightIndexes;
 
+	int		c_vboDraws;			// draw calls made from the world vertex buffer
+
 	int		c_flareAdds;
 	int		c_flareTests;
 	int		c_flareRenders;
@@ -935,6 +980,8 @@ typedef struct {
 	orientationr_t	ori;
 	backEndCounters_t	pc;
 	qboolean	isHyperspace;
+	int			smpFrame;		// which backEndData the commands being run came from
+	int			smpVideoMaps;	// video map handles the render thread left for the front end to update
 	trRefEntity_t	*currentEntity;
 	qboolean	skyRenderedThisView;	// flag for drawing sun
 
@@ -957,6 +1004,9 @@ typedef struct {
 typedef struct {
 	qboolean				registered;		// cleared at shutdown, set at beginRegistration
 
+	qboolean				smpActive;		// the back end is running on the render thread
+	int						smpFrame;		// backEndData the front end is filling
+
 	int						visCount;		// incremented every time a new vis cluster is entered
 	int						frameCount;		// incremented every frame
 	int						sceneCount;		// incremented every scene
@@ -1071,6 +1121,9 @@ image_t *R_Images_GetNextIteration(void);
 void	 R_Images_Clear(void);
 void	 R_Images_DeleteLightMaps(void);
 void	 R_Images_DeleteImage(image_t *pImage);
+void	 R_Images_LevelLoadBegin(void);
+void	 R_Images_FlushPendingUploads(void);
+void	 R_ImageCache_Clear_f(void);
 
 
 extern backEndState_t	backEnd;
@@ -1128,7 +1181,9 @@ extern	cvar_t	*r_nocurves;
 extern	cvar_t	*r_showcluster;
 
 extern cvar_t	*r_dlightStyle;
+extern cvar_t	*r_dlightSurfaceMax;	// most dlights drawn on one surface, the strongest are kept
 extern cvar_t	*r_surfaceSprites;
+extern cvar_t	*r_surfaceSpriteLodDist;	// surface sprites further away thin out, 0 draws them all
 extern cvar_t	*r_surfaceWeather;
 
 extern cvar_t	*r_windSpeed;
@@ -1155,6 +1210,7 @@ extern cvar_t	*r_ext_gamma_control;
 extern cvar_t	*r_ext_texenv_op;
 extern cvar_t	*r_ext_multitexture;
 extern cvar_t	*r_ext_compiled_vertex_array;
+extern cvar_t	*r_ext_vertex_buffer_object;
 extern cvar_t	*r_ext_texture_env_add;
 extern cvar_t	*r_ext_texture_filter_anisotropic;
 
@@ -1199,6 +1255,7 @@ extern	cvar_t	*r_portalOnly;
 extern	cvar_t	*r_subdivisions;
 extern	cvar_t	*r_lodCurveError;
 extern	cvar_t	*r_skipBackEnd;
+extern	cvar_t	*r_smp;
 
 extern	cvar_t	*r_ignoreGLErrors;
 
@@ -1207,6 +1264,9 @@ extern	cvar_t	*r_mapOverBrightBits;
 
 extern	cvar_t	*r_debugSurface;
 extern	cvar_t	*r_simpleMipMaps;
+extern	cvar_t	*r_shaderCache;
+extern	cvar_t	*r_imageUploadBatchMB;
+extern	cvar_t	*r_imageCacheMB;
 
 extern	cvar_t	*r_showImages;
 extern	cvar_t	*r_debugSort;
@@ -1324,6 +1384,8 @@ qboolean	RE_RegisterModels_LevelLoadEnd(qboolean bDeleteEverythingNotUsedThisLev
 void*		RE_RegisterModels_Malloc(int iSize, void *pvDiskBufferIfJustLoaded, const char *psModelFileName, qboolean *pqbAlreadyFound, memtag_t eTag);
 void		RE_RegisterModels_StoreShaderRequest(const char *psModelFileName, const char *psShaderName, const int *piShaderIndexPoke);
 void		RE_RegisterModels_Info_f(void);
+void		G2_PoseCache_Info_f(void);
+void		G2_PoseCache_Clear(void);
 qboolean	RE_RegisterImages_LevelLoadEnd(void);
 void		RE_RegisterImages_Info_f(void);
 
@@ -1436,6 +1498,10 @@ struct shaderCommands_s
 
 	//rww - doing a fade, don't compute shader color/alpha overrides
 	bool		fading;
+
+	// static world surfaces drawn straight from the world vertex buffer, on top of the arrays above
+	int			numVBOVertexes;
+	int			numVBOIndexes;
 };
 
 #ifdef _MSC_VER
@@ -1456,6 +1522,9 @@ void RB_CheckOverflow( int verts, int indexes );
 
 void RB_StageIteratorGeneric( void );
 void RB_StageIteratorSky( void );
+void RB_StageIteratorWorldVBO( void );
+qboolean RB_ShaderCanUseWorldVBO( const shader_t *shader );
+qboolean RB_WorldVBOBatchAllowed( void );
 
 void RB_AddQuadStamp( vec3_t origin, vec3_t left, vec3_t up, byte *color );
 void RB_AddQuadStampExt( vec3_t origin, vec3_t left, vec3_t up, byte *color, float s1, float t1, float s2, float t2 );
@@ -1472,6 +1541,17 @@ WORLD MAP
 
 void R_AddBrushModelSurfaces( trRefEntity_t *e );
 void R_AddWorldSurfaces( void );
+void R_BuildWorldLeafs( world_t *world );
+
+// tr_vbo.cpp
+void R_BuildWorldVBO( world_t *world );
+void R_DeleteWorldVBO( void );
+void RB_ClearWorldVBOBatch( void );
+qboolean RB_AddWorldVBOSurface( const worldVBORange_t *range, int dlightBits );
+qboolean RB_AddWorldVBOGrid( const srfGridMesh_t *cv, int dlightBits, int lod );
+void RB_BeginWorldVBOBatch( void );
+void RB_DrawWorldVBOElements( void );
+void RB_EndWorldVBOBatch( void );
 
 
 /*
@@ -1485,6 +1565,8 @@ LIGHTS
 void R_DlightBmodel( bmodel_t *bmodel, qboolean NoLight );
 void R_SetupEntityLighting( const trRefdef_t *refdef, trRefEntity_t *ent );
 void R_TransformDlights( int count, dlight_t *dl, orientationr_t *ori );
+void R_SetupDlightClusters( void );
+int R_DlightClusterBits( const vec3_t mins, const vec3_t maxs );
 
 
 /*
@@ -1496,6 +1578,8 @@ SHADOWS
 */
 
 void RB_ShadowTessEnd( void );
+void RB_AddShadowEdges( const byte *edgeMasks, int numTriangles );
+byte *R_BuildShadowEdges( const int *indexes, int numTriangles, int numVertexes );
 void RB_ShadowFinish( void );
 void RB_ProjectionShadowDeform( void );
 
@@ -1522,6 +1606,7 @@ CURVE TESSELATION
 */
 srfGridMesh_t *R_SubdividePatchToGrid( int width, int height,
 								drawVert_t points[MAX_PATCH_SIZE*MAX_PATCH_SIZE] );
+void R_GridLodTables( const srfGridMesh_t *cv, int lod, int *widthTable, int *lodWidth, int *heightTable, int *lodHeight );
 /*
 Ghoul2 Insert Start
 */
@@ -1586,7 +1671,9 @@ public:
 	const int		ident;			// ident of this surface - required so the materials renderer knows what sort of surface this refers to
 #endif
  	CBoneCache 		*boneCache;		// pointer to transformed bone list for this surf
+	const mdxaBone_t	*bones;		// with r_smp, a copy of the bones in surfaceData's bone reference order, taken by the front end
 	mdxmSurface_t	*surfaceData;	// pointer to surface data loaded into file - only used by client renderer DO NOT USE IN GAME SIDE - if there is a vid restart this will be out of wack on the game
+	const byte		*shadowEdges;	// for stencil shadow surfaces, which edges to extrude, NULL for all of them
 #ifdef _G2_GORE
 	float			*alternateTex;		// alternate texture coordinates.
 	void			*goreChain;
@@ -1601,7 +1688,9 @@ public:
 	{
 		ident	 = src.ident;
 		boneCache = src.boneCache;
+		bones = src.bones;
 		surfaceData = src.surfaceData;
+		shadowEdges = src.shadowEdges;
 		alternateTex = src.alternateTex;
 		goreChain = src.goreChain;
 
@@ -1612,19 +1701,24 @@ public:
 CRenderableSurface():
 	ident(SF_MDX),
 	boneCache(0),
+	bones(0),
 #ifdef _G2_GORE
 	surfaceData(0),
+	shadowEdges(0),
 	alternateTex(0),
 	goreChain(0)
 #else
-	surfaceData(0)
+	surfaceData(0),
+	shadowEdges(0)
 #endif
 	{}
 
 	void Init()
 	{
 		boneCache=0;
+		bones=0;
 		surfaceData=0;
+		shadowEdges=0;
 #ifdef _G2_GORE
 		ident = SF_MDX;
 		alternateTex=0;
@@ -1737,6 +1831,21 @@ typedef struct {
 	float	s2, t2;
 } stretchPicCommand_t;
 
+typedef struct {
+	shader_t	*shader;
+	float	x, y;
+	float	w, h;
+	float	s1, t1;
+	float	s2, t2;
+} stretchPic_t;
+
+// a run of pics sharing the current colour, used for whole strings of text
+typedef struct {
+	int		commandId;
+	int		numPics;
+	stretchPic_t	pics[1];	// numPics long
+} stretchPicsCommand_t;
+
 typedef struct {
 	int		commandId;
 	shader_t	*shader;
@@ -1778,6 +1887,7 @@ typedef enum {
 	RC_DRAW_BUFFER,
 	RC_SWAP_BUFFERS,
 	RC_WORLD_EFFECTS,
+	RC_STRETCH_PICS,
 } renderCommand_t;
 
 
@@ -1798,18 +1908,26 @@ typedef struct {
 	renderCommandList_t	commands;
 } backEndData_t;
 
-extern	backEndData_t	*backEndData;
+extern	backEndData_t	*backEndData[SMP_FRAMES];	// the second is only allocated with r_smp
 
 void *R_GetCommandBuffer( int bytes );
 void RB_ExecuteRenderCommands( const void *data );
 
 void R_IssuePendingRenderCommands( void );
+void R_SyncRenderThread( void );
+qboolean R_OnRenderThread( void );
+void R_InitRenderThread( void );
+void R_ShutdownRenderThread( void );
+void R_AllocRenderBones( void );
+void R_FreeRenderBones( void );
 
 void R_AddDrawSurfCmd( drawSurf_t *drawSurfs, int numDrawSurfs );
 
 void RE_SetColor( const float *rgba );
 void RE_StretchPic ( float x, float y, float w, float h,
 					  float s1, float t1, float s2, float t2, qhandle_t hShader );
+#define MAX_STRETCH_PICS_PER_COMMAND	256
+stretchPic_t *R_AddStretchPics( int numPics );
 void RE_RotatePic ( float x, float y, float w, float h,
 					  float s1, float t1, float s2, float t2,float a, qhandle_t hShader );
 void RE_RotatePic2 ( float x, float y, float w, float h,
@@ -1843,3 +1961,4 @@ Ghoul2 Insert End
 
 // tr_surfacesprites
 void RB_DrawSurfaceSprites( shaderStage_t *stage, shaderCommands_t *input);
+void R_ClearSurfaceSpriteCache( void );
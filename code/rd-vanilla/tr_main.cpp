@@ -1380,6 +1380,8 @@ R_GenerateDrawSurfs
 ====================
 */
 void R_GenerateDrawSurfs( void ) {
+	R_SetupDlightClusters ();
+
 	R_AddWorldSurfaces ();
 
 	R_AddPolygonSurfaces();
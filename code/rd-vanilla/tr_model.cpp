@@ -308,6 +308,11 @@ qboolean RE_RegisterModels_LevelLoadEnd(qboolean bDeleteEverythingNotUsedThisLev
 		}
 	}
 
+	if (bAtLeastoneModelFreed)
+	{
+		G2_PoseCache_Clear();
+	}
+
 	//ri.Printf( PRINT_DEVELOPER, "RE_RegisterModels_LevelLoadEnd(): Ok\n");
 
 	return bAtLeastoneModelFreed;
@@ -356,6 +361,7 @@ static void RE_RegisterModels_DeleteAll(void)
 
 		CachedModels->erase(itModel++);
 	}
+	G2_PoseCache_Clear();
 
 	extern void RE_AnimationCFGs_DeleteAll(void);
 	RE_AnimationCFGs_DeleteAll();
@@ -417,6 +423,8 @@ void RE_RegisterMedia_LevelLoadBegin(const char *psMapName, ForceReload_e eForce
 		Q_strncpyz( sPrevMapName, psMapName, sizeof(sPrevMapName) );
 		giRegisterMedia_CurrentLevel++;
 	}
+
+	R_Images_LevelLoadBegin();
 }
 
 int RE_RegisterMedia_GetLevel(void)
@@ -50,7 +50,10 @@ R_InitNextFrame
 */
 void R_InitNextFrame( void ) {
 
-	backEndData->commands.used = 0;
+	// the render thread is still drawing the frame that was just issued, so build this one in the other set
+	tr.smpFrame = tr.smpActive ? tr.smpFrame ^ 1 : 0;
+
+	backEndData[tr.smpFrame]->commands.used = 0;
 
 	r_firstSceneDrawSurf = 0;
 
@@ -145,11 +148,11 @@ void RE_AddPolyToScene( qhandle_t hShader , int numVerts, const polyVert_t *vert
 		return;
 	}
 
-	poly = &backEndData->polys[r_numpolys];
+	poly = &backEndData[tr.smpFrame]->polys[r_numpolys];
 	poly->surfaceType = SF_POLY;
 	poly->hShader = hShader;
 	poly->numVerts = numVerts;
-	poly->verts = &backEndData->polyVerts[r_numpolyverts];
+	poly->verts = &backEndData[tr.smpFrame]->polyVerts[r_numpolyverts];
 
 	memcpy( poly->verts, verts, numVerts * sizeof( *verts ) );
 	r_numpolys++;
@@ -221,8 +224,8 @@ void RE_AddRefEntityToScene( const refEntity_t *ent ) {
 		Com_Error( ERR_DROP, "RE_AddRefEntityToScene: bad reType %i", ent->reType );
 	}
 
-	backEndData->entities[r_numentities].e = *ent;
-	backEndData->entities[r_numentities].lightingCalculated = qfalse;
+	backEndData[tr.smpFrame]->entities[r_numentities].e = *ent;
+	backEndData[tr.smpFrame]->entities[r_numentities].lightingCalculated = qfalse;
 
 	r_numentities++;
 }
@@ -246,7 +249,7 @@ void RE_AddLightToScene( const vec3_t org, float intensity, float r, float g, fl
 	if ( intensity <= 0 ) {
 		return;
 	}
-	dl = &backEndData->dlights[r_numdlights++];
+	dl = &backEndData[tr.smpFrame]->dlights[r_numdlights++];
 	VectorCopy (org, dl->origin);
 	dl->radius = intensity;
 	dl->color[0] = r;
@@ -353,15 +356,15 @@ void RE_RenderScene( const refdef_t *fd ) {
 	tr.refdef.floatTime = tr.refdef.time * 0.001;
 
 	tr.refdef.numDrawSurfs = r_firstSceneDrawSurf;
-	tr.refdef.drawSurfs = backEndData->drawSurfs;
+	tr.refdef.drawSurfs = backEndData[tr.smpFrame]->drawSurfs;
 
 	tr.refdef.num_entities = r_numentities - r_firstSceneEntity;
-	tr.refdef.entities = &backEndData->entities[r_firstSceneEntity];
+	tr.refdef.entities = &backEndData[tr.smpFrame]->entities[r_firstSceneEntity];
 	tr.refdef.num_dlights = r_numdlights - r_firstSceneDlight;
-	tr.refdef.dlights = &backEndData->dlights[r_firstSceneDlight];
+	tr.refdef.dlights = &backEndData[tr.smpFrame]->dlights[r_firstSceneDlight];
 
 	tr.refdef.numPolys = r_numpolys - r_firstScenePoly;
-	tr.refdef.polys = &backEndData->polys[r_firstScenePoly];
+	tr.refdef.polys = &backEndData[tr.smpFrame]->polys[r_firstScenePoly];
 
 	// turn off dynamic lighting globally by clearing all the
 	// dlights if it needs to be disabled or if vertex lighting is enabled
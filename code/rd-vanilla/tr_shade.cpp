@@ -28,6 +28,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#include "qcommon/q_dlight.h"
+
 /*
 
   THIS ENTIRE FILE IS BACK END
@@ -229,12 +231,18 @@ void R_BindAnimatedImage( const textureBundle_t *bundle) {
 	int		index;
 
 	if ( bundle->isVideoMap ) {
+		if ( R_OnRenderThread() && bundle->videoMapHandle >= 0 && bundle->videoMapHandle < NUM_SCRATCH_IMAGES ) {
+			// draw the last uploaded frame, the front end advances the cinematic before the next batch
+			GL_Bind( tr.scratchImage[bundle->videoMapHandle] );
+			backEnd.smpVideoMaps |= 1 << bundle->videoMapHandle;
+			return;
+		}
 		ri.CIN_RunCinematic(bundle->videoMapHandle);
 		ri.CIN_UploadCinematic(bundle->videoMapHandle);
 		return;
 	}
 
-	if ((r_fullbright->integer || tr.refdef.doLAGoggles || (tr.refdef.rdflags & RDF_doFullbright) ) && bundle->isLightmap)
+	if ((r_fullbright->integer || backEnd.refdef.doLAGoggles || (backEnd.refdef.rdflags & RDF_doFullbright) ) && bundle->isLightmap)
 	{
 		GL_Bind( tr.whiteImage );
 		return;
@@ -441,6 +449,10 @@ void RB_BeginSurface( shader_t *shader, int fogNum ) {
 
 	tess.fading = false;
 
+	tess.numVBOVertexes = 0;
+	tess.numVBOIndexes = 0;
+	RB_ClearWorldVBOBatch();
+
 	tess.registration++;
 }
 
@@ -649,6 +661,127 @@ static void ProjectDlightTexture( void ) {
 }
 */
 
+static byte	tessDlightClipCodes[MAX_DLIGHTS][SHADER_MAX_VERTEXES];
+static int	dlightClipRows[MAX_DLIGHTS];
+
+/*
+===================
+RB_SurfaceDlights
+
+The dlights the front end found touching the surfaces in tess
+===================
+*/
+static int RB_SurfaceDlights( void ) {
+	if ( backEnd.refdef.num_dlights < MAX_DLIGHTS ) {
+		return tess.dlightBits & ( ( 1 << backEnd.refdef.num_dlights ) - 1 );
+	}
+	return tess.dlightBits;
+}
+
+/*
+===================
+RB_ClipDlights
+
+Works out the clip codes of every vertex against the box around each light,
+four lights at a time, and drops the lights that can't reach any triangle
+===================
+*/
+static int RB_ClipDlights( int lights ) {
+	float	spheres[MAX_DLIGHTS][4];
+	int		lightNums[MAX_DLIGHTS];
+	int		i, count;
+	unsigned int	reached;
+
+	count = 0;
+	for ( i = 0 ; i < backEnd.refdef.num_dlights ; i++ ) {
+		const dlight_t	*dl = &backEnd.refdef.dlights[i];
+
+		if ( !( lights & ( 1 << i ) ) ) {
+			continue;
+		}
+		VectorCopy( dl->transformed, spheres[count] );
+		spheres[count][3] = dl->radius;
+		dlightClipRows[i] = count;
+		lightNums[count++] = i;
+	}
+
+	reached = Q::dlightClipCodes( (const float (*)[4])tess.xyz, tess.numVertexes, spheres, count, tessDlightClipCodes[0], SHADER_MAX_VERTEXES );
+
+	lights = 0;
+	for ( i = 0 ; i < count ; i++ ) {
+		if ( reached & ( 1u << i ) ) {
+			lights |= 1 << lightNums[i];
+		}
+	}
+	return lights;
+}
+
+/*
+===================
+RB_CapDlights
+
+Keeps the r_dlightSurfaceMax strongest lights on the surface, so piling up
+lights costs a fixed number of passes instead of one more pass per light
+===================
+*/
+static int RB_CapDlights( int lights ) {
+	const int	cap = r_dlightSurfaceMax->integer;
+	float		weights[MAX_DLIGHTS];
+	vec3_t		mins, maxs;
+	int			i, l, count, kept;
+
+	if ( cap <= 0 ) {
+		return lights;
+	}
+
+	count = 0;
+	for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ ) {
+		if ( lights & ( 1 << l ) ) {
+			count++;
+		}
+	}
+	if ( count <= cap ) {
+		return lights;
+	}
+
+	ClearBounds( mins, maxs );
+	for ( i = 0 ; i < tess.numVertexes ; i++ ) {
+		AddPointToBounds( tess.xyz[i], mins, maxs );
+	}
+
+	// brighter, bigger and closer lights first
+	for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ ) {
+		const dlight_t	*dl = &backEnd.refdef.dlights[l];
+		float			distSquared = 0;
+
+		if ( !( lights & ( 1 << l ) ) ) {
+			continue;
+		}
+		for ( i = 0 ; i < 3 ; i++ ) {
+			float d = 0;
+			if ( dl->transformed[i] < mins[i] ) {
+				d = mins[i] - dl->transformed[i];
+			} else if ( dl->transformed[i] > maxs[i] ) {
+				d = dl->transformed[i] - maxs[i];
+			}
+			distSquared += d * d;
+		}
+		weights[l] = dl->radius * dl->radius * ( dl->color[0] + dl->color[1] + dl->color[2] ) / ( 1.0f + distSquared );
+	}
+
+	kept = 0;
+	for ( i = 0 ; i < cap ; i++ ) {
+		int best = -1;
+		for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ ) {
+			if ( ( lights & ~kept & ( 1 << l ) ) && ( best < 0 || weights[l] > weights[best] ) ) {
+				best = l;
+			}
+		}
+		kept |= 1 << best;
+	}
+	return kept;
+}
+
 // Lifted from Quake III to see if people like this kind of dlight better
 /*
 ===================
@@ -659,8 +792,8 @@ Perform dynamic lighting with another rendering pass
 */
 static void ProjectDlightTexture2( void ) {
 	int		i, l;
+	int		lights;
 	vec3_t	origin;
-	byte	clipBits[SHADER_MAX_VERTEXES];
 	float	texCoordsArray[SHADER_MAX_VERTEXES][2];
 	float	oldTexCoordsArray[SHADER_MAX_VERTEXES][2];
 	float	vertCoordsArray[SHADER_MAX_VERTEXES][4];
@@ -690,11 +823,14 @@ static void ProjectDlightTexture2( void ) {
 		return;
 	}
 
+	// lights that can't reach any triangle are already dropped
+	lights = RB_CapDlights( RB_ClipDlights( RB_SurfaceDlights() ) );
+
 	for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ )
 	{
 		dlight_t	*dl;
 
-		if ( !( tess.dlightBits & ( 1 << l ) ) ) {
+		if ( !( lights & ( 1 << l ) ) ) {
 			continue;	// this surface definately doesn't have any of this light
 		}
 
@@ -702,45 +838,7 @@ static void ProjectDlightTexture2( void ) {
 		VectorCopy( dl->transformed, origin );
 		radius = dl->radius;
 
-		int		clipall = 63;
-		for ( i = 0 ; i < tess.numVertexes ; i++)
-		{
-			int		clip;
-			VectorSubtract( origin, tess.xyz[i], dist );
-
-			clip = 0;
-			if (  dist[0] < -radius )
-			{
-				clip |= 1;
-			}
-			else if ( dist[0] > radius )
-			{
-				clip |= 2;
-			}
-			if (  dist[1] < -radius )
-			{
-				clip |= 4;
-			}
-			else if ( dist[1] > radius )
-			{
-				clip |= 8;
-			}
-			if (  dist[2] < -radius )
-			{
-				clip |= 16;
-			}
-			else if ( dist[2] > radius )
-			{
-				clip |= 32;
-			}
-
-			clipBits[i] = clip;
-			clipall &= clip;
-		}
-		if ( clipall )
-		{
-			continue;	// this surface doesn't have any of this light
-		}
+		const byte *clipBits = tessDlightClipCodes[dlightClipRows[l]];
 		floatColor[0] = dl->color[0] * 255.0f;
 		floatColor[1] = dl->color[1] * 255.0f;
 		floatColor[2] = dl->color[2] * 255.0f;
@@ -1002,15 +1100,18 @@ static void ProjectDlightTexture( void ) {
 #endif
 	vec3_t	floatColor;
 	shaderStage_t *dStage;
+	int		lights;
 
 	if ( !backEnd.refdef.num_dlights ) {
 		return;
 	}
 
+	lights = RB_CapDlights( RB_SurfaceDlights() );
+
 	for ( l = 0 ; l < backEnd.refdef.num_dlights ; l++ ) {
 		dlight_t	*dl;
 
-		if ( !( tess.dlightBits & ( 1 << l ) ) ) {
+		if ( !( lights & ( 1 << l ) ) ) {
 			continue;	// this surface definately doesn't have any of this light
 		}
 
@@ -1797,13 +1898,18 @@ static vec4_t	GLFogOverrideColors[GLFOGOVERRIDE_MAX] =
 
 static const float logtestExp2 = (sqrt( -log( 1.0 / 255.0 ) ));
 #endif
-extern bool tr_stencilled; //tr_backend.cpp
-static void RB_IterateStagesGeneric( shaderCommands_t *input )
-{
-	int stage;
 #ifndef JK2_MODE
-	bool	UseGLFog = false;
-	bool	FogColorChange = false;
+/*
+==================
+RB_SetupGLFog
+
+With r_drawfog 2 the global fog and the "special fog" are drawn with
+hardware fog instead of a fog pass. Turns it on and returns the fog if
+this batch is in one of them.
+==================
+*/
+static fog_t *RB_SetupGLFog( void )
+{
 	fog_t	*fog = NULL;
 
 	if (tess.fogNum && tess.shader->fogPass && (tess.fogNum == tr.world->globalFog || tess.fogNum == tr.world->numfogs)
@@ -1861,8 +1967,36 @@ static void RB_IterateStagesGeneric( shaderCommands_t *input )
 		}
 
 		qglEnable(GL_FOG);
-		UseGLFog = true;
 	}
+	return fog;
+}
+
+/*
+==================
+RB_DisableGLFog
+
+Hardware fog stays on until after the surface sprites
+==================
+*/
+static void RB_DisableGLFog( void )
+{
+	if (r_drawfog->value == 2 &&
+		tess.fogNum && tess.shader->fogPass &&
+		(tess.fogNum == tr.world->globalFog || tess.fogNum == tr.world->numfogs))
+	{
+		qglDisable(GL_FOG);
+	}
+}
+#endif
+
+extern bool tr_stencilled; //tr_backend.cpp
+static void RB_IterateStagesGeneric( shaderCommands_t *input )
+{
+	int stage;
+#ifndef JK2_MODE
+	bool	FogColorChange = false;
+	fog_t	*fog = RB_SetupGLFog();
+	bool	UseGLFog = fog != NULL;
 #endif
 
 	for ( stage = 0; stage < input->shader->numUnfoggedPasses; stage++ )
@@ -2184,15 +2318,289 @@ void RB_StageIteratorGeneric( void )
 
 #ifndef JK2_MODE
 	//don't disable the hardware fog til after we do surface sprites
-	if (r_drawfog->value == 2 &&
-		tess.fogNum && tess.shader->fogPass &&
-		(tess.fogNum == tr.world->globalFog || tess.fogNum == tr.world->numfogs))
+	RB_DisableGLFog();
+#endif
+}
+
+
+/*
+=================
+R_WorldVBOStageColor
+
+World vertex buffer surfaces skip ComputeColors, so a stage can only be
+drawn from the buffer if it gives every vertex the same colour, or the
+vertex colours as they are. Matches what ComputeColors does for those.
+=================
+*/
+enum {
+	WORLDVBO_COLOR_NONE,		// needs ComputeColors
+	WORLDVBO_COLOR_CONST,
+	WORLDVBO_COLOR_VERTEX
+};
+
+static int R_WorldVBOStageColor( const shaderStage_t *pStage, byte *color )
+{
+	switch ( pStage->rgbGen )
 	{
-		qglDisable(GL_FOG);
+	case CGEN_IDENTITY:
+		color[0] = color[1] = color[2] = color[3] = 0xff;
+		break;
+	case CGEN_IDENTITY_LIGHTING:
+		color[0] = color[1] = color[2] = color[3] = tr.identityLightByte;
+		break;
+	case CGEN_CONST:
+		memcpy( color, pStage->constantColor, 4 );
+		break;
+	case CGEN_EXACT_VERTEX:
+		return ( pStage->alphaGen == AGEN_VERTEX || pStage->alphaGen == AGEN_SKIP ) ? WORLDVBO_COLOR_VERTEX : WORLDVBO_COLOR_NONE;
+	case CGEN_VERTEX:
+		if ( tr.identityLight != 1 )
+		{
+			return WORLDVBO_COLOR_NONE;
+		}
+		return ( pStage->alphaGen == AGEN_VERTEX || pStage->alphaGen == AGEN_SKIP || pStage->alphaGen == AGEN_IDENTITY ) ? WORLDVBO_COLOR_VERTEX : WORLDVBO_COLOR_NONE;
+	default:
+		return WORLDVBO_COLOR_NONE;
 	}
+
+	switch ( pStage->alphaGen )
+	{
+	case AGEN_SKIP:
+		break;
+	case AGEN_IDENTITY:
+		color[3] = 0xff;
+		break;
+	case AGEN_CONST:
+		color[3] = pStage->constantColor[3];
+		break;
+	default:
+		return WORLDVBO_COLOR_NONE;
+	}
+	return WORLDVBO_COLOR_CONST;
+}
+
+/*
+=================
+RB_ShaderCanUseWorldVBO
+
+Whether surfaces with this shader can always be drawn from the world
+vertex buffer: no deforms, texture mods or generated texture coordinates,
+and no per vertex colour work.
+=================
+*/
+qboolean RB_ShaderCanUseWorldVBO( const shader_t *shader )
+{
+	byte	color[4];
+
+	if ( shader->sky || shader->numDeforms || shader == tr.distortionShader || shader == tr.shadowShader )
+	{
+		return qfalse;
+	}
+	// vertex lit surfaces get their colours from the light styles every frame
+	if ( shader->lightmapIndex[0] == LIGHTMAP_BY_VERTEX )
+	{
+		return qfalse;
+	}
+
+	for ( int stage = 0; stage < shader->numUnfoggedPasses; stage++ )
+	{
+		const shaderStage_t *pStage = &shader->stages[stage];
+		if ( !pStage->active )
+		{
+			break;
+		}
+		if ( pStage->ss && pStage->ss->surfaceSpriteType )
+		{
+			return qfalse;
+		}
+		if ( R_WorldVBOStageColor( pStage, color ) == WORLDVBO_COLOR_NONE )
+		{
+			return qfalse;
+		}
+		for ( int b = 0; b < NUM_TEXTURE_BUNDLES; b++ )
+		{
+			const textureBundle_t *bundle = &pStage->bundle[b];
+			if ( b && !bundle->image )
+			{
+				break;
+			}
+			if ( bundle->numTexMods || ( bundle->tcGen != TCGEN_TEXTURE && bundle->tcGen != TCGEN_LIGHTMAP ) )
+			{
+				return qfalse;
+			}
+		}
+	}
+	return qtrue;
+}
+
+/*
+=================
+RB_WorldVBOBatchAllowed
+
+Whether the current batch can take surfaces from the world vertex buffer,
+everything that would have to look at the tess arrays keeps it off.
+=================
+*/
+qboolean RB_WorldVBOBatchAllowed( void )
+{
+	if ( backEnd.currentEntity != &tr.worldEntity || backEnd.projection2D )
+	{
+		return qfalse;
+	}
+	if ( tess.currentStageIteratorFunc != RB_StageIteratorGeneric )
+	{
+		return qfalse;
+	}
+	if ( r_lightmap->integer || r_debugStyle->integer >= 0 || r_showtris->integer || r_shownormals->integer
+		|| ( r_primitives->integer != 0 && r_primitives->integer != 2 ) )
+	{
+		return qfalse;
+	}
+	if ( tess.fogNum && tess.shader->fogPass )
+	{
+		// the fog pass and fog colour adjustments are per vertex
+#ifdef JK2_MODE
+		if ( r_drawfog->value )
+#else
+		if ( tr.world && (tess.fogNum != tr.world->globalFog || r_drawfog->value != 2) && r_drawfog->value )
 #endif
+		{
+			return qfalse;
+		}
+	}
+	if ( tess.fogNum )
+	{
+		for ( int stage = 0; stage < tess.shader->numUnfoggedPasses; stage++ )
+		{
+			if ( !tess.xstages[stage].active )
+			{
+				break;
+			}
+			if ( tess.xstages[stage].adjustColorsForFog != ACFF_NONE )
+			{
+				return qfalse;
+			}
+		}
+	}
+	return RB_ShaderCanUseWorldVBO( tess.shader );
 }
 
+/*
+** RB_StageIteratorWorldVBO
+
+RB_StageIteratorGeneric for the world vertex buffer surfaces of a batch,
+only what RB_WorldVBOBatchAllowed lets through needs handling here
+*/
+void RB_StageIteratorWorldVBO( void )
+{
+#ifndef JK2_MODE
+	bool	FogColorChange = false;
+	fog_t	*fog;
+#endif
+
+	GL_Cull( tess.shader->cullType );
+
+	if ( tess.shader->polygonOffset )
+	{
+		qglEnable( GL_POLYGON_OFFSET_FILL );
+		qglPolygonOffset( r_offsetFactor->value, r_offsetUnits->value );
+	}
+
+#ifndef JK2_MODE
+	fog = RB_SetupGLFog();
+#endif
+
+	RB_BeginWorldVBOBatch();
+
+	for ( int stage = 0; stage < tess.shader->numUnfoggedPasses; stage++ )
+	{
+		shaderStage_t	*pStage = &tess.xstages[stage];
+		byte			color[4];
+
+		if ( !pStage->active )
+		{
+			break;
+		}
+		if ( g_bRenderGlowingObjects && !pStage->glow )
+		{
+			continue;
+		}
+
+#ifndef JK2_MODE
+		if ( fog )
+		{
+			if ( pStage->mGLFogColorOverride )
+			{
+				qglFogfv( GL_FOG_COLOR, GLFogOverrideColors[pStage->mGLFogColorOverride] );
+				FogColorChange = true;
+			}
+			else if ( FogColorChange )
+			{
+				FogColorChange = false;
+				qglFogfv( GL_FOG_COLOR, fog->parms.color );
+			}
+		}
+#endif
+
+		if ( R_WorldVBOStageColor( pStage, color ) == WORLDVBO_COLOR_CONST )
+		{
+			qglDisableClientState( GL_COLOR_ARRAY );
+			qglColor4ubv( color );
+		}
+		else
+		{
+			qglEnableClientState( GL_COLOR_ARRAY );
+			qglColorPointer( 4, GL_UNSIGNED_BYTE, sizeof( worldVBOVertex_t ), (const void *)offsetof( worldVBOVertex_t, color ) );
+		}
+
+		qglEnableClientState( GL_TEXTURE_COORD_ARRAY );
+		qglTexCoordPointer( 2, GL_FLOAT, sizeof( worldVBOVertex_t ),
+			(const void *)( pStage->bundle[0].tcGen == TCGEN_LIGHTMAP ? offsetof( worldVBOVertex_t, lightmap ) : offsetof( worldVBOVertex_t, st ) ) );
+		R_BindAnimatedImage( &pStage->bundle[0] );
+		GL_State( pStage->stateBits );
+
+		if ( pStage->bundle[1].image )
+		{
+			GL_SelectTexture( 1 );
+			qglEnable( GL_TEXTURE_2D );
+			qglEnableClientState( GL_TEXTURE_COORD_ARRAY );
+			GL_TexEnv( tess.shader->multitextureEnv );
+			qglTexCoordPointer( 2, GL_FLOAT, sizeof( worldVBOVertex_t ),
+				(const void *)( pStage->bundle[1].tcGen == TCGEN_LIGHTMAP ? offsetof( worldVBOVertex_t, lightmap ) : offsetof( worldVBOVertex_t, st ) ) );
+			R_BindAnimatedImage( &pStage->bundle[1] );
+
+			RB_DrawWorldVBOElements();
+
+			// the pointer refers to the buffer, don't leave it enabled for the tess path
+			qglDisableClientState( GL_TEXTURE_COORD_ARRAY );
+			qglDisable( GL_TEXTURE_2D );
+			GL_SelectTexture( 0 );
+		}
+		else
+		{
+			RB_DrawWorldVBOElements();
+		}
+	}
+
+#ifndef JK2_MODE
+	if ( FogColorChange )
+	{
+		qglFogfv( GL_FOG_COLOR, fog->parms.color );
+	}
+#endif
+
+	qglEnableClientState( GL_COLOR_ARRAY );
+	RB_EndWorldVBOBatch();
+
+	if ( tess.shader->polygonOffset )
+	{
+		qglDisable( GL_POLYGON_OFFSET_FILL );
+	}
+
+#ifndef JK2_MODE
+	RB_DisableGLFog();
+#endif
+}
 
 /*
 ** RB_EndSurface
@@ -2202,7 +2610,7 @@ void RB_EndSurface( void ) {
 
 	input = &tess;
 
-	if (input->numIndexes == 0) {
+	if (input->numIndexes == 0 && input->numVBOIndexes == 0) {
 		return;
 	}
 
@@ -2252,9 +2660,9 @@ void RB_EndSurface( void ) {
 	if (!backEnd.projection2D)
 	{
 		backEnd.pc.c_shaders++;
-		backEnd.pc.c_vertexes += tess.numVertexes;
-		backEnd.pc.c_indexes += tess.numIndexes;
-		backEnd.pc.c_totalIndexes += tess.numIndexes * tess.numPasses;
+		backEnd.pc.c_vertexes += tess.numVertexes + tess.numVBOVertexes;
+		backEnd.pc.c_indexes += tess.numIndexes + tess.numVBOIndexes;
+		backEnd.pc.c_totalIndexes += ( tess.numIndexes + tess.numVBOIndexes ) * tess.numPasses;
 #ifdef JK2_MODE
 		if (tess.fogNum && tess.shader->fogPass && r_drawfog->value)
 #else
@@ -2265,6 +2673,16 @@ void RB_EndSurface( void ) {
 		}
 	}
 
+	if ( tess.numVBOIndexes )
+	{
+		RB_StageIteratorWorldVBO();
+		if ( tess.numIndexes == 0 )
+		{
+			GLimp_LogComment( "----------\n" );
+			return;
+		}
+	}
+
 	//
 	// call off to shader specific tess end function
 	//
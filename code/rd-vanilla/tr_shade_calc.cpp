@@ -27,6 +27,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 #include "../rd-common/tr_common.h"
+#include "qcommon/q_shadecalc.h"
 #define	WAVEVALUE( table, base, amplitude, phase, freq )  ((base) + table[ Q_ftol( ( ( (phase) + backEnd.refdef.floatTime * (freq) ) * FUNCTABLE_SIZE ) ) & FUNCTABLE_MASK ] * (amplitude))
 
 static float *TableForFunc( genFunc_t func )
@@ -128,45 +129,20 @@ RB_CalcDeformVertexes
 */
 void RB_CalcDeformVertexes( deformStage_t *ds )
 {
-	int i;
-	vec3_t	offset;
-	float	scale;
-	float	*xyz = ( float * ) tess.xyz;
-	float	*normal = ( float * ) tess.normal;
-	float	*table;
-
 	if ( ds->deformationWave.frequency == 0 )
 	{
-		scale = EvalWaveForm( &ds->deformationWave );
-
-		for ( i = 0; i < tess.numVertexes; i++, xyz += 4, normal += 4 )
-		{
-			VectorScale( normal, scale, offset );
-
-			xyz[0] += offset[0];
-			xyz[1] += offset[1];
-			xyz[2] += offset[2];
-		}
+		Q::deformVertexes( tess.xyz, tess.normal, tess.numVertexes, EvalWaveForm( &ds->deformationWave ) );
 	}
 	else
 	{
-		table = TableForFunc( ds->deformationWave.func );
-
-		for ( i = 0; i < tess.numVertexes; i++, xyz += 4, normal += 4 )
-		{
-			float off = ( xyz[0] + xyz[1] + xyz[2] ) * ds->deformationSpread;
-
-			scale = WAVEVALUE( table, ds->deformationWave.base,
-				ds->deformationWave.amplitude,
-				ds->deformationWave.phase + off,
-				ds->deformationWave.frequency );
-
-			VectorScale( normal, scale, offset );
-
-			xyz[0] += offset[0];
-			xyz[1] += offset[1];
-			xyz[2] += offset[2];
-		}
+		// same as WAVEVALUE with the vertex's offset added to the phase
+		Q::deformVertexesWave( tess.xyz, tess.normal, tess.numVertexes,
+			TableForFunc( ds->deformationWave.func ), FUNCTABLE_SIZE,
+			ds->deformationWave.base,
+			ds->deformationWave.amplitude,
+			ds->deformationWave.phase,
+			backEnd.refdef.floatTime * ds->deformationWave.frequency,
+			ds->deformationSpread );
 	}
 }
 
@@ -688,10 +664,8 @@ void RB_CalcAlphaFromOneMinusEntity( unsigned char *dstColors )
 */
 void RB_CalcWaveColor( const waveForm_t *wf, unsigned char *dstColors )
 {
-	int i;
 	int v;
 	float glow;
-	int *colors = ( int * ) dstColors;
 	byte	color[4];
 
 	if ( wf->func == GF_NOISE ) {
@@ -713,9 +687,7 @@ void RB_CalcWaveColor( const waveForm_t *wf, unsigned char *dstColors )
 
 	byteAlias_t *ba = (byteAlias_t *)&color;
 
-	for ( i = 0; i < tess.numVertexes; i++ ) {
-		*colors++ = ba->i;
-	}
+	Q::fillColors( ( uint32_t * ) dstColors, tess.numVertexes, ba->ui );
 }
 
 /*
@@ -741,7 +713,6 @@ void RB_CalcWaveAlpha( const waveForm_t *wf, unsigned char *dstColors )
 ** RB_CalcModulateColorsByFog
 */
 void RB_CalcModulateColorsByFog( unsigned char *colors ) {
-	int i;
 	float	texCoords[SHADER_MAX_VERTEXES][2];
 
 	// calculate texcoords so we can derive density
@@ -749,19 +720,13 @@ void RB_CalcModulateColorsByFog( unsigned char *colors ) {
 	// been previously called if the surface was opaque
 	RB_CalcFogTexCoords( texCoords[0] );
 
-	for ( i = 0; i < tess.numVertexes; i++, colors += 4 ) {
-		float f = 1.0 - R_FogFactor( texCoords[i][0], texCoords[i][1] );
-		colors[0] *= f;
-		colors[1] *= f;
-		colors[2] *= f;
-	}
+	Q::fogModulateColors( texCoords, tess.numVertexes, tr.fogTable, FOG_TABLE_SIZE, 7, ( uint8_t (*)[4] ) colors );
 }
 
 /*
 ** RB_CalcModulateAlphasByFog
 */
 void RB_CalcModulateAlphasByFog( unsigned char *colors ) {
-	int i;
 	float	texCoords[SHADER_MAX_VERTEXES][2];
 
 	// calculate texcoords so we can derive density
@@ -769,17 +734,13 @@ void RB_CalcModulateAlphasByFog( unsigned char *colors ) {
 	// been previously called if the surface was opaque
 	RB_CalcFogTexCoords( texCoords[0] );
 
-	for ( i = 0; i < tess.numVertexes; i++, colors += 4 ) {
-		float f = 1.0 - R_FogFactor( texCoords[i][0], texCoords[i][1] );
-		colors[3] *= f;
-	}
+	Q::fogModulateColors( texCoords, tess.numVertexes, tr.fogTable, FOG_TABLE_SIZE, 8, ( uint8_t (*)[4] ) colors );
 }
 
 /*
 ** RB_CalcModulateRGBAsByFog
 */
 void RB_CalcModulateRGBAsByFog( unsigned char *colors ) {
-	int i;
 	float	texCoords[SHADER_MAX_VERTEXES][2];
 
 	// calculate texcoords so we can derive density
@@ -787,13 +748,7 @@ void RB_CalcModulateRGBAsByFog( unsigned char *colors ) {
 	// been previously called if the surface was opaque
 	RB_CalcFogTexCoords( texCoords[0] );
 
-	for ( i = 0; i < tess.numVertexes; i++, colors += 4 ) {
-		float f = 1.0 - R_FogFactor( texCoords[i][0], texCoords[i][1] );
-		colors[0] *= f;
-		colors[1] *= f;
-		colors[2] *= f;
-		colors[3] *= f;
-	}
+	Q::fogModulateColors( texCoords, tess.numVertexes, tr.fogTable, FOG_TABLE_SIZE, 15, ( uint8_t (*)[4] ) colors );
 }
 
 
@@ -816,9 +771,6 @@ doesn't fit our shader data.
 */
 
 void RB_CalcFogTexCoords( float *st ) {
-	int			i;
-	float		*v;
-	float		s, t;
 	float		eyeT;
 	qboolean	eyeOutside;
 	fog_t		*fog;
@@ -869,30 +821,7 @@ void RB_CalcFogTexCoords( float *st ) {
 	fogDistanceVector[3] += 1.0/512;
 
 	// calculate density for each point
-	for (i = 0, v = tess.xyz[0] ; i < tess.numVertexes ; i++, v += 4) {
-		// calculate the length in fog
-		s = DotProduct( v, fogDistanceVector ) + fogDistanceVector[3];
-		t = DotProduct( v, fogDepthVector ) + fogDepthVector[3];
-
-		// partially clipped fogs use the T axis
-		if ( eyeOutside ) {
-			if ( t < 1.0 ) {
-				t = 1.0/32;	// point is outside, so no fogging
-			} else {
-				t = 1.0/32 + 30.0/32 * t / ( t - eyeT );	// cut the distance at the fog plane
-			}
-		} else {
-			if ( t < 0 ) {
-				t = 1.0/32;	// point is outside, so no fogging
-			} else {
-				t = 31.0/32;
-			}
-		}
-
-		st[0] = Q_isnan (s) ? 0.0f : s;
-		st[1] = Q_isnan (s) ? 0.0f : t;
-		st += 2;
-	}
+	Q::fogTexCoords( tess.xyz, tess.numVertexes, fogDistanceVector, fogDepthVector, eyeT, !!eyeOutside, ( float (*)[2] ) st );
 }
 
 
@@ -901,32 +830,11 @@ void RB_CalcFogTexCoords( float *st ) {
 */
 void RB_CalcEnvironmentTexCoords( float *st )
 {
-	int			i;
-	float		*v, *normal;
-	vec3_t		viewer;
-	float		d;
-
-	v = tess.xyz[0];
-	normal = tess.normal[0];
-
 	if (backEnd.currentEntity && backEnd.currentEntity->e.renderfx&RF_FIRST_PERSON)	//this is a view model so we must use world lights instead of vieworg
 	{
-		for (i = 0 ; i < tess.numVertexes ; i++, v += 4, normal += 4, st += 2 )
-		{
-			d = DotProduct (normal, backEnd.currentEntity->lightDir);
-			st[0] = normal[0]*d - backEnd.currentEntity->lightDir[0];
-			st[1] = normal[1]*d - backEnd.currentEntity->lightDir[1];
-		}
+		Q::environmentTexCoordsFromLight( tess.normal, tess.numVertexes, backEnd.currentEntity->lightDir, ( float (*)[2] ) st );
 	} else {	//the normal way
-		for (i = 0 ; i < tess.numVertexes ; i++, v += 4, normal += 4, st += 2 )
-		{
-			VectorSubtract (backEnd.ori.viewOrigin, v, viewer);
-			VectorNormalizeFast (viewer);
-
-			d = DotProduct (normal, viewer);
-			st[0] = normal[0]*d - 0.5*viewer[0];
-			st[1] = normal[1]*d - 0.5*viewer[1];
-		}
+		Q::environmentTexCoords( tess.xyz, tess.normal, tess.numVertexes, backEnd.ori.viewOrigin, ( float (*)[2] ) st );
 	}
 }
 
@@ -935,19 +843,11 @@ void RB_CalcEnvironmentTexCoords( float *st )
 */
 void RB_CalcTurbulentTexCoords( const waveForm_t *wf, float *st )
 {
-	int i;
 	float now;
 
 	now = ( wf->phase + backEnd.refdef.floatTime * wf->frequency );
 
-	for ( i = 0; i < tess.numVertexes; i++, st += 2 )
-	{
-		float s = st[0];
-		float t = st[1];
-
-		st[0] = s + tr.sinTable[ ( ( int ) ( ( ( tess.xyz[i][0] + tess.xyz[i][2] )* 1.0/128 * 0.125 + now ) * FUNCTABLE_SIZE ) ) & ( FUNCTABLE_MASK ) ] * wf->amplitude;
-		st[1] = t + tr.sinTable[ ( ( int ) ( ( tess.xyz[i][1] * 1.0/128 * 0.125 + now ) * FUNCTABLE_SIZE ) ) & ( FUNCTABLE_MASK ) ] * wf->amplitude;
-	}
+	Q::turbulentTexCoords( tess.xyz, tess.numVertexes, tr.sinTable, FUNCTABLE_SIZE, now, wf->amplitude, ( float (*)[2] ) st );
 }
 
 /*
@@ -1105,54 +1005,12 @@ void RB_CalcSpecularAlpha( unsigned char *alphas ) {
 */
 void RB_CalcDiffuseColor( unsigned char *colors )
 {
-	int				i, j;
-	float			*v, *normal;
-	float			incoming;
 	trRefEntity_t	*ent;
-	int				ambientLightInt;
-	vec3_t			ambientLight;
-	vec3_t			lightDir;
-	vec3_t			directedLight;
-	int				numVertexes;
 
 	ent = backEnd.currentEntity;
-	ambientLightInt = ent->ambientLightInt;
-	VectorCopy( ent->ambientLight, ambientLight );
-	VectorCopy( ent->directedLight, directedLight );
-	VectorCopy( ent->lightDir, lightDir );
-
-	v = tess.xyz[0];
-	normal = tess.normal[0];
 
-	numVertexes = tess.numVertexes;
-
-	for ( i = 0 ; i < numVertexes ; i++, v += 4, normal += 4)
-	{
-		incoming = DotProduct (normal, lightDir);
-		if ( incoming <= 0 ) {
-			*(int *)&colors[i*4] = ambientLightInt;
-			continue;
-		}
-		j = Q_ftol( ambientLight[0] + incoming * directedLight[0] );
-		if ( j > 255 ) {
-			j = 255;
-		}
-		colors[i*4+0] = j;
-
-		j = Q_ftol( ambientLight[1] + incoming * directedLight[1] );
-		if ( j > 255 ) {
-			j = 255;
-		}
-		colors[i*4+1] = j;
-
-		j = Q_ftol( ambientLight[2] + incoming * directedLight[2] );
-		if ( j > 255 ) {
-			j = 255;
-		}
-		colors[i*4+2] = j;
-
-		colors[i*4+3] = 255;
-	}
+	Q::diffuseColors( tess.normal, tess.numVertexes, ent->ambientLight, ( uint32_t ) ent->ambientLightInt,
+		ent->directedLight, ent->lightDir, ( uint8_t (*)[4] ) colors );
 }
 
 /*
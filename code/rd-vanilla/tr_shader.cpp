@@ -27,6 +27,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_common.h"
 #include "tr_local.h"
 #include "tr_stl.h"
+#include "qcommon/q_parallel.h"
+
+#include <vector>
 
 // tr_shader.c -- this file deals with the parsing and definition of shaders
 
@@ -2655,7 +2658,7 @@ sortedIndex.
 extern bool inServer;
 static void FixRenderCommandList( int newShader ) {
 	if( !inServer ) {
-		renderCommandList_t	*cmdList = &backEndData->commands;
+		renderCommandList_t	*cmdList = &backEndData[tr.smpFrame]->commands;
 
 		if( cmdList ) {
 			const void *curCmd = cmdList->cmds;
@@ -2676,6 +2679,12 @@ static void FixRenderCommandList( int newShader ) {
 					curCmd = (const void *)(sp_cmd + 1);
 					break;
 					}
+				case RC_STRETCH_PICS:
+					{
+					const stretchPicsCommand_t *sp_cmd = (const stretchPicsCommand_t *)curCmd;
+					curCmd = (const void *)(sp_cmd->pics + sp_cmd->numPics);
+					break;
+					}
 				case RC_SCISSOR:
 					{
 					const scissorCommand_t *sp_cmd = (const scissorCommand_t *)curCmd;
@@ -3740,6 +3749,166 @@ static void SetupShaderEntryPtrs(void)
 #endif
 
 
+#ifdef USE_STL_FOR_SHADER_LOOKUPS
+/*
+====================
+Shader index cache
+
+The combined shader text and the shader name index get written to SHADER_CACHE_FILE, so
+the next start can read them back instead of loading, compressing and scanning every
+.shader file. The cache is keyed by the loaded pk3 checksums plus the shader file list,
+and is only used if all shader files come from pk3s, so loose files being edited never
+hit a stale cache.
+=====================
+*/
+#define SHADER_CACHE_FILE		"shadercache.dat"
+#define SHADER_CACHE_IDENT		(('X'<<24)+('I'<<16)+('H'<<8)+'S')
+#define SHADER_CACHE_VERSION	1
+
+typedef struct shaderCacheHeader_s {
+	int				ident;
+	int				version;
+	unsigned int	key;
+	int				textLength;		// including the trailing 0
+	int				numEntries;
+	int				namesLength;
+	// followed by the text, numEntries text offsets and numEntries 0 terminated shader names
+} shaderCacheHeader_t;
+
+static unsigned int R_ShaderCacheHash( const char *data, unsigned int hash )
+{
+	// FNV-1a
+	while ( *data )
+	{
+		hash ^= (byte)*data++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// returns 0 if the shader files can't be cached
+static unsigned int R_ShaderCacheKey( char **shaderFiles, int numShaderFiles )
+{
+	unsigned int key = R_ShaderCacheHash( ri.FS_LoadedPakChecksums(), 2166136261u );
+
+	for ( int i = 0; i < numShaderFiles; i++ )
+	{
+		const char *filename = va( "shaders/%s", shaderFiles[i] );
+
+		if ( ri.FS_FileIsInPAK( filename, NULL ) != 1 )
+		{
+			return 0;
+		}
+		key = R_ShaderCacheHash( filename, key );
+	}
+
+	return key ? key : 1;
+}
+
+static qboolean R_LoadShaderCache( unsigned int key )
+{
+	byte *buffer;
+	const long len = ri.FS_ReadFile( SHADER_CACHE_FILE, (void **)&buffer );
+
+	if ( !buffer )
+	{
+		return qfalse;
+	}
+
+	shaderCacheHeader_t header;
+	memset( &header, 0, sizeof( header ) );
+	if ( len >= (long)sizeof( header ) )
+	{
+		memcpy( &header, buffer, sizeof( header ) );
+	}
+
+	if ( header.ident != SHADER_CACHE_IDENT
+		|| header.version != SHADER_CACHE_VERSION
+		|| header.key != key
+		|| header.textLength <= 0
+		|| header.numEntries < 0
+		|| header.namesLength < 0
+		|| len != (long)sizeof( header ) + header.textLength + header.numEntries * (long)sizeof( int ) + header.namesLength )
+	{
+		ri.FS_FreeFile( buffer );
+		return qfalse;
+	}
+
+	const char *text = (const char *)buffer + sizeof( header );
+	const int *offsets = (const int *)( text + header.textLength );
+	const char *name = (const char *)( offsets + header.numEntries );
+	const char *namesEnd = name + header.namesLength;
+
+	s_shaderText = (char *) R_Hunk_Alloc( header.textLength, qfalse );
+	memcpy( s_shaderText, text, header.textLength );
+	s_shaderText[header.textLength - 1] = '\0';
+
+	ShaderEntryPtrs_Clear();
+	for ( int i = 0; i < header.numEntries; i++ )
+	{
+		const int nameLength = (int)strnlen( name, namesEnd - name );
+
+		if ( offsets[i] < 0 || offsets[i] >= header.textLength || name + nameLength >= namesEnd )
+		{
+			ri.Printf( PRINT_WARNING, "R_LoadShaderCache: %s is corrupt\n", SHADER_CACHE_FILE );
+			ShaderEntryPtrs_Clear();
+			s_shaderText = NULL;
+			ri.FS_FreeFile( buffer );
+			return qfalse;
+		}
+
+		ShaderEntryPtrs_Insert( name, s_shaderText + offsets[i] );
+		name += nameLength + 1;
+	}
+
+	ri.FS_FreeFile( buffer );
+	return qtrue;
+}
+
+static void R_AddShaderCacheEntry( const char *psShaderName, const char *p, void *userData )
+{
+	std::vector<char> &names = *(std::vector<char> *)userData;
+	const int offset = (int)( p - s_shaderText );
+
+	// offsets go first, then the names, so collect both in one pass and split them later
+	names.insert( names.end(), (const char *)&offset, (const char *)&offset + sizeof( offset ) );
+	names.insert( names.end(), psShaderName, psShaderName + strlen( psShaderName ) + 1 );
+}
+
+static void R_WriteShaderCache( unsigned int key )
+{
+	std::vector<char> entries;
+	ShaderEntryPtrs_ForEach( R_AddShaderCacheEntry, &entries );
+
+	std::vector<char> offsets;
+	std::vector<char> names;
+	for ( size_t i = 0; i < entries.size(); )
+	{
+		offsets.insert( offsets.end(), &entries[i], &entries[i] + sizeof( int ) );
+		i += sizeof( int );
+
+		const size_t nameLength = strlen( &entries[i] ) + 1;
+		names.insert( names.end(), &entries[i], &entries[i] + nameLength );
+		i += nameLength;
+	}
+
+	shaderCacheHeader_t header;
+	header.ident = SHADER_CACHE_IDENT;
+	header.version = SHADER_CACHE_VERSION;
+	header.key = key;
+	header.textLength = (int)strlen( s_shaderText ) + 1;
+	header.numEntries = ShaderEntryPtrs_Size();
+	header.namesLength = (int)names.size();
+
+	std::vector<char> buffer( (const char *)&header, (const char *)&header + sizeof( header ) );
+	buffer.insert( buffer.end(), s_shaderText, s_shaderText + header.textLength );
+	buffer.insert( buffer.end(), offsets.begin(), offsets.end() );
+	buffer.insert( buffer.end(), names.begin(), names.end() );
+
+	ri.FS_WriteFile( SHADER_CACHE_FILE, buffer.data(), (int)buffer.size() );
+}
+#endif
+
 /*
 ====================
 ScanAndLoadShaderFiles
@@ -3771,6 +3940,16 @@ static void ScanAndLoadShaderFiles( void )
 		numShaderFiles = MAX_SHADER_FILES;
 	}
 
+#ifdef USE_STL_FOR_SHADER_LOOKUPS
+	const unsigned int cacheKey = r_shaderCache->integer ? R_ShaderCacheKey( shaderFiles, numShaderFiles ) : 0;
+
+	if ( cacheKey && R_LoadShaderCache( cacheKey ) )
+	{
+		ri.FS_FreeFileList( shaderFiles );
+		return;
+	}
+#endif
+
 	// load and store shader files
 	for ( i = 0; i < numShaderFiles; i++ )
 	{
@@ -3787,6 +3966,15 @@ static void ScanAndLoadShaderFiles( void )
 			sum += summand;
 	}
 
+	// strip comments and whitespace, each file on its own so the worker threads can share the work
+	Q::parallelFor( numShaderFiles, 4, [&buffers]( size_t begin, size_t end ) {
+		for ( size_t j = begin; j < end; j++ )
+		{
+			if ( buffers[j] )
+				COM_Compress( buffers[j] );
+		}
+	} );
+
 	// build single large buffer
 	s_shaderText = (char *) R_Hunk_Alloc( sum + numShaderFiles*2, qtrue );
 	s_shaderText[0] = '\0';
@@ -3804,13 +3992,16 @@ static void ScanAndLoadShaderFiles( void )
 		ri.FS_FreeFile( buffers[i] );
 	}
 
-	COM_Compress( s_shaderText );
-
 	// free up memory
 	ri.FS_FreeFileList( shaderFiles );
 
 	#ifdef USE_STL_FOR_SHADER_LOOKUPS
 	SetupShaderEntryPtrs();
+
+	if ( cacheKey )
+	{
+		R_WriteShaderCache( cacheKey );
+	}
 	#endif
 }
 
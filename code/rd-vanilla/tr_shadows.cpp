@@ -24,6 +24,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#include "qcommon/q_shadowvolume.h"
+
+#include <vector>
+
 /*
 
   for a projection shadow:
@@ -38,131 +42,131 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #define _STENCIL_REVERSE
 
-typedef struct {
-	int		i2;
-	int		facing;
-} edgeDef_t;
-
 #define	MAX_EDGE_DEFS	32
 
-static	edgeDef_t	edgeDefs[SHADER_MAX_VERTEXES][MAX_EDGE_DEFS];
-static	int			numEdgeDefs[SHADER_MAX_VERTEXES];
-static	int			facing[SHADER_MAX_INDEXES/3];
-static	vec3_t		shadowXyz[SHADER_MAX_VERTEXES];
+// per triangle of the current batch, which edges get extruded
+static	byte		shadowEdgeMasks[SHADER_MAX_INDEXES/3];
+static	int			numShadowEdgeMasks;
+static	int			shadowEdgeRegistration;
+static	int			shadowEdgeCounts[SHADER_MAX_VERTEXES];
 
+static	byte		facing[SHADER_MAX_INDEXES/3];
+// tess.xyz followed by the extruded copies, so the volume can be one array
+static	vec4_t		shadowXyz[SHADER_MAX_VERTEXES*2] QALIGN(16);
+static	glIndex_t	shadowIndexes[SHADER_MAX_INDEXES*8];
 
-void R_AddEdgeDef( int i1, int i2, int facing ) {
-	int		c;
 
-	c = numEdgeDefs[ i1 ];
-	if ( c == MAX_EDGE_DEFS ) {
-		return;		// overflow
+/*
+=================
+R_ComputeShadowEdges
+
+Edge masks for the triangles of tess that came without any
+=================
+*/
+static void R_ComputeShadowEdges( int firstTriangle, int numTriangles ) {
+	const glIndex_t	*indexes = tess.indexes + firstTriangle * 3;
+	glIndex_t		minVertex, maxVertex;
+	int				i;
+
+	if ( numTriangles <= 0 ) {
+		return;
 	}
-	edgeDefs[ i1 ][ c ].i2 = i2;
-	edgeDefs[ i1 ][ c ].facing = facing;
 
-	numEdgeDefs[ i1 ]++;
+	minVertex = maxVertex = indexes[0];
+	for ( i = 1 ; i < numTriangles * 3 ; i++ ) {
+		minVertex = Q_min( minVertex, indexes[i] );
+		maxVertex = Q_max( maxVertex, indexes[i] );
+	}
+
+	Q::shadowEdgeMasks( indexes, numTriangles, minVertex, maxVertex - minVertex + 1,
+		MAX_EDGE_DEFS, shadowEdgeCounts, shadowEdgeMasks + firstTriangle );
 }
 
-void R_RenderShadowEdges( void ) {
-	int		i;
-	int		c;
-	int		j;
-	int		i2;
-	//int		c_edges, c_rejected;
-#if 0
-	int		c2, k;
-	int		hit[2];
-#endif
-#ifdef _STENCIL_REVERSE
-	int		numTris;
-	int		o1, o2, o3;
-#endif
+/*
+=================
+R_SyncShadowEdges
 
-	// an edge is NOT a silhouette edge if its face doesn't face the light,
-	// or if it has a reverse paired edge that also faces the light.
-	// A well behaved polyhedron would have exactly two faces for each edge,
-	// but lots of models have dangling edges or overfanned edges
-#if 0
-	c_edges = 0;
-	c_rejected = 0;
-#endif
+Starts over for a new batch, and fills in the masks of surfaces added
+without any up to the end of tess
+=================
+*/
+static void R_SyncShadowEdges( int numTriangles ) {
+	if ( shadowEdgeRegistration != tess.registration ) {
+		shadowEdgeRegistration = tess.registration;
+		numShadowEdgeMasks = 0;
+	}
+	if ( numShadowEdgeMasks < numTriangles ) {
+		R_ComputeShadowEdges( numShadowEdgeMasks, numTriangles - numShadowEdgeMasks );
+		numShadowEdgeMasks = numTriangles;
+	}
+}
 
-	for ( i = 0 ; i < tess.numVertexes ; i++ ) {
-		c = numEdgeDefs[ i ];
-		for ( j = 0 ; j < c ; j++ ) {
-			if ( !edgeDefs[ i ][ j ].facing ) {
-				continue;
-			}
-
-			//with this system we can still get edges shared by more than 2 tris which
-			//produces artifacts including seeing the shadow through walls. So for now
-			//we are going to render all edges even though it is a tiny bit slower. -rww
-#if 1
-			i2 = edgeDefs[ i ][ j ].i2;
-			qglBegin( GL_TRIANGLE_STRIP );
-				qglVertex3fv( tess.xyz[ i ] );
-				qglVertex3fv( shadowXyz[ i ] );
-				qglVertex3fv( tess.xyz[ i2 ] );
-				qglVertex3fv( shadowXyz[ i2 ] );
-			qglEnd();
-#else
-			hit[0] = 0;
-			hit[1] = 0;
-
-			i2 = edgeDefs[ i ][ j ].i2;
-			c2 = numEdgeDefs[ i2 ];
-			for ( k = 0 ; k < c2 ; k++ ) {
-				if ( edgeDefs[ i2 ][ k ].i2 == i ) {
-					hit[ edgeDefs[ i2 ][ k ].facing ]++;
-				}
-			}
-
-			// if it doesn't share the edge with another front facing
-			// triangle, it is a sil edge
-			if ( hit[ 1 ] == 0 ) {
-				qglBegin( GL_TRIANGLE_STRIP );
-				qglVertex3fv( tess.xyz[ i ] );
-				qglVertex3fv( shadowXyz[ i ] );
-				qglVertex3fv( tess.xyz[ i2 ] );
-				qglVertex3fv( shadowXyz[ i2 ] );
-				qglEnd();
-				c_edges++;
-			} else {
-				c_rejected++;
-			}
-#endif
-		}
+/*
+=================
+RB_AddShadowEdges
+
+Called by surfaces that have their edge masks worked out at load, right
+after adding their numTriangles to tess. NULL means every edge is used.
+=================
+*/
+void RB_AddShadowEdges( const byte *edgeMasks, int numTriangles ) {
+	const int firstTriangle = tess.numIndexes / 3 - numTriangles;
+
+	R_SyncShadowEdges( firstTriangle );
+
+	if ( edgeMasks ) {
+		memcpy( shadowEdgeMasks + firstTriangle, edgeMasks, numTriangles );
+	} else {
+		memset( shadowEdgeMasks + firstTriangle, Q::SHADOW_EDGES_ALL, numTriangles );
 	}
+	numShadowEdgeMasks = firstTriangle + numTriangles;
+}
 
-#ifdef _STENCIL_REVERSE
-	//Carmack Reverse<tm> method requires that volumes
-	//be capped properly -rww
-	numTris = tess.numIndexes / 3;
+/*
+=================
+R_BuildShadowEdges
 
-	for ( i = 0 ; i < numTris ; i++ )
-	{
-		if ( !facing[i] )
-		{
-			continue;
-		}
+Works out the edge masks of a model surface at load, returns NULL if
+every edge is used, which is almost always the case
+=================
+*/
+byte *R_BuildShadowEdges( const int *indexes, int numTriangles, int numVertexes ) {
+	// models can be registered while the back end runs, so no sharing its scratch space
+	std::vector<int>	counts( numVertexes );
+	std::vector<byte>	masks( numTriangles );
+	byte				*out;
 
-		o1 = tess.indexes[ i*3 + 0 ];
-		o2 = tess.indexes[ i*3 + 1 ];
-		o3 = tess.indexes[ i*3 + 2 ];
+	if ( !numTriangles || !Q::shadowEdgeMasks( indexes, numTriangles, 0, numVertexes, MAX_EDGE_DEFS, counts.data(), masks.data() ) ) {
+		return NULL;
+	}
 
-		qglBegin(GL_TRIANGLES);
-			qglVertex3fv(tess.xyz[o1]);
-			qglVertex3fv(tess.xyz[o2]);
-			qglVertex3fv(tess.xyz[o3]);
-		qglEnd();
-		qglBegin(GL_TRIANGLES);
-			qglVertex3fv(shadowXyz[o3]);
-			qglVertex3fv(shadowXyz[o2]);
-			qglVertex3fv(shadowXyz[o1]);
-		qglEnd();
+	out = (byte *)R_Hunk_Alloc( numTriangles, qfalse );
+	memcpy( out, masks.data(), numTriangles );
+	return out;
+}
+
+/*
+=================
+R_RenderShadowEdges
+
+Draws the volume built by RB_DoShadowTessEnd
+=================
+*/
+static void R_RenderShadowEdges( int numIndexes ) {
+	if ( !numIndexes ) {
+		return;
 	}
-#endif
+
+	// an edge is NOT a silhouette edge if its face doesn't face the light,
+	// or if it has a reverse paired edge that also faces the light.
+	// A well behaved polyhedron would have exactly two faces for each edge,
+	// but lots of models have dangling edges or overfanned edges.
+	//with this system we can still get edges shared by more than 2 tris which
+	//produces artifacts including seeing the shadow through walls. So for now
+	//we are going to render all edges even though it is a tiny bit slower. -rww
+	//Carmack Reverse<tm> method requires that volumes
+	//be capped properly -rww
+	qglDrawElements( GL_TRIANGLES, numIndexes, GL_INDEX_TYPE, shadowIndexes );
 }
 
 //#define _DEBUG_STENCIL_SHADOWS
@@ -226,12 +230,16 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 {
 	int		i;
 	int		numTris;
+	int		numIndexes;
 	vec3_t	lightDir;
+	vec4_t	*extrudedXyz = shadowXyz + tess.numVertexes;
 
 	if ( glConfig.stencilBits < 4 ) {
 		return;
 	}
 
+	memcpy( shadowXyz, tess.xyz, tess.numVertexes * sizeof( tess.xyz[0] ) );
+
 #if 1 //controlled method - try to keep shadows in range so they don't show through so much -rww
 	vec3_t	worldxyz;
 	vec3_t	entLight;
@@ -252,16 +260,16 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 		VectorAdd(tess.xyz[i], backEnd.ori.origin, worldxyz);
 		groundDist = worldxyz[2] - backEnd.currentEntity->e.shadowPlane;
 		groundDist += 16.0f; //fudge factor
-		VectorMA( tess.xyz[i], -groundDist, lightDir, shadowXyz[i] );
+		VectorMA( tess.xyz[i], -groundDist, lightDir, extrudedXyz[i] );
 	}
 #else
 	if (lightPos)
 	{
 		for ( i = 0 ; i < tess.numVertexes ; i++ )
 		{
-			shadowXyz[i][0] = tess.xyz[i][0]+(( tess.xyz[i][0]-lightPos[0] )*128.0f);
-			shadowXyz[i][1] = tess.xyz[i][1]+(( tess.xyz[i][1]-lightPos[1] )*128.0f);
-			shadowXyz[i][2] = tess.xyz[i][2]+(( tess.xyz[i][2]-lightPos[2] )*128.0f);
+			extrudedXyz[i][0] = tess.xyz[i][0]+(( tess.xyz[i][0]-lightPos[0] )*128.0f);
+			extrudedXyz[i][1] = tess.xyz[i][1]+(( tess.xyz[i][1]-lightPos[1] )*128.0f);
+			extrudedXyz[i][2] = tess.xyz[i][2]+(( tess.xyz[i][2]-lightPos[2] )*128.0f);
 		}
 	}
 	else
@@ -270,39 +278,21 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 
 		// project vertexes away from light direction
 		for ( i = 0 ; i < tess.numVertexes ; i++ ) {
-			VectorMA( tess.xyz[i], -512, lightDir, shadowXyz[i] );
+			VectorMA( tess.xyz[i], -512, lightDir, extrudedXyz[i] );
 		}
 	}
 #endif
-	// decide which triangles face the light
-	memset( numEdgeDefs, 0, 4 * tess.numVertexes );
-
+	// decide which triangles face the light, and build the volume out of their edges
 	numTris = tess.numIndexes / 3;
-	for ( i = 0 ; i < numTris ; i++ ) {
-		int		i1, i2, i3;
-		vec3_t	d1, d2, normal;
-		float	*v1, *v2, *v3;
-		float	d;
+	R_SyncShadowEdges( numTris );
 
-		i1 = tess.indexes[ i*3 + 0 ];
-		i2 = tess.indexes[ i*3 + 1 ];
-		i3 = tess.indexes[ i*3 + 2 ];
+	if ( lightPos ) {
+		for ( i = 0 ; i < numTris ; i++ ) {
+			float	*v1 = tess.xyz[ tess.indexes[ i*3 + 0 ] ];
+			float	*v2 = tess.xyz[ tess.indexes[ i*3 + 1 ] ];
+			float	*v3 = tess.xyz[ tess.indexes[ i*3 + 2 ] ];
+			float	planeEq[4];
 
-		v1 = tess.xyz[ i1 ];
-		v2 = tess.xyz[ i2 ];
-		v3 = tess.xyz[ i3 ];
-
-		if (!lightPos)
-		{
-			VectorSubtract( v2, v1, d1 );
-			VectorSubtract( v3, v1, d2 );
-			CrossProduct( d1, d2, normal );
-
-			d = DotProduct( normal, lightDir );
-		}
-		else
-		{
-			float planeEq[4];
 			planeEq[0] = v1[1]*(v2[2]-v3[2]) + v2[1]*(v3[2]-v1[2]) + v3[1]*(v1[2]-v2[2]);
 			planeEq[1] = v1[2]*(v2[0]-v3[0]) + v2[2]*(v3[0]-v1[0]) + v3[2]*(v1[0]-v2[0]);
 			planeEq[2] = v1[0]*(v2[1]-v3[1]) + v2[0]*(v3[1]-v1[1]) + v3[0]*(v1[1]-v2[1]);
@@ -310,23 +300,23 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 						v2[0]*(v3[1]*v1[2] - v1[1]*v3[2]) +
 						v3[0]*(v1[1]*v2[2] - v2[1]*v1[2]) );
 
-			d = planeEq[0]*lightPos[0]+
-				planeEq[1]*lightPos[1]+
-				planeEq[2]*lightPos[2]+
-				planeEq[3];
+			facing[ i ] = ( planeEq[0]*lightPos[0] + planeEq[1]*lightPos[1] + planeEq[2]*lightPos[2] + planeEq[3] ) > 0;
 		}
+	} else {
+		Q::shadowFacing( tess.xyz, tess.indexes, numTris, lightDir, facing );
+	}
 
-		if ( d > 0 ) {
-			facing[ i ] = 1;
-		} else {
-			facing[ i ] = 0;
-		}
+	numIndexes = Q::shadowVolumeIndices( tess.indexes, numTris, facing, shadowEdgeMasks, tess.numVertexes, shadowIndexes );
 
-		// create the edges
-		R_AddEdgeDef( i1, i2, facing[ i ] );
-		R_AddEdgeDef( i2, i3, facing[ i ] );
-		R_AddEdgeDef( i3, i1, facing[ i ] );
+	// the immediate mode this replaced had no arrays but the vertexes
+	qglDisableClientState( GL_COLOR_ARRAY );
+	qglDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	if ( qglActiveTextureARB ) {
+		GL_SelectTexture( 1 );
+		qglDisableClientState( GL_TEXTURE_COORD_ARRAY );
+		GL_SelectTexture( 0 );
 	}
+	qglVertexPointer( 3, GL_FLOAT, 16, shadowXyz );
 
 	GL_Bind( tr.whiteImage );
 	//qglEnable( GL_CULL_FACE );
@@ -355,25 +345,25 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 		GL_Cull(CT_BACK_SIDED);
 		qglStencilOp( GL_KEEP, GL_INCR, GL_KEEP );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 
 		//qglCullFace( GL_FRONT );
 		GL_Cull(CT_FRONT_SIDED);
 		qglStencilOp( GL_KEEP, GL_DECR, GL_KEEP );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 	} else {
 		//qglCullFace( GL_FRONT );
 		GL_Cull(CT_FRONT_SIDED);
 		qglStencilOp( GL_KEEP, GL_INCR, GL_KEEP );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 
 		//qglCullFace( GL_BACK );
 		GL_Cull(CT_BACK_SIDED);
 		qglStencilOp( GL_KEEP, GL_DECR, GL_KEEP );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 	}
 
 	qglDepthFunc(GL_LEQUAL);
@@ -383,28 +373,30 @@ void RB_DoShadowTessEnd( vec3_t lightPos )
 		qglCullFace( GL_FRONT );
 		qglStencilOp( GL_KEEP, GL_KEEP, GL_INCR );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 
 		qglCullFace( GL_BACK );
 		qglStencilOp( GL_KEEP, GL_KEEP, GL_DECR );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 	} else {
 		qglCullFace( GL_BACK );
 		qglStencilOp( GL_KEEP, GL_KEEP, GL_INCR );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 
 		qglCullFace( GL_FRONT );
 		qglStencilOp( GL_KEEP, GL_KEEP, GL_DECR );
 
-		R_RenderShadowEdges();
+		R_RenderShadowEdges( numIndexes );
 	}
 #endif
 
 	// reenable writing to the color buffer
 	qglColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
 
+	qglVertexPointer( 3, GL_FLOAT, 16, tess.xyz );	// padded for SIMD
+
 #ifdef _DEBUG_STENCIL_SHADOWS
 	qglPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 #endif
@@ -635,14 +627,14 @@ void RB_DistortionFill(void)
 	}
 	else
 	{ //do slow stretchy effect
-		spost = sin(tr.refdef.time*0.0005f);
+		spost = sin(backEnd.refdef.time*0.0005f);
 		if (spost < 0.0f)
 		{
 			spost = -spost;
 		}
 		spost *= 0.2f;
 
-		spost2 = sin(tr.refdef.time*0.0005f);
+		spost2 = sin(backEnd.refdef.time*0.0005f);
 		if (spost2 < 0.0f)
 		{
 			spost2 = -spost2;
@@ -687,14 +679,14 @@ void RB_DistortionFill(void)
 			GL_State(GLS_SRCBLEND_SRC_ALPHA|GLS_DSTBLEND_SRC_ALPHA);
 		}
 
-		spost = sin(tr.refdef.time*0.0008f);
+		spost = sin(backEnd.refdef.time*0.0008f);
 		if (spost < 0.0f)
 		{
 			spost = -spost;
 		}
 		spost *= 0.08f;
 
-		spost2 = sin(tr.refdef.time*0.0008f);
+		spost2 = sin(backEnd.refdef.time*0.0008f);
 		if (spost2 < 0.0f)
 		{
 			spost2 = -spost2;
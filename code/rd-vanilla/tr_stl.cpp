@@ -63,6 +63,14 @@ void ShaderEntryPtrs_Insert(const char *token, const char *p)
 	}
 }
 
+void ShaderEntryPtrs_ForEach(void (*callback)(const char *psShaderName, const char *p, void *userData), void *userData)
+{
+	for (ShaderEntryPtrs_t::iterator it = ShaderEntryPtrs.begin(); it != ShaderEntryPtrs.end(); ++it)
+	{
+		callback((*it).first.c_str(), (*it).second, userData);
+	}
+}
+
 // returns NULL if not found...
 //
 const char *ShaderEntryPtrs_Lookup(const char *psShaderName)
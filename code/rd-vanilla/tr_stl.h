@@ -36,6 +36,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 	int ShaderEntryPtrs_Size(void);
 	const char  *ShaderEntryPtrs_Lookup(const char *psShaderName);
 	void ShaderEntryPtrs_Insert(const char  *token, const char  *p);
+	void ShaderEntryPtrs_ForEach(void (*callback)(const char *psShaderName, const char *p, void *userData), void *userData);
 #else
 
 	#define ShaderEntryPtrs_Clear()
@@ -27,6 +27,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#include <algorithm>
+
 /*
 
   THIS ENTIRE FILE IS BACK END
@@ -837,7 +839,7 @@ static void RB_SurfaceElectricity()
 	// see if we should grow from start to end
 	if ( e->renderfx & RF_GROW )
 	{
-		perc = 1.0f - ( e->endTime - tr.refdef.time ) / e->angles[1]/*duration*/;
+		perc = 1.0f - ( e->endTime - backEnd.refdef.time ) / e->angles[1]/*duration*/;
 
 		if ( perc > 1.0f )
 		{
@@ -986,7 +988,10 @@ void RB_SurfaceTriangles( srfTriangles_t *srf ) {
 	byte		*color;
 	int			dlightBits;
 
-	dlightBits = srf->dlightBits;
+	dlightBits = srf->dlightBits[backEnd.smpFrame];
+	if ( RB_AddWorldVBOSurface( &srf->vbo, dlightBits ) ) {
+		return;
+	}
 	tess.dlightBits |= dlightBits;
 
 	RB_CHECKOVERFLOW( srf->numVerts, srf->numIndexes );
@@ -1333,9 +1338,13 @@ void RB_SurfaceFace( srfSurfaceFace_t *surf ) {
 	int			dlightBits;
 	byteAlias_t	ba;
 
+	dlightBits = surf->dlightBits[backEnd.smpFrame];
+	if ( RB_AddWorldVBOSurface( &surf->vbo, dlightBits ) ) {
+		return;
+	}
+
 	RB_CHECKOVERFLOW( surf->numPoints, surf->numIndices );
 
-	dlightBits = surf->dlightBits;
 	tess.dlightBits |= dlightBits;
 
 	indices = ( unsigned * ) ( ( ( char  * ) surf ) + surf->ofsIndices );
@@ -1388,7 +1397,7 @@ void RB_SurfaceFace( srfSurfaceFace_t *surf ) {
 }
 
 
-static float LodErrorForVolume( vec3_t local, float radius ) {
+static float LodErrorForVolume( const vec3_t local, float radius ) {
 	vec3_t		world;
 	float		d;
 
@@ -1418,6 +1427,32 @@ static float LodErrorForVolume( vec3_t local, float radius ) {
 	return r_lodCurveError->value / d;
 }
 
+/*
+=============
+RB_GridLod
+
+Picks the grid's level of detail at its current distance. The level
+drawn last time is kept until the allowable error crosses one of its
+thresholds, which it rarely does from one view to the next
+=============
+*/
+static int RB_GridLod( srfGridMesh_t *cv ) {
+	float	lodError;
+	int		lod;
+
+	// determine the allowable discrepance
+	lodError = LodErrorForVolume( cv->lodOrigin, cv->lodRadius );
+
+	lod = cv->lod;
+	if ( ( lod > 0 && lodError < cv->lodErrors[lod - 1] )
+		|| ( lod < cv->numLods - 1 && lodError >= cv->lodErrors[lod] ) ) {
+		lod = std::upper_bound( cv->lodErrors, cv->lodErrors + cv->numLods - 1, lodError ) - cv->lodErrors;
+		cv->lod = lod;
+	}
+
+	return lod;
+}
+
 /*
 =============
 RB_SurfaceGrid
@@ -1436,41 +1471,24 @@ void RB_SurfaceGrid( srfGridMesh_t *cv ) {
 	int		used;
 	int		widthTable[MAX_GRID_SIZE];
 	int		heightTable[MAX_GRID_SIZE];
-	float	lodError;
 	int		lodWidth, lodHeight;
+	int		lod;
 	int		numVertexes;
 	int		dlightBits;
 	int		*vDlightBits;
 
-	dlightBits = cv->dlightBits;
-	tess.dlightBits |= dlightBits;
+	dlightBits = cv->dlightBits[backEnd.smpFrame];
 
-	// determine the allowable discrepance
-	lodError = LodErrorForVolume( cv->lodOrigin, cv->lodRadius );
+	lod = RB_GridLod( cv );
 
-	// determine which rows and columns of the subdivision
-	// we are actually going to use
-	widthTable[0] = 0;
-	lodWidth = 1;
-	for ( i = 1 ; i < cv->width-1 ; i++ ) {
-		if ( cv->widthLodError[i] <= lodError ) {
-			widthTable[lodWidth] = i;
-			lodWidth++;
-		}
+	if ( RB_AddWorldVBOGrid( cv, dlightBits, lod ) ) {
+		return;
 	}
-	widthTable[lodWidth] = cv->width-1;
-	lodWidth++;
+	tess.dlightBits |= dlightBits;
 
-	heightTable[0] = 0;
-	lodHeight = 1;
-	for ( i = 1 ; i < cv->height-1 ; i++ ) {
-		if ( cv->heightLodError[i] <= lodError ) {
-			heightTable[lodHeight] = i;
-			lodHeight++;
-		}
-	}
-	heightTable[lodHeight] = cv->height-1;
-	lodHeight++;
+	// determine which rows and columns of the subdivision
+	// we are actually going to use
+	R_GridLodTables( cv, lod, widthTable, &lodWidth, heightTable, &lodHeight );
 
 
 	// very large grids may have more points or indexes than can be fit
@@ -28,6 +28,14 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_WorldEffects.h"
 #include <float.h> //for isnan
 
+#include <unordered_map>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define R_SSFADE_SSE
+#include <xmmintrin.h>
+#endif
+
 /////===== Part of the VERTIGON system =====/////
 // The surfacesprites are a simple system.  When a polygon with this shader stage on it is drawn,
 // there are randomly distributed images (defined by the shader stage) placed on the surface.
@@ -336,25 +344,323 @@ qboolean SSAdditiveTransparency=qfalse;
 qboolean SSUsingFog=qfalse;
 
 
+/////////////////////////////////////////////
+// Vertical surface sprite placement cache
+
+// Where the sprites of a triangle go, how big they are and which random numbers they fade with only
+// depends on the triangle and the stage, so it's worked out the first time a triangle is drawn and
+// kept until the next map load. Only fading, wind and fog are left to do every frame.
+// Shaders with deformVertexes move their triangles every frame, so theirs are never kept.
+
+#define MAX_SS_PLACEMENTS	(1<<18)
+
+typedef struct {
+	vec3_t	origin;
+	float	width, height;		// a negative width flips the image
+	vec2_t	skew;
+	float	swayCos, swaySin;	// of the sway angle at time 0
+	float	bobCos, bobSin;		// of 2.5 times that
+	int		rightVector;
+} ssPlacement_t;
+
+typedef struct ssTriangleKey_s {
+	const surfaceSprite_t	*ss;
+	vec3_t					xyz[3];
+
+	bool operator==( const ssTriangleKey_s &other ) const
+	{
+		return ss == other.ss && !memcmp( xyz, other.xyz, sizeof( xyz ) );
+	}
+} ssTriangleKey_t;
+
+struct ssTriangleKeyHash
+{
+	size_t operator()( const ssTriangleKey_t &key ) const
+	{
+		// FNV-1a over the vertexes, the stage pointer mixed in last
+		const byte	*data = (const byte *)key.xyz;
+		uint32_t	hash = 2166136261u;
+		for ( size_t i = 0; i < sizeof( key.xyz ); i++ )
+		{
+			hash = ( hash ^ data[i] ) * 16777619u;
+		}
+		return hash ^ (size_t)key.ss;
+	}
+};
+
+typedef struct {
+	int		first, count;
+} ssPlacementRange_t;
+
+static std::unordered_map<ssTriangleKey_t, ssPlacementRange_t, ssTriangleKeyHash>	ssPlacementRanges;
+static std::vector<ssPlacement_t>	ssPlacements;
+
+// what the per frame fade needs, kept apart so that pass runs over plain arrays
+static std::vector<float>	ssWeights[3];		// barycentric weights of the triangle's vertexes
+static std::vector<float>	ssFadeRand;			// where in the fade range the sprite starts fading
+static std::vector<float>	ssDensityRank;		// the density lod leaves out sprites ranked above the kept fraction
+
+static std::vector<float>	ssAlphaPos;
+static std::vector<float>	ssAlpha;
+
+// the wind's sway and bob at the current time, rotated onto each sprite's own angle
+static float	ssSwayCos, ssSwaySin, ssBobCos, ssBobSin;
+
+/*
+=================
+R_ClearSurfaceSpriteCache
+
+Placements point at stages, so they can't outlive the map's shaders
+=================
+*/
+void R_ClearSurfaceSpriteCache( void )
+{
+	std::unordered_map<ssTriangleKey_t, ssPlacementRange_t, ssTriangleKeyHash>().swap( ssPlacementRanges );
+	std::vector<ssPlacement_t>().swap( ssPlacements );
+	for ( int i = 0; i < 3; i++ )
+	{
+		std::vector<float>().swap( ssWeights[i] );
+	}
+	std::vector<float>().swap( ssFadeRand );
+	std::vector<float>().swap( ssDensityRank );
+	std::vector<float>().swap( ssAlphaPos );
+	std::vector<float>().swap( ssAlpha );
+}
+
+/*
+=================
+RB_SurfaceSpriteRank
+
+Bit reversal of the sprite's number, so any fraction of a triangle's
+sprites taken by rank is spread evenly over the triangle
+=================
+*/
+static float RB_SurfaceSpriteRank( uint32_t n )
+{
+	n = ( n << 16 ) | ( n >> 16 );
+	n = ( ( n & 0x00ff00ff ) << 8 ) | ( ( n & 0xff00ff00 ) >> 8 );
+	n = ( ( n & 0x0f0f0f0f ) << 4 ) | ( ( n & 0xf0f0f0f0 ) >> 4 );
+	n = ( ( n & 0x33333333 ) << 2 ) | ( ( n & 0xcccccccc ) >> 2 );
+	n = ( ( n & 0x55555555 ) << 1 ) | ( ( n & 0xaaaaaaaa ) >> 1 );
+	return (float)( n * ( 1.0 / 4294967296.0 ) );
+}
+
+/*
+=================
+RB_SurfaceSpritePlacements
+
+Places the sprites of a vertical sprite stage on a triangle the way they always
+have been, from the random chart seeded by the triangle's corners. Without cache
+the placements are only good until RB_DropSurfaceSpritePlacements
+=================
+*/
+static ssPlacementRange_t RB_SurfaceSpritePlacements( const surfaceSprite_t *ss, const vec3_t v1, const vec3_t v2, const vec3_t v3, float step, bool cache )
+{
+	ssTriangleKey_t	key;
+	float			posi, posj;
+	float			fa, fb, fc;
+	byte			randindex, randinterval, randindex2;
+	int				rightVector;
+
+	key.ss = ss;
+	VectorCopy( v1, key.xyz[0] );
+	VectorCopy( v2, key.xyz[1] );
+	VectorCopy( v3, key.xyz[2] );
+
+	if ( cache )
+	{
+		auto it = ssPlacementRanges.find( key );
+		if ( it != ssPlacementRanges.end() )
+		{
+			return it->second;
+		}
+	}
+
+	if ( ssPlacements.size() >= MAX_SS_PLACEMENTS )
+	{
+		// start over rather than grow without bound on huge maps
+		R_ClearSurfaceSpriteCache();
+	}
+
+	ssPlacementRange_t range;
+	range.first = (int)ssPlacements.size();
+
+	randindex = (byte)(v1[0]+v1[1]+v2[0]+v2[1]+v3[0]+v3[1]);
+	randinterval = (byte)(v1[0]+v2[1]+v3[2])|0x03;	// Make sure the interval is at least 3, and always odd
+	rightVector = 0;
+
+	for (posi=0; posi<1.0; posi+=step)
+	{
+		for (posj=0; posj<(1.0-posi); posj+=step)
+		{
+			fa=posi+randomchart[randindex]*step;
+			randindex += randinterval;
+
+			fb=posj+randomchart[randindex]*step;
+			randindex += randinterval;
+
+			rightVector=(rightVector+1)&3;
+
+			if (fa>1.0)
+				continue;
+
+			if (fb>(1.0-fa))
+				continue;
+
+			fc = 1.0-fa-fb;
+
+			ssPlacement_t p;
+			VectorScale(v1, fa, p.origin);
+			VectorMA(p.origin, fb, v2, p.origin);
+			VectorMA(p.origin, fc, v3, p.origin);
+
+			ssFadeRand.push_back( randomchart[randindex] );
+			randindex += randinterval;
+
+			randindex2 = randindex;
+			p.width = ss->width*(1.0 + (ss->variance[0]*randomchart[randindex2]));
+			p.height = ss->height*(1.0 + (ss->variance[1]*randomchart[randindex2++]));
+			if (randomchart[randindex2++]>0.5)
+			{
+				p.width = -p.width;
+			}
+
+			p.skew[0] = p.skew[1] = 0;
+			if (ss->vertSkew != 0)
+			{	// flrand(-vertskew, vertskew)
+				p.skew[0] = p.height * ((ss->vertSkew*2.0f*randomchart[randindex2++])-ss->vertSkew);
+				p.skew[1] = p.height * ((ss->vertSkew*2.0f*randomchart[randindex2++])-ss->vertSkew);
+			}
+
+			const double swayAngle = (p.origin[0]+p.origin[1])*0.02;
+			p.swayCos = cos(swayAngle);
+			p.swaySin = sin(swayAngle);
+			p.bobCos = cos(swayAngle*2.5);
+			p.bobSin = sin(swayAngle*2.5);
+			p.rightVector = rightVector;
+
+			ssWeights[0].push_back( fa );
+			ssWeights[1].push_back( fb );
+			ssWeights[2].push_back( fc );
+			ssDensityRank.push_back( RB_SurfaceSpriteRank( ssPlacements.size() - range.first ) );
+			ssPlacements.push_back( p );
+		}
+	}
+
+	range.count = (int)ssPlacements.size() - range.first;
+	if ( cache )
+	{
+		ssPlacementRanges[key] = range;
+	}
+	return range;
+}
+
+/*
+=================
+RB_DropSurfaceSpritePlacements
+
+Throws away the placements of a triangle that wasn't cached, which are always the last ones
+=================
+*/
+static void RB_DropSurfaceSpritePlacements( const ssPlacementRange_t &range )
+{
+	ssPlacements.resize( range.first );
+	for ( int i = 0; i < 3; i++ )
+	{
+		ssWeights[i].resize( range.first );
+	}
+	ssFadeRand.resize( range.first );
+	ssDensityRank.resize( range.first );
+}
+
+/*
+=================
+RB_SurfaceSpriteFade
+
+Where each of a triangle's sprites is in the fade from the vertex alphas, and its alpha. The
+alpha is a value from 1.0 to 0.0 but represents when to START fading, minus a random factor so
+some things fade out sooner
+=================
+*/
+static void RB_SurfaceSpriteFade( const float *wa, const float *wb, const float *wc, const float *fadeRand, int count,
+									float a1, float a2, float a3, float faderange, float *alphaPos, float *alpha )
+{
+	int i = 0;
+
+#ifdef R_SSFADE_SSE
+	const __m128	va1 = _mm_set1_ps( a1 );
+	const __m128	va2 = _mm_set1_ps( a2 );
+	const __m128	va3 = _mm_set1_ps( a3 );
+	const __m128	range = _mm_set1_ps( faderange );
+	const __m128	randRange = _mm_set1_ps( 1.0f - faderange );
+	const __m128	one = _mm_set1_ps( 1.0f );
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128 pos = _mm_add_ps( _mm_add_ps( _mm_mul_ps( va1, _mm_loadu_ps( wa + i ) ),
+			_mm_mul_ps( va2, _mm_loadu_ps( wb + i ) ) ), _mm_mul_ps( va3, _mm_loadu_ps( wc + i ) ) );
+		const __m128 start = _mm_sub_ps( _mm_add_ps( range, _mm_mul_ps( randRange, _mm_loadu_ps( fadeRand + i ) ) ), pos );
+		_mm_storeu_ps( alphaPos + i, pos );
+		_mm_storeu_ps( alpha + i, _mm_sub_ps( one, _mm_div_ps( start, range ) ) );
+	}
+#endif
+
+	for ( ; i < count; i++ )
+	{
+		alphaPos[i] = a1*wa[i] + a2*wb[i] + a3*wc[i];
+		alpha[i] = 1.0f - ((faderange + (1.0f-faderange)*fadeRand[i] - alphaPos[i])/faderange);
+	}
+}
+
+/*
+=================
+RB_SurfaceSpriteDensity
+
+The fraction of a triangle's sprites drawn at its distance, sprites
+further than r_surfaceSpriteLodDist thin out so the count on screen
+stays about the same
+=================
+*/
+static float RB_SurfaceSpriteDensity( const vec3_t v1, const vec3_t v2, const vec3_t v3 )
+{
+	vec3_t	center;
+	float	lodDist, dist2;
+
+	lodDist = r_surfaceSpriteLodDist->value * rangescalefactor;
+	if ( lodDist <= 0 )
+	{
+		return 1.0f;
+	}
+
+	VectorAdd( v1, v2, center );
+	VectorAdd( center, v3, center );
+	VectorScale( center, 1.0f / 3.0f, center );
+	dist2 = DistanceSquared( center, ssViewOrigin );
+	if ( dist2 <= lodDist * lodDist )
+	{
+		return 1.0f;
+	}
+	return lodDist * lodDist / dist2;
+}
+
+
 /////////////////////////////////////////////
 // Vertical surface sprites
 
-static void RB_VerticalSurfaceSprite(vec3_t loc, float width, float height, byte light,
-										byte alpha, float wind, float windidle, vec2_t fog, int hangdown, vec2_t skew, bool flattened)
+static void RB_VerticalSurfaceSprite(const ssPlacement_t *p, float width, byte light,
+										byte alpha, float wind, float windidle, vec2_t fog, int hangdown, bool flattened)
 {
+	const float *loc = p->origin;
+	const float height = p->height;
 	vec3_t loc2, right;
-	float angle;
 	float windsway;
 	float points[16];
 	color4ub_t color;
 
-	angle = ((loc[0]+loc[1])*0.02+(tr.refdef.time*0.0015));
-
 	if (windidle>0.0)
 	{
 		windsway = (height*windidle*0.075);
-		loc2[0] = loc[0]+skew[0]+cos(angle)*windsway;
-		loc2[1] = loc[1]+skew[1]+sin(angle)*windsway;
+		loc2[0] = loc[0]+p->skew[0]+(p->swayCos*ssSwayCos - p->swaySin*ssSwaySin)*windsway;
+		loc2[1] = loc[1]+p->skew[1]+(p->swaySin*ssSwayCos + p->swayCos*ssSwaySin)*windsway;
 
 		if (hangdown)
 		{
@@ -367,8 +673,8 @@ static void RB_VerticalSurfaceSprite(vec3_t loc, float width, float height, byte
 	}
 	else
 	{
-		loc2[0] = loc[0]+skew[0];
-		loc2[1] = loc[1]+skew[1];
+		loc2[0] = loc[0]+p->skew[0];
+		loc2[1] = loc[1]+p->skew[1];
 		if (hangdown)
 		{
 			loc2[2] = loc[2]-height;
@@ -394,7 +700,7 @@ static void RB_VerticalSurfaceSprite(vec3_t loc, float width, float height, byte
 		{
 			windsway *= 0.4f;
 		}
-		loc2[2] += sin(angle*2.5)*windsway;
+		loc2[2] += (p->bobSin*ssBobCos + p->bobCos*ssBobSin)*windsway;
 	}
 
 	if ( flattened )
@@ -405,7 +711,7 @@ static void RB_VerticalSurfaceSprite(vec3_t loc, float width, float height, byte
 	}
 	else
 	{
-		VectorScale(ssrightvectors[rightvectorcount], width*0.5, right);
+		VectorScale(ssrightvectors[p->rightVector], width*0.5, right);
 	}
 
 	color[0]=light;
@@ -445,12 +751,13 @@ static void RB_VerticalSurfaceSprite(vec3_t loc, float width, float height, byte
 	SQuickSprite.Add(points, color, fog);
 }
 
-static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, float width, float height, byte light,
+static void RB_VerticalSurfaceSpriteWindPoint(const ssPlacement_t *p, float width, byte light,
 												byte alpha, float wind, float windidle, vec2_t fog,
-												int hangdown, vec2_t skew, vec2_t winddiff, float windforce, bool flattened)
+												int hangdown, vec2_t winddiff, float windforce, bool flattened)
 {
+	const float *loc = p->origin;
+	const float height = p->height;
 	vec3_t loc2, right;
-	float angle;
 	float windsway;
 	float points[16];
 	color4ub_t color;
@@ -460,18 +767,16 @@ static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, float width, float hei
 
 //	wind += 1.0-windforce;
 
-	angle = (loc[0]+loc[1])*0.02+(tr.refdef.time*0.0015);
-
 	if (curWindSpeed <80.0)
 	{
 		windsway = (height*windidle*0.1)*(1.0+windforce);
-		loc2[0] = loc[0]+skew[0]+cos(angle)*windsway;
-		loc2[1] = loc[1]+skew[1]+sin(angle)*windsway;
+		loc2[0] = loc[0]+p->skew[0]+(p->swayCos*ssSwayCos - p->swaySin*ssSwaySin)*windsway;
+		loc2[1] = loc[1]+p->skew[1]+(p->swaySin*ssSwayCos + p->swayCos*ssSwaySin)*windsway;
 	}
 	else
 	{
-		loc2[0] = loc[0]+skew[0];
-		loc2[1] = loc[1]+skew[1];
+		loc2[0] = loc[0]+p->skew[0];
+		loc2[1] = loc[1]+p->skew[1];
 	}
 	if (hangdown)
 	{
@@ -490,7 +795,7 @@ static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, float width, float hei
 
 	loc2[0] += height*winddiff[0]*windforce;
 	loc2[1] += height*winddiff[1]*windforce;
-	loc2[2] -= height*windforce*(0.75 + 0.15*sin((tr.refdef.time + 500*windforce)*0.01));
+	loc2[2] -= height*windforce*(0.75 + 0.15*sin((backEnd.refdef.time + 500*windforce)*0.01));
 
 	if ( flattened )
 	{
@@ -500,7 +805,7 @@ static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, float width, float hei
 	}
 	else
 	{
-		VectorScale(ssrightvectors[rightvectorcount], width*0.5, right);
+		VectorScale(ssrightvectors[p->rightVector], width*0.5, right);
 	}
 
 
@@ -555,21 +860,19 @@ static void RB_DrawVerticalSurfaceSprites( shaderStage_t *stage, shaderCommands_
 	vec2_t winddiff1, winddiff2, winddiff3;
 	float  windforce1, windforce2, windforce3;
 
-	float posi, posj;
 	float step;
 	float fa,fb,fc;
 
-	vec3_t curpoint;
-	float width, height;
-	float alpha, alphapos, thisspritesfadestart, light;
-
-	byte randomindex2;
+	float width;
+	float alpha, alphapos, light;
+	float density;
+	int i;
 
-	vec2_t skew={0,0};
 	vec2_t fogv;
-	vec2_t winddiffv;
+	vec2_t winddiffv={0,0};
 	float windforce=0;
 	qboolean usewindpoint = (qboolean) !! (curWindPointActive && stage->ss->wind > 0);
+	const bool cachePlacements = !input->shader->numDeforms;
 
 	float cutdist=stage->ss->fadeMax*rangescalefactor, cutdist2=cutdist*cutdist;
 	float fadedist=stage->ss->fadeDist*rangescalefactor, fadedist2=fadedist*fadedist;
@@ -585,6 +888,13 @@ static void RB_DrawVerticalSurfaceSprites( shaderStage_t *stage, shaderCommands_
 		faderange = 1.0;
 	}
 
+	// The sway angle of every sprite moves on at the same rate
+	const double windAngle = backEnd.refdef.time*0.0015;
+	ssSwayCos = cos(windAngle);
+	ssSwaySin = sin(windAngle);
+	ssBobCos = cos(windAngle*2.5);
+	ssBobSin = sin(windAngle*2.5);
+
 	// Quickly calc all the alphas and windstuff for each vertex
 	for (curvert=0; curvert<input->numVertexes; curvert++)
 	{
@@ -722,119 +1032,89 @@ static void RB_DrawVerticalSurfaceSprites( shaderStage_t *stage, shaderCommands_
 		}
 		step = stage->ss->density * Q_rsqrt(triarea);
 
-		randomindex = (byte)(v1[0]+v1[1]+v2[0]+v2[1]+v3[0]+v3[1]);
-		randominterval = (byte)(v1[0]+v2[1]+v3[2])|0x03;	// Make sure the interval is at least 3, and always odd
-		rightvectorcount = 0;
-
-		for (posi=0; posi<1.0; posi+=step)
+		const ssPlacementRange_t range = RB_SurfaceSpritePlacements(stage->ss, v1, v2, v3, step, cachePlacements);
+		if (!range.count)
 		{
-			for (posj=0; posj<(1.0-posi); posj+=step)
-			{
-				fa=posi+randomchart[randomindex]*step;
-				randomindex += randominterval;
-
-				fb=posj+randomchart[randomindex]*step;
-				randomindex += randominterval;
-
-				rightvectorcount=(rightvectorcount+1)&3;
-
-				if (fa>1.0)
-					continue;
-
-				if (fb>(1.0-fa))
-					continue;
+			continue;
+		}
+		if ((int)ssAlpha.size() < range.count)
+		{
+			ssAlphaPos.resize(range.count);
+			ssAlpha.resize(range.count);
+		}
+		const ssPlacement_t *placements = &ssPlacements[range.first];
+		const float *wa = &ssWeights[0][range.first];
+		const float *wb = &ssWeights[1][range.first];
+		const float *wc = &ssWeights[2][range.first];
+		const float *fadeRand = &ssFadeRand[range.first];
+		const float *rank = &ssDensityRank[range.first];
 
-				fc = 1.0-fa-fb;
+		// Fade every sprite of the triangle first
+		RB_SurfaceSpriteFade(wa, wb, wc, fadeRand, range.count, a1, a2, a3, faderange, ssAlphaPos.data(), ssAlpha.data());
 
-				// total alpha, minus random factor so some things fade out sooner.
-				alphapos = a1*fa + a2*fb + a3*fc;
-
-				// Note that the alpha at this point is a value from 1.0 to 0.0, but represents when to START fading
-				thisspritesfadestart = faderange + (1.0-faderange) * randomchart[randomindex];
-				randomindex += randominterval;
+		density = RB_SurfaceSpriteDensity(v1, v2, v3);
 
-				// Find where the alpha is relative to the fadestart, and calc the real alpha to draw at.
-				alpha = 1.0 - ((thisspritesfadestart-alphapos)/faderange);
-				if (alpha > 0.0)
-				{
-					if (alpha > 1.0)
-						alpha=1.0;
+		for (i=0; i<range.count; i++)
+		{
+			alpha = ssAlpha[i];
+			if (alpha <= 0.0 || rank[i] >= density)
+			{
+				continue;
+			}
+			if (alpha > 1.0)
+				alpha=1.0;
 
-					if (SSUsingFog)
-					{
-						fogv[0] = fog1[0]*fa + fog2[0]*fb + fog3[0]*fc;
-						fogv[1] = fog1[1]*fa + fog2[1]*fb + fog3[1]*fc;
-					}
+			fa = wa[i];
+			fb = wb[i];
+			fc = wc[i];
+			alphapos = ssAlphaPos[i];
 
-					if (usewindpoint)
-					{
-						winddiffv[0] = winddiff1[0]*fa + winddiff2[0]*fb + winddiff3[0]*fc;
-						winddiffv[1] = winddiff1[1]*fa + winddiff2[1]*fb + winddiff3[1]*fc;
-						windforce = windforce1*fa + windforce2*fb + windforce3*fc;
-					}
+			if (SSUsingFog)
+			{
+				fogv[0] = fog1[0]*fa + fog2[0]*fb + fog3[0]*fc;
+				fogv[1] = fog1[1]*fa + fog2[1]*fb + fog3[1]*fc;
+			}
 
-					VectorScale(v1, fa, curpoint);
-					VectorMA(curpoint, fb, v2, curpoint);
-					VectorMA(curpoint, fc, v3, curpoint);
+			if (usewindpoint)
+			{
+				winddiffv[0] = winddiff1[0]*fa + winddiff2[0]*fb + winddiff3[0]*fc;
+				winddiffv[1] = winddiff1[1]*fa + winddiff2[1]*fb + winddiff3[1]*fc;
+				windforce = windforce1*fa + windforce2*fb + windforce3*fc;
+			}
 
-					light = l1*fa + l2*fb + l3*fc;
-					if (SSAdditiveTransparency)
-					{	// Additive transparency, scale light value
-//						light *= alpha;
-						light = (128 + (light*0.5))*alpha;
-						alpha = 1.0;
-					}
+			light = l1*fa + l2*fb + l3*fc;
+			if (SSAdditiveTransparency)
+			{	// Additive transparency, scale light value
+//				light *= alpha;
+				light = (128 + (light*0.5))*alpha;
+				alpha = 1.0;
+			}
 
-					randomindex2 = randomindex;
-					width = stage->ss->width*(1.0 + (stage->ss->variance[0]*randomchart[randomindex2]));
-					height = stage->ss->height*(1.0 + (stage->ss->variance[1]*randomchart[randomindex2++]));
-					if (randomchart[randomindex2++]>0.5)
-					{
-						width = -width;
-					}
-					if (stage->ss->fadeScale!=0 && alphapos < 1.0)
-					{
-						width *= 1.0 + (stage->ss->fadeScale*(1.0-alphapos));
-					}
+			width = placements[i].width;
+			if (stage->ss->fadeScale!=0 && alphapos < 1.0)
+			{
+				width *= 1.0 + (stage->ss->fadeScale*(1.0-alphapos));
+			}
 
-					if (stage->ss->vertSkew != 0)
-					{	// flrand(-vertskew, vertskew)
-						skew[0] = height * ((stage->ss->vertSkew*2.0f*randomchart[randomindex2++])-stage->ss->vertSkew);
-						skew[1] = height * ((stage->ss->vertSkew*2.0f*randomchart[randomindex2++])-stage->ss->vertSkew);
-					}
+			if (usewindpoint && windforce > 0 && stage->ss->wind > 0.0)
+			{
+				RB_VerticalSurfaceSpriteWindPoint(&placements[i], width, (byte)light, (byte)(alpha*255.0),
+							stage->ss->wind, stage->ss->windIdle, SSUsingFog ? fogv : NULL, stage->ss->facing,
+							winddiffv, windforce, SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
+			}
+			else
+			{
+				RB_VerticalSurfaceSprite(&placements[i], width, (byte)light, (byte)(alpha*255.0),
+							stage->ss->wind, stage->ss->windIdle, SSUsingFog ? fogv : NULL, stage->ss->facing,
+							SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
+			}
 
-					if (usewindpoint && windforce > 0 && stage->ss->wind > 0.0)
-					{
-						if (SSUsingFog)
-						{
-							RB_VerticalSurfaceSpriteWindPoint(curpoint, width, height, (byte)light, (byte)(alpha*255.0),
-										stage->ss->wind, stage->ss->windIdle, fogv, stage->ss->facing, skew,
-										winddiffv, windforce, SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
-						}
-						else
-						{
-							RB_VerticalSurfaceSpriteWindPoint(curpoint, width, height, (byte)light, (byte)(alpha*255.0),
-										stage->ss->wind, stage->ss->windIdle, NULL, stage->ss->facing, skew,
-										winddiffv, windforce, SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
-						}
-					}
-					else
-					{
-						if (SSUsingFog)
-						{
-							RB_VerticalSurfaceSprite(curpoint, width, height, (byte)light, (byte)(alpha*255.0),
-										stage->ss->wind, stage->ss->windIdle, fogv, stage->ss->facing, skew, SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
-						}
-						else
-						{
-							RB_VerticalSurfaceSprite(curpoint, width, height, (byte)light, (byte)(alpha*255.0),
-										stage->ss->wind, stage->ss->windIdle, NULL, stage->ss->facing, skew, SURFSPRITE_FLATTENED == stage->ss->surfaceSpriteType);
-						}
-					}
+			totalsurfsprites++;
+		}
 
-					totalsurfsprites++;
-				}
-			}
+		if (!cachePlacements)
+		{
+			RB_DropSurfaceSpritePlacements(range);
 		}
 	}
 }
@@ -1340,7 +1620,7 @@ static void RB_DrawEffectSurfaceSprites( shaderStage_t *stage, shaderCommands_t
 		{
 			for (posj=0; posj<(1.0-posi); posj+=step)
 			{
-				effecttime = (tr.refdef.time+10000.0*randomchart[randomindex])/stage->ss->fxDuration;
+				effecttime = (backEnd.refdef.time+10000.0*randomchart[randomindex])/stage->ss->fxDuration;
 				effectpos = (float)effecttime - (int)effecttime;
 
 				randomindex2 = randomindex+effecttime;
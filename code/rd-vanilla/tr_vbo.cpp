@@ -0,0 +1,542 @@
+/*
+===========================================================================
+Copyright (C) 1999 - 2005, Id Software, Inc.
+Copyright (C) 2000 - 2013, Raven Software, Inc.
+Copyright (C) 2001 - 2013, Activision, Inc.
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#include "../server/exe_headers.h"
+
+#include "tr_local.h"
+
+#include <algorithm>
+#include <vector>
+
+/*
+=============================================================
+
+WORLD VERTEX BUFFERS
+
+Static world surfaces whose shaders don't need any per vertex work on the
+cpu are copied into one vertex and one index buffer at load, sorted by
+shader so a batch usually ends up as a few ranges of the index buffer.
+Everything else, and anything that can't be decided until the frame is
+drawn, still goes through tess.
+
+=============================================================
+*/
+
+#define	MAX_WORLD_VBO_RANGES	1024
+
+// grids needing more indexes than this for all their levels of detail build them every frame instead
+#define	MAX_GRID_LOD_INDEXES	65536
+
+static GLuint	worldVBO;
+static GLuint	worldIBO;
+
+typedef struct {
+	int			firstIndex, numIndexes;
+} worldVBODraw_t;
+
+typedef struct {
+	int					numRanges;
+	worldVBODraw_t		ranges[MAX_WORLD_VBO_RANGES];
+
+	// grids too big to keep every level of detail in the buffer have their indexes built here
+	int					numGridIndexes;
+	glIndex_t			gridIndexes[SHADER_MAX_INDEXES];
+
+	// whether the current batch may use the buffer, worked out on the first surface
+	const trRefEntity_t	*allowedEntity;
+	qboolean			allowed;
+} worldVBOBatch_t;
+
+static worldVBOBatch_t	vboBatch;
+
+/*
+=================
+RB_ClearWorldVBOBatch
+=================
+*/
+void RB_ClearWorldVBOBatch( void )
+{
+	vboBatch.numRanges = 0;
+	vboBatch.numGridIndexes = 0;
+	vboBatch.allowedEntity = NULL;
+}
+
+/*
+=================
+RB_WorldVBOUsable
+=================
+*/
+static qboolean RB_WorldVBOUsable( int dlightBits )
+{
+	if ( !worldVBO || dlightBits )
+	{
+		// dlights are projected from tess
+		return qfalse;
+	}
+	if ( vboBatch.allowedEntity != backEnd.currentEntity )
+	{
+		vboBatch.allowedEntity = backEnd.currentEntity;
+		vboBatch.allowed = RB_WorldVBOBatchAllowed();
+	}
+	return vboBatch.allowed;
+}
+
+/*
+=================
+RB_AddWorldVBOSurface
+
+Adds a face or triangle surface to the batch as an index range,
+returns qfalse if it has to go through tess instead
+=================
+*/
+qboolean RB_AddWorldVBOSurface( const worldVBORange_t *range, int dlightBits )
+{
+	if ( !range->numIndexes || !RB_WorldVBOUsable( dlightBits ) )
+	{
+		return qfalse;
+	}
+
+	if ( vboBatch.numRanges )
+	{
+		worldVBODraw_t *last = &vboBatch.ranges[vboBatch.numRanges - 1];
+		if ( last->firstIndex + last->numIndexes == range->firstIndex )
+		{
+			last->numIndexes += range->numIndexes;
+			tess.numVBOVertexes += range->numVerts;
+			tess.numVBOIndexes += range->numIndexes;
+			return qtrue;
+		}
+	}
+
+	if ( vboBatch.numRanges == MAX_WORLD_VBO_RANGES )
+	{
+		RB_EndSurface();
+		RB_BeginSurface( tess.shader, tess.fogNum );
+		if ( !RB_WorldVBOUsable( dlightBits ) )
+		{
+			return qfalse;
+		}
+	}
+
+	vboBatch.ranges[vboBatch.numRanges].firstIndex = range->firstIndex;
+	vboBatch.ranges[vboBatch.numRanges].numIndexes = range->numIndexes;
+	vboBatch.numRanges++;
+	tess.numVBOVertexes += range->numVerts;
+	tess.numVBOIndexes += range->numIndexes;
+	return qtrue;
+}
+
+/*
+=================
+R_WorldVBOGridIndexes
+
+Triangulates the picked rows and columns of a grid whose vertexes start at firstVertex
+=================
+*/
+static glIndex_t *R_WorldVBOGridIndexes( glIndex_t *out, const srfGridMesh_t *cv, int firstVertex, const int *widthTable, int lodWidth, const int *heightTable, int lodHeight )
+{
+	int		i, j;
+
+	for ( i = 0 ; i < lodHeight - 1 ; i++ ) {
+		const int row = firstVertex + heightTable[i] * cv->width;
+		const int nextRow = firstVertex + heightTable[i + 1] * cv->width;
+
+		for ( j = 0 ; j < lodWidth - 1 ; j++ ) {
+			// same order as RB_SurfaceGrid
+			const glIndex_t v2 = row + widthTable[j];
+			const glIndex_t v1 = row + widthTable[j + 1];
+			const glIndex_t v3 = nextRow + widthTable[j];
+			const glIndex_t v4 = nextRow + widthTable[j + 1];
+
+			out[0] = v2;
+			out[1] = v3;
+			out[2] = v1;
+
+			out[3] = v1;
+			out[4] = v3;
+			out[5] = v4;
+			out += 6;
+		}
+	}
+	return out;
+}
+
+/*
+=================
+RB_AddWorldVBOGrid
+
+Adds the index range of the grid's level of detail to the batch, or
+builds the indexes for grids that don't have them in the buffer
+=================
+*/
+qboolean RB_AddWorldVBOGrid( const srfGridMesh_t *cv, int dlightBits, int lod )
+{
+	int		widthTable[MAX_GRID_SIZE];
+	int		heightTable[MAX_GRID_SIZE];
+	int		lodWidth, lodHeight;
+	int		numIndexes;
+
+	if ( !cv->vbo.numVerts )
+	{
+		return qfalse;
+	}
+	if ( cv->lodRanges )
+	{
+		return RB_AddWorldVBOSurface( &cv->lodRanges[lod], dlightBits );
+	}
+	if ( !RB_WorldVBOUsable( dlightBits ) )
+	{
+		return qfalse;
+	}
+
+	R_GridLodTables( cv, lod, widthTable, &lodWidth, heightTable, &lodHeight );
+
+	numIndexes = ( lodWidth - 1 ) * ( lodHeight - 1 ) * 6;
+	if ( numIndexes >= SHADER_MAX_INDEXES )
+	{
+		return qfalse;
+	}
+	if ( vboBatch.numGridIndexes + numIndexes > SHADER_MAX_INDEXES )
+	{
+		RB_EndSurface();
+		RB_BeginSurface( tess.shader, tess.fogNum );
+		if ( !RB_WorldVBOUsable( dlightBits ) )
+		{
+			return qfalse;
+		}
+	}
+
+	R_WorldVBOGridIndexes( vboBatch.gridIndexes + vboBatch.numGridIndexes, cv, cv->vbo.firstVertex, widthTable, lodWidth, heightTable, lodHeight );
+
+	vboBatch.numGridIndexes += numIndexes;
+	tess.numVBOVertexes += lodWidth * lodHeight;
+	tess.numVBOIndexes += numIndexes;
+	return qtrue;
+}
+
+static bool R_WorldVBODrawSort( const worldVBODraw_t &a, const worldVBODraw_t &b )
+{
+	return a.firstIndex < b.firstIndex;
+}
+
+/*
+=================
+RB_BeginWorldVBOBatch
+
+Binds the buffers and merges the batch into as few draws as possible,
+the texture coordinate and colour pointers are up to the stage iterator
+=================
+*/
+void RB_BeginWorldVBOBatch( void )
+{
+	if ( vboBatch.numRanges > 1 )
+	{
+		std::sort( vboBatch.ranges, vboBatch.ranges + vboBatch.numRanges, R_WorldVBODrawSort );
+
+		int merged = 0;
+		for ( int i = 1 ; i < vboBatch.numRanges ; i++ )
+		{
+			worldVBODraw_t *last = &vboBatch.ranges[merged];
+			if ( last->firstIndex + last->numIndexes == vboBatch.ranges[i].firstIndex )
+			{
+				last->numIndexes += vboBatch.ranges[i].numIndexes;
+			}
+			else
+			{
+				vboBatch.ranges[++merged] = vboBatch.ranges[i];
+			}
+		}
+		vboBatch.numRanges = merged + 1;
+	}
+
+	// the generic path leaves the second unit's array on, and it would read past tess
+	if ( qglActiveTextureARB )
+	{
+		GL_SelectTexture( 1 );
+		qglDisableClientState( GL_TEXTURE_COORD_ARRAY );
+		GL_SelectTexture( 0 );
+	}
+
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, worldVBO );
+	qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, worldIBO );
+	qglVertexPointer( 3, GL_FLOAT, sizeof( worldVBOVertex_t ), (const void *)offsetof( worldVBOVertex_t, xyz ) );
+}
+
+/*
+=================
+RB_DrawWorldVBOElements
+=================
+*/
+void RB_DrawWorldVBOElements( void )
+{
+	for ( int i = 0 ; i < vboBatch.numRanges ; i++ )
+	{
+		qglDrawElements( GL_TRIANGLES, vboBatch.ranges[i].numIndexes, GL_INDEX_TYPE,
+			(const void *)( vboBatch.ranges[i].firstIndex * sizeof( glIndex_t ) ) );
+	}
+
+	if ( vboBatch.numGridIndexes )
+	{
+		qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+		qglDrawElements( GL_TRIANGLES, vboBatch.numGridIndexes, GL_INDEX_TYPE, vboBatch.gridIndexes );
+		qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, worldIBO );
+	}
+
+	backEnd.pc.c_vboDraws += vboBatch.numRanges + ( vboBatch.numGridIndexes ? 1 : 0 );
+}
+
+/*
+=================
+RB_EndWorldVBOBatch
+
+Puts the array pointers back on tess for the rest of the batch
+=================
+*/
+void RB_EndWorldVBOBatch( void )
+{
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+	qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+
+	qglVertexPointer( 3, GL_FLOAT, 16, tess.xyz );	// padded for SIMD
+	qglTexCoordPointer( 2, GL_FLOAT, 0, tess.svars.texcoords[0] );
+	qglColorPointer( 4, GL_UNSIGNED_BYTE, 0, tess.svars.colors );
+}
+
+/*
+=================
+R_WorldVBOVertex
+=================
+*/
+static void R_WorldVBOVertex( worldVBOVertex_t *out, const float *xyz, const float *st, const float *lightmap, const byte *color )
+{
+	VectorCopy( xyz, out->xyz );
+	out->st[0] = st[0];
+	out->st[1] = st[1];
+	out->lightmap[0] = lightmap[0];
+	out->lightmap[1] = lightmap[1];
+	memcpy( out->color, color, sizeof( out->color ) );
+}
+
+static bool R_WorldVBOSurfaceSort( const msurface_t *a, const msurface_t *b )
+{
+	return a->shader->index < b->shader->index;
+}
+
+/*
+=================
+R_BuildWorldVBOGridLods
+
+Appends the indexes of every level of detail of a grid, so the back end
+only has to pick a range. Grids with too many are left to build theirs
+every frame.
+=================
+*/
+static void R_BuildWorldVBOGridLods( srfGridMesh_t *grid, int base, std::vector<glIndex_t> &indexes )
+{
+	int		widthTable[MAX_GRID_SIZE];
+	int		heightTable[MAX_GRID_SIZE];
+	int		lodWidth, lodHeight;
+	int		numIndexes;
+	int		lod;
+
+	grid->lodRanges = NULL;
+
+	numIndexes = 0;
+	for ( lod = 0 ; lod < grid->numLods ; lod++ )
+	{
+		R_GridLodTables( grid, lod, widthTable, &lodWidth, heightTable, &lodHeight );
+		numIndexes += ( lodWidth - 1 ) * ( lodHeight - 1 ) * 6;
+	}
+	if ( numIndexes > MAX_GRID_LOD_INDEXES )
+	{
+		return;
+	}
+
+	grid->lodRanges = (worldVBORange_t *)R_Hunk_Alloc( grid->numLods * sizeof( worldVBORange_t ), qtrue );
+	for ( lod = 0 ; lod < grid->numLods ; lod++ )
+	{
+		worldVBORange_t	*range = &grid->lodRanges[lod];
+
+		R_GridLodTables( grid, lod, widthTable, &lodWidth, heightTable, &lodHeight );
+		range->firstVertex = base;
+		range->numVerts = lodWidth * lodHeight;
+		range->firstIndex = (int)indexes.size();
+		range->numIndexes = ( lodWidth - 1 ) * ( lodHeight - 1 ) * 6;
+
+		indexes.resize( range->firstIndex + range->numIndexes );
+		R_WorldVBOGridIndexes( &indexes[range->firstIndex], grid, base, widthTable, lodWidth, heightTable, lodHeight );
+	}
+}
+
+/*
+=================
+R_BuildWorldVBO
+
+Called once the world is loaded
+=================
+*/
+void R_BuildWorldVBO( world_t *world )
+{
+	std::vector<msurface_t *>		surfs;
+	std::vector<worldVBOVertex_t>	verts;
+	std::vector<glIndex_t>			indexes;
+	int								i, j;
+
+	// the main thread needs the context back before touching GL
+	R_IssuePendingRenderCommands();
+	R_DeleteWorldVBO();
+
+	if ( !qglBindBufferARB )
+	{
+		return;
+	}
+
+	for ( i = 0 ; i < world->numsurfaces ; i++ )
+	{
+		msurface_t *surf = &world->surfaces[i];
+		if ( *surf->data != SF_FACE && *surf->data != SF_GRID && *surf->data != SF_TRIANGLES )
+		{
+			continue;
+		}
+		if ( !RB_ShaderCanUseWorldVBO( surf->shader ) )
+		{
+			continue;
+		}
+		surfs.push_back( surf );
+	}
+	if ( surfs.empty() )
+	{
+		return;
+	}
+
+	// surfaces sharing a shader are usually drawn together, keep their indexes next to each other
+	std::stable_sort( surfs.begin(), surfs.end(), R_WorldVBOSurfaceSort );
+
+	for ( i = 0 ; i < (int)surfs.size() ; i++ )
+	{
+		worldVBORange_t	*range;
+		const int		base = (int)verts.size();
+		const int		firstIndex = (int)indexes.size();
+
+		switch ( *surfs[i]->data )
+		{
+		case SF_FACE:
+		{
+			srfSurfaceFace_t	*face = (srfSurfaceFace_t *)surfs[i]->data;
+			const unsigned		*faceIndexes = (unsigned *)( (byte *)face + face->ofsIndices );
+			const float			*v = face->points[0];
+
+			verts.resize( base + face->numPoints );
+			for ( j = 0 ; j < face->numPoints ; j++, v += VERTEXSIZE )
+			{
+				R_WorldVBOVertex( &verts[base + j], v, v + 3, v + VERTEX_LM, (const byte *)&v[VERTEX_COLOR] );
+			}
+			for ( j = 0 ; j < face->numIndices ; j++ )
+			{
+				indexes.push_back( faceIndexes[j] + base );
+			}
+			range = &face->vbo;
+			break;
+		}
+		case SF_GRID:
+		{
+			srfGridMesh_t	*grid = (srfGridMesh_t *)surfs[i]->data;
+			const int		numVerts = grid->width * grid->height;
+
+			verts.resize( base + numVerts );
+			for ( j = 0 ; j < numVerts ; j++ )
+			{
+				const drawVert_t *dv = &grid->verts[j];
+				R_WorldVBOVertex( &verts[base + j], dv->xyz, dv->st, dv->lightmap[0], dv->color[0] );
+			}
+			R_BuildWorldVBOGridLods( grid, base, indexes );
+			range = &grid->vbo;
+			break;
+		}
+		default:
+		{
+			srfTriangles_t	*tri = (srfTriangles_t *)surfs[i]->data;
+
+			verts.resize( base + tri->numVerts );
+			for ( j = 0 ; j < tri->numVerts ; j++ )
+			{
+				const drawVert_t *dv = &tri->verts[j];
+				R_WorldVBOVertex( &verts[base + j], dv->xyz, dv->st, dv->lightmap[0], dv->color[0] );
+			}
+			for ( j = 0 ; j < tri->numIndexes ; j++ )
+			{
+				indexes.push_back( tri->indexes[j] + base );
+			}
+			range = &tri->vbo;
+			break;
+		}
+		}
+
+		range->firstVertex = base;
+		range->numVerts = (int)verts.size() - base;
+		range->firstIndex = firstIndex;
+		range->numIndexes = (int)indexes.size() - firstIndex;
+	}
+
+	qglGenBuffersARB( 1, &worldVBO );
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, worldVBO );
+	qglBufferDataARB( GL_ARRAY_BUFFER_ARB, verts.size() * sizeof( worldVBOVertex_t ), &verts[0], GL_STATIC_DRAW_ARB );
+	qglBindBufferARB( GL_ARRAY_BUFFER_ARB, 0 );
+
+	if ( !indexes.empty() )
+	{
+		qglGenBuffersARB( 1, &worldIBO );
+		qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, worldIBO );
+		qglBufferDataARB( GL_ELEMENT_ARRAY_BUFFER_ARB, indexes.size() * sizeof( glIndex_t ), &indexes[0], GL_STATIC_DRAW_ARB );
+		qglBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, 0 );
+	}
+
+	ri.Printf( PRINT_DEVELOPER, "world vertex buffer: %d of %d surfaces, %d verts, %d indexes\n",
+		(int)surfs.size(), world->numsurfaces, (int)verts.size(), (int)indexes.size() );
+}
+
+/*
+=================
+R_DeleteWorldVBO
+=================
+*/
+void R_DeleteWorldVBO( void )
+{
+	if ( !worldVBO && !worldIBO )
+	{
+		return;
+	}
+
+	R_IssuePendingRenderCommands();
+
+	if ( worldVBO )
+	{
+		qglDeleteBuffersARB( 1, &worldVBO );
+		worldVBO = 0;
+	}
+	if ( worldIBO )
+	{
+		qglDeleteBuffersARB( 1, &worldIBO );
+		worldIBO = 0;
+	}
+}
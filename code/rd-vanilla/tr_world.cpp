@@ -25,6 +25,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define R_LEAFCULL_SSE
+#include <xmmintrin.h>
+#endif
+
 /*
 =================
 R_CullTriSurf
@@ -182,7 +187,7 @@ static int R_DlightFace( srfSurfaceFace_t *face, int dlightBits ) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	face->dlightBits = dlightBits;
+	face->dlightBits[ tr.smpFrame ] = dlightBits;
 	return dlightBits;
 }
 
@@ -210,13 +215,13 @@ static int R_DlightGrid( srfGridMesh_t *grid, int dlightBits ) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	grid->dlightBits = dlightBits;
+	grid->dlightBits[ tr.smpFrame ] = dlightBits;
 	return dlightBits;
 }
 
 static int R_DlightTrisurf( srfTriangles_t *surf, int dlightBits ) {
 	// FIXME: more dlight culling to trisurfs...
-	surf->dlightBits = dlightBits;
+	surf->dlightBits[ tr.smpFrame ] = dlightBits;
 	return dlightBits;
 #if 0
 	int			i;
@@ -296,15 +301,15 @@ static void R_AddWorldSurface( msurface_t *surf, int dlightBits, qboolean noView
 			// already in this view, but lets make sure all the dlight bits are set
 			if ( *surf->data == SF_FACE )
 			{
-				((srfSurfaceFace_t *)surf->data)->dlightBits |= dlightBits;
+				((srfSurfaceFace_t *)surf->data)->dlightBits[ tr.smpFrame ] |= dlightBits;
 			}
 			else if ( *surf->data == SF_GRID )
 			{
-				((srfGridMesh_t *)surf->data)->dlightBits |= dlightBits;
+				((srfGridMesh_t *)surf->data)->dlightBits[ tr.smpFrame ] |= dlightBits;
 			}
 			else if ( *surf->data == SF_TRIANGLES )
 			{
-				((srfTriangles_t *)surf->data)->dlightBits |= dlightBits;
+				((srfTriangles_t *)surf->data)->dlightBits[ tr.smpFrame ] |= dlightBits;
 			}
 			return;
 		}
@@ -477,126 +482,205 @@ void RE_GetBModelVerts( int bmodelIndex, vec3_t *verts, vec3_t normal )
 
 /*
 ================
-R_RecursiveWorldNode
+R_CollectLeafs
 ================
 */
-static void R_RecursiveWorldNode( mnode_t *node, int planeBits, int dlightBits ) {
+static void R_CollectLeafs( world_t *world, mnode_t *node ) {
+	while ( node->contents == -1 ) {
+		R_CollectLeafs( world, node->children[0] );
+		node = node->children[1];
+	}
+	world->leafs[world->numLeafs++] = node;
+}
 
-	do {
-		int			newDlights[2];
+/*
+================
+R_BuildWorldLeafs
 
-		// if the node wasn't marked as potentially visible, exit
-		if (node->visframe != tr.visCount) {
-			return;
-		}
+Lists the leafs in the order a front child first walk of the bsp reaches them,
+so surfaces can be added from a flat pass over the potentially visible ones
+and still come out in the same order
+================
+*/
+void R_BuildWorldLeafs( world_t *world ) {
+	const int	maxLeafs = world->numnodes - world->numDecisionNodes;
+	int			stride;
+
+	world->numLeafs = 0;
+	world->leafs = (mnode_t **) R_Hunk_Alloc( maxLeafs * sizeof( *world->leafs ), qfalse );
+	R_CollectLeafs( world, world->nodes );
+
+	stride = ( world->numLeafs + 3 ) & ~3;
+	world->leafDlightBits = (int *) R_Hunk_Alloc( maxLeafs * sizeof( *world->leafDlightBits ), qtrue );
+	world->numVisLeafs = 0;
+	world->visLeafs = (mnode_t **) R_Hunk_Alloc( world->numLeafs * sizeof( *world->visLeafs ), qfalse );
+	world->visLeafBounds = (float *) R_Hunk_Alloc( 6 * stride * sizeof( *world->visLeafBounds ), qtrue );
+	world->visLeafCulled = (byte *) R_Hunk_Alloc( stride, qtrue );
+}
 
-		// if the bounding volume is outside the frustum, nothing
-		// inside can be visible OPTIMIZE: don't do this all the way to leafs?
+/*
+================
+R_AddVisLeaf
+================
+*/
+static void R_AddVisLeaf( world_t *world, mnode_t *leaf ) {
+	const int	stride = ( world->numLeafs + 3 ) & ~3;
+	const int	i = world->numVisLeafs++;
+	float		*bounds = world->visLeafBounds;
+
+	world->visLeafs[i] = leaf;
+	bounds[0 * stride + i] = leaf->mins[0];
+	bounds[1 * stride + i] = leaf->mins[1];
+	bounds[2 * stride + i] = leaf->mins[2];
+	bounds[3 * stride + i] = leaf->maxs[0];
+	bounds[4 * stride + i] = leaf->maxs[1];
+	bounds[5 * stride + i] = leaf->maxs[2];
+}
 
-		if ( r_nocull->integer!=1 ) {
-			int		r;
+/*
+================
+R_CullWorldLeafs
 
-			if ( planeBits & 1 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[0]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~1;			// all descendants will also be in front
-				}
+Frustum culls every potentially visible leaf. A leaf is only culled when it is
+entirely behind one plane, exactly like BoxOnPlaneSide, so testing leafs alone
+gives the same result as testing every node on the way down to them. The result
+is kept until the pvs or the frustum changes.
+================
+*/
+static void R_CullWorldLeafs( world_t *world ) {
+	static const world_t	*cullWorld;
+	static int				cullVisCount, cullNoCull;
+	static cplane_t			cullFrustum[5];
+	const int				stride = ( world->numLeafs + 3 ) & ~3;
+	const int				count = world->numVisLeafs;
+	const float				*bounds = world->visLeafBounds;
+	byte					*culled = world->visLeafCulled;
+	int						i, p;
+
+	if ( cullWorld == world && cullVisCount == tr.visCount && cullNoCull == r_nocull->integer ) {
+		for ( p = 0 ; p < 5 ; p++ ) {
+			if ( !VectorCompare( cullFrustum[p].normal, tr.viewParms.frustum[p].normal )
+				|| cullFrustum[p].dist != tr.viewParms.frustum[p].dist
+				|| cullFrustum[p].type != tr.viewParms.frustum[p].type ) {
+				break;
 			}
+		}
+		if ( p == 5 ) {
+			return;
+		}
+	}
+	cullWorld = world;
+	cullVisCount = tr.visCount;
+	cullNoCull = r_nocull->integer;
+	memcpy( cullFrustum, tr.viewParms.frustum, sizeof( cullFrustum ) );
 
-			if ( planeBits & 2 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[1]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~2;			// all descendants will also be in front
-				}
-			}
+	memset( culled, 0, stride );
+	if ( r_nocull->integer == 1 ) {
+		return;
+	}
 
-			if ( planeBits & 4 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[2]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~4;			// all descendants will also be in front
-				}
-			}
+	for ( p = 0 ; p < 5 ; p++ ) {
+		cplane_t	*frust = &tr.viewParms.frustum[p];
 
-			if ( planeBits & 8 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[3]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~8;			// all descendants will also be in front
+		if ( frust->type < 3 || frust->signbits >= 8 ) {
+			for ( i = 0 ; i < count ; i++ ) {
+				if ( BoxOnPlaneSide( world->visLeafs[i]->mins, world->visLeafs[i]->maxs, frust ) == 2 ) {
+					culled[i] = 1;
 				}
 			}
+			continue;
+		}
 
-			if ( planeBits & 16 ) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[4]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if ( r == 1 ) {
-					planeBits &= ~16;			// all descendants will also be in front
-				}
+		// the corner furthest in front of the plane, which BoxOnPlaneSide
+		// compares against the plane to decide if the box is behind it
+		const float *x = bounds + ( ( frust->signbits & 1 ) ? 0 : 3 ) * stride;
+		const float *y = bounds + ( ( frust->signbits & 2 ) ? 1 : 4 ) * stride;
+		const float *z = bounds + ( ( frust->signbits & 4 ) ? 2 : 5 ) * stride;
+
+#ifdef R_LEAFCULL_SSE
+		const __m128	nx = _mm_set1_ps( frust->normal[0] );
+		const __m128	ny = _mm_set1_ps( frust->normal[1] );
+		const __m128	nz = _mm_set1_ps( frust->normal[2] );
+		const __m128	dist = _mm_set1_ps( frust->dist );
+
+		for ( i = 0 ; i < count ; i += 4 ) {
+			const __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, _mm_loadu_ps( x + i ) ),
+				_mm_mul_ps( ny, _mm_loadu_ps( y + i ) ) ), _mm_mul_ps( nz, _mm_loadu_ps( z + i ) ) );
+			const int behind = _mm_movemask_ps( _mm_cmplt_ps( d, dist ) );
+
+			culled[i + 0] |= behind & 1;
+			culled[i + 1] |= ( behind >> 1 ) & 1;
+			culled[i + 2] |= ( behind >> 2 ) & 1;
+			culled[i + 3] |= ( behind >> 3 ) & 1;
+		}
+#else
+		for ( i = 0 ; i < count ; i++ ) {
+			if ( frust->normal[0] * x[i] + frust->normal[1] * y[i] + frust->normal[2] * z[i] < frust->dist ) {
+				culled[i] = 1;
 			}
-
 		}
+#endif
+	}
+}
 
-		if ( node->contents != -1 ) {
-			break;
+/*
+================
+R_DlightWorldLeafs
+
+Flags the leafs a dlight reaches, splitting at the same planes the surfaces
+would have been split by on the way down
+================
+*/
+static void R_DlightWorldLeafs( world_t *world, mnode_t *node, const dlight_t *dl, int bit ) {
+	while ( node->contents == -1 ) {
+		const float	dist = DotProduct( dl->origin, node->plane->normal ) - node->plane->dist;
+		const bool	front = dist > -dl->radius;
+		const bool	back = dist < dl->radius;
+
+		if ( front && back ) {
+			R_DlightWorldLeafs( world, node->children[0], dl, bit );
+			node = node->children[1];
+		} else if ( front ) {
+			node = node->children[0];
+		} else if ( back ) {
+			node = node->children[1];
+		} else {
+			return;
 		}
+	}
+	world->leafDlightBits[node - world->nodes - world->numDecisionNodes] |= bit;
+}
 
-		// determine which dlights are needed
-		if ( r_nocull->integer!=2 )
-		{
-			newDlights[0] = 0;
-			newDlights[1] = 0;
-			if ( dlightBits )
-			{
-				int	i;
-				for ( i = 0 ; i < tr.refdef.num_dlights ; i++ )
-				{
-					dlight_t	*dl;
-					float		dist;
-
-					if ( dlightBits & ( 1 << i ) ) {
-						dl = &tr.refdef.dlights[i];
-						dist = DotProduct( dl->origin, node->plane->normal ) - node->plane->dist;
-
-						if ( dist > -dl->radius ) {
-							newDlights[0] |= ( 1 << i );
-						}
-						if ( dist < dl->radius ) {
-							newDlights[1] |= ( 1 << i );
-						}
-					}
-				}
-			}
+/*
+================
+R_AddWorldLeafs
+================
+*/
+static void R_AddWorldLeafs( world_t *world, int dlightBits ) {
+	int		i;
+
+	R_CullWorldLeafs( world );
+
+	if ( r_nocull->integer != 2 ) {
+		for ( i = 0 ; i < world->numVisLeafs ; i++ ) {
+			world->leafDlightBits[world->visLeafs[i] - world->nodes - world->numDecisionNodes] = 0;
 		}
-		else
-		{
-			newDlights[0] = dlightBits;
-			newDlights[1] = dlightBits;
+		for ( i = 0 ; i < tr.refdef.num_dlights ; i++ ) {
+			if ( dlightBits & ( 1 << i ) ) {
+				R_DlightWorldLeafs( world, world->nodes, &tr.refdef.dlights[i], 1 << i );
+			}
 		}
-		// recurse down the children, front side first
-		R_RecursiveWorldNode (node->children[0], planeBits, newDlights[0] );
-
-		// tail recurse
-		node = node->children[1];
-		dlightBits = newDlights[1];
-	} while ( 1 );
+	}
 
-	{
-		// leaf node, so add mark surfaces
-		int			c;
+	for ( i = 0 ; i < world->numVisLeafs ; i++ ) {
+		mnode_t		*node = world->visLeafs[i];
+		int			c, leafDlightBits;
 		msurface_t	*surf, **mark;
 
+		if ( world->visLeafCulled[i] ) {
+			continue;
+		}
+
 		tr.pc.c_leafs++;
 
 		// add to z buffer bounds
@@ -620,6 +704,16 @@ static void R_RecursiveWorldNode( mnode_t *node, int planeBits, int dlightBits )
 			tr.viewParms.visBounds[1][2] = node->maxs[2];
 		}
 
+		if ( r_nocull->integer != 2 ) {
+			leafDlightBits = world->leafDlightBits[node - world->nodes - world->numDecisionNodes];
+			if ( leafDlightBits ) {
+				// drop the lights that only reach parts of the leaf out of view
+				leafDlightBits &= R_DlightClusterBits( node->mins, node->maxs );
+			}
+		} else {
+			leafDlightBits = dlightBits;
+		}
+
 		// add the individual surfaces
 		mark = node->firstmarksurface;
 		c = node->nummarksurfaces;
@@ -627,11 +721,10 @@ static void R_RecursiveWorldNode( mnode_t *node, int planeBits, int dlightBits )
 			// the surface may have already been added if it
 			// spans multiple leafs
 			surf = *mark;
-			R_AddWorldSurface( surf, dlightBits );
+			R_AddWorldSurface( surf, leafDlightBits );
 			mark++;
 		}
 	}
-
 }
 
 /*
@@ -703,13 +796,13 @@ qboolean R_inPVS( vec3_t p1, vec3_t p2 ) {
 ===============
 R_MarkLeaves
 
-Mark the leaves and nodes that are in the PVS for the current
+Lists the leaves that are in the PVS for the current
 cluster
 ===============
 */
 static void R_MarkLeaves (void) {
 	const byte	*vis;
-	mnode_t	*leaf, *parent;
+	mnode_t	*leaf;
 	int		i;
 	int		cluster;
 
@@ -741,11 +834,12 @@ static void R_MarkLeaves (void) {
 
 	tr.visCount++;
 	tr.viewCluster = cluster;
+	tr.world->numVisLeafs = 0;
 
 	if ( r_novis->integer || tr.viewCluster == -1 ) {
-		for (i=0 ; i<tr.world->numnodes ; i++) {
-			if (tr.world->nodes[i].contents != CONTENTS_SOLID) {
-				tr.world->nodes[i].visframe = tr.visCount;
+		for (i=0 ; i<tr.world->numLeafs ; i++) {
+			if (tr.world->leafs[i]->contents != CONTENTS_SOLID) {
+				R_AddVisLeaf( tr.world, tr.world->leafs[i] );
 			}
 		}
 		return;
@@ -753,7 +847,8 @@ static void R_MarkLeaves (void) {
 
 	vis = R_ClusterPVS (tr.viewCluster);
 
-	for (i=0,leaf=tr.world->nodes ; i<tr.world->numnodes ; i++, leaf++) {
+	for (i=0 ; i<tr.world->numLeafs ; i++) {
+		leaf = tr.world->leafs[i];
 		cluster = leaf->cluster;
 		if ( cluster < 0 || cluster >= tr.world->numClusters ) {
 			continue;
@@ -769,13 +864,7 @@ static void R_MarkLeaves (void) {
 			continue;		// not visible
 		}
 
-		parent = leaf;
-		do {
-			if (parent->visframe == tr.visCount)
-				break;
-			parent->visframe = tr.visCount;
-			parent = parent->parent;
-		} while (parent);
+		R_AddVisLeaf( tr.world, leaf );
 	}
 }
 
@@ -807,5 +896,5 @@ void R_AddWorldSurfaces (void) {
 		tr.refdef.num_dlights = 32 ;
 	}
 
-	R_RecursiveWorldNode( tr.world->nodes, 31, ( 1 << tr.refdef.num_dlights ) - 1 );
+	R_AddWorldLeafs( tr.world, ( 1 << tr.refdef.num_dlights ) - 1 );
 }
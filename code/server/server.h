@@ -171,6 +171,8 @@ extern	cvar_t	*sv_mapChecksum;
 extern	cvar_t	*sv_serverid;
 extern  cvar_t	*sv_testsave;
 extern  cvar_t	*sv_compress_saved_games;
+extern  cvar_t	*sv_delta_saved_games;
+extern  cvar_t	*sv_delta_saved_games_interval;
 
 //===========================================================
 
@@ -50,6 +50,8 @@ cvar_t	*sv_mapChecksum;
 cvar_t	*sv_serverid;
 cvar_t	*sv_testsave;			// Run the savegame enumeration every game frame
 cvar_t	*sv_compress_saved_games;	// compress the saved games on the way out (only affect saver, loader can read both)
+cvar_t	*sv_delta_saved_games;		// quicksaves store only the chunks changed since the last full quicksave
+cvar_t	*sv_delta_saved_games_interval;	// number of delta quicksaves between two full ones
 
 /*
 =============================================================================
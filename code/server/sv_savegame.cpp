@@ -60,6 +60,20 @@ char sLastSaveFileLoaded[MAX_QPATH]={0};
 
 static char *SG_GetSaveGameMapName(const char *psPathlessBaseName);
 
+// delta quicksaves (sv_delta_saved_games)...
+//
+static int sg_iDeltaSavesSinceFull = 0;		// delta quicksaves written since the last full one
+static qboolean sg_qbDeltaBaseStored = qfalse;	// qtrue once the last full quicksave was moved to its delta base file
+
+static qboolean SG_IsQuickSave(const char *psPathlessBaseName)
+{
+#ifdef JK2_MODE
+	return (qboolean)!strcmp("quik",psPathlessBaseName);
+#else
+	return (qboolean)!strcmp("quick",psPathlessBaseName);
+#endif
+}
+
 
 #ifdef SG_PROFILE
 
@@ -114,6 +128,15 @@ void SG_WipeSavegame(
 {
 	ojk::SavedGame::remove(
 		psPathlessBaseName);
+
+	if (SG_IsQuickSave(psPathlessBaseName))
+	{
+		// any delta base is useless without the quicksave referencing it...
+		//
+		ojk::SavedGame::get_instance().clear_delta_base();
+		ojk::SavedGame::remove_delta_base(psPathlessBaseName);
+		sg_qbDeltaBaseStored = qfalse;
+	}
 }
 
 // called from the ERR_DROP stuff just in case the error occured during loading of a saved game, because if
@@ -1141,17 +1164,24 @@ qboolean SG_WriteSavegame(const char *psPathlessBaseName, qboolean qbAutosave)
 	const char *psServerInfo = sv.configstrings[CS_SERVERINFO];
 	const char *psMapName    = Info_ValueForKey( psServerInfo, "mapname" );
 //JLF
-#ifdef JK2_MODE
-	if ( !strcmp("quik",psPathlessBaseName))
-#else
-	if ( !strcmp("quick",psPathlessBaseName))
-#endif
+	if ( SG_IsQuickSave(psPathlessBaseName) )
 	{
 		SG_StoreSaveGameComment(va("--> %s <--",psMapName));
 	}
 
 	ojk::SavedGame& saved_game = ojk::SavedGame::get_instance();
 
+	// delta quicksaves only store the chunks that changed since the last full quicksave, which
+	//	becomes the delta base. Every sv_delta_saved_games_interval deltas a full one is written again...
+	//
+	const qboolean qbDeltaMode = (qboolean)(!qbAutosave && sv_delta_saved_games->integer && SG_IsQuickSave(psPathlessBaseName));
+	qboolean qbWriteDelta = qfalse;
+
+	if (qbDeltaMode && saved_game.has_delta_base() && sg_iDeltaSavesSinceFull < sv_delta_saved_games_interval->integer)
+	{
+		qbWriteDelta = qtrue;
+	}
+
 	if(!saved_game.create( "current" ))
 	{
 		Com_Printf (GetString_FailedToOpenSaveGame("current",qfalse));//S_COLOR_RED "Failed to create savegame\n");
@@ -1161,6 +1191,15 @@ qboolean SG_WriteSavegame(const char *psPathlessBaseName, qboolean qbAutosave)
 	}
 //END JLF
 
+	if (qbWriteDelta)
+	{
+		saved_game.begin_delta(psPathlessBaseName);
+	}
+	else if (qbDeltaMode)
+	{
+		saved_game.begin_delta_base();
+	}
+
 	ojk::SavedGameHelper sgh(
 		&saved_game);
 
@@ -1205,13 +1244,54 @@ qboolean SG_WriteSavegame(const char *psPathlessBaseName, qboolean qbAutosave)
 	{
 		Com_Printf (GetString_FailedToOpenSaveGame("current",qfalse));//S_COLOR_RED "Failed to write savegame!\n");
 		SG_WipeSavegame( "current" );
+		if (qbDeltaMode && !qbWriteDelta)
+		{
+			saved_game.clear_delta_base();	// only partially recorded
+		}
 		sv_testsave->integer = iPrevTestSave;
 		return qfalse;
 	}
 
-	ojk::SavedGame::rename(
-		"current",
-		psPathlessBaseName);
+	if (qbWriteDelta && !sg_qbDeltaBaseStored)
+	{
+		// the previous full quicksave is only now overwritten, so keep it as the delta base. Until
+		//	then it stays where it is, so a failed save can't cost the player their last quicksave...
+		//
+		if (!ojk::SavedGame::store_delta("current", psPathlessBaseName))
+		{
+			Com_Printf (GetString_FailedToOpenSaveGame(psPathlessBaseName,qfalse));
+			SG_WipeSavegame( "current" );
+			sv_testsave->integer = iPrevTestSave;
+			return qfalse;
+		}
+		sg_qbDeltaBaseStored = qtrue;
+	}
+	else
+	{
+		ojk::SavedGame::rename(
+			"current",
+			psPathlessBaseName);
+	}
+
+	if (qbWriteDelta)
+	{
+		sg_iDeltaSavesSinceFull++;
+	}
+	else if (SG_IsQuickSave(psPathlessBaseName))
+	{
+		// a full quicksave replaces the previous delta base...
+		//
+		if (sg_qbDeltaBaseStored)
+		{
+			ojk::SavedGame::remove_delta_base(psPathlessBaseName);
+			sg_qbDeltaBaseStored = qfalse;
+		}
+		if (!qbDeltaMode)
+		{
+			saved_game.clear_delta_base();
+		}
+		sg_iDeltaSavesSinceFull = 0;
+	}
 
 	sv_testsave->integer = iPrevTestSave;
 	return qtrue;
@@ -92,6 +92,7 @@ vmCvar_t bot_debugmessages;
 
 vmCvar_t bot_attachments;
 vmCvar_t bot_camp;
+vmCvar_t bot_parallel;
 
 vmCvar_t bot_wp_info;
 vmCvar_t bot_wp_edit;
@@ -724,21 +725,25 @@ void RemoveColorEscapeSequences( char *text ) {
 BotAI
 ==============
 */
-int BotAI(int client, float thinktime) {
+/*
+==============
+BotAIBeginThink
+
+Everything a bot's think does before StandardBotAI.
+Returns the bot's state, or NULL if it isn't set up.
+==============
+*/
+static bot_state_t *BotAIBeginThink(int client, float thinktime) {
 	bot_state_t *bs;
 	char buf[1024], *args;
 	int j;
-#ifdef _DEBUG
-	int start = 0;
-	int end = 0;
-#endif
 
 	trap->EA_ResetInput(client);
 	//
 	bs = botstates[client];
 	if (!bs || !bs->inuse) {
 		BotAI_Print(PRT_FATAL, "BotAI: client %d is not setup\n", client);
-		return qfalse;
+		return NULL;
 	}
 
 	//retrieve the current client state
@@ -778,7 +783,22 @@ int BotAI(int client, float thinktime) {
 	bs->eye[2] += bs->cur_ps.viewheight;
 	//get the area the bot is in
 
+	return bs;
+}
+
+/*
+==============
+BotAIEndThink
+
+Runs StandardBotAI and finishes the think started by BotAIBeginThink.
+==============
+*/
+static void BotAIEndThink(bot_state_t *bs, float thinktime) {
+	int j;
 #ifdef _DEBUG
+	int start = 0;
+	int end = 0;
+
 	start = trap->Milliseconds();
 #endif
 	StandardBotAI(bs, thinktime);
@@ -797,6 +817,21 @@ int BotAI(int client, float thinktime) {
 	for (j = 0; j < 3; j++) {
 		bs->viewangles[j] = AngleMod(bs->viewangles[j] - SHORT2ANGLE(bs->cur_ps.delta_angles[j]));
 	}
+}
+
+/*
+==============
+BotAI
+==============
+*/
+int BotAI(int client, float thinktime) {
+	bot_state_t *bs = BotAIBeginThink(client, thinktime);
+
+	if (!bs) {
+		return qfalse;
+	}
+
+	BotAIEndThink(bs, thinktime);
 	//everything was ok
 	return qtrue;
 }
@@ -1131,16 +1166,16 @@ qboolean BotPVSCheck( const vec3_t p1, const vec3_t p2 )
 	return trap->InPVS(p1, p2);
 }
 
-//get the index to the nearest visible waypoint in the global trail
-int GetNearestVisibleWP(vec3_t org, int ignore)
+//get the index to the nearest visible waypoint in the global trail,
+//using candidates (MAX_WPARRAY_SIZE long) as scratch space
+static int GetNearestVisibleWPInto(vec3_t org, int ignore, wpCandidate_t *candidates)
 {
+	int numCandidates;
+	int n;
 	int i;
 	float bestdist;
-	float flLen;
-	int bestindex;
-	vec3_t a, mins, maxs;
+	vec3_t mins, maxs;
 
-	i = 0;
 	if (RMG.integer)
 	{
 		bestdist = 300;
@@ -1150,7 +1185,6 @@ int GetNearestVisibleWP(vec3_t org, int ignore)
 		bestdist = 800;//99999;
 				   //don't trace over 800 units away to avoid GIANT HORRIBLE SPEED HITS ^_^
 	}
-	bestindex = -1;
 
 	mins[0] = -15;
 	mins[1] = -15;
@@ -1159,24 +1193,28 @@ int GetNearestVisibleWP(vec3_t org, int ignore)
 	maxs[1] = 15;
 	maxs[2] = 1;
 
-	while (i < gWPNum)
+	// closest first, so the first visible one is the nearest
+	numCandidates = WPGrid_Gather(org, bestdist, candidates);
+	WPGrid_SortCandidates(candidates, numCandidates, qtrue);
+
+	for (n = 0; n < numCandidates; n++)
 	{
-		if (gWPArray[i] && gWPArray[i]->inuse)
-		{
-			VectorSubtract(org, gWPArray[i]->origin, a);
-			flLen = VectorLength(a);
+		i = candidates[n].index;
 
-			if (flLen < bestdist && (RMG.integer || BotPVSCheck(org, gWPArray[i]->origin)) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
-			{
-				bestdist = flLen;
-				bestindex = i;
-			}
+		if ((RMG.integer || BotPVSCheck(org, gWPArray[i]->origin)) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
+		{
+			return i;
 		}
-
-		i++;
 	}
 
-	return bestindex;
+	return -1;
+}
+
+int GetNearestVisibleWP(vec3_t org, int ignore)
+{
+	static wpCandidate_t candidates[MAX_WPARRAY_SIZE];	// main thread only, BotPerceive has its own
+
+	return GetNearestVisibleWPInto(org, ignore, candidates);
 }
 
 //wpDirection
@@ -2155,6 +2193,86 @@ int PassLovedOneCheck(bot_state_t *bs, gentity_t *ent)
 qboolean G_ThereIsAMaster(void);
 
 //standard check to find a new enemy.
+/*
+==============
+BotPerceive
+
+Does the visibility checks StandardBotAI will want this think ahead of time.
+Only traces and reads game state, so it can run for several bots at once.
+candidates is waypoint scratch space no other thread is using.
+==============
+*/
+static void BotPerceive(bot_state_t *bs, wpCandidate_t *candidates)
+{
+	gentity_t *ent;
+	int i;
+
+	bs->perceiveTime = level.time;
+
+	// the same checks ScanForEnemies makes before tracing
+	for (i = 0; i < MAX_CLIENTS; i++)
+	{
+		ent = &g_entities[i];
+		bs->perceivedClientVis[i] = -1;
+
+		if (i != bs->client && ent->client && !OnSameTeam(&g_entities[bs->client], ent) &&
+			PassStandardEnemyChecks(bs, ent) && BotPVSCheck(ent->client->ps.origin, bs->eye))
+		{
+			bs->perceivedClientVis[i] = OrgVisible(bs->eye, ent->client->ps.origin, -1);
+		}
+	}
+
+	bs->perceivedWP = bs->wpCurrent;
+	if (bs->wpCurrent)
+	{
+		bs->perceivedWPVis = WPOrgVisible(&g_entities[bs->client], bs->origin, bs->wpCurrent->origin, bs->client);
+		bs->perceivedNearestWPValid = qfalse;
+	}
+	else
+	{
+		bs->perceivedNearestWP = GetNearestVisibleWPInto(bs->origin, bs->client, candidates);
+		bs->perceivedNearestWPValid = qtrue;
+	}
+}
+
+// BotPerceive is split into this many slots, each with its own waypoint scratch space,
+// so worker threads don't need room for a whole candidate list on their stacks
+#define BOT_PERCEIVE_SLOTS	8
+
+static wpCandidate_t botPerceiveCandidates[BOT_PERCEIVE_SLOTS][MAX_WPARRAY_SIZE];
+
+typedef struct botPerceiveJob_s {
+	bot_state_t	**thinking;
+	int			numThinking;
+	int			numSlots;
+} botPerceiveJob_t;
+
+static void BotPerceiveBatch(void *data, int begin, int end)
+{
+	const botPerceiveJob_t *job = (const botPerceiveJob_t *)data;
+	int slot, i;
+
+	// every slot runs in exactly one batch, so its scratch space is never shared
+	for (slot = begin; slot < end; slot++)
+	{
+		for (i = slot; i < job->numThinking; i += job->numSlots)
+		{
+			BotPerceive(job->thinking[i], botPerceiveCandidates[slot]);
+		}
+	}
+}
+
+//is the client visible from the bot's eye, using what BotPerceive found if it can
+static int BotClientVisible(bot_state_t *bs, int client)
+{
+	if (bs->perceiveTime == level.time && client < MAX_CLIENTS && bs->perceivedClientVis[client] != -1)
+	{
+		return bs->perceivedClientVis[client];
+	}
+
+	return OrgVisible(bs->eye, g_entities[client].client->ps.origin, -1);
+}
+
 int ScanForEnemies(bot_state_t *bs)
 {
 	vec3_t a;
@@ -2208,7 +2326,7 @@ int ScanForEnemies(bot_state_t *bs)
 				distcheck = 1;
 			}
 
-			if (distcheck < closest && ((InFieldOfVision(bs->viewangles, 90, a) && !BotMindTricked(bs->client, i)) || BotCanHear(bs, &g_entities[i], distcheck)) && OrgVisible(bs->eye, g_entities[i].client->ps.origin, -1))
+			if (distcheck < closest && ((InFieldOfVision(bs->viewangles, 90, a) && !BotMindTricked(bs->client, i)) || BotCanHear(bs, &g_entities[i], distcheck)) && BotClientVisible(bs, i))
 			{
 				if (BotMindTricked(bs->client, i))
 				{
@@ -6531,7 +6649,14 @@ void StandardBotAI(bot_state_t *bs, float thinktime)
 
 	if (!bs->wpCurrent)
 	{
-		wp = GetNearestVisibleWP(bs->origin, bs->client);
+		if (bs->perceiveTime == level.time && bs->perceivedNearestWPValid)
+		{
+			wp = bs->perceivedNearestWP;
+		}
+		else
+		{
+			wp = GetNearestVisibleWP(bs->origin, bs->client);
+		}
 
 		if (wp != -1)
 		{
@@ -6592,7 +6717,14 @@ void StandardBotAI(bot_state_t *bs, float thinktime)
 		}
 		bs->frame_Waypoint_Len = VectorLength(a);
 
-		visResult = WPOrgVisible(&g_entities[bs->client], bs->origin, bs->wpCurrent->origin, bs->client);
+		if (bs->perceiveTime == level.time && bs->perceivedWP == bs->wpCurrent)
+		{
+			visResult = bs->perceivedWPVis;
+		}
+		else
+		{
+			visResult = WPOrgVisible(&g_entities[bs->client], bs->origin, bs->wpCurrent->origin, bs->client);
+		}
 
 		if (visResult == 2)
 		{
@@ -7525,6 +7657,9 @@ BotAIStartFrame
 */
 int BotAIStartFrame(int time) {
 	int i;
+	bot_state_t *thinking[MAX_CLIENTS];
+	bot_state_t *bs;
+	int numThinking;
 	int elapsed_time, thinktime;
 	static int local_time;
 //	static int botlib_residual;
@@ -7534,6 +7669,7 @@ int BotAIStartFrame(int time) {
 	{
 		trap->Cvar_Update(&bot_pvstype);
 		trap->Cvar_Update(&bot_camp);
+		trap->Cvar_Update(&bot_parallel);
 		trap->Cvar_Update(&bot_attachments);
 		trap->Cvar_Update(&bot_forgimmick);
 		trap->Cvar_Update(&bot_honorableduelacceptance);
@@ -7569,6 +7705,7 @@ int BotAIStartFrame(int time) {
 	else thinktime = BOT_THINK_TIME;
 
 	// execute scheduled bot AI
+	numThinking = 0;
 	for( i = 0; i < MAX_CLIENTS; i++ ) {
 		if( !botstates[i] || !botstates[i]->inuse ) {
 			continue;
@@ -7580,11 +7717,34 @@ int BotAIStartFrame(int time) {
 			botstates[i]->botthink_residual -= thinktime;
 
 			if (g_entities[i].client->pers.connected == CON_CONNECTED) {
-				BotAI(i, (float) thinktime / 1000);
+				if (bot_parallel.integer) {
+					bs = BotAIBeginThink(i, (float) thinktime / 1000);
+					if (bs) {
+						thinking[numThinking++] = bs;
+					}
+				}
+				else {
+					BotAI(i, (float) thinktime / 1000);
+				}
 			}
 		}
 	}
 
+	if (numThinking) {
+		botPerceiveJob_t job;
+
+		// work out what every bot can see at once, then let them decide one at a time
+		job.thinking = thinking;
+		job.numThinking = numThinking;
+		job.numSlots = numThinking < BOT_PERCEIVE_SLOTS ? numThinking : BOT_PERCEIVE_SLOTS;
+		WPGrid_Update();
+		trap->ParallelFor(job.numSlots, 1, BotPerceiveBatch, &job);
+
+		for (i = 0; i < numThinking; i++) {
+			BotAIEndThink(thinking[i], (float) thinktime / 1000);
+		}
+	}
+
 	// execute bot user commands every frame
 	for( i = 0; i < MAX_CLIENTS; i++ ) {
 		if( !botstates[i] || !botstates[i]->inuse ) {
@@ -7623,6 +7783,7 @@ int BotAISetup( int restart ) {
 
 	trap->Cvar_Register(&bot_attachments, "bot_attachments", "1", 0);
 	trap->Cvar_Register(&bot_camp, "bot_camp", "1", 0);
+	trap->Cvar_Register(&bot_parallel, "bot_parallel", "0", 0);
 
 	trap->Cvar_Register(&bot_wp_info, "bot_wp_info", "1", 0);
 	trap->Cvar_Register(&bot_wp_edit, "bot_wp_edit", "0", CVAR_CHEAT);
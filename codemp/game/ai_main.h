@@ -353,6 +353,14 @@ typedef struct bot_state_s
 	int					forceMove_Right;
 	int					forceMove_Up;
 	//end rww
+
+	// visibility worked out up front by BotPerceive, only valid while perceiveTime is level.time
+	int					perceiveTime;
+	int					perceivedClientVis[MAX_CLIENTS];	// -1 if not checked
+	wpobject_t			*perceivedWP;						// wpCurrent when perceivedWPVis was checked
+	int					perceivedWPVis;
+	qboolean			perceivedNearestWPValid;
+	int					perceivedNearestWP;
 } bot_state_t;
 
 void *B_TempAlloc(int size);
@@ -387,6 +395,7 @@ extern vmCvar_t bot_debugmessages;
 
 extern vmCvar_t bot_attachments;
 extern vmCvar_t bot_camp;
+extern vmCvar_t bot_parallel;
 
 extern vmCvar_t bot_wp_info;
 extern vmCvar_t bot_wp_edit;
@@ -411,6 +420,17 @@ extern int gWPRenderedFrame;
 extern wpobject_t *gWPArray[MAX_WPARRAY_SIZE];
 extern int gWPNum;
 
+// a waypoint returned by a grid query
+typedef struct wpCandidate_s {
+	int		index;
+	float	dist;
+} wpCandidate_t;
+
+void WPGrid_Invalidate( void );
+void WPGrid_Update( void );
+int WPGrid_Gather( const vec3_t org, float radius, wpCandidate_t *list );
+void WPGrid_SortCandidates( wpCandidate_t *list, int num, qboolean byDistance );
+
 extern int gLastPrintedIndex;
 extern nodeobject_t nodetable[MAX_NODETABLE_SIZE];
 extern int nodenum;
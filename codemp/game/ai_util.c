@@ -160,6 +160,7 @@ void B_InitAlloc(void)
 #endif
 
 	memset(gWPArray, 0, sizeof(gWPArray));
+	WPGrid_Invalidate();
 }
 
 void B_CleanupAlloc(void)
@@ -34,6 +34,163 @@ int gWPRenderedFrame = 0;
 wpobject_t *gWPArray[MAX_WPARRAY_SIZE];
 int gWPNum = 0;
 
+/*
+==============================================================================
+
+WAYPOINT GRID
+
+Waypoint origins are bucketed into a hashed uniform grid so range queries only
+look at nearby waypoints instead of the whole of gWPArray. The grid is rebuilt
+lazily on the next query after anything touches the waypoint array.
+
+==============================================================================
+*/
+
+#define WPGRID_CELL_SIZE	256
+#define WPGRID_HASH_SIZE	4096	// power of two
+
+static int wpGridHead[WPGRID_HASH_SIZE];
+static int wpGridNext[MAX_WPARRAY_SIZE];
+static int wpGridCell[MAX_WPARRAY_SIZE][3];
+static qboolean wpGridValid = qfalse;
+
+static int WPGrid_CellCoord( float f )
+{
+	return (int)floor( f / WPGRID_CELL_SIZE );
+}
+
+static int WPGrid_Hash( int x, int y, int z )
+{
+	return (int)( ( (unsigned)x * 73856093u ^ (unsigned)y * 19349663u ^ (unsigned)z * 83492791u ) & ( WPGRID_HASH_SIZE - 1 ) );
+}
+
+void WPGrid_Invalidate( void )
+{
+	wpGridValid = qfalse;
+}
+
+static void WPGrid_Build( void )
+{
+	int i, hash;
+
+	memset( wpGridHead, -1, sizeof( wpGridHead ) );
+
+	// insert backwards so every chain is in index order
+	for ( i = gWPNum - 1; i >= 0; i-- )
+	{
+		if ( !gWPArray[i] || !gWPArray[i]->inuse )
+		{
+			continue;
+		}
+
+		wpGridCell[i][0] = WPGrid_CellCoord( gWPArray[i]->origin[0] );
+		wpGridCell[i][1] = WPGrid_CellCoord( gWPArray[i]->origin[1] );
+		wpGridCell[i][2] = WPGrid_CellCoord( gWPArray[i]->origin[2] );
+
+		hash = WPGrid_Hash( wpGridCell[i][0], wpGridCell[i][1], wpGridCell[i][2] );
+		wpGridNext[i] = wpGridHead[hash];
+		wpGridHead[hash] = i;
+	}
+
+	wpGridValid = qtrue;
+}
+
+/*
+==================
+WPGrid_Update
+
+Rebuilds the grid now if it's out of date. Queries build it on demand, but that
+mustn't happen from several threads at once.
+==================
+*/
+void WPGrid_Update( void )
+{
+	if ( !wpGridValid )
+	{
+		WPGrid_Build();
+	}
+}
+
+/*
+==================
+WPGrid_Gather
+
+Fills list with every in use waypoint closer than radius to org and their distances.
+The order is unspecified. Returns the number found.
+==================
+*/
+int WPGrid_Gather( const vec3_t org, float radius, wpCandidate_t *list )
+{
+	int mins[3], maxs[3];
+	int x, y, z, i, num = 0;
+	vec3_t a;
+	float dist;
+
+	WPGrid_Update();
+
+	for ( i = 0; i < 3; i++ )
+	{
+		mins[i] = WPGrid_CellCoord( org[i] - radius );
+		maxs[i] = WPGrid_CellCoord( org[i] + radius );
+	}
+
+	for ( x = mins[0]; x <= maxs[0]; x++ )
+	{
+		for ( y = mins[1]; y <= maxs[1]; y++ )
+		{
+			for ( z = mins[2]; z <= maxs[2]; z++ )
+			{
+				for ( i = wpGridHead[WPGrid_Hash( x, y, z )]; i != -1; i = wpGridNext[i] )
+				{
+					// other cells can share the bucket
+					if ( wpGridCell[i][0] != x || wpGridCell[i][1] != y || wpGridCell[i][2] != z )
+					{
+						continue;
+					}
+
+					VectorSubtract( org, gWPArray[i]->origin, a );
+					dist = VectorLength( a );
+
+					if ( dist < radius )
+					{
+						list[num].index = i;
+						list[num].dist = dist;
+						num++;
+					}
+				}
+			}
+		}
+	}
+
+	return num;
+}
+
+static int QDECL WPGrid_SortByIndex( const void *a, const void *b )
+{
+	return ((const wpCandidate_t *)a)->index - ((const wpCandidate_t *)b)->index;
+}
+
+static int QDECL WPGrid_SortByDistance( const void *a, const void *b )
+{
+	const wpCandidate_t *ca = (const wpCandidate_t *)a;
+	const wpCandidate_t *cb = (const wpCandidate_t *)b;
+
+	if ( ca->dist < cb->dist )
+	{
+		return -1;
+	}
+	if ( ca->dist > cb->dist )
+	{
+		return 1;
+	}
+	return ca->index - cb->index;
+}
+
+void WPGrid_SortCandidates( wpCandidate_t *list, int num, qboolean byDistance )
+{
+	qsort( list, num, sizeof( *list ), byDistance ? WPGrid_SortByDistance : WPGrid_SortByIndex );
+}
+
 int gLastPrintedIndex = -1;
 
 nodeobject_t nodetable[MAX_NODETABLE_SIZE];
@@ -367,6 +524,8 @@ checkprint:
 
 void TransferWPData(int from, int to)
 {
+	WPGrid_Invalidate();
+
 	if (!gWPArray[to])
 	{
 		gWPArray[to] = (wpobject_t *)B_Alloc(sizeof(wpobject_t));
@@ -389,6 +548,8 @@ void TransferWPData(int from, int to)
 
 void CreateNewWP(vec3_t origin, int flags)
 {
+	WPGrid_Invalidate();
+
 	if (gWPNum >= MAX_WPARRAY_SIZE)
 	{
 		if (!RMG.integer)
@@ -423,6 +584,8 @@ void CreateNewWP_FromObject(wpobject_t *wp)
 {
 	int i;
 
+	WPGrid_Invalidate();
+
 	if (gWPNum >= MAX_WPARRAY_SIZE)
 	{
 		return;
@@ -474,6 +637,8 @@ void CreateNewWP_FromObject(wpobject_t *wp)
 
 void RemoveWP(void)
 {
+	WPGrid_Invalidate();
+
 	if (gWPNum <= 0)
 	{
 		return;
@@ -514,6 +679,8 @@ void RemoveWP_InTrail(int afterindex)
 	int didchange;
 	int i;
 
+	WPGrid_Invalidate();
+
 	foundindex = 0;
 	foundanindex = 0;
 	didchange = 0;
@@ -581,6 +748,8 @@ int CreateNewWP_InTrail(vec3_t origin, int flags, int afterindex)
 	int foundanindex;
 	int i;
 
+	WPGrid_Invalidate();
+
 	foundindex = 0;
 	foundanindex = 0;
 	i = 0;
@@ -659,6 +828,8 @@ int CreateNewWP_InsertUnder(vec3_t origin, int flags, int afterindex)
 	int foundanindex;
 	int i;
 
+	WPGrid_Invalidate();
+
 	foundindex = 0;
 	foundanindex = 0;
 	i = 0;
@@ -1634,6 +1805,10 @@ int CanForceJumpTo(int baseindex, int testingindex, float distance)
 
 void CalculatePaths(void)
 {
+	static wpCandidate_t candidates[MAX_WPARRAY_SIZE];
+	int numCandidates;
+	int n;
+	float linkRange;
 	int i;
 	int c;
 	int forceJumpable;
@@ -1678,17 +1853,24 @@ void CalculatePaths(void)
 		i++;
 	}
 
+	// nothing further than this can be linked, see CanForceJumpTo
+	linkRange = (float)Q_max( maxNeighborDist, 400 ) + 1;
+
 	i = 0;
 
 	while (i < gWPNum)
 	{
 		if (gWPArray[i] && gWPArray[i]->inuse)
 		{
-			c = 0;
+			// same order as testing every waypoint, so the links come out the same
+			numCandidates = WPGrid_Gather(gWPArray[i]->origin, linkRange, candidates);
+			WPGrid_SortCandidates(candidates, numCandidates, qfalse);
 
-			while (c < gWPNum)
+			for (n = 0; n < numCandidates; n++)
 			{
-				if (gWPArray[c] && gWPArray[c]->inuse && i != c &&
+				c = candidates[n].index;
+
+				if (i != c &&
 					NotWithinRange(i, c))
 				{
 					VectorSubtract(gWPArray[i]->origin, gWPArray[c]->origin, a);
@@ -1717,7 +1899,6 @@ void CalculatePaths(void)
 						break;
 					}
 				}
-				c++;
 			}
 		}
 		i++;
@@ -1828,15 +2009,11 @@ float botGlobalNavWeaponWeights[WP_NUM_WEAPONS] =
 
 int GetNearestVisibleWPToItem(vec3_t org, int ignore)
 {
+	wpCandidate_t candidates[MAX_WPARRAY_SIZE];
+	int numCandidates;
+	int n;
 	int i;
-	float bestdist;
-	float flLen;
-	int bestindex;
-	vec3_t a, mins, maxs;
-
-	i = 0;
-	bestdist = 64; //has to be less than 64 units to the item or it isn't safe enough
-	bestindex = -1;
+	vec3_t mins, maxs;
 
 	mins[0] = -15;
 	mins[1] = -15;
@@ -1845,26 +2022,23 @@ int GetNearestVisibleWPToItem(vec3_t org, int ignore)
 	maxs[1] = 15;
 	maxs[2] = 0;
 
-	while (i < gWPNum)
+	//has to be less than 64 units to the item or it isn't safe enough
+	numCandidates = WPGrid_Gather(org, 64, candidates);
+	WPGrid_SortCandidates(candidates, numCandidates, qtrue);
+
+	for (n = 0; n < numCandidates; n++)
 	{
-		if (gWPArray[i] && gWPArray[i]->inuse &&
-			gWPArray[i]->origin[2]-15 < org[2] &&
-			gWPArray[i]->origin[2]+15 > org[2])
-		{
-			VectorSubtract(org, gWPArray[i]->origin, a);
-			flLen = VectorLength(a);
+		i = candidates[n].index;
 
-			if (flLen < bestdist && trap->InPVS(org, gWPArray[i]->origin) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
-			{
-				bestdist = flLen;
-				bestindex = i;
-			}
+		if (gWPArray[i]->origin[2]-15 < org[2] &&
+			gWPArray[i]->origin[2]+15 > org[2] &&
+			trap->InPVS(org, gWPArray[i]->origin) && OrgVisibleBox(org, mins, maxs, gWPArray[i]->origin, ignore))
+		{
+			return i;
 		}
-
-		i++;
 	}
 
-	return bestindex;
+	return -1;
 }
 
 void CalculateWeightGoals(void)
@@ -29,7 +29,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #define Q3_INFINITE			16777216
 
-#define	GAME_API_VERSION	1
+#define	GAME_API_VERSION	2
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -1093,6 +1093,10 @@ typedef struct gameImport_s {
 	void		(*G2API_CleanEntAttachments)			( void );
 	qboolean	(*G2API_OverrideServer)					( void *serverInstance );
 	void		(*G2API_GetSurfaceName)					( void *ghoul2, int surfNumber, int modelIndex, char *fillBuf );
+
+	// calls func over [0, count) in batches of at least minBatch, possibly on several threads at once
+	// only traces, PVS checks and reading game state are safe from func
+	void		(*ParallelFor)							( int count, int minBatch, void (*func)( void *data, int begin, int end ), void *data );
 } gameImport_t;
 
 typedef struct gameExport_s {
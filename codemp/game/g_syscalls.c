@@ -915,6 +915,12 @@ void trap_G2API_CollisionDetectCache( CollisionRecord_t *collRecMap, void* ghoul
 void trap_G2API_GetSurfaceName(void *ghoul2, int surfNumber, int modelIndex, char *fillBuf) {
 	Q_syscall(G_G2_GETSURFACENAME, ghoul2, surfNumber, modelIndex, fillBuf);
 }
+// there's no legacy syscall for this, so it always runs on the calling thread
+void trap_ParallelFor( int count, int minBatch, void (*func)( void *data, int begin, int end ), void *data ) {
+	if ( count > 0 ) {
+		func( data, 0, count );
+	}
+}
 qboolean trap_G2API_SetRootSurface(void *ghoul2, const int modelIndex, const char *surfaceName) {
 	return Q_syscall(G_G2_SETROOTSURFACE, ghoul2, modelIndex, surfaceName);
 }
@@ -1354,4 +1360,5 @@ static void TranslateSyscalls( void ) {
 	trap->G2API_CleanEntAttachments			= trap_G2API_CleanEntAttachments;
 	trap->G2API_OverrideServer				= trap_G2API_OverrideServer;
 	trap->G2API_GetSurfaceName				= trap_G2API_GetSurfaceName;
+	trap->ParallelFor						= trap_ParallelFor;
 }
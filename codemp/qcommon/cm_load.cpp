@@ -65,12 +65,28 @@ cvar_t		*cm_noAreas;
 cvar_t		*cm_noCurves;
 cvar_t		*cm_playerCurveClip;
 cvar_t		*cm_extraVerbose;
+cvar_t		*cm_debugSurfaceUpdate;
 #endif
 
 cmodel_t	box_model;
 cplane_t	*box_planes;
 cbrush_t	*box_brush;
 
+// a copy of the box hull for each thread tracing concurrently, rebuilt when the map changes
+typedef struct threadBoxHull_s {
+	int				generation;
+	cmodel_t		model;
+	cbrush_t		brush;
+	cbrushside_t	sides[6];
+	cplane_t		planes[12];
+} threadBoxHull_t;
+
+static int					boxHullGeneration;
+static thread_local threadBoxHull_t	threadBoxHull;
+thread_local bool			cm_concurrentTrace;
+
+static threadBoxHull_t *CM_ThreadBoxHull( void );
+
 
 
 void	CM_InitBoxHull (void);
@@ -635,6 +651,7 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	cm_noCurves = Cvar_Get ("cm_noCurves", "0", CVAR_CHEAT);
 	cm_playerCurveClip = Cvar_Get ("cm_playerCurveClip", "1", CVAR_ARCHIVE_ND|CVAR_CHEAT );
 	cm_extraVerbose = Cvar_Get ("cm_extraVerbose", "0", CVAR_TEMP );
+	cm_debugSurfaceUpdate = Cvar_Get ("r_debugSurfaceUpdate", "1", 0 );
 #endif
 	Com_DPrintf( "CM_LoadMap( %s, %i )\n", name, clientload );
 
@@ -843,6 +860,10 @@ cmodel_t	*CM_ClipHandleToModel( clipHandle_t handle, clipMap_t **clipMap ) {
 		{
 			*clipMap = &cmg;
 		}
+		if ( cm_concurrentTrace )
+		{
+			return &CM_ThreadBoxHull()->model;
+		}
 		return &box_model;
 	}
 
@@ -920,43 +941,34 @@ Set up the planes and nodes so that the six floats of a bounding box
 can just be stored out and get a proper clipping hull structure.
 ===================
 */
-void CM_InitBoxHull (void)
+static void CM_SetupBoxHull( cbrush_t *brush, cbrushside_t *sides, cplane_t *planes )
 {
 	int			i;
 	int			side;
 	cplane_t	*p;
 	cbrushside_t	*s;
 
-	box_planes = &cmg.planes[cmg.numPlanes];
-
-	box_brush = &cmg.brushes[cmg.numBrushes];
-	box_brush->numsides = 6;
-	box_brush->sides = cmg.brushsides + cmg.numBrushSides;
-	box_brush->contents = CONTENTS_BODY;
-
-	box_model.firstNode = -1;
-	box_model.leaf.numLeafBrushes = 1;
-//	box_model.leaf.firstLeafBrush = cmg.numBrushes;
-	box_model.leaf.firstLeafBrush = cmg.numLeafBrushes;
-	cmg.leafbrushes[cmg.numLeafBrushes] = cmg.numBrushes;
+	brush->numsides = 6;
+	brush->sides = sides;
+	brush->contents = CONTENTS_BODY;
 
 	for (i=0 ; i<6 ; i++)
 	{
 		side = i&1;
 
 		// brush sides
-		s = &cmg.brushsides[cmg.numBrushSides+i];
-		s->plane = 	cmg.planes + (cmg.numPlanes+i*2+side);
+		s = &sides[i];
+		s->plane = 	planes + (i*2+side);
 		s->shaderNum = cmg.numShaders;
 
 		// planes
-		p = &box_planes[i*2];
+		p = &planes[i*2];
 		p->type = i>>1;
 		p->signbits = 0;
 		VectorClear (p->normal);
 		p->normal[i>>1] = 1;
 
-		p = &box_planes[i*2+1];
+		p = &planes[i*2+1];
 		p->type = 3 + (i>>1);
 		p->signbits = 0;
 		VectorClear (p->normal);
@@ -966,6 +978,88 @@ void CM_InitBoxHull (void)
 	}
 }
 
+void CM_InitBoxHull (void)
+{
+	box_planes = &cmg.planes[cmg.numPlanes];
+
+	box_brush = &cmg.brushes[cmg.numBrushes];
+	CM_SetupBoxHull( box_brush, cmg.brushsides + cmg.numBrushSides, box_planes );
+
+	box_model.firstNode = -1;
+	box_model.leaf.numLeafBrushes = 1;
+//	box_model.leaf.firstLeafBrush = cmg.numBrushes;
+	box_model.leaf.firstLeafBrush = cmg.numLeafBrushes;
+	cmg.leafbrushes[cmg.numLeafBrushes] = cmg.numBrushes;
+
+	boxHullGeneration++;
+}
+
+/*
+===================
+CM_SetBoxHull
+===================
+*/
+static void CM_SetBoxHull( cmodel_t *model, cbrush_t *brush, cplane_t *planes, const vec3_t mins, const vec3_t maxs, int capsule )
+{
+	VectorCopy( mins, model->mins );
+	VectorCopy( maxs, model->maxs );
+
+	if ( capsule ) {
+		return;
+	}
+
+	planes[0].dist = maxs[0];
+	planes[1].dist = -maxs[0];
+	planes[2].dist = mins[0];
+	planes[3].dist = -mins[0];
+	planes[4].dist = maxs[1];
+	planes[5].dist = -maxs[1];
+	planes[6].dist = mins[1];
+	planes[7].dist = -mins[1];
+	planes[8].dist = maxs[2];
+	planes[9].dist = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
+
+	VectorCopy( mins, brush->bounds[0] );
+	VectorCopy( maxs, brush->bounds[1] );
+}
+
+/*
+===================
+CM_ThreadBoxHull
+
+The box hull of the calling thread, for concurrent traces.
+===================
+*/
+static threadBoxHull_t *CM_ThreadBoxHull( void )
+{
+	threadBoxHull_t *hull = &threadBoxHull;
+
+	if ( hull->generation != boxHullGeneration )
+	{
+		hull->model = box_model;
+		CM_SetupBoxHull( &hull->brush, hull->sides, hull->planes );
+		hull->generation = boxHullGeneration;
+	}
+	return hull;
+}
+
+cbrush_t *CM_ThreadBoxBrush( void )
+{
+	return &CM_ThreadBoxHull()->brush;
+}
+
+void CM_BeginConcurrentTraces( void )
+{
+	cm_concurrentTrace = true;
+}
+
+void CM_EndConcurrentTraces( void )
+{
+	cm_concurrentTrace = false;
+}
+
 /*
 ===================
 CM_TempBoxModel
@@ -977,29 +1071,16 @@ Capsules are handled differently though.
 */
 clipHandle_t CM_TempBoxModel( const vec3_t mins, const vec3_t maxs, int capsule ) {
 
-	VectorCopy( mins, box_model.mins );
-	VectorCopy( maxs, box_model.maxs );
+	if ( cm_concurrentTrace ) {
+		threadBoxHull_t *hull = CM_ThreadBoxHull();
+		CM_SetBoxHull( &hull->model, &hull->brush, hull->planes, mins, maxs, capsule );
+	} else {
+		CM_SetBoxHull( &box_model, box_brush, box_planes, mins, maxs, capsule );
+	}
 
 	if ( capsule ) {
 		return CAPSULE_MODEL_HANDLE;
 	}
-
-	box_planes[0].dist = maxs[0];
-	box_planes[1].dist = -maxs[0];
-	box_planes[2].dist = mins[0];
-	box_planes[3].dist = -mins[0];
-	box_planes[4].dist = maxs[1];
-	box_planes[5].dist = -maxs[1];
-	box_planes[6].dist = mins[1];
-	box_planes[7].dist = -mins[1];
-	box_planes[8].dist = maxs[2];
-	box_planes[9].dist = -maxs[2];
-	box_planes[10].dist = mins[2];
-	box_planes[11].dist = -mins[2];
-
-	VectorCopy( mins, box_brush->bounds[0] );
-	VectorCopy( maxs, box_brush->bounds[1] );
-
 	return BOX_MODEL_HANDLE;
 }
 
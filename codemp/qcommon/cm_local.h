@@ -160,6 +160,49 @@ extern	cvar_t		*cm_noAreas;
 extern	cvar_t		*cm_noCurves;
 extern	cvar_t		*cm_playerCurveClip;
 extern	cvar_t		*cm_extraVerbose;
+extern	cvar_t		*cm_debugSurfaceUpdate;
+
+// set between CM_BeginConcurrentTraces and CM_EndConcurrentTraces on the calling thread
+extern	thread_local bool	cm_concurrentTrace;
+
+cbrush_t	*CM_ThreadBoxBrush( void );
+
+/*
+================
+CM_CheckOnce
+
+Returns true the first time a brush or patch is reached in the current trace.
+Threads tracing concurrently can't share the marks, so they test everything they
+reach; testing a brush twice gives the same result, just slower.
+================
+*/
+template<typename T>
+inline bool CM_CheckOnce( T &mark, int checkcount )
+{
+	if ( cm_concurrentTrace ) {
+		return true;
+	}
+	if ( mark == checkcount ) {
+		return false;
+	}
+	mark = checkcount;
+	return true;
+}
+
+/*
+================
+CM_LeafBrush
+
+The temp box model's brush is kept per thread while tracing concurrently.
+================
+*/
+inline cbrush_t *CM_LeafBrush( clipMap_t *local, int brushnum )
+{
+	if ( cm_concurrentTrace && local == &cmg && brushnum == cmg.numBrushes ) {
+		return CM_ThreadBoxBrush();
+	}
+	return &local->brushes[brushnum];
+}
 
 // cm_test.c
 
@@ -1251,9 +1251,6 @@ static inline void CM_TracePointThroughPatchCollide( traceWork_t *tw, trace_t &t
 	int			i, j, k;
 	float		offset;
 	float		d1, d2;
-#ifndef BSPC
-	static cvar_t *cv;
-#endif //BSPC
 
 #ifndef BSPC
 	if ( !cm_playerCurveClip->integer || !tw->isPoint ) {
@@ -1311,10 +1308,8 @@ static inline void CM_TracePointThroughPatchCollide( traceWork_t *tw, trace_t &t
 		if ( j == facet->numBorders ) {
 			// we hit this facet
 #ifndef BSPC
-			if (!cv) {
-				cv = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
-			}
-			if (cv->integer) {
+			// only the main thread's traces are drawn
+			if ( !cm_concurrentTrace && cm_debugSurfaceUpdate->integer ) {
 				debugPatchCollide = pc;
 				debugFacet = facet;
 			}
@@ -1396,9 +1391,6 @@ void CM_TraceThroughPatchCollide( traceWork_t *tw, trace_t &trace, const struct
 	facet_t	*facet;
 	float plane[4] = { 0.0f }, bestplane[4] = { 0.0f };
 	vec3_t startp, endp;
-#ifndef BSPC
-	static cvar_t *cv;
-#endif //BSPC
 
 #ifndef CULL_BBOX
 	// I'm not sure if test is strictly correct.  Are all
@@ -1508,10 +1500,8 @@ void CM_TraceThroughPatchCollide( traceWork_t *tw, trace_t &trace, const struct
 					enterFrac = 0;
 				}
 #ifndef BSPC
-				if (!cv) {
-					cv = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
-				}
-				if (cv && cv->integer) {
+				// only the main thread's traces are drawn
+				if ( !cm_concurrentTrace && cm_debugSurfaceUpdate->integer ) {
 					debugPatchCollide = pc;
 					debugFacet = facet;
 				}
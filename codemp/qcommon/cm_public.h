@@ -46,6 +46,12 @@ void		CM_TransformedBoxTrace( trace_t *results, const vec3_t start, const vec3_t
 
 byte		*CM_ClusterPVS (int cluster);
 
+// Lets the calling thread trace and test PVS while other threads do the same, by
+// keeping trace bookkeeping and the temp box model per thread until the matching end.
+// Nothing may load maps or link entities meanwhile.
+void		CM_BeginConcurrentTraces( void );
+void		CM_EndConcurrentTraces( void );
+
 int			CM_PointLeafnum( const vec3_t p );
 
 // only returns non-solid leafs
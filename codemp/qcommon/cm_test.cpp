@@ -49,7 +49,9 @@ int CM_PointLeafnum_r( const vec3_t p, int num, clipMap_t *local ) {
 			num = node->children[0];
 	}
 
-	c_pointcontents++;		// optimize counter
+	if ( !cm_concurrentTrace ) {
+		c_pointcontents++;		// optimize counter
+	}
 
 	return -1 - num;
 }
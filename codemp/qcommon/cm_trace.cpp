@@ -219,11 +219,10 @@ void CM_TestInLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *l
 	// test box position against all brushes in the leaf
 	for (k=0 ; k<leaf->numLeafBrushes ; k++) {
 		brushnum = local->leafbrushes[leaf->firstLeafBrush+k];
-		b = &local->brushes[brushnum];
-		if (b->checkcount == local->checkcount) {
+		b = CM_LeafBrush( local, brushnum );
+		if ( !CM_CheckOnce( b->checkcount, local->checkcount ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents)) {
 			continue;
@@ -246,10 +245,9 @@ void CM_TestInLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *l
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( !CM_CheckOnce( patch->checkcount, local->checkcount ) ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents)) {
 				continue;
@@ -399,12 +397,16 @@ void CM_PositionTest( traceWork_t *tw, trace_t &trace ) {
 	ll.lastLeaf = 0;
 	ll.overflowed = qfalse;
 
-	cmg.checkcount++;
+	if ( !cm_concurrentTrace ) {
+		cmg.checkcount++;
+	}
 
 	CM_BoxLeafnums_r( &ll, 0 );
 
 
-	cmg.checkcount++;
+	if ( !cm_concurrentTrace ) {
+		cmg.checkcount++;
+	}
 
 	// test the contents of the leafs
 	for (i=0 ; i < ll.count ; i++) {
@@ -433,7 +435,9 @@ CM_TraceThroughPatch
 void CM_TraceThroughPatch( traceWork_t *tw, trace_t &trace, cPatch_t *patch ) {
 	float		oldFrac;
 
-	c_patch_traces++;
+	if ( !cm_concurrentTrace ) {
+		c_patch_traces++;
+	}
 
 	oldFrac = trace.fraction;
 
@@ -658,11 +662,10 @@ void CM_TraceThroughLeaf( traceWork_t *tw, trace_t &trace, clipMap_t *local, cLe
 	for ( k = 0 ; k < leaf->numLeafBrushes ; k++ ) {
 		brushnum = local->leafbrushes[leaf->firstLeafBrush+k];
 
-		b = &local->brushes[brushnum];
-		if ( b->checkcount == local->checkcount ) {
+		b = CM_LeafBrush( local, brushnum );
+		if ( !CM_CheckOnce( b->checkcount, local->checkcount ) ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents) ) {
 			continue;
@@ -686,10 +689,9 @@ void CM_TraceThroughLeaf( traceWork_t *tw, trace_t &trace, clipMap_t *local, cLe
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( !CM_CheckOnce( patch->checkcount, local->checkcount ) ) {
 				continue;	// already checked this patch in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents) ) {
 				continue;
@@ -1015,12 +1017,11 @@ void CM_TraceToLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *
 	{
 		brushnum = local->leafbrushes[leaf->firstLeafBrush + k];
 
-		b = &local->brushes[brushnum];
-		if ( b->checkcount == local->checkcount )
+		b = CM_LeafBrush( local, brushnum );
+		if ( !CM_CheckOnce( b->checkcount, local->checkcount ) )
 		{
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = local->checkcount;
 
 		if ( !(b->contents & tw->contents) )
 		{
@@ -1045,10 +1046,9 @@ void CM_TraceToLeaf( traceWork_t *tw, trace_t &trace, cLeaf_t *leaf, clipMap_t *
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == local->checkcount ) {
+			if ( !CM_CheckOnce( patch->checkcount, local->checkcount ) ) {
 				continue;	// already checked this patch in another leaf
 			}
-			patch->checkcount = local->checkcount;
 
 			if ( !(patch->contents & tw->contents) ) {
 				continue;
@@ -1225,9 +1225,11 @@ void CM_Trace( trace_t *trace, const vec3_t start, const vec3_t end,
 
 	cmod = CM_ClipHandleToModel( model, &local );
 
-	local->checkcount++;		// for multi-check avoidance
+	if ( !cm_concurrentTrace ) {
+		local->checkcount++;		// for multi-check avoidance
 
-	c_traces++;				// for statistics, may be zeroed
+		c_traces++;				// for statistics, may be zeroed
+	}
 
 	// fill in a default trace
 	Com_Memset( &tw, 0, sizeof(tw) );
@@ -174,6 +174,10 @@ void QDECL Com_Printf( const char *fmt, ... ) {
 					// data even if we are crashing
 					FS_ForceFlush(logfile);
 				}
+				else {
+					// the writer thread keeps disk stalls out of the frame
+					FS_MakeAsync( logfile );
+				}
 			}
 			else {
 				Com_Printf( "Opening qconsole.log failed!\n" );
@@ -250,6 +254,7 @@ void NORETURN QDECL Com_Error( int code, const char *fmt, ... ) {
 	int			currentTime;
 
 	if ( com_errorEntered ) {
+		FS_FlushAsyncFiles();
 		Sys_Error( "recursive error after: %s", com_errorMessage );
 	}
 	com_errorEntered = qtrue;
@@ -288,6 +293,7 @@ void NORETURN QDECL Com_Error( int code, const char *fmt, ... ) {
 	}
 
 	if ( code == ERR_DISCONNECT || code == ERR_SERVERDISCONNECT || code == ERR_DROP || code == ERR_NEED_CD ) {
+		FS_FlushAsyncFiles();
 		throw code;
 	} else {
 		CL_Shutdown ();
@@ -295,6 +301,7 @@ void NORETURN QDECL Com_Error( int code, const char *fmt, ... ) {
 	}
 
 	Com_Shutdown ();
+	FS_FlushAsyncFiles();
 
 	Sys_Error ("%s", com_errorMessage);
 }
@@ -646,7 +653,7 @@ int Com_FilterPath(char *filter, char *name, int casesensitive)
 Com_HashKey
 ============
 */
-int Com_HashKey(char *string, int maxlen) {
+int Com_HashKey(const char *string, int maxlen) {
 	int hash, i;
 
 	hash = 0;
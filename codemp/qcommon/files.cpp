@@ -31,6 +31,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
  *****************************************************************************/
 
 #include "qcommon/qcommon.h"
+#include "qcommon/q_asynclog.h"
 
 #ifndef DEDICATED
 #ifndef FINAL_BUILD
@@ -242,6 +243,9 @@ static cvar_t		*fs_basegame;
 static cvar_t		*fs_cdpath;
 static cvar_t		*fs_copyfiles;
 static cvar_t		*fs_gamedirvar;
+static cvar_t		*fs_logFlushMsec;
+static cvar_t		*fs_logRotateKB;
+static cvar_t		*fs_logRotateCount;
 static cvar_t		*fs_dirbeforepak; //rww - when building search path, keep directories at top and insert pk3's under them
 static searchpath_t	*fs_searchpaths;
 static int			fs_readCount;			// total bytes read
@@ -269,6 +273,7 @@ typedef struct fileHandleData_s {
 	int			zipFileLen;
 	qboolean	zipFile;
 	char		name[MAX_ZPATH];
+	Q::AsyncLog	*asyncLog;		// set by FS_MakeAsync, owns the FILE from then on
 } fileHandleData_t;
 
 static fileHandleData_t	fsh[MAX_FILE_HANDLES];
@@ -381,7 +386,7 @@ static fileHandle_t FS_HandleForFile(void) {
 	int		i;
 
 	for ( i = 1 ; i < MAX_FILE_HANDLES ; i++ ) {
-		if ( fsh[i].handleFiles.file.o == NULL ) {
+		if ( fsh[i].handleFiles.file.o == NULL && !fsh[i].asyncLog ) {
 			return i;
 		}
 	}
@@ -396,6 +401,9 @@ static FILE	*FS_FileForHandle( fileHandle_t f ) {
 	if (fsh[f].zipFile == qtrue) {
 		Com_Error( ERR_DROP, "FS_FileForHandle: can't get FILE on zip file" );
 	}
+	if ( fsh[f].asyncLog ) {
+		Com_Error( ERR_DROP, "FS_FileForHandle: can't get FILE on async file" );
+	}
 	if ( ! fsh[f].handleFiles.file.o ) {
 		Com_Error( ERR_DROP, "FS_FileForHandle: NULL" );
 	}
@@ -406,6 +414,10 @@ static FILE	*FS_FileForHandle( fileHandle_t f ) {
 void	FS_ForceFlush( fileHandle_t f ) {
 	FILE *file;
 
+	if ( fsh[f].asyncLog ) {
+		return;
+	}
+
 	file = FS_FileForHandle(f);
 	setvbuf( file, NULL, _IONBF, 0 );
 }
@@ -994,6 +1006,13 @@ void FS_FCloseFile( fileHandle_t f ) {
 		return;
 	}
 
+	if ( fsh[f].asyncLog ) {
+		// drains whatever is still queued and closes the file
+		delete fsh[f].asyncLog;
+		Com_Memset( &fsh[f], 0, sizeof( fsh[f] ) );
+		return;
+	}
+
 	// we didn't find it as a pak, so close it as a unique file
 	if (fsh[f].handleFiles.file.o) {
 		fclose (fsh[f].handleFiles.file.o);
@@ -1676,6 +1695,11 @@ int FS_Write( const void *buffer, int len, fileHandle_t h ) {
 		return 0;
 	}
 
+	if ( fsh[h].asyncLog ) {
+		fsh[h].asyncLog->write( buffer, len );
+		return len;
+	}
+
 	f = FS_FileForHandle(h);
 	buf = (byte *)buffer;
 
@@ -2838,7 +2862,7 @@ void FS_Path_f( void ) {
 
 	Com_Printf( "\n" );
 	for ( i = 1 ; i < MAX_FILE_HANDLES ; i++ ) {
-		if ( fsh[i].handleFiles.file.o ) {
+		if ( fsh[i].handleFiles.file.o || fsh[i].asyncLog ) {
 			Com_Printf( "handle %i: %s\n", i, fsh[i].name );
 		}
 	}
@@ -3363,6 +3387,10 @@ void FS_Startup( const char *gameName ) {
 	fs_homepath = Cvar_Get ("fs_homepath", homePath, CVAR_USER_CREATED, "(Read/Write) Location for user generated files" );
 	fs_gamedirvar = Cvar_Get ("fs_game", "MD", CVAR_INIT|CVAR_SYSTEMINFO, "Mod directory" );
 
+	fs_logFlushMsec = Cvar_Get( "fs_logFlushMsec", "1000", CVAR_ARCHIVE_ND, "Longest time in msec a log line waits before it is written to disk" );
+	fs_logRotateKB = Cvar_Get( "fs_logRotateKB", "0", CVAR_ARCHIVE_ND, "Start a new log file once it grows past this many KB, 0 never rotates" );
+	fs_logRotateCount = Cvar_Get( "fs_logRotateCount", "5", CVAR_ARCHIVE_ND, "Number of rotated log files to keep" );
+
 	fs_dirbeforepak = Cvar_Get("fs_dirbeforepak", "0", CVAR_INIT|CVAR_PROTECTED, "Prioritize directories before paks if not pure" );
 
 	// add search path elements in reverse priority order (lowest priority first)
@@ -3951,6 +3979,9 @@ int		FS_FTell( fileHandle_t f ) {
 	int pos;
 	if (fsh[f].zipFile == qtrue) {
 		pos = unztell(fsh[f].handleFiles.file.z);
+	} else if ( fsh[f].asyncLog ) {
+		// the position isn't known until the writer thread catches up
+		pos = 0;
 	} else {
 		pos = ftell(fsh[f].handleFiles.file.o);
 	}
@@ -3958,9 +3989,55 @@ int		FS_FTell( fileHandle_t f ) {
 }
 
 void	FS_Flush( fileHandle_t f ) {
+	if ( fsh[f].asyncLog ) {
+		fsh[f].asyncLog->flush();
+		return;
+	}
 	fflush(fsh[f].handleFiles.file.o);
 }
 
+/*
+=================
+FS_MakeAsync
+
+Hands a file opened for writing to a background writer thread, so FS_Write
+only queues the data. Used for logs, where disk latency would otherwise
+show up as frame time spikes.
+=================
+*/
+void FS_MakeAsync( fileHandle_t f ) {
+	Q::AsyncLog::Options options;
+	FILE *file;
+
+	FS_AssertInitialised();
+
+	file = FS_FileForHandle( f );
+	options.flushMilliseconds = fs_logFlushMsec->integer;
+	options.rotateBytes = fs_logRotateKB->integer > 0 ? (size_t)fs_logRotateKB->integer * 1024 : 0;
+	options.rotateCount = fs_logRotateCount->integer;
+
+	fsh[f].asyncLog = new Q::AsyncLog( file, FS_BuildOSPath( fs_homepath->string, fs_gamedir, fsh[f].name ), options );
+	fsh[f].handleFiles.file.o = NULL;
+	fsh[f].handleSync = qfalse;
+}
+
+/*
+=================
+FS_FlushAsyncFiles
+
+Blocks until every async log is on disk, so nothing is lost when we go down
+=================
+*/
+void FS_FlushAsyncFiles( void ) {
+	int i;
+
+	for ( i = 1 ; i < MAX_FILE_HANDLES ; i++ ) {
+		if ( fsh[i].asyncLog ) {
+			fsh[i].asyncLog->flush();
+		}
+	}
+}
+
 void FS_FilenameCompletion( const char *dir, const char *ext, qboolean stripExt, callbackFunc_t callback, qboolean allowNonPureFilesOnDisk ) {
 	int nfiles;
 	char **filenames, filename[MAX_STRING_CHARS];
@@ -216,6 +216,50 @@ void MSG_WriteBits( msg_t *msg, int value, int bits ) {
 	}
 }
 
+/*
+============
+MSG_WriteEncodedBits
+
+Appends bits that another message already wrote with MSG_WriteBits, so
+they don't have to be compressed again. The huffman table is fixed, so
+the encoded bits are the same wherever they start.
+============
+*/
+void MSG_WriteEncodedBits( msg_t *msg, const byte *data, int bits ) {
+	int		i, bytes, shift, carry;
+	byte	*out;
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_WriteEncodedBits: can't append to an out of band message" );
+	}
+	if ( bits <= 0 ) {
+		return;
+	}
+	if ( msg->maxsize - ( ( msg->bit + bits ) >> 3 ) < 4 ) {
+		msg->overflowed = qtrue;
+		return;
+	}
+
+	oldsize += bits;
+
+	// the bits past the end of the last byte are always clear, like Huff_putBit leaves them
+	bytes = ( bits + 7 ) >> 3;
+	out = &msg->data[msg->bit >> 3];
+	shift = msg->bit & 7;
+	if ( !shift ) {
+		Com_Memcpy( out, data, bytes );
+	} else {
+		carry = out[0] & ( ( 1 << shift ) - 1 );
+		for ( i = 0 ; i < bytes ; i++ ) {
+			out[i] = (byte)( carry | ( data[i] << shift ) );
+			carry = data[i] >> ( 8 - shift );
+		}
+		out[i] = (byte)carry;
+	}
+	msg->bit += bits;
+	msg->cursize = (msg->bit>>3)+1;
+}
+
 int MSG_ReadBits( msg_t *msg, int bits ) {
 	int			value;
 	int			get;
@@ -20,6 +20,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 ===========================================================================
 */
 
+#include <list>
+#include <string>
+#include <unordered_map>
+
 #include "qcommon/sstring.h"	// stl string class won't compile in here (MS shite), so use Gil's.
 #include "tr_local.h"
 #include "tr_font.h"
@@ -1355,12 +1359,131 @@ CFontInfo *GetFont(int index)
 	return pFont;
 }
 
-float RE_Font_StrLenPixelsNew( const char *psText, const int iFontHandle, const float fScale ) {
-	CFontInfo *curfont = GetFont(iFontHandle);
-	if ( !curfont ) {
-		return 0.0f;
+// laid out strings, so the UI and HUD don't re-parse the same text every frame
+//
+struct FontLayoutItem
+{
+	int			colour;		// -1 for a glyph, else the colour code this switches to
+	qhandle_t	hShader;
+	float		x, y, w, h;	// relative to the draw position
+	float		s1, t1, s2, t2;
+};
+
+class CFontLayout
+{
+public:
+	std::vector<FontLayoutItem>	m_items;
+	float						m_fWidth;	// only set for the measuring keys
+
+	CFontLayout() : m_fWidth( 0.0f ) {}
+
+	void AddColour( int colour )
+	{
+		FontLayoutItem item = {};
+		item.colour = colour;
+		m_items.push_back( item );
+	}
+
+	void AddGlyph( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader )
+	{
+		FontLayoutItem item = { -1, hShader, x, y, w, h, s1, t1, s2, t2 };
+		m_items.push_back( item );
+	}
+};
+
+#define FONT_LAYOUT_CACHE_SIZE		512
+#define FONT_LAYOUT_MAX_TEXT		1024	// longer strings (text crawls etc) are laid out every time
+
+class CFontLayoutCache
+{
+public:
+	// NULL if missing, else the entry moved to the front
+	CFontLayout *Find( const std::string &key )
+	{
+		LayoutIndex_t::iterator it = m_index.find( key );
+		if ( it == m_index.end() )
+		{
+			return NULL;
+		}
+		m_layouts.splice( m_layouts.begin(), m_layouts, it->second );
+		return &it->second->second;
+	}
+
+	CFontLayout &Insert( const std::string &key )
+	{
+		if ( m_layouts.size() >= FONT_LAYOUT_CACHE_SIZE )
+		{
+			m_index.erase( m_layouts.back().first );
+			m_layouts.pop_back();
+		}
+		m_layouts.push_front( LayoutEntry_t( key, CFontLayout() ) );
+		m_index[key] = m_layouts.begin();
+		return m_layouts.front().second;
 	}
 
+	void Clear()
+	{
+		m_index.clear();
+		m_layouts.clear();
+	}
+
+private:
+	typedef std::pair<std::string, CFontLayout>					LayoutEntry_t;
+	typedef std::list<LayoutEntry_t>							LayoutList_t;	// most recently used first
+	typedef std::unordered_map<std::string, LayoutList_t::iterator>	LayoutIndex_t;
+
+	LayoutList_t	m_layouts;
+	LayoutIndex_t	m_index;
+};
+
+static CFontLayoutCache	g_FontLayoutCache;
+static CFontLayout		g_FontLayoutScratch;
+
+enum
+{
+	FONT_LAYOUT_DRAW,
+	FONT_LAYOUT_WIDTH
+};
+
+// everything a layout depends on besides the font data itself
+static const std::string &RE_Font_LayoutKey( int iKind, const int iFontHandle, const float fScale, int iMaxPixelWidth, const char *psText )
+{
+	static std::string key;
+	byteAlias_t header[6];
+
+	header[0].i = iKind;
+	header[1].i = iFontHandle & SET_MASK;
+	header[2].f = fScale;
+	header[3].i = iMaxPixelWidth;
+	header[4].i = se_language->modificationCount;
+	header[5].i = r_aspectCorrectFonts->integer;
+
+	key.assign( (const char *)header, sizeof( header ) );
+	key.append( psText );
+	return key;
+}
+
+static void RE_Font_BuildLayout( CFontInfo *curfont, const char *psText, int iMaxPixelWidth, const float fScale, CFontLayout &layout );
+
+static const CFontLayout &RE_Font_GetLayout( CFontInfo *curfont, const int iFontHandle, const char *psText, int iMaxPixelWidth, const float fScale )
+{
+	if ( strlen( psText ) > FONT_LAYOUT_MAX_TEXT )
+	{
+		RE_Font_BuildLayout( curfont, psText, iMaxPixelWidth, fScale, g_FontLayoutScratch );
+		return g_FontLayoutScratch;
+	}
+
+	const std::string &key = RE_Font_LayoutKey( FONT_LAYOUT_DRAW, iFontHandle, fScale, iMaxPixelWidth, psText );
+	CFontLayout *layout = g_FontLayoutCache.Find( key );
+	if ( !layout )
+	{
+		layout = &g_FontLayoutCache.Insert( key );
+		RE_Font_BuildLayout( curfont, psText, iMaxPixelWidth, fScale, *layout );
+	}
+	return *layout;
+}
+
+static float RE_Font_MeasureString( CFontInfo *curfont, const char *psText, const float fScale ) {
 	float fScaleAsian = fScale;
 	if (Language_IsAsian() && fScale > 0.7f )
 	{
@@ -1411,6 +1534,25 @@ float RE_Font_StrLenPixelsNew( const char *psText, const int iFontHandle, const
 	return maxLineWidth;
 }
 
+float RE_Font_StrLenPixelsNew( const char *psText, const int iFontHandle, const float fScale ) {
+	CFontInfo *curfont = GetFont(iFontHandle);
+	if ( !curfont ) {
+		return 0.0f;
+	}
+
+	if ( strlen( psText ) > FONT_LAYOUT_MAX_TEXT ) {
+		return RE_Font_MeasureString( curfont, psText, fScale );
+	}
+
+	const std::string &key = RE_Font_LayoutKey( FONT_LAYOUT_WIDTH, iFontHandle, fScale, -1, psText );
+	CFontLayout *layout = g_FontLayoutCache.Find( key );
+	if ( !layout ) {
+		layout = &g_FontLayoutCache.Insert( key );
+		layout->m_fWidth = RE_Font_MeasureString( curfont, psText, fScale );
+	}
+	return layout->m_fWidth;
+}
+
 int RE_Font_StrLenPixels( const char *psText, const int iFontHandle, const float fScale ) {
 	return (int)ceilf( RE_Font_StrLenPixelsNew( psText, iFontHandle, fScale ) );
 }
@@ -1467,76 +1609,21 @@ int RE_Font_HeightPixels(const int iFontHandle, const float fScale)
 	return(0);
 }
 
-// iMaxPixelWidth is -1 for "all of string", else pixel display count...
-//
-void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, const int iFontHandle, int iMaxPixelWidth, const float fScale)
+/*
+=================
+RE_Font_BuildLayout
+
+Works out where every glyph of psText goes, relative to the draw position.
+Anything that changes the result (language, scale, width limit) has to be part of the cache key
+=================
+*/
+static void RE_Font_BuildLayout( CFontInfo *curfont, const char *psText, int iMaxPixelWidth, const float fScale, CFontLayout &layout )
 {
-	static qboolean gbInShadow = qfalse;	// MUST default to this
 	float				fox, foy, fx, fy;
-	int					colour, offset;
 	const glyphInfo_t	*pLetter;
 	qhandle_t			hShader;
 
-	assert (psText);
-
-	if(iFontHandle & STYLE_BLINK)
-	{
-		if((ri->Milliseconds() >> 7) & 1)
-		{
-			return;
-		}
-	}
-
-//	// test code only
-//	if (GetLanguageEnum() == eTaiwanese)
-//	{
-//		psText = "Wp:}Fa pGAƱAL̻@˦C";
-//	}
-//	else
-//	if (GetLanguageEnum() == eChinese)
-//	{
-//		//psText = "ӶսII  Լ?Ī˹  ʧ  Ҫû趨ı  Ԥ,S3 ѹ,DXT1 ѹ,DXT5 ѹ,16 Bit,32 Bit";
-//		psText = "ӶսII";
-//	}
-//	else
-//	if (GetLanguageEnum() == eThai)
-//	{
-//		//psText = "ҵðҹԵѳصˡѺѡ·Ѻ";
-//		psText = "ҵðҹԵ";
-//		psText = "Ѻ";
-//		psText = "Ѻ   _Թ__1415";
-//	}
-//	else
-//	if (GetLanguageEnum() == eKorean)
-//	{
-//		psText = "Wp:Ÿ̴ ָ. ׵ Ѵ װ  ϰڴ.";
-//	}
-//	else
-//	if (GetLanguageEnum() == eJapanese)
-//	{
-//		static char sBlah[200];
-//		sprintf(sBlah,va("%c%c%c%c%c%c%c%c",0x82,0xA9,0x82,0xC8,0x8A,0xBF,0x8E,0x9A));
-//		psText = &sBlah[0];
-//	}
-//	else
-//	if (GetLanguageEnum() == eRussian)
-//	{
-////		//psText = "            ."
-//		psText = "   ";
-//	}
-//	else
-//	if (GetLanguageEnum() == ePolish)
-//	{
-//		psText = "zaoony w 1364 roku, jest najstarsz polsk uczelni i naley...";
-//		psText = "zaoony naley";
-//	}
-
-
-	CFontInfo *curfont = GetFont(iFontHandle);
-	if(!curfont || !psText)
-	{
-		return;
-	}
+	layout.m_items.clear();
 
 	float fScaleAsian = fScale;
 	float fAsianYAdjust = 0.0f;
@@ -1546,24 +1633,10 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 		fAsianYAdjust = ((curfont->GetPointSize() * fScale) - (curfont->GetPointSize() * fScaleAsian)) / 2.0f;
 	}
 
-	// Draw a dropshadow if required
-	if(iFontHandle & STYLE_DROPSHADOW)
-	{
-		offset = Round(curfont->GetPointSize() * fScale * 0.075f);
-
-		const vec4_t v4DKGREY2 = {0.15f, 0.15f, 0.15f, rgba?rgba[3]:1.0f};
-
-		gbInShadow = qtrue;
-		RE_Font_DrawString(ox + offset, oy + offset, psText, v4DKGREY2, iFontHandle & SET_MASK, iMaxPixelWidth, fScale);
-		gbInShadow = qfalse;
-	}
-
-	RE_SetColor( rgba );
-
 	// Now we take off the training wheels and become a big font renderer
 	// It's all floats from here on out
-	fox = ox;
-	foy = oy;
+	fox = 0.0f;
+	foy = 0.0f;
 
 	fx = fox;
 	foy += curfont->mbRoundCalcs ? Round((curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale) : (curfont->GetHeight() - (curfont->GetDescender() >> 1)) * fScale;
@@ -1604,14 +1677,7 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 				if (*psText >= '0' &&
 					*psText <= '9')
 				{
-					colour = ColorIndex(*psText++);
-					if (!gbInShadow)
-					{
-						vec4_t color;
-						Com_Memcpy( color, g_color_table[colour], sizeof( color ) );
-						color[3] = rgba ? rgba[3] : 1.0f;
-						RE_SetColor( color );
-					}
+					layout.AddColour( ColorIndex(*psText++) );
 					break;
 				}
 			}
@@ -1644,7 +1710,7 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 					fy += 3.0f; // I'm sick and tired of going round in circles trying to do this legally, so bollocks to it
 				}
 
-				RE_StretchPic(curfont->mbRoundCalcs ? fx + Round(pLetter->horizOffset * fThisScale) : fx + pLetter->horizOffset * fThisScale, // float x
+				layout.AddGlyph(curfont->mbRoundCalcs ? fx + Round(pLetter->horizOffset * fThisScale) : fx + pLetter->horizOffset * fThisScale, // float x
 								(uiLetter > (unsigned)g_iNonScaledCharRange) ? fy - fAsianYAdjust : fy,	// float y
 								curfont->mbRoundCalcs ? Round(pLetter->width * fThisScale) : pLetter->width * fThisScale,	// float w
 								curfont->mbRoundCalcs ? Round(pLetter->height * fThisScale) : pLetter->height * fThisScale, // float h
@@ -1670,6 +1736,144 @@ void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, c
 			break;
 		}
 	}
+}
+
+/*
+=================
+RE_Font_SubmitLayout
+
+Each run of glyphs between colour codes goes to the back end as a single command
+=================
+*/
+static void RE_Font_SubmitLayout( const CFontLayout &layout, int ox, int oy, const float *rgba, qboolean bInShadow )
+{
+	const FontLayoutItem *item = layout.m_items.data();
+	const FontLayoutItem *end = item + layout.m_items.size();
+
+	while ( item != end )
+	{
+		if ( item->colour >= 0 )
+		{
+			if ( !bInShadow )
+			{
+				vec4_t color;
+				Com_Memcpy( color, g_color_table[item->colour], sizeof( color ) );
+				color[3] = rgba ? rgba[3] : 1.0f;
+				RE_SetColor( color );
+			}
+			item++;
+			continue;
+		}
+
+		int numPics = 0;
+		while ( item + numPics != end && item[numPics].colour < 0 && numPics < MAX_STRETCH_PICS_PER_COMMAND )
+		{
+			numPics++;
+		}
+
+		stretchPic_t *pic = R_AddStretchPics( numPics );
+		if ( !pic )
+		{
+			return;	// command buffer is full, same as RE_StretchPic dropping it
+		}
+		for ( ; numPics; numPics--, item++, pic++ )
+		{
+			pic->shader = R_GetShaderByHandle( item->hShader );
+			pic->x = ox + item->x;
+			pic->y = oy + item->y;
+			pic->w = item->w;
+			pic->h = item->h;
+			pic->s1 = item->s1;
+			pic->t1 = item->t1;
+			pic->s2 = item->s2;
+			pic->t2 = item->t2;
+		}
+	}
+}
+
+// iMaxPixelWidth is -1 for "all of string", else pixel display count...
+//
+void RE_Font_DrawString(int ox, int oy, const char *psText, const float *rgba, const int iFontHandle, int iMaxPixelWidth, const float fScale)
+{
+	static qboolean gbInShadow = qfalse;	// MUST default to this
+	int					offset;
+
+	assert (psText);
+
+	if(iFontHandle & STYLE_BLINK)
+	{
+		if((ri->Milliseconds() >> 7) & 1)
+		{
+			return;
+		}
+	}
+
+//	// test code only
+//	if (GetLanguageEnum() == eTaiwanese)
+//	{
+//		psText = "Wp:}Fa pGAƱAL̻@˦C";
+//	}
+//	else
+//	if (GetLanguageEnum() == eChinese)
+//	{
+//		//psText = "ӶսII  Լ?Ī˹  ʧ  Ҫû趨ı  Ԥ,S3 ѹ,DXT1 ѹ,DXT5 ѹ,16 Bit,32 Bit";
+//		psText = "ӶսII";
+//	}
+//	else
+//	if (GetLanguageEnum() == eThai)
+//	{
+//		//psText = "ҵðҹԵѳصˡѺѡ·Ѻ";
+//		psText = "ҵðҹԵ";
+//		psText = "Ѻ";
+//		psText = "Ѻ   _Թ__1415";
+//	}
+//	else
+//	if (GetLanguageEnum() == eKorean)
+//	{
+//		psText = "Wp:Ÿ̴ ָ. ׵ Ѵ װ  ϰڴ.";
+//	}
+//	else
+//	if (GetLanguageEnum() == eJapanese)
+//	{
+//		static char sBlah[200];
+//		sprintf(sBlah,va("%c%c%c%c%c%c%c%c",0x82,0xA9,0x82,0xC8,0x8A,0xBF,0x8E,0x9A));
+//		psText = &sBlah[0];
+//	}
+//	else
+//	if (GetLanguageEnum() == eRussian)
+//	{
+////		//psText = "            ."
+//		psText = "   ";
+//	}
+//	else
+//	if (GetLanguageEnum() == ePolish)
+//	{
+//		psText = "zaoony w 1364 roku, jest najstarsz polsk uczelni i naley...";
+//		psText = "zaoony naley";
+//	}
+
+
+	CFontInfo *curfont = GetFont(iFontHandle);
+	if(!curfont || !psText)
+	{
+		return;
+	}
+
+	// Draw a dropshadow if required
+	if(iFontHandle & STYLE_DROPSHADOW)
+	{
+		offset = Round(curfont->GetPointSize() * fScale * 0.075f);
+
+		const vec4_t v4DKGREY2 = {0.15f, 0.15f, 0.15f, rgba?rgba[3]:1.0f};
+
+		gbInShadow = qtrue;
+		RE_Font_DrawString(ox + offset, oy + offset, psText, v4DKGREY2, iFontHandle & SET_MASK, iMaxPixelWidth, fScale);
+		gbInShadow = qfalse;
+	}
+
+	RE_SetColor( rgba );
+
+	RE_Font_SubmitLayout( RE_Font_GetLayout( curfont, iFontHandle, psText, iMaxPixelWidth, fScale ), ox, oy, rgba, gbInShadow );
 	//let it remember the old color //RE_SetColor(NULL);
 }
 
@@ -1740,6 +1944,7 @@ void R_ShutdownFonts(void)
 	g_iCurrentFontIndex = 1;	// entry 0 is reserved for "missing/invalid"
 
 	g_ThaiCodes.Clear();
+	g_FontLayoutCache.Clear();
 }
 
 // this is only really for debugging while tinkering with fonts, but harmless to leave in...
@@ -25,6 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/MiniHeap.h"
 #include "server/server.h"
 #include "ghoul2/g2_local.h"
+#include "qcommon/q_g2trace.h"
 
 #ifdef _G2_GORE
 #include "ghoul2/G2_gore.h"
@@ -386,6 +387,12 @@ int G2_DecideTraceLod(CGhoul2Info &ghoul2, int useLod)
 	return returnLod;
 }
 
+// Transformed surfaces keep the trace bounds of Q::g2TraceBuildBounds after their vertices
+static inline const float *G2_TraceBounds( const mdxmSurface_t *surface, const float *verts )
+{
+	return verts + surface->numVerts * 5;
+}
+
 void R_TransformEachSurface( const mdxmSurface_t *surface, vec3_t scale, IHeapAllocator *G2VertSpace, size_t *TransformedVertsArray,CBoneCache *boneCache)
 {
 	int				 j, k;
@@ -398,7 +405,7 @@ void R_TransformEachSurface( const mdxmSurface_t *surface, vec3_t scale, IHeapAl
 	int *piBoneReferences = (int*) ((byte*)surface + surface->ofsBoneReferences);
 
 	// alloc some space for the transformed verts to get put in
-	TransformedVerts = (float *)G2VertSpace->MiniHeapAlloc(surface->numVerts * 5 * 4);
+	TransformedVerts = (float *)G2VertSpace->MiniHeapAlloc((surface->numVerts * 5 + Q::g2TraceBoundsSize(surface->numTriangles)) * 4);
 	TransformedVertsArray[surface->thisSurfaceIndex] = (size_t)TransformedVerts;
 	if (!TransformedVerts)
 	{
@@ -495,6 +502,8 @@ void R_TransformEachSurface( const mdxmSurface_t *surface, vec3_t scale, IHeapAl
 			v++;// = (mdxmVertex_t *)&v->weights[/*v->numWeights*/surface->maxVertBoneWeights];
 		}
 	}
+
+	Q::g2TraceBuildBounds(TransformedVerts, (const int32_t (*)[3])((byte *)surface + surface->ofsTriangles), surface->numTriangles, TransformedVerts + numVerts * 5);
 }
 
 void G2_TransformSurfaces(int surfaceNum, surfaceInfo_v &rootSList,
@@ -693,70 +702,7 @@ qboolean G2_SegmentTriangleTest( const vec3_t start, const vec3_t end,
 	const vec3_t A, const vec3_t B, const vec3_t C,
 	qboolean backFaces,qboolean frontFaces,vec3_t returnedPoint,vec3_t returnedNormal, float *denom)
 {
-	static const float tiny=1E-10f;
-	vec3_t returnedNormalT;
-	vec3_t edgeAC;
-
-	VectorSubtract(C, A, edgeAC);
-	VectorSubtract(B, A, returnedNormalT);
-
-	CrossProduct(returnedNormalT, edgeAC, returnedNormal);
-
-	vec3_t ray;
-	VectorSubtract(end, start, ray);
-
-	*denom=DotProduct(ray, returnedNormal);
-
-	if (fabs(*denom)<tiny||        // triangle parallel to ray
-		(!backFaces && *denom>0)||		// not accepting back faces
-		(!frontFaces && *denom<0))		//not accepting front faces
-	{
-		return qfalse;
-	}
-
-	vec3_t toPlane;
-	VectorSubtract(A, start, toPlane);
-
-	float t=DotProduct(toPlane, returnedNormal)/ *denom;
-
-	if (t<0.0f||t>1.0f)
-	{
-		return qfalse; // off segment
-	}
-
-	VectorScale(ray, t, ray);
-
-	VectorAdd(ray, start, returnedPoint);
-
-	vec3_t edgePA;
-	VectorSubtract(A, returnedPoint, edgePA);
-
-	vec3_t edgePB;
-	VectorSubtract(B, returnedPoint, edgePB);
-
-	vec3_t edgePC;
-	VectorSubtract(C, returnedPoint, edgePC);
-
-	vec3_t temp;
-
-	CrossProduct(edgePA, edgePB, temp);
-	if (DotProduct(temp, returnedNormal)<0.0f)
-	{
-		return qfalse; // off triangle
-	}
-
-	CrossProduct(edgePC, edgePA, temp);
-	if (DotProduct(temp,returnedNormal)<0.0f)
-	{
-		return qfalse; // off triangle
-	}
-
-	CrossProduct(edgePB, edgePC, temp);
-	if (DotProduct(temp, returnedNormal)<0.0f)
-	{
-		return qfalse; // off triangle
-	}
-	return qtrue;
+	return (qboolean)Q::g2SegmentTriangleTest(start, end, A, B, C, !!backFaces, !!frontFaces, returnedPoint, returnedNormal, denom);
 }
 
 #ifdef _G2_GORE
@@ -1073,9 +1019,21 @@ static bool G2_TracePolys(const mdxmSurface_t *surface, const mdxmSurfHierarchy_
 	// whip through and actually transform each vertex
 	const mdxmTriangle_t *tris = (mdxmTriangle_t *) ((byte *)surface + surface->ofsTriangles);
 	const float *verts = (float *)TS.TransformedVertsArray[surface->thisSurfaceIndex];
+	const float *bounds = G2_TraceBounds(surface, verts);
+	if (!Q::g2SegmentTouchesBounds(TS.rayStart, TS.rayEnd, bounds))
+	{
+		return false;
+	}
 	numTris = surface->numTriangles;
 	for ( j = 0; j < numTris; j++ )
 	{
+		// skip whole runs of triangles the ray can't reach
+		if (!(j % Q::G2_TRACE_CHUNK_TRIS) && !Q::g2SegmentTouchesBounds(TS.rayStart, TS.rayEnd, &bounds[6 + (j / Q::G2_TRACE_CHUNK_TRIS) * 6]))
+		{
+			j += Q::G2_TRACE_CHUNK_TRIS - 1;
+			continue;
+		}
+
 		float			face;
 		vec3_t	hitPoint, normal;
 		// determine actual coords for this triangle
@@ -1251,44 +1209,15 @@ static bool G2_RadiusTracePolys(
 	v3RayDir[1]/=f;
 	v3RayDir[2]/=f;
 
-	for ( j = 0; j < numVerts; j++ )
+	const float * const bounds = G2_TraceBounds(surface, verts);
+	if (Q::g2BoundsOutsideRadiusTrace(bounds, TS.rayStart, saxis, taxis, v3RayDir))
 	{
-		const int pos=j*5;
-		vec3_t delta;
-		delta[0]=verts[pos+0]-TS.rayStart[0];
-		delta[1]=verts[pos+1]-TS.rayStart[1];
-		delta[2]=verts[pos+2]-TS.rayStart[2];
-		const float s=DotProduct(delta,saxis)+0.5f;
-		const float t=DotProduct(delta,taxis)+0.5f;
-		const float u=DotProduct(delta,v3RayDir);
-		int vflags=0;
-
-		if (s>0)
-		{
-			vflags|=1;
-		}
-		if (s<1)
-		{
-			vflags|=2;
-		}
-		if (t>0)
-		{
-			vflags|=4;
-		}
-		if (t<1)
-		{
-			vflags|=8;
-		}
-		if (u>0)
-		{
-			vflags|=16;
-		}
-		if (u<1)
-		{
-			vflags|=32;
-		}
+		return false; // the whole surface is off the gore splotch
+	}
 
-		vflags=(~vflags);
+	for ( j = 0; j < numVerts; j++ )
+	{
+		const int vflags=Q::g2RadiusTraceOutside(&verts[j*5], TS.rayStart, saxis, taxis, v3RayDir);
 		flags&=vflags;
 		GoreVerts[j].flags=vflags;
 	}
@@ -1302,6 +1231,11 @@ static bool G2_RadiusTracePolys(
 
 	for ( j = 0; j < numTris; j++ )
 	{
+		if (!(j % Q::G2_TRACE_CHUNK_TRIS) && Q::g2BoundsOutsideRadiusTrace(&bounds[6 + (j / Q::G2_TRACE_CHUNK_TRIS) * 6], TS.rayStart, saxis, taxis, v3RayDir))
+		{
+			j += Q::G2_TRACE_CHUNK_TRIS - 1;
+			continue;
+		}
 		assert(tris[j].indexes[0]>=0&&tris[j].indexes[0]<numVerts);
 		assert(tris[j].indexes[1]>=0&&tris[j].indexes[1]<numVerts);
 		assert(tris[j].indexes[2]>=0&&tris[j].indexes[2]<numVerts);
@@ -1329,21 +1329,13 @@ const void	*RB_SetColor( const void *data ) {
 
 /*
 =============
-RB_StretchPic
+RB_AddStretchPic
 =============
 */
-const void *RB_StretchPic ( const void *data ) {
-	const stretchPicCommand_t	*cmd;
-	shader_t *shader;
+static void RB_AddStretchPic ( shader_t *shader, float x, float y, float w, float h,
+					  float s1, float t1, float s2, float t2 ) {
 	int		numVerts, numIndexes;
 
-	cmd = (const stretchPicCommand_t *)data;
-
-	if ( !backEnd.projection2D ) {
-		RB_SetGL2D();
-	}
-
-	shader = cmd->shader;
 	if ( shader != tess.shader ) {
 		if ( tess.numIndexes ) {
 			RB_EndSurface();
@@ -1372,37 +1364,77 @@ const void *RB_StretchPic ( const void *data ) {
 	baDest = (byteAlias_t *)&tess.vertexColors[numVerts + 2]; baDest->ui = baSource->ui;
 	baDest = (byteAlias_t *)&tess.vertexColors[numVerts + 3]; baDest->ui = baSource->ui;
 
-	tess.xyz[ numVerts ][0] = cmd->x;
-	tess.xyz[ numVerts ][1] = cmd->y;
+	tess.xyz[ numVerts ][0] = x;
+	tess.xyz[ numVerts ][1] = y;
 	tess.xyz[ numVerts ][2] = 0;
 
-	tess.texCoords[ numVerts ][0][0] = cmd->s1;
-	tess.texCoords[ numVerts ][0][1] = cmd->t1;
+	tess.texCoords[ numVerts ][0][0] = s1;
+	tess.texCoords[ numVerts ][0][1] = t1;
 
-	tess.xyz[ numVerts + 1 ][0] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 1 ][1] = cmd->y;
+	tess.xyz[ numVerts + 1 ][0] = x + w;
+	tess.xyz[ numVerts + 1 ][1] = y;
 	tess.xyz[ numVerts + 1 ][2] = 0;
 
-	tess.texCoords[ numVerts + 1 ][0][0] = cmd->s2;
-	tess.texCoords[ numVerts + 1 ][0][1] = cmd->t1;
+	tess.texCoords[ numVerts + 1 ][0][0] = s2;
+	tess.texCoords[ numVerts + 1 ][0][1] = t1;
 
-	tess.xyz[ numVerts + 2 ][0] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 2 ][1] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 2 ][0] = x + w;
+	tess.xyz[ numVerts + 2 ][1] = y + h;
 	tess.xyz[ numVerts + 2 ][2] = 0;
 
-	tess.texCoords[ numVerts + 2 ][0][0] = cmd->s2;
-	tess.texCoords[ numVerts + 2 ][0][1] = cmd->t2;
+	tess.texCoords[ numVerts + 2 ][0][0] = s2;
+	tess.texCoords[ numVerts + 2 ][0][1] = t2;
 
-	tess.xyz[ numVerts + 3 ][0] = cmd->x;
-	tess.xyz[ numVerts + 3 ][1] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 3 ][0] = x;
+	tess.xyz[ numVerts + 3 ][1] = y + h;
 	tess.xyz[ numVerts + 3 ][2] = 0;
 
-	tess.texCoords[ numVerts + 3 ][0][0] = cmd->s1;
-	tess.texCoords[ numVerts + 3 ][0][1] = cmd->t2;
+	tess.texCoords[ numVerts + 3 ][0][0] = s1;
+	tess.texCoords[ numVerts + 3 ][0][1] = t2;
+}
+
+/*
+=============
+RB_StretchPic
+=============
+*/
+const void *RB_StretchPic ( const void *data ) {
+	const stretchPicCommand_t	*cmd;
+
+	cmd = (const stretchPicCommand_t *)data;
+
+	if ( !backEnd.projection2D ) {
+		RB_SetGL2D();
+	}
+
+	RB_AddStretchPic( cmd->shader, cmd->x, cmd->y, cmd->w, cmd->h, cmd->s1, cmd->t1, cmd->s2, cmd->t2 );
 
 	return (const void *)(cmd + 1);
 }
 
+/*
+=============
+RB_StretchPics
+=============
+*/
+const void *RB_StretchPics ( const void *data ) {
+	const stretchPicsCommand_t	*cmd;
+	const stretchPic_t	*pic;
+	int		i;
+
+	cmd = (const stretchPicsCommand_t *)data;
+
+	if ( !backEnd.projection2D ) {
+		RB_SetGL2D();
+	}
+
+	for ( i = 0, pic = cmd->pics; i < cmd->numPics; i++, pic++ ) {
+		RB_AddStretchPic( pic->shader, pic->x, pic->y, pic->w, pic->h, pic->s1, pic->t1, pic->s2, pic->t2 );
+	}
+
+	return (const void *)(cmd->pics + cmd->numPics);
+}
+
 
 /*
 =============
@@ -1968,6 +2000,9 @@ void RB_ExecuteRenderCommands( const void *data ) {
 		case RC_STRETCH_PIC:
 			data = RB_StretchPic( data );
 			break;
+		case RC_STRETCH_PICS:
+			data = RB_StretchPics( data );
+			break;
 		case RC_ROTATE_PIC:
 			data = RB_RotatePic( data );
 			break;
@@ -235,6 +235,29 @@ void RE_StretchPic ( float x, float y, float w, float h,
 	cmd->t2 = t2;
 }
 
+/*
+=============
+R_AddStretchPics
+
+Reserves one command for up to MAX_STRETCH_PICS_PER_COMMAND pics drawn with
+the current colour, the caller fills in the returned array. NULL once the
+command buffer is full, same as the single pic commands.
+=============
+*/
+stretchPic_t *R_AddStretchPics( int numPics ) {
+	stretchPicsCommand_t	*cmd;
+
+	assert( numPics > 0 && numPics <= MAX_STRETCH_PICS_PER_COMMAND );
+
+	cmd = (stretchPicsCommand_t *) R_GetCommandBuffer( sizeof( *cmd ) + ( numPics - 1 ) * sizeof( stretchPic_t ) );
+	if ( !cmd ) {
+		return NULL;
+	}
+	cmd->commandId = RC_STRETCH_PICS;
+	cmd->numPics = numPics;
+	return cmd->pics;
+}
+
 /*
 =============
 RE_RotatePic
@@ -1772,6 +1772,21 @@ typedef struct stretchPicCommand_s {
 	float	s2, t2;
 } stretchPicCommand_t;
 
+typedef struct stretchPic_s {
+	shader_t	*shader;
+	float	x, y;
+	float	w, h;
+	float	s1, t1;
+	float	s2, t2;
+} stretchPic_t;
+
+// a run of pics sharing the current colour, used for whole strings of text
+typedef struct stretchPicsCommand_s {
+	int		commandId;
+	int		numPics;
+	stretchPic_t	pics[1];	// numPics long
+} stretchPicsCommand_t;
+
 typedef struct rotatePicCommand_s {
 	int		commandId;
 	shader_t	*shader;
@@ -1810,7 +1825,8 @@ typedef enum {
 	RC_SWAP_BUFFERS,
 	RC_WORLD_EFFECTS,
 	RC_AUTO_MAP,
-	RC_VIDEOFRAME
+	RC_VIDEOFRAME,
+	RC_STRETCH_PICS
 } renderCommand_t;
 
 
@@ -1842,6 +1858,8 @@ void R_AddDrawSurfCmd( drawSurf_t *drawSurfs, int numDrawSurfs );
 void RE_SetColor( const float *rgba );
 void RE_StretchPic ( float x, float y, float w, float h,
 					  float s1, float t1, float s2, float t2, qhandle_t hShader );
+#define MAX_STRETCH_PICS_PER_COMMAND	256
+stretchPic_t *R_AddStretchPics( int numPics );
 void RE_RotatePic ( float x, float y, float w, float h,
 					  float s1, float t1, float s2, float t2,float a, qhandle_t hShader );
 void RE_RotatePic2 ( float x, float y, float w, float h,
@@ -2573,6 +2573,12 @@ static void FixRenderCommandList( int newShader ) {
 					curCmd = (const void *)(sp_cmd + 1);
 					break;
 					}
+				case RC_STRETCH_PICS:
+					{
+					const stretchPicsCommand_t *sp_cmd = (const stretchPicsCommand_t *)curCmd;
+					curCmd = (const void *)(sp_cmd->pics + sp_cmd->numPics);
+					break;
+					}
 				case RC_ROTATE_PIC:
 					{
 					const rotatePicCommand_t *sp_cmd = (const rotatePicCommand_t *)curCmd;
@@ -66,6 +66,12 @@ typedef struct server_s {
 	char			*configstrings[MAX_CONFIGSTRINGS];
 	svEntity_t		svEntities[MAX_GENTITIES];
 
+	// the configstrings and baselines part of the gamestate message, encoded once
+	// and shared by every client until a configstring or baseline changes
+	qboolean		gameStateCacheValid;
+	int				gameStateCacheBits;
+	byte			gameStateCache[MAX_MSGLEN];
+
 	char			*entityParsePoint;	// used during game VM init
 
 	// the game virtual machine will update these on init and changes
@@ -132,13 +138,19 @@ typedef struct {
 } demoInfo_t;
 
 
+// a reliable command string, shared by every client it was sent to
+typedef struct reliableCommand_s {
+	int				refCount;		// client slots still pointing at it
+	char			string[1];		// allocated to fit
+} reliableCommand_t;
+
 typedef struct client_s {
 	clientState_t	state;
 	char			userinfo[MAX_INFO_STRING];		// name, etc
 
 	qboolean		sentGamedir; //see if he has been sent an svc_setgame
 
-	char			reliableCommands[MAX_RELIABLE_COMMANDS][MAX_STRING_CHARS];
+	reliableCommand_t	*reliableCommands[MAX_RELIABLE_COMMANDS];	// use SV_ReliableCommand to read
 	int				reliableSequence;		// last added reliable message, not necesarily sent or acknowledged yet
 	int				reliableAcknowledge;	// last acknowledged reliable message
 	int				reliableSent;			// last sent reliable message, not necesarily acknowledged yet
@@ -303,6 +315,8 @@ qboolean SVC_RateLimit( leakyBucket_t *bucket, int burst, int period );
 qboolean SVC_RateLimitAddress( netadr_t from, int burst, int period );
 void SV_FinalMessage (char *message);
 void QDECL SV_SendServerCommand( client_t *cl, const char *fmt, ...);
+const char *SV_ReliableCommand( const client_t *client, int sequence );
+void SV_FreeReliableCommands( client_t *client );
 
 
 void SV_AddOperatorCommands (void);
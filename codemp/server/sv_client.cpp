@@ -310,6 +310,7 @@ gotnewcl:
 	// build a new connection
 	// accept the new client
 	// this is the only place a client_t is ever initialized
+	SV_FreeReliableCommands( newcl );
 	*newcl = temp;
 	clientNum = newcl - svs.clients;
 	ent = SV_GentityNum( clientNum );
@@ -429,24 +430,17 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 	}
 }
 
-void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
+/*
+================
+SV_WriteGameStateBody
+
+Writes the configstrings and baselines, which are the same for every client
+================
+*/
+static void SV_WriteGameStateBody( msg_t *msg ) {
 	int			start;
 	entityState_t	*base, nullstate;
 
-	// NOTE, MRE: all server->client messages now acknowledge
-	// let the client know which reliable clientCommands we have received
-	MSG_WriteLong( msg, client->lastClientCommand );
-
-	// send any server commands waiting to be sent first.
-	// we have to do this cause we send the client->reliableSequence
-	// with a gamestate and it sets the clc.serverCommandSequence at
-	// the client side
-	SV_UpdateServerCommandsToClient( client, msg );
-
-	// send the gamestate
-	MSG_WriteByte( msg, svc_gamestate );
-	MSG_WriteLong( msg, client->reliableSequence );
-
 	// write the configstrings
 	for ( start = 0 ; start < MAX_CONFIGSTRINGS ; start++ ) {
 		if (sv.configstrings[start][0]) {
@@ -466,6 +460,53 @@ void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
 		MSG_WriteByte( msg, svc_baseline );
 		MSG_WriteDeltaEntity( msg, &nullstate, base, qtrue );
 	}
+}
+
+/*
+================
+SV_WriteCachedGameStateBody
+
+Encodes the gamestate body the first time it's needed after a change and
+copies the encoded bits for every client after that, so a full server
+changing maps doesn't encode the same gamestate once per client
+================
+*/
+static void SV_WriteCachedGameStateBody( msg_t *msg ) {
+	msg_t		cache;
+
+	if ( !sv.gameStateCacheValid ) {
+		MSG_Init( &cache, sv.gameStateCache, sizeof( sv.gameStateCache ) );
+		SV_WriteGameStateBody( &cache );
+		if ( cache.overflowed ) {
+			// won't fit in a message either, let the client's message overflow the usual way
+			SV_WriteGameStateBody( msg );
+			return;
+		}
+		sv.gameStateCacheBits = cache.bit;
+		sv.gameStateCacheValid = qtrue;
+	}
+
+	MSG_WriteEncodedBits( msg, sv.gameStateCache, sv.gameStateCacheBits );
+}
+
+void SV_CreateClientGameStateMessage( client_t *client, msg_t *msg ) {
+
+	// NOTE, MRE: all server->client messages now acknowledge
+	// let the client know which reliable clientCommands we have received
+	MSG_WriteLong( msg, client->lastClientCommand );
+
+	// send any server commands waiting to be sent first.
+	// we have to do this cause we send the client->reliableSequence
+	// with a gamestate and it sets the clc.serverCommandSequence at
+	// the client side
+	SV_UpdateServerCommandsToClient( client, msg );
+
+	// send the gamestate
+	MSG_WriteByte( msg, svc_gamestate );
+	MSG_WriteLong( msg, client->reliableSequence );
+
+	// write the configstrings and baselines
+	SV_WriteCachedGameStateBody( msg );
 
 	MSG_WriteByte( msg, svc_EOF );
 
@@ -1412,7 +1453,7 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 	// also use the message acknowledge
 	key ^= cl->messageAcknowledge;
 	// also use the last acknowledged server command in the key
-	key ^= Com_HashKey(cl->reliableCommands[ cl->reliableAcknowledge & (MAX_RELIABLE_COMMANDS-1) ], 32);
+	key ^= Com_HashKey(SV_ReliableCommand( cl, cl->reliableAcknowledge ), 32);
 
 	Com_Memset( &nullcmd, 0, sizeof(nullcmd) );
 	oldcmd = &nullcmd;
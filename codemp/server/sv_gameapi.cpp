@@ -29,6 +29,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/cm_public.h"
 #include "icarus/GameInterface.h"
 #include "qcommon/timing.h"
+#include "qcommon/q_parallel.h"
 #include "NPCNav/navigator.h"
 
 botlib_export_t	*botlib_export;
@@ -469,6 +470,16 @@ static qboolean SV_EntityContact( const vec3_t mins, const vec3_t maxs, const sh
 	return (qboolean)trace.startsolid;
 }
 
+// everything the game module appends to is a log (g_log, the security, client and
+// stat logs), so those are written from a background thread; FS_APPEND_SYNC stays synchronous
+static int SV_GameFS_Open( const char *qpath, fileHandle_t *f, fsMode_t mode ) {
+	const int r = FS_FOpenFileByMode( qpath, f, mode );
+	if ( mode == FS_APPEND && *f ) {
+		FS_MakeAsync( *f );
+	}
+	return r;
+}
+
 static void SV_SetBrushModel( sharedEntity_t *ent, const char *name ) {
 	clipHandle_t	h;
 	vec3_t			mins, maxs;
@@ -1716,6 +1727,14 @@ static void SV_G2API_GetSurfaceName( void *ghoul2, int surfNumber, int modelInde
 	strcpy( fillBuf, tmp );
 }
 
+static void SV_ParallelFor( int count, int minBatch, void (*func)( void *data, int begin, int end ), void *data ) {
+	Q::parallelFor( count, minBatch, [func, data]( std::size_t begin, std::size_t end ) {
+		CM_BeginConcurrentTraces();
+		func( data, (int)begin, (int)end );
+		CM_EndConcurrentTraces();
+	} );
+}
+
 static void GVM_Cvar_Set( const char *var_name, const char *value ) {
 	Cvar_VM_Set( var_name, value, VM_GAME );
 }
@@ -1831,7 +1850,7 @@ intptr_t SV_GameSystemCalls( intptr_t *args ) {
 		return 0;
 
 	case G_FS_FOPEN_FILE:
-		return FS_FOpenFileByMode( (const char *)VMA(1), (int *)VMA(2), (fsMode_t)args[3] );
+		return SV_GameFS_Open( (const char *)VMA(1), (int *)VMA(2), (fsMode_t)args[3] );
 
 	case G_FS_READ:
 		FS_Read( VMA(1), args[2], args[3] );
@@ -2907,7 +2926,7 @@ void SV_BindGame( void ) {
 		gi.Argv									= Cmd_ArgvBuffer;
 		gi.FS_Close								= FS_FCloseFile;
 		gi.FS_GetFileList						= FS_GetFileList;
-		gi.FS_Open								= FS_FOpenFileByMode;
+		gi.FS_Open								= SV_GameFS_Open;
 		gi.FS_Read								= FS_Read;
 		gi.FS_Write								= FS_Write;
 		gi.AdjustAreaPortalState				= SV_AdjustAreaPortalState;
@@ -3197,6 +3216,7 @@ void SV_BindGame( void ) {
 		gi.G2API_CleanEntAttachments			= SV_G2API_CleanEntAttachments;
 		gi.G2API_OverrideServer					= SV_G2API_OverrideServer;
 		gi.G2API_GetSurfaceName					= SV_G2API_GetSurfaceName;
+		gi.ParallelFor							= SV_ParallelFor;
 
 		GetGameAPI = (GetGameAPI_t)gvm->GetModuleAPI;
 		ret = GetGameAPI( GAME_API_VERSION, &gi );
@@ -129,6 +129,7 @@ void SV_SetConfigstring (int index, const char *val) {
 	// change the string in sv
 	Z_Free( sv.configstrings[index] );
 	sv.configstrings[index] = CopyString( val );
+	sv.gameStateCacheValid = qfalse;
 
 	// send it to all the clients if we aren't
 	// spawning a new server
@@ -232,6 +233,7 @@ void SV_CreateBaseline( void ) {
 		//
 		sv.svEntities[entnum].baseline = svent->s;
 	}
+	sv.gameStateCacheValid = qfalse;
 }
 
 /*
@@ -340,9 +342,13 @@ void SV_ChangeMaxClients( void ) {
 			oldClients[i] = svs.clients[i];
 		}
 		else {
+			SV_FreeReliableCommands( &svs.clients[i] );
 			Com_Memset(&oldClients[i], 0, sizeof(client_t));
 		}
 	}
+	for ( ; i < oldMaxClients ; i++ ) {
+		SV_FreeReliableCommands( &svs.clients[i] );
+	}
 
 	// free old clients arrays
 	Z_Free( svs.clients );
@@ -771,7 +777,7 @@ void SV_BotInitBotLib(void);
 
 #ifdef DEDICATED
 
-#define G2_VERT_SPACE_SERVER_SIZE 256
+#define G2_VERT_SPACE_SERVER_SIZE 320	// KB; transformed Ghoul2 surfaces keep their trace bounds after the vertexes, about 15% more
 IHeapAllocator *G2VertSpaceServer = NULL;
 CMiniHeap IHeapAllocator_singleton(G2_VERT_SPACE_SERVER_SIZE * 1024);
 
@@ -1100,6 +1106,9 @@ Ghoul2 Insert Start
 
 	// free server static data
 	if ( svs.clients ) {
+		for ( int i = 0 ; i < sv_maxclients->integer ; i++ ) {
+			SV_FreeReliableCommands( &svs.clients[i] );
+		}
 		Z_Free( svs.clients );
 	}
 	Com_Memset( &svs, 0, sizeof( svs ) );
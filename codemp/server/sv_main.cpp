@@ -108,13 +108,73 @@ char	*SV_ExpandNewlines( char *in ) {
 
 /*
 ======================
-SV_AddServerCommand
+SV_AllocReliableCommand
+
+Reliable commands are reference counted, so a broadcast is stored once
+no matter how many clients it goes to
+======================
+*/
+static reliableCommand_t *SV_AllocReliableCommand( const char *cmd ) {
+	reliableCommand_t	*command;
+	size_t				len;
+
+	len = strlen( cmd );
+	if ( len > MAX_STRING_CHARS - 1 ) {
+		len = MAX_STRING_CHARS - 1;
+	}
+	command = (reliableCommand_t *)Z_Malloc( sizeof( reliableCommand_t ) + len, TAG_CLIENTS, qfalse );
+	command->refCount = 0;
+	Com_Memcpy( command->string, cmd, len );
+	command->string[len] = 0;
+	return command;
+}
+
+static void SV_ReleaseReliableCommand( reliableCommand_t *command ) {
+	if ( command && --command->refCount <= 0 ) {
+		Z_Free( command );
+	}
+}
+
+/*
+======================
+SV_ReliableCommand
+
+The command string the client has at the given reliable sequence, or
+an empty string if that slot was never filled
+======================
+*/
+const char *SV_ReliableCommand( const client_t *client, int sequence ) {
+	const reliableCommand_t *command = client->reliableCommands[ sequence & (MAX_RELIABLE_COMMANDS-1) ];
+
+	return command ? command->string : "";
+}
+
+/*
+======================
+SV_FreeReliableCommands
+
+Drops the client's references to its reliable commands, must be done
+before the client_t is cleared or freed
+======================
+*/
+void SV_FreeReliableCommands( client_t *client ) {
+	int		i;
+
+	for ( i = 0 ; i < MAX_RELIABLE_COMMANDS ; i++ ) {
+		SV_ReleaseReliableCommand( client->reliableCommands[i] );
+		client->reliableCommands[i] = NULL;
+	}
+}
+
+/*
+======================
+SV_AddReliableCommand
 
 The given command will be transmitted to the client, and is guaranteed to
 not have future snapshot_t executed before it is executed
 ======================
 */
-void SV_AddServerCommand( client_t *client, const char *cmd ) {
+static void SV_AddReliableCommand( client_t *client, reliableCommand_t *command ) {
 	int		index, i;
 
 	// do not send commands until the gamestate has been sent
@@ -130,14 +190,35 @@ void SV_AddServerCommand( client_t *client, const char *cmd ) {
 	if ( client->reliableSequence - client->reliableAcknowledge == MAX_RELIABLE_COMMANDS + 1 ) {
 		Com_Printf( "===== pending server commands =====\n" );
 		for ( i = client->reliableAcknowledge + 1 ; i <= client->reliableSequence ; i++ ) {
-			Com_Printf( "cmd %5d: %s\n", i, client->reliableCommands[ i & (MAX_RELIABLE_COMMANDS-1) ] );
+			Com_Printf( "cmd %5d: %s\n", i, SV_ReliableCommand( client, i ) );
 		}
-		Com_Printf( "cmd %5d: %s\n", i, cmd );
+		Com_Printf( "cmd %5d: %s\n", i, command->string );
 		SV_DropClient( client, "Server command overflow" );
 		return;
 	}
 	index = client->reliableSequence & ( MAX_RELIABLE_COMMANDS - 1 );
-	Q_strncpyz( client->reliableCommands[ index ], cmd, sizeof( client->reliableCommands[ index ] ) );
+	command->refCount++;
+	SV_ReleaseReliableCommand( client->reliableCommands[ index ] );
+	client->reliableCommands[ index ] = command;
+}
+
+/*
+======================
+SV_AddServerCommand
+======================
+*/
+void SV_AddServerCommand( client_t *client, const char *cmd ) {
+	reliableCommand_t	*command;
+
+	// do not send commands until the gamestate has been sent
+	if ( client->state < CS_PRIMED ) {
+		return;
+	}
+
+	command = SV_AllocReliableCommand( cmd );
+	command->refCount++;	// hold it in case the client gets dropped
+	SV_AddReliableCommand( client, command );
+	SV_ReleaseReliableCommand( command );
 }
 
 
@@ -155,6 +236,7 @@ void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 	byte		message[MAX_MSGLEN];
 	client_t	*client;
 	int			j;
+	reliableCommand_t	*command;
 
 	va_start (argptr,fmt);
 	Q_vsnprintf((char *)message, sizeof(message), fmt, argptr);
@@ -178,10 +260,13 @@ void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 		Com_Printf ("broadcast: %s\n", SV_ExpandNewlines((char *)message) );
 	}
 
-	// send the data to all relevent clients
+	// send the data to all relevent clients, sharing a single copy of the string
+	command = SV_AllocReliableCommand( (char *)message );
+	command->refCount++;
 	for (j = 0, client = svs.clients; j < sv_maxclients->integer ; j++, client++) {
-		SV_AddServerCommand( client, (char *)message );
+		SV_AddReliableCommand( client, command );
 	}
+	SV_ReleaseReliableCommand( command );
 }
 
 
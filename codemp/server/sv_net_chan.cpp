@@ -95,7 +95,8 @@ static void SV_Netchan_Decode( client_t *client, msg_t *msg ) {
 	int serverId, messageAcknowledge, reliableAcknowledge;
 	int i, index, srdc, sbit;
 	qboolean soob;
-	byte key, *string;
+	byte key;
+	const byte *string;
 
         srdc = msg->readcount;
         sbit = msg->bit;
@@ -111,7 +112,7 @@ static void SV_Netchan_Decode( client_t *client, msg_t *msg ) {
         msg->bit = sbit;
         msg->readcount = srdc;
 
-	string = (byte *)client->reliableCommands[ reliableAcknowledge & (MAX_RELIABLE_COMMANDS-1) ];
+	string = (const byte *)SV_ReliableCommand( client, reliableAcknowledge );
 	index = 0;
 	//
 	key = client->challenge ^ serverId ^ messageAcknowledge;
@@ -27,6 +27,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "ghoul2/ghoul2_shared.h"
 #include "qcommon/cm_public.h"
 
+#include <mutex>
+
 /*
 ================
 SV_ClipHandleForEntity
@@ -535,8 +537,11 @@ static float VectorDistance(vec3_t p1, vec3_t p2)
 }
 #endif
 
+// Ghoul2 collision isn't safe to run on several threads at once, see CM_BeginConcurrentTraces
+static std::mutex	sv_ghoul2TraceMutex;
+
 static void SV_ClipMoveToEntities( moveclip_t *clip ) {
-	static int	touchlist[MAX_GENTITIES];
+	int			touchlist[MAX_GENTITIES];
 	int			i, num;
 	sharedEntity_t *touch;
 	int			passOwnerNum;
@@ -705,6 +710,7 @@ Ghoul2 Insert Start
 		//this must be done somewhat differently.
 		if ((clip->traceFlags & G2TRFLAG_DOGHOULTRACE) && trace.entityNum == touch->s.number && touch->ghoul2 && ((clip->traceFlags & G2TRFLAG_HITCORPSES) || !(touch->s.eFlags & EF_DEAD)))
 		{ //standard behavior will be to ignore g2 col on dead ents, but if traceFlags is set to allow, then we'll try g2 col on EF_DEAD people too.
+			std::lock_guard<std::mutex> ghoul2TraceLock( sv_ghoul2TraceMutex );
 			static G2Trace_t G2Trace;
 			vec3_t angles;
 			float fRadius = 0.0f;
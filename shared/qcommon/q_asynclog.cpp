@@ -0,0 +1,245 @@
+#include "q_asynclog.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace Q
+{
+	namespace
+	{
+		struct LogNode
+		{
+			LogNode* next;
+			/// set for the markers flush() queues, the writer flags it once everything before it is on disk
+			bool* flushed;
+			std::size_t length;
+			char data[ 1 ];
+		};
+
+		/// nullptr if out of memory
+		LogNode* allocNode( std::size_t length )
+		{
+			LogNode* node = static_cast< LogNode* >( std::malloc( offsetof( LogNode, data ) + length ) );
+			if( !node )
+			{
+				return nullptr;
+			}
+			node->next = nullptr;
+			node->flushed = nullptr;
+			node->length = length;
+			return node;
+		}
+	}
+
+	struct AsyncLog::Impl
+	{
+		std::FILE* file;
+		const std::string path;
+		const Options options;
+		std::size_t fileBytes = 0;
+
+		// producers push onto this stack without locking, the writer takes all of it at once
+		std::atomic< LogNode* > head{ nullptr };
+		std::atomic< std::size_t > pendingBytes{ 0 };
+		std::atomic< bool > urgent{ false };
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable flushed;
+		bool stop = false;
+
+		std::thread thread;
+
+		Impl( std::FILE* file_, const std::string& path_, const Options& options_ )
+			: file( file_ )
+			, path( path_ )
+			, options( options_ )
+		{
+			if( file && std::fseek( file, 0, SEEK_END ) == 0 )
+			{
+				const long size = std::ftell( file );
+				fileBytes = size > 0 ? static_cast< std::size_t >( size ) : 0;
+			}
+			thread = std::thread( [ this ]{ writerMain(); } );
+		}
+
+		void push( LogNode* node )
+		{
+			LogNode* expected = head.load( std::memory_order_relaxed );
+			do
+			{
+				node->next = expected;
+			} while( !head.compare_exchange_weak( expected, node, std::memory_order_release, std::memory_order_relaxed ) );
+		}
+
+		void writerMain()
+		{
+			const auto interval = std::chrono::milliseconds( options.flushMilliseconds > 0 ? options.flushMilliseconds : 1 );
+			for( ;; )
+			{
+				bool stopping;
+				{
+					std::unique_lock< std::mutex > lock( mutex );
+					wake.wait_for( lock, interval, [ this ]{ return stop || urgent.load(); } );
+					stopping = stop;
+				}
+				urgent = false;
+				drain();
+				if( stopping )
+				{
+					// anything written after stop was set has still been drained above, since stop is only set on destruction
+					return;
+				}
+			}
+		}
+
+		void drain()
+		{
+			LogNode* list = head.exchange( nullptr, std::memory_order_acquire );
+			if( !list )
+			{
+				return;
+			}
+
+			// the stack is newest first
+			LogNode* ordered = nullptr;
+			while( list )
+			{
+				LogNode* next = list->next;
+				list->next = ordered;
+				ordered = list;
+				list = next;
+			}
+
+			while( ordered )
+			{
+				LogNode* node = ordered;
+				ordered = node->next;
+				if( node->flushed )
+				{
+					// markers live on the stack of the thread waiting in flush(), which may return as soon as this is set
+					bool* done = node->flushed;
+					if( file )
+					{
+						std::fflush( file );
+					}
+					std::lock_guard< std::mutex > lock( mutex );
+					*done = true;
+					flushed.notify_all();
+				}
+				else
+				{
+					writeOut( node->data, node->length );
+					pendingBytes -= node->length;
+					std::free( node );
+				}
+			}
+
+			if( file )
+			{
+				std::fflush( file );
+			}
+		}
+
+		void writeOut( const char* data, std::size_t length )
+		{
+			if( !file )
+			{
+				return;
+			}
+			if( options.rotateBytes && fileBytes > 0 && fileBytes + length > options.rotateBytes )
+			{
+				rotate();
+				if( !file )
+				{
+					return;
+				}
+			}
+			fileBytes += std::fwrite( data, 1, length, file );
+		}
+
+		void rotate()
+		{
+			std::fclose( file );
+			for( int i = options.rotateCount - 1; i >= 1; --i )
+			{
+				const std::string from = path + "." + std::to_string( i );
+				const std::string to = path + "." + std::to_string( i + 1 );
+				std::remove( to.c_str() );
+				std::rename( from.c_str(), to.c_str() );
+			}
+			if( options.rotateCount > 0 )
+			{
+				const std::string to = path + ".1";
+				std::remove( to.c_str() );
+				std::rename( path.c_str(), to.c_str() );
+			}
+			file = std::fopen( path.c_str(), "wb" );
+			fileBytes = 0;
+		}
+	};
+
+	AsyncLog::AsyncLog( std::FILE* file, const std::string& path, const Options& options )
+		: _impl( new Impl( file, path, options ) )
+	{
+	}
+
+	AsyncLog::~AsyncLog()
+	{
+		{
+			std::lock_guard< std::mutex > lock( _impl->mutex );
+			_impl->stop = true;
+		}
+		_impl->wake.notify_one();
+		_impl->thread.join();
+		if( _impl->file )
+		{
+			std::fclose( _impl->file );
+		}
+		delete _impl;
+	}
+
+	void AsyncLog::write( const void* data, std::size_t length )
+	{
+		if( !length )
+		{
+			return;
+		}
+		LogNode* node = allocNode( length );
+		if( !node )
+		{
+			// nowhere to put it, losing a log line beats taking the game down
+			return;
+		}
+		std::memcpy( node->data, data, length );
+		const std::size_t pending = _impl->pendingBytes += length;
+		_impl->push( node );
+
+		// notifying without the mutex can miss a writer that is just about to wait, the timeout catches that
+		if( _impl->options.flushEveryWrite || pending >= _impl->options.flushBytes )
+		{
+			_impl->urgent = true;
+			_impl->wake.notify_one();
+		}
+	}
+
+	void AsyncLog::flush()
+	{
+		bool done = false;
+		LogNode marker;
+		marker.next = nullptr;
+		marker.flushed = &done;
+		marker.length = 0;
+		_impl->push( &marker );
+
+		std::unique_lock< std::mutex > lock( _impl->mutex );
+		_impl->urgent = true;
+		_impl->wake.notify_one();
+		_impl->flushed.wait( lock, [ &done ]{ return done; } );
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	Appends to a log file from a background thread so callers never wait on the disk.
+
+	write() may be called from any thread and doesn't lock; writes from one thread stay in order.
+	The writer thread flushes whenever flushBytes are pending or flushMilliseconds have passed,
+	and starts a new file once the current one has grown past rotateBytes.
+	*/
+	class AsyncLog
+	{
+	public:
+		struct Options
+		{
+			/// wake the writer once this many bytes are waiting
+			std::size_t flushBytes = 64 * 1024;
+			/// longest time written data waits before it reaches the file
+			int flushMilliseconds = 1000;
+			/// fflush after every batch the writer takes, for logs that need to survive a crash
+			bool flushEveryWrite = false;
+			/// 0 never rotates, otherwise the file is renamed to path.1 (and older ones shifted up) once it's this big
+			std::size_t rotateBytes = 0;
+			/// how many rotated files to keep
+			int rotateCount = 5;
+		};
+
+		/// Takes ownership of file, which must be open for writing at path. path is only used to rotate.
+		AsyncLog( std::FILE* file, const std::string& path, const Options& options );
+		/// Writes out everything still queued and closes the file.
+		~AsyncLog();
+
+		AsyncLog( const AsyncLog& ) = delete;
+		AsyncLog& operator=( const AsyncLog& ) = delete;
+
+		/// Queues a copy of data. Drops it if there's no memory to copy it into.
+		void write( const void* data, std::size_t length );
+
+		/// Blocks until everything written so far is in the file and flushed.
+		void flush();
+
+	private:
+		struct Impl;
+		Impl* _impl;
+	};
+}
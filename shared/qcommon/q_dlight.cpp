@@ -0,0 +1,306 @@
+#include "q_dlight.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_DLIGHT_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Q
+{
+	namespace
+	{
+		inline std::uint8_t clipCode( const float* vertex, const float* light ) NOEXCEPT
+		{
+			const float radius = light[ 3 ];
+			std::uint8_t code = 0;
+			for( int axis = 0; axis < 3; ++axis )
+			{
+				const float dist = light[ axis ] - vertex[ axis ];
+				if( dist < -radius )
+				{
+					code |= 1 << ( axis * 2 );
+				}
+				else if( dist > radius )
+				{
+					code |= 2 << ( axis * 2 );
+				}
+			}
+			return code;
+		}
+	}
+
+	std::uint32_t dlightClipCodesReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float( *lights )[ 4 ], std::size_t numLights, std::uint8_t* codes, std::size_t codeStride )
+	{
+		std::uint32_t reached = 0;
+		for( std::size_t l = 0; l < numLights; ++l )
+		{
+			std::uint8_t* out = codes + l * codeStride;
+			std::uint8_t clipAll = 63;
+			for( std::size_t v = 0; v < numVertexes; ++v )
+			{
+				out[ v ] = clipCode( xyz[ v ], lights[ l ] );
+				clipAll &= out[ v ];
+			}
+			if( !clipAll )
+			{
+				reached |= 1u << l;
+			}
+		}
+		return reached;
+	}
+
+	std::uint32_t dlightClipCodes( const float( *xyz )[ 4 ], std::size_t numVertexes, const float( *lights )[ 4 ], std::size_t numLights, std::uint8_t* codes, std::size_t codeStride )
+	{
+#ifdef Q_DLIGHT_SSE
+		std::uint32_t reached = 0;
+		std::size_t l = 0;
+		for( ; l + 4 <= numLights; l += 4 )
+		{
+			// lights across the lanes
+			__m128 x = _mm_loadu_ps( lights[ l + 0 ] );
+			__m128 y = _mm_loadu_ps( lights[ l + 1 ] );
+			__m128 z = _mm_loadu_ps( lights[ l + 2 ] );
+			__m128 radius = _mm_loadu_ps( lights[ l + 3 ] );
+			_MM_TRANSPOSE4_PS( x, y, z, radius );
+			const __m128 negRadius = _mm_xor_ps( radius, _mm_set1_ps( -0.0f ) );
+
+			const __m128i one = _mm_set1_epi32( 1 );
+			const __m128i two = _mm_set1_epi32( 2 );
+			std::uint8_t* out0 = codes + ( l + 0 ) * codeStride;
+			std::uint8_t* out1 = codes + ( l + 1 ) * codeStride;
+			std::uint8_t* out2 = codes + ( l + 2 ) * codeStride;
+			std::uint8_t* out3 = codes + ( l + 3 ) * codeStride;
+			__m128i clipAll = _mm_set1_epi32( 63 );
+
+			for( std::size_t v = 0; v < numVertexes; ++v )
+			{
+				const __m128 dx = _mm_sub_ps( x, _mm_set1_ps( xyz[ v ][ 0 ] ) );
+				const __m128 dy = _mm_sub_ps( y, _mm_set1_ps( xyz[ v ][ 1 ] ) );
+				const __m128 dz = _mm_sub_ps( z, _mm_set1_ps( xyz[ v ][ 2 ] ) );
+
+				// the far side is only tested when the near one isn't clipped, like the scalar else if
+				const __m128 belowX = _mm_cmplt_ps( dx, negRadius );
+				const __m128 aboveX = _mm_andnot_ps( belowX, _mm_cmpgt_ps( dx, radius ) );
+				const __m128 belowY = _mm_cmplt_ps( dy, negRadius );
+				const __m128 aboveY = _mm_andnot_ps( belowY, _mm_cmpgt_ps( dy, radius ) );
+				const __m128 belowZ = _mm_cmplt_ps( dz, negRadius );
+				const __m128 aboveZ = _mm_andnot_ps( belowZ, _mm_cmpgt_ps( dz, radius ) );
+
+				const __m128i codeX = _mm_or_si128( _mm_and_si128( _mm_castps_si128( belowX ), one ), _mm_and_si128( _mm_castps_si128( aboveX ), two ) );
+				const __m128i codeY = _mm_or_si128( _mm_and_si128( _mm_castps_si128( belowY ), one ), _mm_and_si128( _mm_castps_si128( aboveY ), two ) );
+				const __m128i codeZ = _mm_or_si128( _mm_and_si128( _mm_castps_si128( belowZ ), one ), _mm_and_si128( _mm_castps_si128( aboveZ ), two ) );
+				const __m128i code = _mm_or_si128( codeX, _mm_or_si128( _mm_slli_epi32( codeY, 2 ), _mm_slli_epi32( codeZ, 4 ) ) );
+				clipAll = _mm_and_si128( clipAll, code );
+
+				const __m128i packed = _mm_packus_epi16( _mm_packs_epi32( code, code ), code );
+				const std::uint32_t bytes = static_cast< std::uint32_t >( _mm_cvtsi128_si32( packed ) );
+				out0[ v ] = static_cast< std::uint8_t >( bytes );
+				out1[ v ] = static_cast< std::uint8_t >( bytes >> 8 );
+				out2[ v ] = static_cast< std::uint8_t >( bytes >> 16 );
+				out3[ v ] = static_cast< std::uint8_t >( bytes >> 24 );
+			}
+
+			// a lane is zero when nothing is clipped by every vertex
+			const int none = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( clipAll, _mm_setzero_si128() ) ) );
+			reached |= static_cast< std::uint32_t >( none ) << l;
+		}
+		if( l < numLights )
+		{
+			reached |= dlightClipCodesReference( xyz, numVertexes, lights + l, numLights - l, codes + l * codeStride, codeStride ) << l;
+		}
+		return reached;
+#else
+		return dlightClipCodesReference( xyz, numVertexes, lights, numLights, codes, codeStride );
+#endif
+	}
+
+	namespace
+	{
+		const float HALF_PI = 1.57079632679489661923f;
+
+		inline float dot( const float* a, const float* b ) NOEXCEPT
+		{
+			return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+		}
+
+		/// Maps a range of view tangents to the cells covering it
+		inline void clusterCells( float lo, float hi, float extent, int count, int& first, int& last ) NOEXCEPT
+		{
+			const float scale = count / ( 2.0f * extent );
+			// clamp before converting, boxes right beside the viewer have huge tangents
+			first = static_cast< int >( std::min( std::max( ( lo + extent ) * scale, 0.0f ), static_cast< float >( count - 1 ) ) );
+			last = static_cast< int >( std::min( std::max( ( hi + extent ) * scale, 0.0f ), static_cast< float >( count - 1 ) ) );
+		}
+
+		inline int clusterSlice( const DlightClusters& clusters, float depth ) NOEXCEPT
+		{
+			if( depth <= clusters.view.zNear )
+			{
+				return 0;
+			}
+			const int slice = static_cast< int >( std::log( depth / clusters.view.zNear ) * clusters.sliceScale );
+			return std::min( std::max( slice, 0 ), DLIGHT_CLUSTER_SLICES - 1 );
+		}
+
+		/// The range of view tangents a sphere covers in one plane through the view axis, or false if it reaches around the viewer
+		inline bool sphereTangents( float forward, float side, float radius, float& lo, float& hi ) NOEXCEPT
+		{
+			const float distSquared = forward * forward + side * side;
+			if( forward <= 0 || distSquared <= radius * radius )
+			{
+				return false;
+			}
+			const float center = std::atan2( side, forward );
+			const float half = std::asin( radius / std::sqrt( distSquared ) );
+			if( center - half <= -HALF_PI || center + half >= HALF_PI )
+			{
+				return false;
+			}
+			lo = std::tan( center - half );
+			hi = std::tan( center + half );
+			return true;
+		}
+
+		template< std::size_t count >
+		inline void addRange( std::uint32_t( &cells )[ count ], int first, int last, std::uint32_t bit ) NOEXCEPT
+		{
+			for( int i = first; i <= last; ++i )
+			{
+				cells[ i ] |= bit;
+			}
+		}
+
+		template< std::size_t count >
+		inline std::uint32_t gatherRange( const std::uint32_t( &cells )[ count ], int first, int last ) NOEXCEPT
+		{
+			std::uint32_t bits = 0;
+			for( int i = first; i <= last; ++i )
+			{
+				bits |= cells[ i ];
+			}
+			return bits;
+		}
+	}
+
+	void dlightClustersSetup( DlightClusters& clusters, const DlightClusterView& view, const float( *lights )[ 4 ], std::size_t numLights )
+	{
+		clusters = DlightClusters();
+		clusters.numLights = std::min( numLights, DLIGHT_CLIP_MAX_LIGHTS );
+		if( !clusters.numLights )
+		{
+			return;
+		}
+
+		clusters.view = view;
+		const float zFar = std::max( view.zFar, view.zNear * 2 );
+		clusters.sliceScale = DLIGHT_CLUSTER_SLICES / std::log( zFar / view.zNear );
+
+		for( std::size_t l = 0; l < clusters.numLights; ++l )
+		{
+			const float* light = lights[ l ];
+			const float radius = light[ 3 ];
+			const std::uint32_t bit = 1u << l;
+			const float delta[ 3 ] = { light[ 0 ] - view.origin[ 0 ], light[ 1 ] - view.origin[ 1 ], light[ 2 ] - view.origin[ 2 ] };
+			const float forward = dot( delta, view.axis[ 0 ] );
+			const float left = dot( delta, view.axis[ 1 ] );
+			const float up = dot( delta, view.axis[ 2 ] );
+			int first, last;
+			float lo, hi;
+
+			if( forward + radius <= 0 )
+			{
+				// entirely behind the view
+				continue;
+			}
+
+			if( sphereTangents( forward, left, radius, lo, hi ) )
+			{
+				clusterCells( lo, hi, view.tanX, DLIGHT_CLUSTER_COLUMNS, first, last );
+			}
+			else
+			{
+				first = 0;
+				last = DLIGHT_CLUSTER_COLUMNS - 1;
+			}
+			addRange( clusters.columns, first, last, bit );
+
+			if( sphereTangents( forward, up, radius, lo, hi ) )
+			{
+				clusterCells( lo, hi, view.tanY, DLIGHT_CLUSTER_ROWS, first, last );
+			}
+			else
+			{
+				first = 0;
+				last = DLIGHT_CLUSTER_ROWS - 1;
+			}
+			addRange( clusters.rows, first, last, bit );
+
+			addRange( clusters.slices, clusterSlice( clusters, forward - radius ), clusterSlice( clusters, forward + radius ), bit );
+		}
+	}
+
+	std::uint32_t dlightClusterBits( const DlightClusters& clusters, const float* mins, const float* maxs )
+	{
+		if( !clusters.numLights )
+		{
+			return 0;
+		}
+
+		const DlightClusterView& view = clusters.view;
+		float minForward = 999999, maxForward = -999999;
+		float minLeft = 999999, maxLeft = -999999;
+		float minUp = 999999, maxUp = -999999;
+		bool inFront = true;
+		for( int i = 0; i < 8; ++i )
+		{
+			const float delta[ 3 ] = {
+				( ( i & 1 ) ? maxs[ 0 ] : mins[ 0 ] ) - view.origin[ 0 ],
+				( ( i & 2 ) ? maxs[ 1 ] : mins[ 1 ] ) - view.origin[ 1 ],
+				( ( i & 4 ) ? maxs[ 2 ] : mins[ 2 ] ) - view.origin[ 2 ]
+			};
+			const float forward = dot( delta, view.axis[ 0 ] );
+			minForward = std::min( minForward, forward );
+			maxForward = std::max( maxForward, forward );
+			if( forward <= 0 )
+			{
+				inFront = false;
+				continue;
+			}
+
+			// the tangents of a box are at their extremes on its corners
+			const float left = dot( delta, view.axis[ 1 ] ) / forward;
+			const float up = dot( delta, view.axis[ 2 ] ) / forward;
+			minLeft = std::min( minLeft, left );
+			maxLeft = std::max( maxLeft, left );
+			minUp = std::min( minUp, up );
+			maxUp = std::max( maxUp, up );
+		}
+
+		if( maxForward <= 0 )
+		{
+			return 0;
+		}
+
+		int first = 0, last = DLIGHT_CLUSTER_COLUMNS - 1;
+		if( inFront )
+		{
+			clusterCells( minLeft, maxLeft, view.tanX, DLIGHT_CLUSTER_COLUMNS, first, last );
+		}
+		const std::uint32_t columns = gatherRange( clusters.columns, first, last );
+
+		first = 0;
+		last = DLIGHT_CLUSTER_ROWS - 1;
+		if( inFront )
+		{
+			clusterCells( minUp, maxUp, view.tanY, DLIGHT_CLUSTER_ROWS, first, last );
+		}
+		const std::uint32_t rows = gatherRange( clusters.rows, first, last );
+
+		const std::uint32_t slices = gatherRange( clusters.slices, clusterSlice( clusters, minForward ), clusterSlice( clusters, maxForward ) );
+
+		return columns & rows & slices;
+	}
+}
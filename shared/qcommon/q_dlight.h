@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/// at most this many lights go into one dlightClipCodes call, as many as the renderer's dlight bit masks hold
+	const std::size_t DLIGHT_CLIP_MAX_LIGHTS = 32;
+
+	/**
+	Clip codes of vertexes against the boxes around dynamic lights, the way the renderer's dlight pass builds them:
+	bit 1 / 2 is set when the light's origin is more than its radius below / above the vertex on x,
+	4 / 8 and 16 / 32 do the same on y and z.
+
+	xyz is numVertexes positions padded to 4 floats, lights holds numLights { x, y, z, radius }.
+	Light l's codes go to codes + l * codeStride.
+	Returns a mask with bit l set unless every vertex shares a clip bit for light l, which means the light can't reach any triangle.
+
+	The SSE version tests four lights per vertex at once.
+	*/
+	std::uint32_t dlightClipCodes( const float( *xyz )[ 4 ], std::size_t numVertexes, const float( *lights )[ 4 ], std::size_t numLights, std::uint8_t* codes, std::size_t codeStride );
+
+	/// The scalar version of dlightClipCodes, one light at a time like the renderer used to do it
+	std::uint32_t dlightClipCodesReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float( *lights )[ 4 ], std::size_t numLights, std::uint8_t* codes, std::size_t codeStride );
+
+	const int DLIGHT_CLUSTER_COLUMNS = 16;
+	const int DLIGHT_CLUSTER_ROWS = 8;
+	const int DLIGHT_CLUSTER_SLICES = 16;
+
+	/// The view dlights are sorted into clusters for; axis is forward, left, up
+	struct DlightClusterView
+	{
+		float origin[ 3 ];
+		float axis[ 3 ][ 3 ];
+		/// Tangents of half the horizontal and vertical field of view
+		float tanX;
+		float tanY;
+		float zNear;
+		float zFar;
+	};
+
+	/**
+	The view cut into columns and rows by angle and into slices by log depth,
+	each cell holding a mask of the dlights reaching into it.
+
+	Lights and the boxes looked up both cover whole ranges of cells on every axis,
+	so the axes are kept apart and anded together with the same result as a full 3D grid.
+	*/
+	struct DlightClusters
+	{
+		std::size_t numLights;
+		DlightClusterView view;
+		/// DLIGHT_CLUSTER_SLICES / log( zFar / zNear )
+		float sliceScale;
+		std::uint32_t columns[ DLIGHT_CLUSTER_COLUMNS ];
+		std::uint32_t rows[ DLIGHT_CLUSTER_ROWS ];
+		std::uint32_t slices[ DLIGHT_CLUSTER_SLICES ];
+	};
+
+	/**
+	Sorts numLights lights, each { x, y, z, radius }, into the clusters of view.
+	Light l gets bit l; lights past DLIGHT_CLIP_MAX_LIGHTS are ignored.
+	Lights reaching around the viewer cover every column and row.
+	*/
+	void dlightClustersSetup( DlightClusters& clusters, const DlightClusterView& view, const float( *lights )[ 4 ], std::size_t numLights );
+
+	/**
+	Returns the lights in the clusters a world space box touches.
+	This is conservative: a light that reaches the box always has its bit set, some that don't may too.
+	*/
+	std::uint32_t dlightClusterBits( const DlightClusters& clusters, const float* mins, const float* maxs );
+}
@@ -0,0 +1,200 @@
+#include "q_g2trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Q
+{
+	namespace
+	{
+		/// model units, keeps hits on a bounds face from being culled by rounding
+		const float BOUNDS_MARGIN = 0.1f;
+		/// the same for radius traces, which work in units of their box
+		const float RADIUS_MARGIN = 0.001f;
+
+		inline void subtract( const float* a, const float* b, float* out ) NOEXCEPT
+		{
+			out[ 0 ] = a[ 0 ] - b[ 0 ];
+			out[ 1 ] = a[ 1 ] - b[ 1 ];
+			out[ 2 ] = a[ 2 ] - b[ 2 ];
+		}
+
+		inline float dot( const float* a, const float* b ) NOEXCEPT
+		{
+			return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+		}
+
+		inline void cross( const float* a, const float* b, float* out ) NOEXCEPT
+		{
+			out[ 0 ] = a[ 1 ] * b[ 2 ] - a[ 2 ] * b[ 1 ];
+			out[ 1 ] = a[ 2 ] * b[ 0 ] - a[ 0 ] * b[ 2 ];
+			out[ 2 ] = a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ];
+		}
+
+		inline void clearBounds( float* bounds ) NOEXCEPT
+		{
+			bounds[ 0 ] = bounds[ 1 ] = bounds[ 2 ] = 99999;
+			bounds[ 3 ] = bounds[ 4 ] = bounds[ 5 ] = -99999;
+		}
+
+		inline void addToBounds( const float* point, float* bounds ) NOEXCEPT
+		{
+			for( int i = 0; i < 3; ++i )
+			{
+				bounds[ i ] = std::min( bounds[ i ], point[ i ] );
+				bounds[ i + 3 ] = std::max( bounds[ i + 3 ], point[ i ] );
+			}
+		}
+	}
+
+	void g2TraceBuildBounds( const float* verts, const std::int32_t( *triangles )[ 3 ], int numTriangles, float* bounds )
+	{
+		float* chunk = bounds + 6;
+		clearBounds( bounds );
+		for( int first = 0; first < numTriangles; first += G2_TRACE_CHUNK_TRIS, chunk += 6 )
+		{
+			const int last = std::min( first + G2_TRACE_CHUNK_TRIS, numTriangles );
+			clearBounds( chunk );
+			for( int j = first; j < last; ++j )
+			{
+				for( int k = 0; k < 3; ++k )
+				{
+					addToBounds( verts + triangles[ j ][ k ] * G2_TRACE_VERTEX_FLOATS, chunk );
+				}
+			}
+			addToBounds( chunk, bounds );
+			addToBounds( chunk + 3, bounds );
+		}
+	}
+
+	bool g2SegmentTouchesBounds( const float* start, const float* end, const float* bounds )
+	{
+		// separating axis test between the segment and the grown bounds
+		float mid[ 3 ], half[ 3 ], extents[ 3 ];
+		for( int i = 0; i < 3; ++i )
+		{
+			half[ i ] = ( end[ i ] - start[ i ] ) * 0.5f;
+			mid[ i ] = start[ i ] + half[ i ] - ( bounds[ i ] + bounds[ i + 3 ] ) * 0.5f;
+			extents[ i ] = ( bounds[ i + 3 ] - bounds[ i ] ) * 0.5f + BOUNDS_MARGIN;
+			if( std::fabs( mid[ i ] ) > extents[ i ] + std::fabs( half[ i ] ) )
+			{
+				return false;
+			}
+		}
+		return !(
+			std::fabs( mid[ 1 ] * half[ 2 ] - mid[ 2 ] * half[ 1 ] ) > extents[ 1 ] * std::fabs( half[ 2 ] ) + extents[ 2 ] * std::fabs( half[ 1 ] ) ||
+			std::fabs( mid[ 2 ] * half[ 0 ] - mid[ 0 ] * half[ 2 ] ) > extents[ 0 ] * std::fabs( half[ 2 ] ) + extents[ 2 ] * std::fabs( half[ 0 ] ) ||
+			std::fabs( mid[ 0 ] * half[ 1 ] - mid[ 1 ] * half[ 0 ] ) > extents[ 0 ] * std::fabs( half[ 1 ] ) + extents[ 1 ] * std::fabs( half[ 0 ] ) );
+	}
+
+	int g2RadiusTraceOutside( const float* vertex, const float* start, const float* saxis, const float* taxis, const float* rayDir )
+	{
+		float delta[ 3 ];
+		subtract( vertex, start, delta );
+		const float s = dot( delta, saxis ) + 0.5f;
+		const float t = dot( delta, taxis ) + 0.5f;
+		const float u = dot( delta, rayDir );
+		int outside = 0;
+		if( !( s > 0 ) )
+		{
+			outside |= 1;
+		}
+		if( !( s < 1 ) )
+		{
+			outside |= 2;
+		}
+		if( !( t > 0 ) )
+		{
+			outside |= 4;
+		}
+		if( !( t < 1 ) )
+		{
+			outside |= 8;
+		}
+		if( !( u > 0 ) )
+		{
+			outside |= 16;
+		}
+		if( !( u < 1 ) )
+		{
+			outside |= 32;
+		}
+		return outside;
+	}
+
+	bool g2BoundsOutsideRadiusTrace( const float* bounds, const float* start, const float* saxis, const float* taxis, const float* rayDir )
+	{
+		const float* axes[ 3 ] = { saxis, taxis, rayDir };
+		const float offsets[ 3 ] = { 0.5f, 0.5f, 0.0f };
+		float center[ 3 ], extents[ 3 ];
+		for( int i = 0; i < 3; ++i )
+		{
+			center[ i ] = ( bounds[ i ] + bounds[ i + 3 ] ) * 0.5f - start[ i ];
+			extents[ i ] = ( bounds[ i + 3 ] - bounds[ i ] ) * 0.5f;
+		}
+		for( int i = 0; i < 3; ++i )
+		{
+			const float* axis = axes[ i ];
+			const float mid = dot( center, axis ) + offsets[ i ];
+			const float extent = std::fabs( axis[ 0 ] ) * extents[ 0 ] + std::fabs( axis[ 1 ] ) * extents[ 1 ] + std::fabs( axis[ 2 ] ) * extents[ 2 ];
+			if( mid + extent < -RADIUS_MARGIN || mid - extent > 1.0f + RADIUS_MARGIN )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool g2SegmentTriangleTest( const float* start, const float* end, const float* a, const float* b, const float* c,
+		bool backFaces, bool frontFaces, float* hitPoint, float* normal, float* denom )
+	{
+		const float tiny = 1E-10f;
+		float edgeAB[ 3 ], edgeAC[ 3 ];
+		subtract( c, a, edgeAC );
+		subtract( b, a, edgeAB );
+		cross( edgeAB, edgeAC, normal );
+
+		float ray[ 3 ];
+		subtract( end, start, ray );
+		*denom = dot( ray, normal );
+		if( std::fabs( *denom ) < tiny || // triangle parallel to ray
+			( !backFaces && *denom > 0 ) ||
+			( !frontFaces && *denom < 0 ) )
+		{
+			return false;
+		}
+
+		float toPlane[ 3 ];
+		subtract( a, start, toPlane );
+		const float t = dot( toPlane, normal ) / *denom;
+		if( t < 0.0f || t > 1.0f )
+		{
+			return false; // off segment
+		}
+		for( int i = 0; i < 3; ++i )
+		{
+			hitPoint[ i ] = ray[ i ] * t + start[ i ];
+		}
+
+		float edgePA[ 3 ], edgePB[ 3 ], edgePC[ 3 ], temp[ 3 ];
+		subtract( a, hitPoint, edgePA );
+		subtract( b, hitPoint, edgePB );
+		subtract( c, hitPoint, edgePC );
+		cross( edgePA, edgePB, temp );
+		if( dot( temp, normal ) < 0.0f )
+		{
+			return false; // off triangle
+		}
+		cross( edgePC, edgePA, temp );
+		if( dot( temp, normal ) < 0.0f )
+		{
+			return false;
+		}
+		cross( edgePB, edgePC, temp );
+		if( dot( temp, normal ) < 0.0f )
+		{
+			return false;
+		}
+		return true;
+	}
+}
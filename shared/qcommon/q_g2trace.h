@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	Triangle tests and culling for Ghoul2 collision traces against transformed surfaces.
+
+	Transformed vertexes are G2_TRACE_VERTEX_FLOATS floats each, position first, and triangles are three vertex indexes
+	like mdxmTriangle_t. After its vertexes a surface keeps a two level bounding volume hierarchy: the bounds of the whole
+	surface, then the bounds of each run of G2_TRACE_CHUNK_TRIS triangles in index order, mins before maxs.
+	Traces skip the runs they can't touch and still test the remaining triangles in their original order,
+	so the collision records don't change.
+	*/
+	const int G2_TRACE_VERTEX_FLOATS = 5;
+	const int G2_TRACE_CHUNK_TRIS = 16;
+
+	/// Number of floats g2TraceBuildBounds writes for a surface with numTriangles
+	inline int g2TraceBoundsSize( int numTriangles ) NOEXCEPT
+	{
+		return ( 1 + ( numTriangles + G2_TRACE_CHUNK_TRIS - 1 ) / G2_TRACE_CHUNK_TRIS ) * 6;
+	}
+
+	void g2TraceBuildBounds( const float* verts, const std::int32_t( *triangles )[ 3 ], int numTriangles, float* bounds );
+
+	/// false if the segment can't touch bounds; they are grown a little so hits on a face aren't culled by rounding
+	bool g2SegmentTouchesBounds( const float* start, const float* end, const float* bounds );
+
+	/**
+	Where a vertex is relative to the box of a radius trace starting at start, spanned by saxis and taxis and reaching
+	along rayDir, which is divided by its squared length. Bits 1 / 2 are set when it's before / after the box on saxis,
+	4 / 8 on taxis and 16 / 32 on rayDir. A triangle whose vertexes share a bit is off the box.
+	*/
+	int g2RadiusTraceOutside( const float* vertex, const float* start, const float* saxis, const float* taxis, const float* rayDir );
+
+	/// true if every vertex inside bounds would get the same g2RadiusTraceOutside bit, so no triangle inside can be hit
+	bool g2BoundsOutsideRadiusTrace( const float* bounds, const float* start, const float* saxis, const float* taxis, const float* rayDir );
+
+	/**
+	Intersects the segment with triangle abc. Returns the hit point, the unnormalized face normal
+	and in denom the dot product of the segment with it, which Ghoul2 traces record as a front face when positive.
+	Yet backFaces is what accepts a positive denom, and frontFaces a negative one.
+	*/
+	bool g2SegmentTriangleTest( const float* start, const float* end, const float* a, const float* b, const float* c,
+		bool backFaces, bool frontFaces, float* hitPoint, float* normal, float* denom );
+}
@@ -0,0 +1,221 @@
+#include "q_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Q
+{
+	namespace
+	{
+		// more threads than this hardly pay off for the per-frame work we split up
+		const std::size_t MAX_DEFAULT_THREADS = 8;
+
+		struct ParallelJob
+		{
+			const ParallelBatch* func = nullptr;
+			std::size_t count = 0;
+			std::size_t batchSize = 0;
+			std::size_t numBatches = 0;
+			std::atomic< std::size_t > nextIndex{ 0 };
+			std::atomic< std::size_t > finishedBatches{ 0 };
+		};
+
+		class WorkerPool
+		{
+		public:
+			~WorkerPool()
+			{
+				shutdown();
+			}
+
+			std::size_t threadCount() const NOEXCEPT
+			{
+				const std::size_t requestedThreads = _requestedThreads;
+				if( requestedThreads != 0 )
+				{
+					return requestedThreads;
+				}
+				const std::size_t hardwareThreads = std::thread::hardware_concurrency();
+				return std::max< std::size_t >( 1, std::min( hardwareThreads, MAX_DEFAULT_THREADS ) );
+			}
+
+			void setThreadCount( std::size_t count )
+			{
+				std::lock_guard< std::mutex > runLock( _runMutex );
+				stopWorkers();
+				_requestedThreads = count;
+			}
+
+			void shutdown()
+			{
+				std::lock_guard< std::mutex > runLock( _runMutex );
+				stopWorkers();
+			}
+
+			void run( std::size_t count, std::size_t minBatch, const ParallelBatch& func )
+			{
+				if( count == 0 )
+				{
+					return;
+				}
+				minBatch = std::max< std::size_t >( minBatch, 1 );
+
+				// std::mutex must not be locked twice by the same thread, so catch nested calls first
+				std::unique_lock< std::mutex > runLock;
+				if( _runningThread != std::this_thread::get_id() )
+				{
+					runLock = std::unique_lock< std::mutex >( _runMutex, std::try_to_lock );
+				}
+				const std::size_t numThreads = threadCount();
+				if( !runLock || numThreads <= 1 || count <= minBatch )
+				{
+					func( 0, count );
+					return;
+				}
+				_runningThread = std::this_thread::get_id();
+
+				startWorkers( numThreads - 1 );
+
+				// a few batches per thread so uneven batches balance out
+				const std::size_t batchSize = std::max( minBatch, ( count + numThreads * 4 - 1 ) / ( numThreads * 4 ) );
+				auto job = std::make_shared< ParallelJob >();
+				job->func = &func;
+				job->count = count;
+				job->batchSize = batchSize;
+				job->numBatches = ( count + batchSize - 1 ) / batchSize;
+
+				{
+					std::lock_guard< std::mutex > lock( _mutex );
+					_job = job;
+					++_generation;
+				}
+				_wake.notify_all();
+
+				runBatches( *job );
+
+				std::unique_lock< std::mutex > lock( _mutex );
+				_done.wait( lock, [ &job ]{ return job->finishedBatches == job->numBatches; } );
+				_job.reset();
+				_runningThread = std::thread::id();
+			}
+
+		private:
+			void startWorkers( std::size_t numWorkers )
+			{
+				if( !_threads.empty() )
+				{
+					return;
+				}
+				_stop = false;
+				for( std::size_t i = 0; i < numWorkers; ++i )
+				{
+					_threads.emplace_back( [ this ]{ workerMain(); } );
+				}
+			}
+
+			void stopWorkers()
+			{
+				{
+					std::lock_guard< std::mutex > lock( _mutex );
+					_stop = true;
+				}
+				_wake.notify_all();
+				for( auto& thread : _threads )
+				{
+					thread.join();
+				}
+				_threads.clear();
+			}
+
+			void workerMain()
+			{
+				std::unique_lock< std::mutex > lock( _mutex );
+				unsigned int seenGeneration = _generation;
+				while( true )
+				{
+					_wake.wait( lock, [ this, &seenGeneration ]{ return _stop || _generation != seenGeneration; } );
+					if( _stop )
+					{
+						return;
+					}
+					seenGeneration = _generation;
+					std::shared_ptr< ParallelJob > job = _job;
+					if( !job )
+					{
+						continue;
+					}
+					lock.unlock();
+					runBatches( *job );
+					lock.lock();
+				}
+			}
+
+			void runBatches( ParallelJob& job )
+			{
+				std::size_t finished = 0;
+				while( true )
+				{
+					const std::size_t begin = job.nextIndex.fetch_add( job.batchSize );
+					if( begin >= job.count )
+					{
+						break;
+					}
+					( *job.func )( begin, std::min( begin + job.batchSize, job.count ) );
+					++finished;
+				}
+				if( finished != 0 && job.finishedBatches.fetch_add( finished ) + finished == job.numBatches )
+				{
+					std::lock_guard< std::mutex > lock( _mutex );
+					_done.notify_all();
+				}
+			}
+
+		private:
+			// held for the whole of a parallelFor, so there's only one job at a time
+			std::mutex _runMutex;
+			std::atomic< std::thread::id > _runningThread{ std::thread::id() };
+
+			// guards everything below
+			std::mutex _mutex;
+			std::condition_variable _wake;
+			std::condition_variable _done;
+			std::vector< std::thread > _threads;
+			std::shared_ptr< ParallelJob > _job;
+			unsigned int _generation = 0;
+			bool _stop = false;
+
+			std::atomic< std::size_t > _requestedThreads{ 0 };
+		};
+
+		WorkerPool& getPool()
+		{
+			static WorkerPool pool;
+			return pool;
+		}
+	}
+
+	void parallelFor( std::size_t count, std::size_t minBatch, const ParallelBatch& func )
+	{
+		getPool().run( count, minBatch, func );
+	}
+
+	std::size_t parallelThreadCount() NOEXCEPT
+	{
+		return getPool().threadCount();
+	}
+
+	void setParallelThreadCount( std::size_t count )
+	{
+		getPool().setThreadCount( count );
+	}
+
+	void parallelShutdown()
+	{
+		getPool().shutdown();
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/// Callback for one batch of a parallelFor, covering the indices [begin, end)
+	using ParallelBatch = std::function< void( std::size_t begin, std::size_t end ) >;
+
+	/**
+	Splits [0, count) into batches of at least minBatch indices and calls func once per batch,
+	distributed over a lazily started pool of worker threads and the calling thread.
+	Returns once every batch has finished.
+
+	Nested or concurrent calls do not wait for the pool; they run all batches on the calling thread.
+	*/
+	void parallelFor( std::size_t count, std::size_t minBatch, const ParallelBatch& func );
+
+	/// Number of threads parallelFor uses, including the calling thread.
+	std::size_t parallelThreadCount() NOEXCEPT;
+
+	/**
+	Sets the number of threads parallelFor uses, including the calling thread.
+	0 picks a default based on the hardware, 1 disables the worker threads.
+	Stops the current workers; new ones are started on the next parallelFor.
+	*/
+	void setParallelThreadCount( std::size_t count );
+
+	/**
+	Stops and joins the worker threads.
+	Modules which are unloaded at runtime must call this on shutdown since threads can't be joined while unloading.
+	*/
+	void parallelShutdown();
+}
@@ -0,0 +1,520 @@
+#include "q_shadecalc.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_SHADECALC_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Q
+{
+	namespace
+	{
+		/// Q_rsqrt, with its single Newton iteration
+		inline float rsqrtApprox( float number ) NOEXCEPT
+		{
+			const float x2 = number * 0.5F;
+			std::int32_t i;
+			std::memcpy( &i, &number, sizeof( i ) );
+			i = 0x5f3759df - ( i >> 1 );
+			float y;
+			std::memcpy( &y, &i, sizeof( y ) );
+			return y * ( 1.5F - ( x2 * y * y ) );
+		}
+
+		/// R_FogFactor
+		inline float fogFactor( float s, float t, const float* fogTable, int fogTableSize ) NOEXCEPT
+		{
+			s -= 1.0 / 512;
+			if( s < 0 )
+			{
+				return 0;
+			}
+			if( t < 1.0 / 32 )
+			{
+				return 0;
+			}
+			if( t < 31.0 / 32 )
+			{
+				s *= ( t - 1.0f / 32.0f ) / ( 30.0f / 32.0f );
+			}
+
+			// we need to leave a lot of clamp range
+			s *= 8;
+
+			if( s > 1.0 )
+			{
+				s = 1.0;
+			}
+
+			return fogTable[ static_cast< int >( s * ( fogTableSize - 1 ) ) ];
+		}
+
+#ifdef Q_SHADECALC_SSE
+		/// updated with the 4th float of original
+		inline __m128 keepW( __m128 original, __m128 updated ) NOEXCEPT
+		{
+			const __m128 xyzMask = _mm_castsi128_ps( _mm_set_epi32( 0, -1, -1, -1 ) );
+			return _mm_or_ps( _mm_and_ps( xyzMask, updated ), _mm_andnot_ps( xyzMask, original ) );
+		}
+
+		inline __m128 select( __m128 mask, __m128 ifTrue, __m128 ifFalse ) NOEXCEPT
+		{
+			return _mm_or_ps( _mm_and_ps( mask, ifTrue ), _mm_andnot_ps( mask, ifFalse ) );
+		}
+
+		inline __m128 gather( const float* table, __m128i indices ) NOEXCEPT
+		{
+			alignas( 16 ) std::int32_t index[ 4 ];
+			_mm_store_si128( reinterpret_cast< __m128i* >( index ), indices );
+			return _mm_set_ps( table[ index[ 3 ] ], table[ index[ 2 ] ], table[ index[ 1 ] ], table[ index[ 0 ] ] );
+		}
+
+		template< int lane >
+		inline __m128 broadcast( __m128 v ) NOEXCEPT
+		{
+			return _mm_shuffle_ps( v, v, _MM_SHUFFLE( lane, lane, lane, lane ) );
+		}
+
+		/// x, y and z of four padded vectors, one vector per component
+		struct Transposed
+		{
+			__m128 x, y, z;
+
+			explicit Transposed( const float( *v )[ 4 ] ) NOEXCEPT
+			{
+				__m128 v0 = _mm_loadu_ps( v[ 0 ] );
+				__m128 v1 = _mm_loadu_ps( v[ 1 ] );
+				__m128 v2 = _mm_loadu_ps( v[ 2 ] );
+				__m128 v3 = _mm_loadu_ps( v[ 3 ] );
+				_MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+				x = v0;
+				y = v1;
+				z = v2;
+			}
+		};
+
+		/// the s and t of four texture coordinates
+		struct TexCoords
+		{
+			__m128 s, t;
+
+			explicit TexCoords( const float( *st )[ 2 ] ) NOEXCEPT
+			{
+				const __m128 a = _mm_loadu_ps( st[ 0 ] );
+				const __m128 b = _mm_loadu_ps( st[ 2 ] );
+				s = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+				t = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+			}
+
+			void store( float( *st )[ 2 ] ) const NOEXCEPT
+			{
+				_mm_storeu_ps( st[ 0 ], _mm_unpacklo_ps( s, t ) );
+				_mm_storeu_ps( st[ 2 ], _mm_unpackhi_ps( s, t ) );
+			}
+		};
+#endif
+	}
+
+	void deformVertexesReference( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, float scale )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float offset[ 3 ] = { normal[ i ][ 0 ] * scale, normal[ i ][ 1 ] * scale, normal[ i ][ 2 ] * scale };
+			xyz[ i ][ 0 ] += offset[ 0 ];
+			xyz[ i ][ 1 ] += offset[ 1 ];
+			xyz[ i ][ 2 ] += offset[ 2 ];
+		}
+	}
+
+	void deformVertexes( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, float scale )
+	{
+#ifdef Q_SHADECALC_SSE
+		const __m128 scales = _mm_set1_ps( scale );
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const __m128 v = _mm_loadu_ps( xyz[ i ] );
+			_mm_storeu_ps( xyz[ i ], keepW( v, _mm_add_ps( v, _mm_mul_ps( _mm_loadu_ps( normal[ i ] ), scales ) ) ) );
+		}
+#else
+		deformVertexesReference( xyz, normal, numVertexes, scale );
+#endif
+	}
+
+	void deformVertexesWaveReference( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* table, int tableSize, float base, float amplitude, float phase, float now, float spread )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float off = ( xyz[ i ][ 0 ] + xyz[ i ][ 1 ] + xyz[ i ][ 2 ] ) * spread;
+			const float scale = base + table[ static_cast< long >( ( ( phase + off ) + now ) * tableSize ) & ( tableSize - 1 ) ] * amplitude;
+			const float offset[ 3 ] = { normal[ i ][ 0 ] * scale, normal[ i ][ 1 ] * scale, normal[ i ][ 2 ] * scale };
+			xyz[ i ][ 0 ] += offset[ 0 ];
+			xyz[ i ][ 1 ] += offset[ 1 ];
+			xyz[ i ][ 2 ] += offset[ 2 ];
+		}
+	}
+
+	void deformVertexesWave( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* table, int tableSize, float base, float amplitude, float phase, float now, float spread )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 spreads = _mm_set1_ps( spread );
+		const __m128 phases = _mm_set1_ps( phase );
+		const __m128 nows = _mm_set1_ps( now );
+		const __m128 sizes = _mm_set1_ps( static_cast< float >( tableSize ) );
+		const __m128i mask = _mm_set1_epi32( tableSize - 1 );
+		const __m128 bases = _mm_set1_ps( base );
+		const __m128 amplitudes = _mm_set1_ps( amplitude );
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed v( xyz + i );
+			const __m128 off = _mm_mul_ps( _mm_add_ps( _mm_add_ps( v.x, v.y ), v.z ), spreads );
+			const __m128i index = _mm_and_si128( _mm_cvttps_epi32( _mm_mul_ps( _mm_add_ps( _mm_add_ps( phases, off ), nows ), sizes ) ), mask );
+			const __m128 scale = _mm_add_ps( bases, _mm_mul_ps( gather( table, index ), amplitudes ) );
+
+			const __m128 scales[ 4 ] = { broadcast< 0 >( scale ), broadcast< 1 >( scale ), broadcast< 2 >( scale ), broadcast< 3 >( scale ) };
+			for( int k = 0; k < 4; ++k )
+			{
+				const __m128 p = _mm_loadu_ps( xyz[ i + k ] );
+				_mm_storeu_ps( xyz[ i + k ], keepW( p, _mm_add_ps( p, _mm_mul_ps( _mm_loadu_ps( normal[ i + k ] ), scales[ k ] ) ) ) );
+			}
+		}
+#endif
+		deformVertexesWaveReference( xyz + i, normal + i, numVertexes - i, table, tableSize, base, amplitude, phase, now, spread );
+	}
+
+	void fillColorsReference( std::uint32_t* colors, std::size_t numVertexes, std::uint32_t color )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			colors[ i ] = color;
+		}
+	}
+
+	void fillColors( std::uint32_t* colors, std::size_t numVertexes, std::uint32_t color )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128i colors4 = _mm_set1_epi32( static_cast< int >( color ) );
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			_mm_storeu_si128( reinterpret_cast< __m128i* >( colors + i ), colors4 );
+		}
+#endif
+		fillColorsReference( colors + i, numVertexes - i, color );
+	}
+
+	void fogTexCoordsReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* distanceVector, const float* depthVector, float eyeT, bool eyeOutside, float( *st )[ 2 ] )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float* v = xyz[ i ];
+
+			// calculate the length in fog
+			const float s = v[ 0 ] * distanceVector[ 0 ] + v[ 1 ] * distanceVector[ 1 ] + v[ 2 ] * distanceVector[ 2 ] + distanceVector[ 3 ];
+			float t = v[ 0 ] * depthVector[ 0 ] + v[ 1 ] * depthVector[ 1 ] + v[ 2 ] * depthVector[ 2 ] + depthVector[ 3 ];
+
+			// partially clipped fogs use the T axis
+			if( eyeOutside )
+			{
+				if( t < 1.0 )
+				{
+					t = 1.0 / 32;	// point is outside, so no fogging
+				}
+				else
+				{
+					t = 1.0 / 32 + 30.0 / 32 * t / ( t - eyeT );	// cut the distance at the fog plane
+				}
+			}
+			else
+			{
+				if( t < 0 )
+				{
+					t = 1.0 / 32;	// point is outside, so no fogging
+				}
+				else
+				{
+					t = 31.0 / 32;
+				}
+			}
+
+			st[ i ][ 0 ] = std::isnan( s ) ? 0.0f : s;
+			st[ i ][ 1 ] = std::isnan( s ) ? 0.0f : t;
+		}
+	}
+
+	void fogTexCoords( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* distanceVector, const float* depthVector, float eyeT, bool eyeOutside, float( *st )[ 2 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 distance[ 4 ] = { _mm_set1_ps( distanceVector[ 0 ] ), _mm_set1_ps( distanceVector[ 1 ] ), _mm_set1_ps( distanceVector[ 2 ] ), _mm_set1_ps( distanceVector[ 3 ] ) };
+		const __m128 depth[ 4 ] = { _mm_set1_ps( depthVector[ 0 ] ), _mm_set1_ps( depthVector[ 1 ] ), _mm_set1_ps( depthVector[ 2 ] ), _mm_set1_ps( depthVector[ 3 ] ) };
+		const __m128 eyeTs = _mm_set1_ps( eyeT );
+		const __m128 outsideT = _mm_set1_ps( 1.0f / 32 );
+		const __m128 insideT = _mm_set1_ps( 31.0f / 32 );
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed v( xyz + i );
+			TexCoords out( st + i );
+			out.s = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( v.x, distance[ 0 ] ), _mm_mul_ps( v.y, distance[ 1 ] ) ), _mm_mul_ps( v.z, distance[ 2 ] ) ), distance[ 3 ] );
+			const __m128 t = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( v.x, depth[ 0 ] ), _mm_mul_ps( v.y, depth[ 1 ] ) ), _mm_mul_ps( v.z, depth[ 2 ] ) ), depth[ 3 ] );
+
+			if( eyeOutside )
+			{
+				// the cut is worked out in double precision, two at a time
+				const __m128 below = _mm_sub_ps( t, eyeTs );
+				const __m128d cutScale = _mm_set1_pd( 30.0 / 32 );
+				const __m128d cutBase = _mm_set1_pd( 1.0 / 32 );
+				const __m128d cutLow = _mm_add_pd( cutBase, _mm_div_pd( _mm_mul_pd( cutScale, _mm_cvtps_pd( t ) ), _mm_cvtps_pd( below ) ) );
+				const __m128d cutHigh = _mm_add_pd( cutBase, _mm_div_pd( _mm_mul_pd( cutScale, _mm_cvtps_pd( _mm_movehl_ps( t, t ) ) ), _mm_cvtps_pd( _mm_movehl_ps( below, below ) ) ) );
+				const __m128 cut = _mm_movelh_ps( _mm_cvtpd_ps( cutLow ), _mm_cvtpd_ps( cutHigh ) );
+				out.t = select( _mm_cmplt_ps( t, _mm_set1_ps( 1.0f ) ), outsideT, cut );
+			}
+			else
+			{
+				out.t = select( _mm_cmplt_ps( t, _mm_setzero_ps() ), outsideT, insideT );
+			}
+
+			const __m128 valid = _mm_cmpord_ps( out.s, out.s );
+			out.s = _mm_and_ps( out.s, valid );
+			out.t = _mm_and_ps( out.t, valid );
+			out.store( st + i );
+		}
+#endif
+		fogTexCoordsReference( xyz + i, numVertexes - i, distanceVector, depthVector, eyeT, eyeOutside, st + i );
+	}
+
+	void fogModulateColorsReference( const float( *st )[ 2 ], std::size_t numVertexes, const float* fogTable, int fogTableSize, int channels, std::uint8_t( *colors )[ 4 ] )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float f = 1.0 - fogFactor( st[ i ][ 0 ], st[ i ][ 1 ], fogTable, fogTableSize );
+			for( int k = 0; k < 4; ++k )
+			{
+				if( channels & ( 1 << k ) )
+				{
+					colors[ i ][ k ] *= f;
+				}
+			}
+		}
+	}
+
+	void fogModulateColors( const float( *st )[ 2 ], std::size_t numVertexes, const float* fogTable, int fogTableSize, int channels, std::uint8_t( *colors )[ 4 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 one = _mm_set1_ps( 1.0f );
+		const __m128 sBias = _mm_set1_ps( 1.0f / 512 );
+		const __m128 tMin = _mm_set1_ps( 1.0f / 32 );
+		const __m128 tMax = _mm_set1_ps( 31.0f / 32 );
+		const __m128 tRange = _mm_set1_ps( 30.0f / 32.0f );
+		const __m128 clampRange = _mm_set1_ps( 8.0f );
+		const __m128 tableScale = _mm_set1_ps( static_cast< float >( fogTableSize - 1 ) );
+		const __m128i channelMask = _mm_set_epi32( ( channels & 8 ) ? -1 : 0, ( channels & 4 ) ? -1 : 0, ( channels & 2 ) ? -1 : 0, ( channels & 1 ) ? -1 : 0 );
+		const __m128i zero = _mm_setzero_si128();
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const TexCoords in( st + i );
+			__m128 s = _mm_sub_ps( in.s, sBias );
+			const __m128 clear = _mm_or_ps( _mm_cmplt_ps( s, _mm_setzero_ps() ), _mm_cmplt_ps( in.t, tMin ) );
+			s = select( _mm_cmplt_ps( in.t, tMax ), _mm_mul_ps( s, _mm_div_ps( _mm_sub_ps( in.t, tMin ), tRange ) ), s );
+			s = _mm_min_ps( _mm_mul_ps( s, clampRange ), one );
+			const __m128i index = _mm_andnot_si128( _mm_castps_si128( clear ), _mm_cvttps_epi32( _mm_mul_ps( s, tableScale ) ) );
+			const __m128 f = select( clear, one, _mm_sub_ps( one, gather( fogTable, index ) ) );
+
+			const __m128i packed = _mm_loadu_si128( reinterpret_cast< const __m128i* >( colors + i ) );
+			const __m128i low = _mm_unpacklo_epi8( packed, zero );
+			const __m128i high = _mm_unpackhi_epi8( packed, zero );
+			__m128i c[ 4 ] = { _mm_unpacklo_epi16( low, zero ), _mm_unpackhi_epi16( low, zero ), _mm_unpacklo_epi16( high, zero ), _mm_unpackhi_epi16( high, zero ) };
+			const __m128 fs[ 4 ] = { broadcast< 0 >( f ), broadcast< 1 >( f ), broadcast< 2 >( f ), broadcast< 3 >( f ) };
+			for( int k = 0; k < 4; ++k )
+			{
+				const __m128i scaled = _mm_cvttps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( c[ k ] ), fs[ k ] ) );
+				c[ k ] = _mm_or_si128( _mm_and_si128( channelMask, scaled ), _mm_andnot_si128( channelMask, c[ k ] ) );
+			}
+			_mm_storeu_si128( reinterpret_cast< __m128i* >( colors + i ), _mm_packus_epi16( _mm_packs_epi32( c[ 0 ], c[ 1 ] ), _mm_packs_epi32( c[ 2 ], c[ 3 ] ) ) );
+		}
+#endif
+		fogModulateColorsReference( st + i, numVertexes - i, fogTable, fogTableSize, channels, colors + i );
+	}
+
+	void environmentTexCoordsReference( const float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* viewOrigin, float( *st )[ 2 ] )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float* v = xyz[ i ];
+			const float* n = normal[ i ];
+			float viewer[ 3 ] = { viewOrigin[ 0 ] - v[ 0 ], viewOrigin[ 1 ] - v[ 1 ], viewOrigin[ 2 ] - v[ 2 ] };
+			const float ilength = rsqrtApprox( viewer[ 0 ] * viewer[ 0 ] + viewer[ 1 ] * viewer[ 1 ] + viewer[ 2 ] * viewer[ 2 ] );
+			viewer[ 0 ] *= ilength;
+			viewer[ 1 ] *= ilength;
+			viewer[ 2 ] *= ilength;
+
+			const float d = n[ 0 ] * viewer[ 0 ] + n[ 1 ] * viewer[ 1 ] + n[ 2 ] * viewer[ 2 ];
+			st[ i ][ 0 ] = n[ 0 ] * d - 0.5 * viewer[ 0 ];
+			st[ i ][ 1 ] = n[ 1 ] * d - 0.5 * viewer[ 1 ];
+		}
+	}
+
+	void environmentTexCoords( const float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* viewOrigin, float( *st )[ 2 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 origin[ 3 ] = { _mm_set1_ps( viewOrigin[ 0 ] ), _mm_set1_ps( viewOrigin[ 1 ] ), _mm_set1_ps( viewOrigin[ 2 ] ) };
+		const __m128 half = _mm_set1_ps( 0.5f );
+		const __m128 threeHalfs = _mm_set1_ps( 1.5f );
+		const __m128i magic = _mm_set1_epi32( 0x5f3759df );
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed v( xyz + i );
+			const Transposed n( normal + i );
+			__m128 vx = _mm_sub_ps( origin[ 0 ], v.x );
+			__m128 vy = _mm_sub_ps( origin[ 1 ], v.y );
+			__m128 vz = _mm_sub_ps( origin[ 2 ], v.z );
+
+			const __m128 lengthSquared = _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ), _mm_mul_ps( vz, vz ) );
+			const __m128 x2 = _mm_mul_ps( lengthSquared, half );
+			__m128 y = _mm_castsi128_ps( _mm_sub_epi32( magic, _mm_srai_epi32( _mm_castps_si128( lengthSquared ), 1 ) ) );
+			y = _mm_mul_ps( y, _mm_sub_ps( threeHalfs, _mm_mul_ps( _mm_mul_ps( x2, y ), y ) ) );
+			vx = _mm_mul_ps( vx, y );
+			vy = _mm_mul_ps( vy, y );
+			vz = _mm_mul_ps( vz, y );
+
+			const __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( n.x, vx ), _mm_mul_ps( n.y, vy ) ), _mm_mul_ps( n.z, vz ) );
+			TexCoords out( st + i );
+			out.s = _mm_sub_ps( _mm_mul_ps( n.x, d ), _mm_mul_ps( half, vx ) );
+			out.t = _mm_sub_ps( _mm_mul_ps( n.y, d ), _mm_mul_ps( half, vy ) );
+			out.store( st + i );
+		}
+#endif
+		environmentTexCoordsReference( xyz + i, normal + i, numVertexes - i, viewOrigin, st + i );
+	}
+
+	void environmentTexCoordsFromLightReference( const float( *normal )[ 4 ], std::size_t numVertexes, const float* lightDir, float( *st )[ 2 ] )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float* n = normal[ i ];
+			const float d = n[ 0 ] * lightDir[ 0 ] + n[ 1 ] * lightDir[ 1 ] + n[ 2 ] * lightDir[ 2 ];
+			st[ i ][ 0 ] = n[ 0 ] * d - lightDir[ 0 ];
+			st[ i ][ 1 ] = n[ 1 ] * d - lightDir[ 1 ];
+		}
+	}
+
+	void environmentTexCoordsFromLight( const float( *normal )[ 4 ], std::size_t numVertexes, const float* lightDir, float( *st )[ 2 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 light[ 3 ] = { _mm_set1_ps( lightDir[ 0 ] ), _mm_set1_ps( lightDir[ 1 ] ), _mm_set1_ps( lightDir[ 2 ] ) };
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed n( normal + i );
+			const __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( n.x, light[ 0 ] ), _mm_mul_ps( n.y, light[ 1 ] ) ), _mm_mul_ps( n.z, light[ 2 ] ) );
+			TexCoords out( st + i );
+			out.s = _mm_sub_ps( _mm_mul_ps( n.x, d ), light[ 0 ] );
+			out.t = _mm_sub_ps( _mm_mul_ps( n.y, d ), light[ 1 ] );
+			out.store( st + i );
+		}
+#endif
+		environmentTexCoordsFromLightReference( normal + i, numVertexes - i, lightDir, st + i );
+	}
+
+	void turbulentTexCoordsReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* sinTable, int tableSize, float now, float amplitude, float( *st )[ 2 ] )
+	{
+		const int mask = tableSize - 1;
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float s = st[ i ][ 0 ];
+			const float t = st[ i ][ 1 ];
+
+			st[ i ][ 0 ] = s + sinTable[ static_cast< int >( ( ( xyz[ i ][ 0 ] + xyz[ i ][ 2 ] ) * 1.0 / 128 * 0.125 + now ) * tableSize ) & mask ] * amplitude;
+			st[ i ][ 1 ] = t + sinTable[ static_cast< int >( ( xyz[ i ][ 1 ] * 1.0 / 128 * 0.125 + now ) * tableSize ) & mask ] * amplitude;
+		}
+	}
+
+	void turbulentTexCoords( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* sinTable, int tableSize, float now, float amplitude, float( *st )[ 2 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		// the table argument is worked out in double precision, scaling by a power of two is exact either way
+		const __m128d frequency = _mm_set1_pd( 1.0 / 1024 );
+		const __m128d nows = _mm_set1_pd( now );
+		const __m128d sizes = _mm_set1_pd( tableSize );
+		const __m128i mask = _mm_set1_epi32( tableSize - 1 );
+		const __m128 amplitudes = _mm_set1_ps( amplitude );
+		const auto tableIndex = [ & ]( __m128 position )
+		{
+			const __m128d low = _mm_mul_pd( _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd( position ), frequency ), nows ), sizes );
+			const __m128d high = _mm_mul_pd( _mm_add_pd( _mm_mul_pd( _mm_cvtps_pd( _mm_movehl_ps( position, position ) ), frequency ), nows ), sizes );
+			return _mm_and_si128( _mm_unpacklo_epi64( _mm_cvttpd_epi32( low ), _mm_cvttpd_epi32( high ) ), mask );
+		};
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed v( xyz + i );
+			TexCoords out( st + i );
+			out.s = _mm_add_ps( out.s, _mm_mul_ps( gather( sinTable, tableIndex( _mm_add_ps( v.x, v.z ) ) ), amplitudes ) );
+			out.t = _mm_add_ps( out.t, _mm_mul_ps( gather( sinTable, tableIndex( v.y ) ), amplitudes ) );
+			out.store( st + i );
+		}
+#endif
+		turbulentTexCoordsReference( xyz + i, numVertexes - i, sinTable, tableSize, now, amplitude, st + i );
+	}
+
+	void diffuseColorsReference( const float( *normal )[ 4 ], std::size_t numVertexes, const float* ambient, std::uint32_t ambientPacked, const float* directed, const float* lightDir, std::uint8_t( *colors )[ 4 ] )
+	{
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			const float* n = normal[ i ];
+			const float incoming = n[ 0 ] * lightDir[ 0 ] + n[ 1 ] * lightDir[ 1 ] + n[ 2 ] * lightDir[ 2 ];
+			if( incoming <= 0 )
+			{
+				std::memcpy( colors[ i ], &ambientPacked, sizeof( ambientPacked ) );
+				continue;
+			}
+			for( int k = 0; k < 3; ++k )
+			{
+				long j = static_cast< long >( ambient[ k ] + incoming * directed[ k ] );
+				if( j > 255 )
+				{
+					j = 255;
+				}
+				colors[ i ][ k ] = static_cast< std::uint8_t >( j );
+			}
+			colors[ i ][ 3 ] = 255;
+		}
+	}
+
+	void diffuseColors( const float( *normal )[ 4 ], std::size_t numVertexes, const float* ambient, std::uint32_t ambientPacked, const float* directed, const float* lightDir, std::uint8_t( *colors )[ 4 ] )
+	{
+		std::size_t i = 0;
+#ifdef Q_SHADECALC_SSE
+		const __m128 light[ 3 ] = { _mm_set1_ps( lightDir[ 0 ] ), _mm_set1_ps( lightDir[ 1 ] ), _mm_set1_ps( lightDir[ 2 ] ) };
+		const __m128 ambients[ 3 ] = { _mm_set1_ps( ambient[ 0 ] ), _mm_set1_ps( ambient[ 1 ] ), _mm_set1_ps( ambient[ 2 ] ) };
+		const __m128 directeds[ 3 ] = { _mm_set1_ps( directed[ 0 ] ), _mm_set1_ps( directed[ 1 ] ), _mm_set1_ps( directed[ 2 ] ) };
+		// clamping the float first gives the same byte as clamping the truncated int
+		const __m128 maxColor = _mm_set1_ps( 255.0f );
+		const __m128i byteMask = _mm_set1_epi32( 0xff );
+		const __m128i alpha = _mm_set1_epi32( static_cast< int >( 0xff000000u ) );
+		std::uint8_t ambientBytes[ 4 ];
+		std::memcpy( ambientBytes, &ambientPacked, sizeof( ambientPacked ) );
+		const __m128i ambients4 = _mm_set1_epi32( static_cast< int >( ambientBytes[ 0 ] | ( ambientBytes[ 1 ] << 8 ) | ( ambientBytes[ 2 ] << 16 ) | ( static_cast< std::uint32_t >( ambientBytes[ 3 ] ) << 24 ) ) );
+		for( ; i + 4 <= numVertexes; i += 4 )
+		{
+			const Transposed n( normal + i );
+			const __m128 incoming = _mm_add_ps( _mm_add_ps( _mm_mul_ps( n.x, light[ 0 ] ), _mm_mul_ps( n.y, light[ 1 ] ) ), _mm_mul_ps( n.z, light[ 2 ] ) );
+			__m128i lit = alpha;
+			for( int k = 0; k < 3; ++k )
+			{
+				const __m128 value = _mm_min_ps( _mm_add_ps( ambients[ k ], _mm_mul_ps( incoming, directeds[ k ] ) ), maxColor );
+				const __m128i channel = _mm_and_si128( _mm_cvttps_epi32( value ), byteMask );
+				lit = _mm_or_si128( lit, _mm_slli_epi32( channel, 8 * k ) );
+			}
+			const __m128i facing = _mm_castps_si128( _mm_cmpgt_ps( incoming, _mm_setzero_ps() ) );
+			_mm_storeu_si128( reinterpret_cast< __m128i* >( colors + i ), _mm_or_si128( _mm_and_si128( facing, lit ), _mm_andnot_si128( facing, ambients4 ) ) );
+		}
+#endif
+		diffuseColorsReference( normal + i, numVertexes - i, ambient, ambientPacked, directed, lightDir, colors + i );
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	The per vertex loops of tr_shade_calc.cpp: deformVertexes, fog, environment mapping,
+	turbulent texture coordinates and lightingDiffuse, working on the renderer's tess layout:
+	positions and normals padded to 4 floats, 2 floats per texture coordinate and 4 bytes per color.
+
+	The parts the renderer computes in double precision are still computed in double,
+	so the SSE versions give the same bits as the Reference ones as long as wave table arguments fit in an int.
+	Wave and sine tables have tableSize entries, which must be a power of two; indexes wrap around the table.
+
+	There is no AVX2 version: built with -mavx2 neither these nor the compiler vectorized Reference loops got any faster
+	in the shadecalc benchmark, the time going to table lookups and the double precision parts rather than vector width.
+	*/
+
+	/// Moves every vertex along its normal by scale. The 4th float of each position is left alone.
+	void deformVertexes( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, float scale );
+	void deformVertexesReference( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, float scale );
+
+	/**
+	Moves every vertex along its normal by base + table[ ( phase + ( x + y + z ) * spread + now ) * tableSize ] * amplitude,
+	where now is the time multiplied by the wave's frequency.
+	*/
+	void deformVertexesWave( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* table, int tableSize, float base, float amplitude, float phase, float now, float spread );
+	void deformVertexesWaveReference( float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* table, int tableSize, float base, float amplitude, float phase, float now, float spread );
+
+	/// Sets every color to the same packed rgba value
+	void fillColors( std::uint32_t* colors, std::size_t numVertexes, std::uint32_t color );
+	void fillColorsReference( std::uint32_t* colors, std::size_t numVertexes, std::uint32_t color );
+
+	/**
+	Fog texture coordinates: s is the distance into the fog, t how deep below the fog surface the vertex is,
+	cut at the surface when the eye is outside the fog.
+	distanceVector and depthVector are planes, { normal, dist } with the dist added.
+	*/
+	void fogTexCoords( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* distanceVector, const float* depthVector, float eyeT, bool eyeOutside, float( *st )[ 2 ] );
+	void fogTexCoordsReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* distanceVector, const float* depthVector, float eyeT, bool eyeOutside, float( *st )[ 2 ] );
+
+	/**
+	Scales colors by how much of them shows through the fog at the given fog texture coordinates,
+	looked up in fogTable like R_FogFactor does. Bit k of channels picks color byte k.
+	*/
+	void fogModulateColors( const float( *st )[ 2 ], std::size_t numVertexes, const float* fogTable, int fogTableSize, int channels, std::uint8_t( *colors )[ 4 ] );
+	void fogModulateColorsReference( const float( *st )[ 2 ], std::size_t numVertexes, const float* fogTable, int fogTableSize, int channels, std::uint8_t( *colors )[ 4 ] );
+
+	/// Reflects the direction to viewOrigin, normalized with Q_rsqrt's approximation, about each normal
+	void environmentTexCoords( const float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* viewOrigin, float( *st )[ 2 ] );
+	void environmentTexCoordsReference( const float( *xyz )[ 4 ], const float( *normal )[ 4 ], std::size_t numVertexes, const float* viewOrigin, float( *st )[ 2 ] );
+
+	/// Reflects a fixed light direction about each normal, for view models
+	void environmentTexCoordsFromLight( const float( *normal )[ 4 ], std::size_t numVertexes, const float* lightDir, float( *st )[ 2 ] );
+	void environmentTexCoordsFromLightReference( const float( *normal )[ 4 ], std::size_t numVertexes, const float* lightDir, float( *st )[ 2 ] );
+
+	/// Wobbles texture coordinates by the sine table, s by x + z and t by y. now is phase + time * frequency.
+	void turbulentTexCoords( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* sinTable, int tableSize, float now, float amplitude, float( *st )[ 2 ] );
+	void turbulentTexCoordsReference( const float( *xyz )[ 4 ], std::size_t numVertexes, const float* sinTable, int tableSize, float now, float amplitude, float( *st )[ 2 ] );
+
+	/**
+	Lambert vertex lighting: ambient plus directed scaled by how much the normal faces lightDir, clamped to 255.
+	Vertexes facing away get ambientPacked as is.
+	*/
+	void diffuseColors( const float( *normal )[ 4 ], std::size_t numVertexes, const float* ambient, std::uint32_t ambientPacked, const float* directed, const float* lightDir, std::uint8_t( *colors )[ 4 ] );
+	void diffuseColorsReference( const float( *normal )[ 4 ], std::size_t numVertexes, const float* ambient, std::uint32_t ambientPacked, const float* directed, const float* lightDir, std::uint8_t( *colors )[ 4 ] );
+}
@@ -0,0 +1,170 @@
+#include "q_shadowvolume.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_SHADOWVOLUME_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Q
+{
+	namespace
+	{
+		template< typename Index >
+		bool edgeMasks( const Index* indices, std::size_t numTriangles, std::uint32_t firstVertex, std::size_t numVertices, int maxEdgesPerVertex, int* edgeCounts, std::uint8_t* masks )
+		{
+			std::memset( edgeCounts, 0, numVertices * sizeof( *edgeCounts ) );
+			bool dropped = false;
+			for( std::size_t t = 0; t < numTriangles; ++t )
+			{
+				std::uint8_t mask = 0;
+				for( int k = 0; k < 3; ++k )
+				{
+					int& count = edgeCounts[ static_cast< std::uint32_t >( indices[ t * 3 + k ] ) - firstVertex ];
+					if( count < maxEdgesPerVertex )
+					{
+						++count;
+						mask |= 1 << k;
+					}
+					else
+					{
+						dropped = true;
+					}
+				}
+				masks[ t ] = mask;
+			}
+			return dropped;
+		}
+
+		inline std::uint8_t facingOne( const float( *xyz )[ 4 ], const std::uint32_t* triangle, const float* lightDir ) NOEXCEPT
+		{
+			const float* v1 = xyz[ triangle[ 0 ] ];
+			const float* v2 = xyz[ triangle[ 1 ] ];
+			const float* v3 = xyz[ triangle[ 2 ] ];
+			const float d1[ 3 ] = { v2[ 0 ] - v1[ 0 ], v2[ 1 ] - v1[ 1 ], v2[ 2 ] - v1[ 2 ] };
+			const float d2[ 3 ] = { v3[ 0 ] - v1[ 0 ], v3[ 1 ] - v1[ 1 ], v3[ 2 ] - v1[ 2 ] };
+			const float normal[ 3 ] = {
+				d1[ 1 ] * d2[ 2 ] - d1[ 2 ] * d2[ 1 ],
+				d1[ 2 ] * d2[ 0 ] - d1[ 0 ] * d2[ 2 ],
+				d1[ 0 ] * d2[ 1 ] - d1[ 1 ] * d2[ 0 ]
+			};
+			const float d = normal[ 0 ] * lightDir[ 0 ] + normal[ 1 ] * lightDir[ 1 ] + normal[ 2 ] * lightDir[ 2 ];
+			return d > 0 ? 1 : 0;
+		}
+	}
+
+	bool shadowEdgeMasks( const std::int32_t* indices, std::size_t numTriangles, std::uint32_t firstVertex, std::size_t numVertices, int maxEdgesPerVertex, int* edgeCounts, std::uint8_t* masks )
+	{
+		return edgeMasks( indices, numTriangles, firstVertex, numVertices, maxEdgesPerVertex, edgeCounts, masks );
+	}
+
+	bool shadowEdgeMasks( const std::uint32_t* indices, std::size_t numTriangles, std::uint32_t firstVertex, std::size_t numVertices, int maxEdgesPerVertex, int* edgeCounts, std::uint8_t* masks )
+	{
+		return edgeMasks( indices, numTriangles, firstVertex, numVertices, maxEdgesPerVertex, edgeCounts, masks );
+	}
+
+	void shadowFacingReference( const float( *xyz )[ 4 ], const std::uint32_t* indices, std::size_t numTriangles, const float* lightDir, std::uint8_t* facing )
+	{
+		for( std::size_t t = 0; t < numTriangles; ++t )
+		{
+			facing[ t ] = facingOne( xyz, indices + t * 3, lightDir );
+		}
+	}
+
+#ifdef Q_SHADOWVOLUME_SSE
+	void shadowFacing( const float( *xyz )[ 4 ], const std::uint32_t* indices, std::size_t numTriangles, const float* lightDir, std::uint8_t* facing )
+	{
+		const __m128 lightX = _mm_set1_ps( lightDir[ 0 ] );
+		const __m128 lightY = _mm_set1_ps( lightDir[ 1 ] );
+		const __m128 lightZ = _mm_set1_ps( lightDir[ 2 ] );
+		const __m128 zero = _mm_setzero_ps();
+
+		// four triangles at a time, with their corners transposed so every lane is one triangle
+		std::size_t t = 0;
+		for( ; t + 4 <= numTriangles; t += 4 )
+		{
+			const std::uint32_t* tri = indices + t * 3;
+			__m128 corner[ 3 ][ 3 ];
+			for( int c = 0; c < 3; ++c )
+			{
+				__m128 a = _mm_loadu_ps( xyz[ tri[ c ] ] );
+				__m128 b = _mm_loadu_ps( xyz[ tri[ 3 + c ] ] );
+				__m128 d = _mm_loadu_ps( xyz[ tri[ 6 + c ] ] );
+				__m128 e = _mm_loadu_ps( xyz[ tri[ 9 + c ] ] );
+				_MM_TRANSPOSE4_PS( a, b, d, e );
+				corner[ c ][ 0 ] = a;
+				corner[ c ][ 1 ] = b;
+				corner[ c ][ 2 ] = d;
+			}
+
+			const __m128 d1x = _mm_sub_ps( corner[ 1 ][ 0 ], corner[ 0 ][ 0 ] );
+			const __m128 d1y = _mm_sub_ps( corner[ 1 ][ 1 ], corner[ 0 ][ 1 ] );
+			const __m128 d1z = _mm_sub_ps( corner[ 1 ][ 2 ], corner[ 0 ][ 2 ] );
+			const __m128 d2x = _mm_sub_ps( corner[ 2 ][ 0 ], corner[ 0 ][ 0 ] );
+			const __m128 d2y = _mm_sub_ps( corner[ 2 ][ 1 ], corner[ 0 ][ 1 ] );
+			const __m128 d2z = _mm_sub_ps( corner[ 2 ][ 2 ], corner[ 0 ][ 2 ] );
+
+			const __m128 nx = _mm_sub_ps( _mm_mul_ps( d1y, d2z ), _mm_mul_ps( d1z, d2y ) );
+			const __m128 ny = _mm_sub_ps( _mm_mul_ps( d1z, d2x ), _mm_mul_ps( d1x, d2z ) );
+			const __m128 nz = _mm_sub_ps( _mm_mul_ps( d1x, d2y ), _mm_mul_ps( d1y, d2x ) );
+
+			const __m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, lightX ), _mm_mul_ps( ny, lightY ) ), _mm_mul_ps( nz, lightZ ) );
+			const int bits = _mm_movemask_ps( _mm_cmpgt_ps( d, zero ) );
+			facing[ t ] = bits & 1;
+			facing[ t + 1 ] = ( bits >> 1 ) & 1;
+			facing[ t + 2 ] = ( bits >> 2 ) & 1;
+			facing[ t + 3 ] = ( bits >> 3 ) & 1;
+		}
+		for( ; t < numTriangles; ++t )
+		{
+			facing[ t ] = facingOne( xyz, indices + t * 3, lightDir );
+		}
+	}
+#else
+	void shadowFacing( const float( *xyz )[ 4 ], const std::uint32_t* indices, std::size_t numTriangles, const float* lightDir, std::uint8_t* facing )
+	{
+		shadowFacingReference( xyz, indices, numTriangles, lightDir, facing );
+	}
+#endif
+
+	std::size_t shadowVolumeIndices( const std::uint32_t* indices, std::size_t numTriangles, const std::uint8_t* facing, const std::uint8_t* edgeMasks, std::uint32_t extrudedOffset, std::uint32_t* out )
+	{
+		std::uint32_t* const start = out;
+		for( std::size_t t = 0; t < numTriangles; ++t )
+		{
+			if( !facing[ t ] )
+			{
+				continue;
+			}
+			const std::uint32_t* tri = indices + t * 3;
+			const std::uint8_t mask = edgeMasks[ t ];
+			for( int k = 0; k < 3; ++k )
+			{
+				if( !( mask & ( 1 << k ) ) )
+				{
+					continue;
+				}
+				// the two triangles of the strip a, a', b, b'
+				const std::uint32_t a = tri[ k ];
+				const std::uint32_t b = tri[ k == 2 ? 0 : k + 1 ];
+				out[ 0 ] = a;
+				out[ 1 ] = a + extrudedOffset;
+				out[ 2 ] = b;
+				out[ 3 ] = b;
+				out[ 4 ] = a + extrudedOffset;
+				out[ 5 ] = b + extrudedOffset;
+				out += 6;
+			}
+
+			out[ 0 ] = tri[ 0 ];
+			out[ 1 ] = tri[ 1 ];
+			out[ 2 ] = tri[ 2 ];
+			out[ 3 ] = tri[ 2 ] + extrudedOffset;
+			out[ 4 ] = tri[ 1 ] + extrudedOffset;
+			out[ 5 ] = tri[ 0 ] + extrudedOffset;
+			out += 6;
+		}
+		return static_cast< std::size_t >( out - start );
+	}
+}
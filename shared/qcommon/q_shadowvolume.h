@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	Stencil shadow volume kernels, working on the renderer's tess layout:
+	positions padded to 4 floats and 3 indices per triangle.
+
+	Every edge of a triangle that faces the light is extruded, not just the silhouette,
+	since models with edges shared by more than two triangles leak otherwise.
+	*/
+
+	/// bit k of a triangle's edge mask stands for the edge from its vertex k to vertex ( k + 1 ) % 3
+	const std::uint8_t SHADOW_EDGES_ALL = 7;
+
+	/**
+	Works out which triangle edges the shadow volume uses. Every vertex keeps at most maxEdgesPerVertex of the edges
+	starting at it, in triangle order, and drops the rest, like the renderer's per vertex edge lists always have.
+
+	Indices are relative to firstVertex and must be below firstVertex + numVertices.
+	edgeCounts is scratch space for numVertices ints.
+	Writes one mask per triangle and returns false if every edge is kept.
+	*/
+	bool shadowEdgeMasks( const std::int32_t* indices, std::size_t numTriangles, std::uint32_t firstVertex, std::size_t numVertices, int maxEdgesPerVertex, int* edgeCounts, std::uint8_t* masks );
+	bool shadowEdgeMasks( const std::uint32_t* indices, std::size_t numTriangles, std::uint32_t firstVertex, std::size_t numVertices, int maxEdgesPerVertex, int* edgeCounts, std::uint8_t* masks );
+
+	/**
+	Sets facing[ t ] to 1 if triangle t's normal, ( v2 - v1 ) x ( v3 - v1 ), points along lightDir and to 0 otherwise.
+	Degenerate triangles and ones seen edge on from the light are never facing.
+
+	The SSE version tests four triangles at a time with the same operations in the same order, so it matches shadowFacingReference.
+	*/
+	void shadowFacing( const float( *xyz )[ 4 ], const std::uint32_t* indices, std::size_t numTriangles, const float* lightDir, std::uint8_t* facing );
+
+	/// The scalar version of shadowFacing, as the renderer used to do it
+	void shadowFacingReference( const float( *xyz )[ 4 ], const std::uint32_t* indices, std::size_t numTriangles, const float* lightDir, std::uint8_t* facing );
+
+	/**
+	Writes the triangles of the shadow volume of every light facing triangle:
+	a quad for each edge in its mask, plus the triangle itself and the reversed, extruded cap.
+	The extruded copy of vertex i is vertex i + extrudedOffset.
+
+	out needs room for 24 indices per triangle. Returns the number written.
+	*/
+	std::size_t shadowVolumeIndices( const std::uint32_t* indices, std::size_t numTriangles, const std::uint8_t* facing, const std::uint8_t* edgeMasks, std::uint32_t extrudedOffset, std::uint32_t* out );
+}
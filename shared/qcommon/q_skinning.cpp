@@ -0,0 +1,176 @@
+#include "q_skinning.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_SKINNING_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Q
+{
+	namespace
+	{
+		const int BITS_PER_BONE_INDEX = 5;
+		const int WEIGHT_TOP_BITS_SHIFT = BITS_PER_BONE_INDEX * 4 - 8;
+		const std::uint32_t WEIGHT_TOP_BITS_MASK = 0x300;
+		const float WEIGHT_SCALE = 1.0f / 1023.0f;
+
+		inline int numWeights( const SkinVertex& vertex ) NOEXCEPT
+		{
+			return static_cast< int >( vertex.weightsAndBoneIndices >> 30 ) + 1;
+		}
+
+		inline int boneIndex( const SkinVertex& vertex, int weight ) NOEXCEPT
+		{
+			return ( vertex.weightsAndBoneIndices >> ( BITS_PER_BONE_INDEX * weight ) ) & ( ( 1 << BITS_PER_BONE_INDEX ) - 1 );
+		}
+
+		inline float boneWeight( const SkinVertex& vertex, int weight ) NOEXCEPT
+		{
+			const std::uint32_t topBits = ( vertex.weightsAndBoneIndices >> ( WEIGHT_TOP_BITS_SHIFT + weight * 2 ) ) & WEIGHT_TOP_BITS_MASK;
+			return WEIGHT_SCALE * static_cast< float >( vertex.boneWeights[ weight ] | topBits );
+		}
+
+		inline float transformRow( const float* row, const float* v ) NOEXCEPT
+		{
+			return row[ 0 ] * v[ 0 ] + row[ 1 ] * v[ 1 ] + row[ 2 ] * v[ 2 ] + row[ 3 ];
+		}
+
+		inline float rotateRow( const float* row, const float* v ) NOEXCEPT
+		{
+			return row[ 0 ] * v[ 0 ] + row[ 1 ] * v[ 1 ] + row[ 2 ] * v[ 2 ];
+		}
+
+#ifdef Q_SKINNING_SSE
+		/// ( dot( rows[ 0 ], v ), dot( rows[ 1 ], v ), dot( rows[ 2 ], v ), 0 )
+		inline __m128 multiplyRows( __m128 row0, __m128 row1, __m128 row2, __m128 v ) NOEXCEPT
+		{
+			__m128 x = _mm_mul_ps( row0, v );
+			__m128 y = _mm_mul_ps( row1, v );
+			__m128 z = _mm_mul_ps( row2, v );
+			__m128 w = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS( x, y, z, w );
+			return _mm_add_ps( _mm_add_ps( x, y ), _mm_add_ps( z, w ) );
+		}
+
+		inline void store3( float* out, __m128 v ) NOEXCEPT
+		{
+			_mm_storel_pi( reinterpret_cast< __m64* >( out ), v );
+			_mm_store_ss( out + 2, _mm_movehl_ps( v, v ) );
+		}
+#endif
+	}
+
+	void skinVerticesReference( const SkinVertex* vertices, std::size_t count, const SkinBone* palette, float( *xyz )[ 4 ], float( *normal )[ 4 ] )
+	{
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			const SkinVertex& vertex = vertices[ i ];
+			const SkinBone& bone = palette[ boneIndex( vertex, 0 ) ];
+			const int weights = numWeights( vertex );
+
+			for( int row = 0; row < 3; ++row )
+			{
+				normal[ i ][ row ] = rotateRow( bone.matrix[ row ], vertex.normal );
+			}
+
+			if( weights == 1 )
+			{
+				for( int row = 0; row < 3; ++row )
+				{
+					xyz[ i ][ row ] = transformRow( bone.matrix[ row ], vertex.position );
+				}
+				continue;
+			}
+
+			float weight = boneWeight( vertex, 0 );
+			if( weights == 2 )
+			{
+				const SkinBone& bone2 = palette[ boneIndex( vertex, 1 ) ];
+				for( int row = 0; row < 3; ++row )
+				{
+					const float t1 = transformRow( bone.matrix[ row ], vertex.position );
+					const float t2 = transformRow( bone2.matrix[ row ], vertex.position );
+					xyz[ i ][ row ] = weight * ( t1 - t2 ) + t2;
+				}
+				continue;
+			}
+
+			for( int row = 0; row < 3; ++row )
+			{
+				xyz[ i ][ row ] = weight * transformRow( bone.matrix[ row ], vertex.position );
+			}
+			float totalWeight = weight;
+			int k;
+			for( k = 1; k < weights - 1; ++k )
+			{
+				const SkinBone& other = palette[ boneIndex( vertex, k ) ];
+				weight = boneWeight( vertex, k );
+				totalWeight += weight;
+				for( int row = 0; row < 3; ++row )
+				{
+					xyz[ i ][ row ] += weight * transformRow( other.matrix[ row ], vertex.position );
+				}
+			}
+			const SkinBone& last = palette[ boneIndex( vertex, k ) ];
+			weight = 1.0f - totalWeight;
+			for( int row = 0; row < 3; ++row )
+			{
+				xyz[ i ][ row ] += weight * transformRow( last.matrix[ row ], vertex.position );
+			}
+		}
+	}
+
+#ifdef Q_SKINNING_SSE
+	void skinVertices( const SkinVertex* vertices, std::size_t count, const SkinBone* palette, float( *xyz )[ 4 ], float( *normal )[ 4 ] )
+	{
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			const SkinVertex& vertex = vertices[ i ];
+			const float* matrix = &palette[ boneIndex( vertex, 0 ) ].matrix[ 0 ][ 0 ];
+			__m128 row0 = _mm_loadu_ps( matrix );
+			__m128 row1 = _mm_loadu_ps( matrix + 4 );
+			__m128 row2 = _mm_loadu_ps( matrix + 8 );
+
+			const __m128 vertexNormal = _mm_setr_ps( vertex.normal[ 0 ], vertex.normal[ 1 ], vertex.normal[ 2 ], 0.0f );
+			store3( normal[ i ], multiplyRows( row0, row1, row2, vertexNormal ) );
+
+			// blend the bones into one matrix, so the position only has to be transformed once
+			const int weights = numWeights( vertex );
+			if( weights > 1 )
+			{
+				float weight = boneWeight( vertex, 0 );
+				float remaining = 1.0f - weight;
+				__m128 scale = _mm_set1_ps( weight );
+				row0 = _mm_mul_ps( row0, scale );
+				row1 = _mm_mul_ps( row1, scale );
+				row2 = _mm_mul_ps( row2, scale );
+				for( int k = 1; k < weights; ++k )
+				{
+					if( k < weights - 1 )
+					{
+						weight = boneWeight( vertex, k );
+						remaining -= weight;
+					}
+					else
+					{
+						weight = remaining;
+					}
+					matrix = &palette[ boneIndex( vertex, k ) ].matrix[ 0 ][ 0 ];
+					scale = _mm_set1_ps( weight );
+					row0 = _mm_add_ps( row0, _mm_mul_ps( _mm_loadu_ps( matrix ), scale ) );
+					row1 = _mm_add_ps( row1, _mm_mul_ps( _mm_loadu_ps( matrix + 4 ), scale ) );
+					row2 = _mm_add_ps( row2, _mm_mul_ps( _mm_loadu_ps( matrix + 8 ), scale ) );
+				}
+			}
+
+			const __m128 position = _mm_setr_ps( vertex.position[ 0 ], vertex.position[ 1 ], vertex.position[ 2 ], 1.0f );
+			store3( xyz[ i ], multiplyRows( row0, row1, row2, position ) );
+		}
+	}
+#else
+	void skinVertices( const SkinVertex* vertices, std::size_t count, const SkinBone* palette, float( *xyz )[ 4 ], float( *normal )[ 4 ] )
+	{
+		skinVerticesReference( vertices, count, palette, xyz, normal );
+	}
+#endif
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	A skinned vertex the way Ghoul2 models store it, laid out exactly like mdxmVertex_t.
+
+	weightsAndBoneIndices holds the number of weights minus one in bits 30 and 31,
+	the top 2 bits of each 10 bit weight from bit 20 on and a 5 bit palette index per weight from bit 0 on.
+	The last weight isn't stored, it's whatever the others leave to 1.
+	*/
+	struct SkinVertex
+	{
+		float normal[ 3 ];
+		float position[ 3 ];
+		std::uint32_t weightsAndBoneIndices;
+		std::uint8_t boneWeights[ 4 ];
+	};
+
+	/// A 3x4 bone matrix, laid out like mdxaBone_t
+	struct SkinBone
+	{
+		float matrix[ 3 ][ 4 ];
+	};
+
+	/**
+	Transforms count vertices by the bone palette, writing their positions to xyz and normals to normal.
+	Positions blend every bone weight, normals only use the first bone.
+	The 4th float of each output vertex is left alone.
+
+	The SSE version blends the bone matrices before transforming, instead of blending transformed positions,
+	so positions may differ from skinVerticesReference in the last bits.
+	*/
+	void skinVertices( const SkinVertex* vertices, std::size_t count, const SkinBone* palette, float( *xyz )[ 4 ], float( *normal )[ 4 ] );
+
+	/// The straightforward scalar version of skinVertices, as the renderer used to do it
+	void skinVerticesReference( const SkinVertex* vertices, std::size_t count, const SkinBone* palette, float( *xyz )[ 4 ], float( *normal )[ 4 ] );
+}
@@ -0,0 +1,561 @@
+#include "q_weather.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Q_WEATHER_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Q
+{
+	namespace
+	{
+		const float CELL_SIZE = 32.0f;
+		/// Particles further than this out of range get a new position instead of wrapping
+		const float WRAP_LIMIT = 500.0f;
+
+		inline bool inBox( const float* mins, const float* maxs, float x, float y, float z ) NOEXCEPT
+		{
+			return x > mins[ 0 ] && y > mins[ 1 ] && z > mins[ 2 ] && x < maxs[ 0 ] && y < maxs[ 1 ] && z < maxs[ 2 ];
+		}
+
+		inline bool cellOutside( const WeatherZone& zone, bool markedOutside, int x, int y, int word, int bit ) NOEXCEPT
+		{
+			if( x < 0 || x >= zone.width || y < 0 || y >= zone.height || word < 0 || word >= zone.depth || bit < 0 || bit >= 32 )
+			{
+				return !markedOutside;
+			}
+			return markedOutside == ( ( zone.cells[ ( word * zone.width * zone.height ) + ( y * zone.width ) + x ] & ( 1u << bit ) ) != 0 );
+		}
+
+		/// Whether every cell around the given one is outside
+		inline bool cellsOutside( const WeatherStep& step, const WeatherZone& zone, int x, int y, int z ) NOEXCEPT
+		{
+			const int bit = z & 31;
+			const int word = z >> 5;
+			for( int cellX = x - step.cellSpread; cellX <= x + step.cellSpread; ++cellX )
+			{
+				for( int cellY = y - step.cellSpread; cellY <= y + step.cellSpread; ++cellY )
+				{
+					for( int cellBit = bit - step.bitSpread; cellBit <= bit + step.bitSpread; ++cellBit )
+					{
+						if( !cellOutside( zone, step.markedOutside, cellX, cellY, word, cellBit ) )
+						{
+							return false;
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		bool pointOutside( const WeatherStep& step, float x, float y, float z ) NOEXCEPT
+		{
+			for( std::size_t i = 0; i < step.numZones; ++i )
+			{
+				const WeatherZone& zone = step.zones[ i ];
+				if( inBox( zone.mins, zone.maxs, x, y, z ) )
+				{
+					return cellsOutside(
+						step, zone,
+						static_cast< int >( ( x / CELL_SIZE ) - zone.cellMins[ 0 ] ),
+						static_cast< int >( ( y / CELL_SIZE ) - zone.cellMins[ 1 ] ),
+						static_cast< int >( ( z / CELL_SIZE ) - zone.cellMins[ 2 ] )
+						);
+				}
+			}
+			return !step.markedOutside;
+		}
+
+		/// Returns false when v is too far out of range to wrap
+		inline bool wrapAxis( float& v, float mins, float maxs ) NOEXCEPT
+		{
+			if( v <= mins )
+			{
+				if( ( mins - v ) > WRAP_LIMIT )
+				{
+					return false;
+				}
+				v = maxs - 10.0f;
+			}
+			if( v >= maxs )
+			{
+				if( ( v - maxs ) > WRAP_LIMIT )
+				{
+					return false;
+				}
+				v = mins + 10.0f;
+			}
+			return true;
+		}
+
+		/// Updates the fade state; returns whether the particle is still rendering
+		inline bool fade( std::uint8_t& flags, float& alpha, bool inView, const WeatherStep& step ) NOEXCEPT
+		{
+			bool rendering = ( flags & WEATHER_RENDER ) != 0;
+			if( rendering && !inView )
+			{
+				flags = static_cast< std::uint8_t >( ( flags & ~WEATHER_FADE_IN ) | WEATHER_FADE_OUT );
+			}
+			else if( rendering && inView && ( flags & WEATHER_FADE_OUT ) )
+			{
+				flags = static_cast< std::uint8_t >( ( flags | WEATHER_FADE_IN ) & ~WEATHER_FADE_OUT );
+			}
+			else if( !rendering && inView )
+			{
+				rendering = true;
+				alpha = 0.0f;
+				flags = static_cast< std::uint8_t >( ( flags | WEATHER_RENDER | WEATHER_FADE_IN ) & ~WEATHER_FADE_OUT );
+			}
+
+			if( rendering )
+			{
+				if( flags & WEATHER_FADE_OUT )
+				{
+					alpha -= step.fade;
+					if( alpha <= 0.0f )
+					{
+						alpha = 0.0f;
+						flags = static_cast< std::uint8_t >( flags & ~( WEATHER_FADE_OUT | WEATHER_FADE_IN | WEATHER_RENDER ) );
+						rendering = false;
+					}
+				}
+				else if( flags & WEATHER_FADE_IN )
+				{
+					alpha += step.fade;
+					if( alpha >= step.maxAlpha )
+					{
+						flags = static_cast< std::uint8_t >( flags & ~WEATHER_FADE_IN );
+						alpha = step.maxAlpha;
+					}
+				}
+			}
+			return rendering;
+		}
+
+		/// Finishes a particle once its position and view state are known
+		inline bool finish( const WeatherParticles& particles, const WeatherStep& step, std::size_t i, bool respawn, bool inView ) NOEXCEPT
+		{
+			std::uint8_t flags = static_cast< std::uint8_t >( particles.flags[ i ] & ~WEATHER_RESPAWN );
+			if( respawn )
+			{
+				flags |= WEATHER_RESPAWN;
+			}
+			const bool rendering = fade( flags, particles.alpha[ i ], inView, step );
+			particles.flags[ i ] = flags;
+			return rendering;
+		}
+
+		std::size_t stepRange( const WeatherParticles& particles, const WeatherStep& step, std::size_t begin ) NOEXCEPT
+		{
+			std::size_t rendering = 0;
+			for( std::size_t i = begin; i < particles.count; ++i )
+			{
+				float& x = particles.x[ i ];
+				float& y = particles.y[ i ];
+				float& z = particles.z[ i ];
+				float& vx = particles.vx[ i ];
+				float& vy = particles.vy[ i ];
+				float& vz = particles.vz[ i ];
+
+				float force[ 3 ] = { step.force[ 0 ], step.force[ 1 ], step.force[ 2 ] };
+				for( std::size_t wind = 0; wind < step.numWinds; ++wind )
+				{
+					if( inBox( step.winds[ wind ].mins, step.winds[ wind ].maxs, x, y, z ) )
+					{
+						force[ 0 ] += step.winds[ wind ].velocity[ 0 ];
+						force[ 1 ] += step.winds[ wind ].velocity[ 1 ];
+						force[ 2 ] += step.winds[ wind ].velocity[ 2 ];
+					}
+				}
+				const float mass = particles.mass[ i ];
+				vx = ( vx + force[ 0 ] / mass ) * step.friction;
+				vy = ( vy + force[ 1 ] / mass ) * step.friction;
+				vz = ( vz + force[ 2 ] / mass ) * step.friction;
+				x += step.seconds * vx;
+				y += step.seconds * vy;
+				z += step.seconds * vz;
+
+				const bool inRange = inBox( step.rangeMins, step.rangeMaxs, x, y, z );
+				const float ahead = ( ( x - step.viewOrigin[ 0 ] ) * step.viewForward[ 0 ] + ( y - step.viewOrigin[ 1 ] ) * step.viewForward[ 1 ] ) + ( z - step.viewOrigin[ 2 ] ) * step.viewForward[ 2 ];
+				const bool inView = inRange && ahead > 0.0f && pointOutside( step, x, y, z );
+
+				bool respawn = false;
+				if( !inRange && !( particles.flags[ i ] & WEATHER_RENDER ) )
+				{
+					vx = vy = vz = 0.0f;
+					respawn = !step.wrap || !( wrapAxis( x, step.rangeMins[ 0 ], step.rangeMaxs[ 0 ] ) && wrapAxis( y, step.rangeMins[ 1 ], step.rangeMaxs[ 1 ] ) && wrapAxis( z, step.rangeMins[ 2 ], step.rangeMaxs[ 2 ] ) );
+				}
+				if( finish( particles, step, i, respawn, inView ) )
+				{
+					++rendering;
+				}
+			}
+			return rendering;
+		}
+
+		struct Corners
+		{
+			/// Offsets from the particle to each vertex
+			float offset[ 4 ][ 3 ];
+			/// Whether to subtract the offset instead of adding it
+			bool negate[ 4 ];
+		};
+
+		inline void corners( const WeatherSprite& sprite, const float* left, const float* down, Corners& out ) NOEXCEPT
+		{
+			for( int k = 0; k < 3; ++k )
+			{
+				if( sprite.vertexCount == 3 )
+				{
+					out.offset[ 0 ][ k ] = 0.0f;
+					out.offset[ 1 ][ k ] = left[ k ];
+					out.offset[ 2 ][ k ] = down[ k ] + left[ k ];
+				}
+				else
+				{
+					const float leftPlusUp = left[ k ] - down[ k ];
+					const float leftMinusUp = left[ k ] + down[ k ];
+					out.offset[ 0 ][ k ] = leftMinusUp;
+					out.offset[ 1 ][ k ] = leftPlusUp;
+					out.offset[ 2 ][ k ] = leftMinusUp;
+					out.offset[ 3 ][ k ] = leftPlusUp;
+				}
+			}
+			// subtracting the triangle's zero offset keeps negative zeroes, like not adding it at all
+			const bool negate[ 4 ] = { true, sprite.vertexCount == 4, false, false };
+			for( int v = 0; v < 4; ++v )
+			{
+				out.negate[ v ] = negate[ v ];
+			}
+		}
+
+		/// VectorNormalize, scaled
+		inline void velocityDown( const WeatherParticles& particles, std::size_t i, float height, float* down ) NOEXCEPT
+		{
+			float dir[ 3 ] = { particles.vx[ i ], particles.vy[ i ], particles.vz[ i ] };
+			const float length = std::sqrt( dir[ 0 ] * dir[ 0 ] + dir[ 1 ] * dir[ 1 ] + dir[ 2 ] * dir[ 2 ] );
+			if( length )
+			{
+				const float inverseLength = 1 / length;
+				dir[ 0 ] *= inverseLength;
+				dir[ 1 ] *= inverseLength;
+				dir[ 2 ] *= inverseLength;
+			}
+			down[ 0 ] = dir[ 0 ] * -height;
+			down[ 1 ] = dir[ 1 ] * -height;
+			down[ 2 ] = dir[ 2 ] * -height;
+		}
+
+		std::size_t vertexesRange( const WeatherParticles& particles, const WeatherSprite& sprite, std::size_t begin, float( *xyz )[ 3 ], float( *colors )[ 4 ] ) NOEXCEPT
+		{
+			Corners fixed;
+			corners( sprite, sprite.left, sprite.down, fixed );
+			std::size_t numVertexes = 0;
+			for( std::size_t i = begin; i < particles.count; ++i )
+			{
+				if( !( particles.flags[ i ] & WEATHER_RENDER ) )
+				{
+					continue;
+				}
+				Corners oriented;
+				if( sprite.orientWithVelocity )
+				{
+					float down[ 3 ];
+					velocityDown( particles, i, sprite.height, down );
+					corners( sprite, sprite.left, down, oriented );
+				}
+				const Corners& c = sprite.orientWithVelocity ? oriented : fixed;
+
+				const float alpha = particles.alpha[ i ];
+				const float color[ 4 ] = {
+					sprite.alphaOnly ? sprite.color[ 0 ] : sprite.color[ 0 ] * alpha,
+					sprite.alphaOnly ? sprite.color[ 1 ] : sprite.color[ 1 ] * alpha,
+					sprite.alphaOnly ? sprite.color[ 2 ] : sprite.color[ 2 ] * alpha,
+					sprite.alphaOnly ? alpha : sprite.color[ 3 ] * alpha,
+				};
+				const float position[ 3 ] = { particles.x[ i ], particles.y[ i ], particles.z[ i ] };
+				for( int v = 0; v < sprite.vertexCount; ++v, ++numVertexes )
+				{
+					for( int k = 0; k < 3; ++k )
+					{
+						xyz[ numVertexes ][ k ] = c.negate[ v ] ? position[ k ] - c.offset[ v ][ k ] : position[ k ] + c.offset[ v ][ k ];
+					}
+					for( int k = 0; k < 4; ++k )
+					{
+						colors[ numVertexes ][ k ] = color[ k ];
+					}
+				}
+			}
+			return numVertexes;
+		}
+
+#ifdef Q_WEATHER_SSE
+		inline __m128 select( __m128 mask, __m128 ifTrue, __m128 ifFalse ) NOEXCEPT
+		{
+			return _mm_or_ps( _mm_and_ps( mask, ifTrue ), _mm_andnot_ps( mask, ifFalse ) );
+		}
+
+		inline __m128 inBox( const float* mins, const float* maxs, __m128 x, __m128 y, __m128 z ) NOEXCEPT
+		{
+			const __m128 above = _mm_and_ps( _mm_and_ps( _mm_cmpgt_ps( x, _mm_set1_ps( mins[ 0 ] ) ), _mm_cmpgt_ps( y, _mm_set1_ps( mins[ 1 ] ) ) ), _mm_cmpgt_ps( z, _mm_set1_ps( mins[ 2 ] ) ) );
+			const __m128 below = _mm_and_ps( _mm_and_ps( _mm_cmplt_ps( x, _mm_set1_ps( maxs[ 0 ] ) ), _mm_cmplt_ps( y, _mm_set1_ps( maxs[ 1 ] ) ) ), _mm_cmplt_ps( z, _mm_set1_ps( maxs[ 2 ] ) ) );
+			return _mm_and_ps( above, below );
+		}
+
+		/// All ones in the lanes whose bit is set
+		inline __m128 laneMask( int bits ) NOEXCEPT
+		{
+			const __m128i lanes = _mm_set_epi32( 8, 4, 2, 1 );
+			return _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( _mm_set1_epi32( bits ), lanes ), lanes ) );
+		}
+
+		/// pointOutside for four points, as a lane bit mask. Boxes and cells are computed for all four at once, the cache is read per point.
+		int pointsOutside( const WeatherStep& step, __m128 x, __m128 y, __m128 z ) NOEXCEPT
+		{
+			int outside = step.markedOutside ? 0 : 15;
+			int pending = 15;
+			const __m128 cellScale = _mm_set1_ps( 1.0f / CELL_SIZE );
+			for( std::size_t i = 0; i < step.numZones && pending; ++i )
+			{
+				const WeatherZone& zone = step.zones[ i ];
+				const int in = _mm_movemask_ps( inBox( zone.mins, zone.maxs, x, y, z ) ) & pending;
+				if( !in )
+				{
+					continue;
+				}
+				pending &= ~in;
+
+				alignas( 16 ) std::int32_t cells[ 3 ][ 4 ];
+				_mm_store_si128( reinterpret_cast< __m128i* >( cells[ 0 ] ), _mm_cvttps_epi32( _mm_sub_ps( _mm_mul_ps( x, cellScale ), _mm_set1_ps( zone.cellMins[ 0 ] ) ) ) );
+				_mm_store_si128( reinterpret_cast< __m128i* >( cells[ 1 ] ), _mm_cvttps_epi32( _mm_sub_ps( _mm_mul_ps( y, cellScale ), _mm_set1_ps( zone.cellMins[ 1 ] ) ) ) );
+				_mm_store_si128( reinterpret_cast< __m128i* >( cells[ 2 ] ), _mm_cvttps_epi32( _mm_sub_ps( _mm_mul_ps( z, cellScale ), _mm_set1_ps( zone.cellMins[ 2 ] ) ) ) );
+				for( int lane = 0; lane < 4; ++lane )
+				{
+					if( in & ( 1 << lane ) )
+					{
+						if( cellsOutside( step, zone, cells[ 0 ][ lane ], cells[ 1 ][ lane ], cells[ 2 ][ lane ] ) )
+						{
+							outside |= 1 << lane;
+						}
+						else
+						{
+							outside &= ~( 1 << lane );
+						}
+					}
+				}
+			}
+			return outside;
+		}
+
+		/// wrapAxis for the active lanes; returns the lanes too far out to wrap, which are left alone
+		inline __m128 wrapAxis( __m128& v, __m128 active, float mins, float maxs ) NOEXCEPT
+		{
+			const __m128 minsV = _mm_set1_ps( mins );
+			const __m128 maxsV = _mm_set1_ps( maxs );
+			const __m128 limit = _mm_set1_ps( WRAP_LIMIT );
+
+			const __m128 low = _mm_and_ps( active, _mm_cmple_ps( v, minsV ) );
+			const __m128 farLow = _mm_and_ps( low, _mm_cmpgt_ps( _mm_sub_ps( minsV, v ), limit ) );
+			v = select( _mm_andnot_ps( farLow, low ), _mm_set1_ps( maxs - 10.0f ), v );
+
+			const __m128 high = _mm_and_ps( _mm_andnot_ps( farLow, active ), _mm_cmpge_ps( v, maxsV ) );
+			const __m128 farHigh = _mm_and_ps( high, _mm_cmpgt_ps( _mm_sub_ps( v, maxsV ), limit ) );
+			v = select( _mm_andnot_ps( farHigh, high ), _mm_set1_ps( mins + 10.0f ), v );
+
+			return _mm_or_ps( farLow, farHigh );
+		}
+#endif
+	}
+
+	std::size_t weatherStepReference( const WeatherParticles& particles, const WeatherStep& step )
+	{
+		return stepRange( particles, step, 0 );
+	}
+
+	std::size_t weatherStep( const WeatherParticles& particles, const WeatherStep& step )
+	{
+		std::size_t i = 0;
+		std::size_t rendering = 0;
+#ifdef Q_WEATHER_SSE
+		const __m128 force[ 3 ] = { _mm_set1_ps( step.force[ 0 ] ), _mm_set1_ps( step.force[ 1 ] ), _mm_set1_ps( step.force[ 2 ] ) };
+		const __m128 friction = _mm_set1_ps( step.friction );
+		const __m128 seconds = _mm_set1_ps( step.seconds );
+		const __m128 viewOrigin[ 3 ] = { _mm_set1_ps( step.viewOrigin[ 0 ] ), _mm_set1_ps( step.viewOrigin[ 1 ] ), _mm_set1_ps( step.viewOrigin[ 2 ] ) };
+		const __m128 viewForward[ 3 ] = { _mm_set1_ps( step.viewForward[ 0 ] ), _mm_set1_ps( step.viewForward[ 1 ] ), _mm_set1_ps( step.viewForward[ 2 ] ) };
+		for( ; i + 4 <= particles.count; i += 4 )
+		{
+			__m128 x = _mm_loadu_ps( particles.x + i );
+			__m128 y = _mm_loadu_ps( particles.y + i );
+			__m128 z = _mm_loadu_ps( particles.z + i );
+
+			__m128 fx = force[ 0 ];
+			__m128 fy = force[ 1 ];
+			__m128 fz = force[ 2 ];
+			for( std::size_t wind = 0; wind < step.numWinds; ++wind )
+			{
+				const WeatherWind& w = step.winds[ wind ];
+				const __m128 in = inBox( w.mins, w.maxs, x, y, z );
+				fx = select( in, _mm_add_ps( fx, _mm_set1_ps( w.velocity[ 0 ] ) ), fx );
+				fy = select( in, _mm_add_ps( fy, _mm_set1_ps( w.velocity[ 1 ] ) ), fy );
+				fz = select( in, _mm_add_ps( fz, _mm_set1_ps( w.velocity[ 2 ] ) ), fz );
+			}
+			const __m128 mass = _mm_loadu_ps( particles.mass + i );
+			__m128 vx = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( particles.vx + i ), _mm_div_ps( fx, mass ) ), friction );
+			__m128 vy = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( particles.vy + i ), _mm_div_ps( fy, mass ) ), friction );
+			__m128 vz = _mm_mul_ps( _mm_add_ps( _mm_loadu_ps( particles.vz + i ), _mm_div_ps( fz, mass ) ), friction );
+			x = _mm_add_ps( x, _mm_mul_ps( seconds, vx ) );
+			y = _mm_add_ps( y, _mm_mul_ps( seconds, vy ) );
+			z = _mm_add_ps( z, _mm_mul_ps( seconds, vz ) );
+
+			const int inRange = _mm_movemask_ps( inBox( step.rangeMins, step.rangeMaxs, x, y, z ) );
+			const __m128 ahead = _mm_add_ps(
+				_mm_add_ps( _mm_mul_ps( _mm_sub_ps( x, viewOrigin[ 0 ] ), viewForward[ 0 ] ), _mm_mul_ps( _mm_sub_ps( y, viewOrigin[ 1 ] ), viewForward[ 1 ] ) ),
+				_mm_mul_ps( _mm_sub_ps( z, viewOrigin[ 2 ] ), viewForward[ 2 ] )
+				);
+			int inView = inRange & _mm_movemask_ps( _mm_cmpgt_ps( ahead, _mm_setzero_ps() ) );
+			if( inView )
+			{
+				inView &= pointsOutside( step, x, y, z );
+			}
+
+			int notRendering = 0;
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( !( particles.flags[ i + lane ] & WEATHER_RENDER ) )
+				{
+					notRendering |= 1 << lane;
+				}
+			}
+			const int leaving = ~inRange & notRendering;
+			int respawn = 0;
+			if( leaving )
+			{
+				const __m128 mask = laneMask( leaving );
+				vx = _mm_andnot_ps( mask, vx );
+				vy = _mm_andnot_ps( mask, vy );
+				vz = _mm_andnot_ps( mask, vz );
+				if( step.wrap )
+				{
+					__m128 tooFar = wrapAxis( x, mask, step.rangeMins[ 0 ], step.rangeMaxs[ 0 ] );
+					tooFar = _mm_or_ps( tooFar, wrapAxis( y, _mm_andnot_ps( tooFar, mask ), step.rangeMins[ 1 ], step.rangeMaxs[ 1 ] ) );
+					tooFar = _mm_or_ps( tooFar, wrapAxis( z, _mm_andnot_ps( tooFar, mask ), step.rangeMins[ 2 ], step.rangeMaxs[ 2 ] ) );
+					respawn = _mm_movemask_ps( tooFar );
+				}
+				else
+				{
+					respawn = leaving;
+				}
+			}
+
+			_mm_storeu_ps( particles.x + i, x );
+			_mm_storeu_ps( particles.y + i, y );
+			_mm_storeu_ps( particles.z + i, z );
+			_mm_storeu_ps( particles.vx + i, vx );
+			_mm_storeu_ps( particles.vy + i, vy );
+			_mm_storeu_ps( particles.vz + i, vz );
+
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( finish( particles, step, i + lane, ( respawn >> lane ) & 1, ( inView >> lane ) & 1 ) )
+				{
+					++rendering;
+				}
+			}
+		}
+#endif
+		return rendering + stepRange( particles, step, i );
+	}
+
+	std::size_t weatherVertexesReference( const WeatherParticles& particles, const WeatherSprite& sprite, float( *xyz )[ 3 ], float( *colors )[ 4 ] )
+	{
+		return vertexesRange( particles, sprite, 0, xyz, colors );
+	}
+
+	std::size_t weatherVertexes( const WeatherParticles& particles, const WeatherSprite& sprite, float( *xyz )[ 3 ], float( *colors )[ 4 ] )
+	{
+		std::size_t i = 0;
+		std::size_t numVertexes = 0;
+#ifdef Q_WEATHER_SSE
+		const __m128 left[ 3 ] = { _mm_set1_ps( sprite.left[ 0 ] ), _mm_set1_ps( sprite.left[ 1 ] ), _mm_set1_ps( sprite.left[ 2 ] ) };
+		const __m128 minusHeight = _mm_set1_ps( -sprite.height );
+		const __m128 color[ 4 ] = { _mm_set1_ps( sprite.color[ 0 ] ), _mm_set1_ps( sprite.color[ 1 ] ), _mm_set1_ps( sprite.color[ 2 ] ), _mm_set1_ps( sprite.color[ 3 ] ) };
+		for( ; i + 4 <= particles.count; i += 4 )
+		{
+			int rendering = 0;
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( particles.flags[ i + lane ] & WEATHER_RENDER )
+				{
+					rendering |= 1 << lane;
+				}
+			}
+			if( !rendering )
+			{
+				continue;
+			}
+
+			__m128 down[ 3 ] = { _mm_set1_ps( sprite.down[ 0 ] ), _mm_set1_ps( sprite.down[ 1 ] ), _mm_set1_ps( sprite.down[ 2 ] ) };
+			if( sprite.orientWithVelocity )
+			{
+				const __m128 vx = _mm_loadu_ps( particles.vx + i );
+				const __m128 vy = _mm_loadu_ps( particles.vy + i );
+				const __m128 vz = _mm_loadu_ps( particles.vz + i );
+				const __m128 length = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) ), _mm_mul_ps( vz, vz ) ) );
+				const __m128 one = _mm_set1_ps( 1.0f );
+				const __m128 scale = select( _mm_cmpneq_ps( length, _mm_setzero_ps() ), _mm_div_ps( one, length ), one );
+				down[ 0 ] = _mm_mul_ps( _mm_mul_ps( vx, scale ), minusHeight );
+				down[ 1 ] = _mm_mul_ps( _mm_mul_ps( vy, scale ), minusHeight );
+				down[ 2 ] = _mm_mul_ps( _mm_mul_ps( vz, scale ), minusHeight );
+			}
+
+			const __m128 position[ 3 ] = { _mm_loadu_ps( particles.x + i ), _mm_loadu_ps( particles.y + i ), _mm_loadu_ps( particles.z + i ) };
+			alignas( 16 ) float corner[ 4 ][ 3 ][ 4 ];
+			for( int k = 0; k < 3; ++k )
+			{
+				if( sprite.vertexCount == 3 )
+				{
+					_mm_store_ps( corner[ 0 ][ k ], position[ k ] );
+					_mm_store_ps( corner[ 1 ][ k ], _mm_add_ps( position[ k ], left[ k ] ) );
+					_mm_store_ps( corner[ 2 ][ k ], _mm_add_ps( position[ k ], _mm_add_ps( down[ k ], left[ k ] ) ) );
+				}
+				else
+				{
+					const __m128 leftPlusUp = _mm_sub_ps( left[ k ], down[ k ] );
+					const __m128 leftMinusUp = _mm_add_ps( left[ k ], down[ k ] );
+					_mm_store_ps( corner[ 0 ][ k ], _mm_sub_ps( position[ k ], leftMinusUp ) );
+					_mm_store_ps( corner[ 1 ][ k ], _mm_sub_ps( position[ k ], leftPlusUp ) );
+					_mm_store_ps( corner[ 2 ][ k ], _mm_add_ps( position[ k ], leftMinusUp ) );
+					_mm_store_ps( corner[ 3 ][ k ], _mm_add_ps( position[ k ], leftPlusUp ) );
+				}
+			}
+
+			const __m128 alpha = _mm_loadu_ps( particles.alpha + i );
+			__m128 rgba[ 4 ] = {
+				sprite.alphaOnly ? color[ 0 ] : _mm_mul_ps( color[ 0 ], alpha ),
+				sprite.alphaOnly ? color[ 1 ] : _mm_mul_ps( color[ 1 ], alpha ),
+				sprite.alphaOnly ? color[ 2 ] : _mm_mul_ps( color[ 2 ], alpha ),
+				sprite.alphaOnly ? alpha : _mm_mul_ps( color[ 3 ], alpha ),
+			};
+			_MM_TRANSPOSE4_PS( rgba[ 0 ], rgba[ 1 ], rgba[ 2 ], rgba[ 3 ] );
+
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( !( rendering & ( 1 << lane ) ) )
+				{
+					continue;
+				}
+				for( int v = 0; v < sprite.vertexCount; ++v, ++numVertexes )
+				{
+					xyz[ numVertexes ][ 0 ] = corner[ v ][ 0 ][ lane ];
+					xyz[ numVertexes ][ 1 ] = corner[ v ][ 1 ][ lane ];
+					xyz[ numVertexes ][ 2 ] = corner[ v ][ 2 ][ lane ];
+					_mm_storeu_ps( colors[ numVertexes ], rgba[ lane ] );
+				}
+			}
+		}
+#endif
+		return numVertexes + vertexesRange( particles, sprite, i, xyz + numVertexes, colors + numVertexes );
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "qcommon/q_platform.h"
+
+namespace Q
+{
+	/**
+	Weather particle kernels for rain, snow and dust clouds.
+
+	Particles are stored as one array per component, so the SSE versions step and build sprites for four at a time.
+	Picking new positions for particles flagged WEATHER_RESPAWN is left to the caller.
+	*/
+
+	/// Bits of WeatherParticles::flags
+	enum : std::uint8_t
+	{
+		WEATHER_RENDER = 1 << 0,
+		WEATHER_FADE_IN = 1 << 1,
+		WEATHER_FADE_OUT = 1 << 2,
+		/// Left the range and needs a new random position from the caller; its velocity has been cleared
+		WEATHER_RESPAWN = 1 << 3,
+	};
+
+	struct WeatherParticles
+	{
+		float* x;
+		float* y;
+		float* z;
+		float* vx;
+		float* vy;
+		float* vz;
+		/// A higher mass resists force more
+		const float* mass;
+		float* alpha;
+		std::uint8_t* flags;
+		std::size_t count;
+	};
+
+	/// A local wind zone, blowing on particles strictly inside its box
+	struct WeatherWind
+	{
+		float mins[ 3 ];
+		float maxs[ 3 ];
+		float velocity[ 3 ];
+	};
+
+	/**
+	A weather zone's outside point cache: one bit per 32 unit cell, 32 cells deep per word,
+	words ordered by depth, then height, then width.
+	*/
+	struct WeatherZone
+	{
+		float mins[ 3 ];
+		float maxs[ 3 ];
+		/// mins in cells
+		float cellMins[ 3 ];
+		int width;
+		int height;
+		int depth;
+		const std::uint32_t* cells;
+	};
+
+	/// One frame of a particle cloud
+	struct WeatherStep
+	{
+		/// Gravity plus global wind
+		float force[ 3 ];
+		/// Velocity is scaled by this after the force is applied; 1 is no friction
+		float friction;
+		float seconds;
+		/// How much alpha changes while fading in or out
+		float fade;
+		/// Alpha fading in stops at
+		float maxAlpha;
+
+		float rangeMins[ 3 ];
+		float rangeMaxs[ 3 ];
+		/// Wrap particles leaving the range around to its other side instead of respawning them
+		bool wrap;
+
+		float viewOrigin[ 3 ];
+		float viewForward[ 3 ];
+
+		const WeatherWind* winds;
+		std::size_t numWinds;
+
+		/// Particles outside every zone count as outside unless markedOutside
+		const WeatherZone* zones;
+		std::size_t numZones;
+		/// Whether set cells are the outside ones
+		bool markedOutside;
+		/// Particles must be outside in every cell within cellSpread cells across and bitSpread cells up and down
+		int cellSpread;
+		int bitSpread;
+	};
+
+	/**
+	Moves every particle by the force and wind zones, then checks whether it's outside, in range and in front of the view.
+	Particles out of range that aren't rendering have their velocity cleared and are wrapped or flagged WEATHER_RESPAWN.
+	Particles coming into or leaving the view start fading in or out.
+	Returns the number of particles left rendering.
+	*/
+	std::size_t weatherStep( const WeatherParticles& particles, const WeatherStep& step );
+	std::size_t weatherStepReference( const WeatherParticles& particles, const WeatherStep& step );
+
+	/// How rendering particles are drawn
+	struct WeatherSprite
+	{
+		float color[ 4 ];
+		/// Apply the particle's alpha just to the alpha channel instead of to every channel
+		bool alphaOnly;
+		/// 3 for a triangle, 4 for a quad
+		int vertexCount;
+		/// Sprite axes, scaled by the width and height
+		float left[ 3 ];
+		float down[ 3 ];
+		/// Point down along each particle's velocity instead, this far
+		bool orientWithVelocity;
+		float height;
+	};
+
+	/**
+	Writes vertexCount vertexes per rendering particle, in particle order, for drawing as triangles or quads.
+	Returns the number of vertexes written.
+	*/
+	std::size_t weatherVertexes( const WeatherParticles& particles, const WeatherSprite& sprite, float( *xyz )[ 3 ], float( *colors )[ 4 ] );
+	std::size_t weatherVertexesReference( const WeatherParticles& particles, const WeatherSprite& sprite, float( *xyz )[ 3 ], float( *colors )[ 4 ] );
+}
@@ -893,3 +893,8 @@ qboolean WIN_GL_ExtensionSupported( const char *extension )
 {
 	return SDL_GL_ExtensionSupported( extension ) == SDL_TRUE ? qtrue : qfalse;
 }
+
+qboolean WIN_GL_MakeCurrent( qboolean current )
+{
+	return SDL_GL_MakeCurrent( screen, current ? opengl_context : NULL ) == 0 ? qtrue : qfalse;
+}
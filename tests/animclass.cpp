@@ -0,0 +1,864 @@
+#include "../code/game/bg_animClass.h"
+
+#include <cstdint>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	struct playerState_t
+	{
+		int legsAnim;
+		int legsAnimTimer;
+	};
+
+	/// Stands in for the force getup check PM_InGetUp falls back to
+	bool inForceGetUp( playerState_t * )
+	{
+		return false;
+	}
+
+	/// The predicates as they were written before the class tables
+	namespace reference
+	{
+		bool PM_SaberInAttack( int move )
+		{
+			if ( move >= LS_A_TL2BR && move <= LS_A_T2B )
+			{
+				return true;
+			}
+			switch ( move )
+			{
+			case LS_A_BACK:
+			case LS_A_BACK_CR:
+			case LS_A_BACKSTAB:
+			case LS_ROLL_STAB:
+			case LS_A_LUNGE:
+			case LS_A_JUMP_T__B_:
+			case LS_A_FLIP_STAB:
+			case LS_A_FLIP_SLASH:
+			case LS_JUMPATTACK_DUAL:
+			case LS_JUMPATTACK_ARIAL_LEFT:
+			case LS_JUMPATTACK_ARIAL_RIGHT:
+			case LS_JUMPATTACK_CART_LEFT:
+			case LS_JUMPATTACK_CART_RIGHT:
+			case LS_JUMPATTACK_STAFF_LEFT:
+			case LS_JUMPATTACK_STAFF_RIGHT:
+			case LS_BUTTERFLY_LEFT:
+			case LS_BUTTERFLY_RIGHT:
+			case LS_A_BACKFLIP_ATK:
+			case LS_SPINATTACK_DUAL:
+			case LS_SPINATTACK:
+			case LS_LEAP_ATTACK:
+			case LS_SWOOP_ATTACK_RIGHT:
+			case LS_SWOOP_ATTACK_LEFT:
+			case LS_TAUNTAUN_ATTACK_RIGHT:
+			case LS_TAUNTAUN_ATTACK_LEFT:
+			case LS_KICK_F:
+			case LS_KICK_F_MD:
+			case LS_KICK_B:
+			case LS_KICK_SWEEP:
+			case LS_KICK_R:
+			case LS_SMACK_R:
+			case LS_KICK_L:
+			case LS_SMACK_L:
+			case LS_KICK_S:
+			case LS_KICK_BF:
+			case LS_KICK_RL:
+			case LS_KICK_F_AIR:
+			case LS_FLYING_KICK:
+			case LS_KICK_B_AIR:
+			case LS_KICK_R_AIR:
+			case LS_KICK_L_AIR:
+			case LS_STABDOWN:
+			case LS_STABDOWN_STAFF:
+			case LS_STABDOWN_DUAL:
+			case LS_DUAL_SPIN_PROTECT:
+			case LS_STAFF_SOULCAL:
+			case LS_A1_SPECIAL:
+			case LS_A2_SPECIAL:
+			case LS_A3_SPECIAL:
+			case LS_UPSIDE_DOWN_ATTACK:
+			case LS_PULL_ATTACK_STAB:
+			case LS_PULL_ATTACK_SWING:
+			case LS_SPINATTACK_ALORA:
+			case LS_DUAL_FB:
+			case LS_DUAL_LR:
+			case LS_HILT_BASH:
+			case LS_SLAP_R:
+			case LS_SLAP_L:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_SaberInAttackPure(int move)
+		{
+			if (move >= LS_A_TL2BR && move <= LS_A_T2B)
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInDamageMove(int move)
+		{
+			if (move >= LS_A_TL2BR && move <= LS_A_T2B)
+			{
+				return true;
+			}
+			switch (move)
+			{
+			case LS_A_BACK:
+			case LS_A_BACK_CR:
+			case LS_A_BACKSTAB:
+			case LS_ROLL_STAB:
+			case LS_A_LUNGE:
+			case LS_A_JUMP_T__B_:
+			case LS_A_FLIP_STAB:
+			case LS_A_FLIP_SLASH:
+			case LS_JUMPATTACK_DUAL:
+			case LS_JUMPATTACK_ARIAL_LEFT:
+			case LS_JUMPATTACK_ARIAL_RIGHT:
+			case LS_JUMPATTACK_CART_LEFT:
+			case LS_JUMPATTACK_CART_RIGHT:
+			case LS_JUMPATTACK_STAFF_LEFT:
+			case LS_JUMPATTACK_STAFF_RIGHT:
+			case LS_BUTTERFLY_LEFT:
+			case LS_BUTTERFLY_RIGHT:
+			case LS_A_BACKFLIP_ATK:
+			case LS_SPINATTACK_DUAL:
+			case LS_SPINATTACK:
+			case LS_LEAP_ATTACK:
+			case LS_SWOOP_ATTACK_RIGHT:
+			case LS_SWOOP_ATTACK_LEFT:
+			case LS_TAUNTAUN_ATTACK_RIGHT:
+			case LS_TAUNTAUN_ATTACK_LEFT:
+			case LS_STABDOWN:
+			case LS_STABDOWN_STAFF:
+			case LS_STABDOWN_DUAL:
+			case LS_DUAL_SPIN_PROTECT:
+			case LS_STAFF_SOULCAL:
+			case LS_A1_SPECIAL:
+			case LS_A2_SPECIAL:
+			case LS_A3_SPECIAL:
+			case LS_UPSIDE_DOWN_ATTACK:
+			case LS_PULL_ATTACK_STAB:
+			case LS_PULL_ATTACK_SWING:
+			case LS_SPINATTACK_ALORA:
+			case LS_DUAL_FB:
+			case LS_DUAL_LR:
+			case LS_HILT_BASH:
+			case LS_SLAP_R:
+			case LS_SLAP_L:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_SaberInTransition( int move )
+		{
+			if ( move >= LS_T1_BR__R && move <= LS_T1_BL__L )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInStart( int move )
+		{
+			if ( move >= LS_S_TL2BR && move <= LS_S_T2B )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInReturn( int move )
+		{
+			if ( move >= LS_R_TL2BR && move <= LS_R_T2B )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInTransitionAny( int move )
+		{
+			if ( PM_SaberInStart( move ) )
+			{
+				return true;
+			}
+			else if ( PM_SaberInTransition( move ) )
+			{
+				return true;
+			}
+			else if ( PM_SaberInReturn( move ) )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInBounce( int move )
+		{
+			if ( move >= LS_B1_BR && move <= LS_B1_BL )
+			{
+				return true;
+			}
+			if ( move >= LS_D1_BR && move <= LS_D1_BL )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInBrokenParry( int move )
+		{
+			if ( move >= LS_V1_BR && move <= LS_V1_B_ )
+			{
+				return true;
+			}
+			if ( move >= LS_H1_T_ && move <= LS_H1_BL )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInDeflect( int move )
+		{
+			if ( move >= LS_D1_BR && move <= LS_D1_B_ )
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInParry( int move )
+		{
+			switch (move)
+			{
+			case LS_PARRY_UP:
+			case LS_PARRY_UR:
+			case LS_PARRY_UL:
+			case LS_PARRY_LR:
+			case LS_PARRY_LL:
+			case LS_PARRY_UP_MD:
+			case LS_PARRY_UR_MD:
+			case LS_PARRY_UL_MD:
+			case LS_PARRY_LR_MD:
+			case LS_PARRY_LL_MD:
+			case LS_PARRY_BACK:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_SaberInKnockaway( int move )
+		{
+			switch (move)
+			{
+			case LS_K1_T_:
+			case LS_K1_TR:
+			case LS_K1_TR_MD:
+			case LS_K1_TR_PB:
+			case LS_K1_TL:
+			case LS_K1_TL_MD:
+			case LS_K1_TL_PB:
+			case LS_K1_BR:
+			case LS_K1_BL:
+				//
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInReflect( int move )
+		{
+			switch (move)
+			{
+			case LS_REFLECT_UP:
+			case LS_REFLECT_UR:
+			case LS_REFLECT_UL:
+			case LS_REFLECT_LR:
+			case LS_REFLECT_LL:
+			case LS_REFLECT_UP_MD:
+			case LS_REFLECT_UR_MD:
+			case LS_REFLECT_UL_MD:
+			case LS_REFLECT_LR_MD:
+			case LS_REFLECT_LL_MD:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_SaberInSpecial( int move )
+		{
+			switch( move )
+			{
+			case LS_A_BACK:
+			case LS_A_BACK_CR:
+			case LS_A_BACKSTAB:
+			case LS_ROLL_STAB:
+			case LS_A_LUNGE:
+			case LS_A_JUMP_T__B_:
+			case LS_A_FLIP_STAB:
+			case LS_A_FLIP_SLASH:
+			case LS_JUMPATTACK_DUAL:
+			case LS_JUMPATTACK_ARIAL_LEFT:
+			case LS_JUMPATTACK_ARIAL_RIGHT:
+			case LS_JUMPATTACK_CART_LEFT:
+			case LS_JUMPATTACK_CART_RIGHT:
+			case LS_JUMPATTACK_STAFF_LEFT:
+			case LS_JUMPATTACK_STAFF_RIGHT:
+			case LS_BUTTERFLY_LEFT:
+			case LS_BUTTERFLY_RIGHT:
+			case LS_A_BACKFLIP_ATK:
+			case LS_SPINATTACK_DUAL:
+			case LS_SPINATTACK:
+			case LS_LEAP_ATTACK:
+			case LS_SWOOP_ATTACK_RIGHT:
+			case LS_SWOOP_ATTACK_LEFT:
+			case LS_TAUNTAUN_ATTACK_RIGHT:
+			case LS_TAUNTAUN_ATTACK_LEFT:
+			case LS_KICK_F:
+			case LS_KICK_F_MD:
+			case LS_KICK_B:
+			case LS_KICK_SWEEP:
+			case LS_KICK_R:
+			case LS_SMACK_R:
+			case LS_KICK_L:
+			case LS_SMACK_L:
+			case LS_KICK_S:
+			case LS_KICK_BF:
+			case LS_KICK_RL:
+			case LS_KICK_F_AIR:
+			case LS_FLYING_KICK:
+			case LS_KICK_B_AIR:
+			case LS_KICK_R_AIR:
+			case LS_KICK_L_AIR:
+			case LS_STABDOWN:
+			case LS_STABDOWN_STAFF:
+			case LS_STABDOWN_DUAL:
+			case LS_DUAL_SPIN_PROTECT:
+			case LS_STAFF_SOULCAL:
+			case LS_A1_SPECIAL:
+			case LS_A2_SPECIAL:
+			case LS_A3_SPECIAL:
+			case LS_UPSIDE_DOWN_ATTACK:
+			case LS_PULL_ATTACK_STAB:
+			case LS_PULL_ATTACK_SWING:
+			case LS_SPINATTACK_ALORA:
+			case LS_DUAL_FB:
+			case LS_DUAL_LR:
+			case LS_HILT_BASH:
+			case LS_SLAP_R:
+			case LS_SLAP_L:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInIdle( int move )
+		{
+			switch ( move )
+			{
+			case LS_NONE:
+			case LS_READY:
+			case LS_DRAW:
+			case LS_PUTAWAY:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_KickMove( int move )
+		{
+			switch( move )
+			{
+			case LS_KICK_F:
+			case LS_KICK_F_MD:
+			case LS_KICK_B:
+			case LS_KICK_SWEEP:
+			case LS_KICK_R:
+			case LS_SMACK_R:
+			case LS_KICK_L:
+			case LS_SMACK_L:
+			case LS_KICK_S:
+			case LS_KICK_BF:
+			case LS_KICK_RL:
+			case LS_HILT_BASH:
+			case LS_SLAP_R:
+			case LS_SLAP_L:
+			case LS_KICK_F_AIR:
+			case LS_FLYING_KICK:
+			case LS_KICK_B_AIR:
+			case LS_KICK_R_AIR:
+			case LS_KICK_L_AIR:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberDoDamageAnim(int anim)
+		{
+			switch (anim)
+			{
+			case BOTH_A2_STABBACK1:
+			case BOTH_ATTACK_BACK:
+			case BOTH_CROUCHATTACKBACK1:
+			case BOTH_ROLL_STAB:
+			case BOTH_BUTTERFLY_LEFT:
+			case BOTH_BUTTERFLY_RIGHT:
+			case BOTH_BUTTERFLY_FL1:
+			case BOTH_BUTTERFLY_FR1:
+			case BOTH_FJSS_TR_BL:
+			case BOTH_FJSS_TL_BR:
+			case BOTH_LUNGE2_B__T_:
+			case BOTH_FORCELEAP2_T__B_:
+			case BOTH_JUMPFLIPSLASHDOWN1://#
+			case BOTH_JUMPFLIPSTABDOWN://#
+			case BOTH_JUMPATTACK6:
+			case BOTH_JUMPATTACK7:
+			case BOTH_SPINATTACK6:
+			case BOTH_SPINATTACK7:
+			case BOTH_FORCELONGLEAP_ATTACK:
+			case BOTH_VS_ATR_S:
+			case BOTH_VS_ATL_S:
+			case BOTH_VT_ATR_S:
+			case BOTH_VT_ATL_S:
+			case BOTH_STABDOWN:
+			case BOTH_STABDOWN_STAFF:
+			case BOTH_STABDOWN_DUAL:
+			case BOTH_A6_SABERPROTECT:
+			case BOTH_A7_SOULCAL:
+			case BOTH_A1_SPECIAL:
+			case BOTH_A2_SPECIAL:
+			case BOTH_A3_SPECIAL:
+			case BOTH_FLIP_ATTACK7:
+			case BOTH_PULL_IMPALE_STAB:
+			case BOTH_PULL_IMPALE_SWING:
+			case BOTH_ALORA_SPIN_SLASH:
+			case BOTH_A6_FB:
+			case BOTH_A6_LR:
+			case BOTH_A7_HILT:
+			case BOTH_SLAP_L:
+			case BOTH_SLAP_R:
+			case BOTH_LK_S_DL_S_SB_1_W:
+			case BOTH_LK_S_DL_T_SB_1_W:
+			case BOTH_LK_S_ST_S_SB_1_W:
+			case BOTH_LK_S_ST_T_SB_1_W:
+			case BOTH_LK_S_S_S_SB_1_W:
+			case BOTH_LK_S_S_T_SB_1_W:
+			case BOTH_LK_DL_DL_S_SB_1_W:
+			case BOTH_LK_DL_DL_T_SB_1_W:
+			case BOTH_LK_DL_ST_S_SB_1_W:
+			case BOTH_LK_DL_ST_T_SB_1_W:
+			case BOTH_LK_DL_S_S_SB_1_W:
+			case BOTH_LK_DL_S_T_SB_1_W:
+			case BOTH_LK_ST_DL_S_SB_1_W:
+			case BOTH_LK_ST_DL_T_SB_1_W:
+			case BOTH_LK_ST_ST_S_SB_1_W:
+			case BOTH_LK_ST_ST_T_SB_1_W:
+			case BOTH_LK_ST_S_S_SB_1_W:
+			case BOTH_LK_ST_S_T_SB_1_W:
+			case BOTH_HANG_ATTACK:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInSpecialAttack( int anim )
+		{
+			switch ( anim )
+			{
+			case BOTH_A2_STABBACK1:
+			case BOTH_ATTACK_BACK:
+			case BOTH_CROUCHATTACKBACK1:
+			case BOTH_ROLL_STAB:
+			case BOTH_BUTTERFLY_LEFT:
+			case BOTH_BUTTERFLY_RIGHT:
+			case BOTH_BUTTERFLY_FL1:
+			case BOTH_BUTTERFLY_FR1:
+			case BOTH_FJSS_TR_BL:
+			case BOTH_FJSS_TL_BR:
+			case BOTH_LUNGE2_B__T_:
+			case BOTH_FORCELEAP2_T__B_:
+			case BOTH_JUMPFLIPSLASHDOWN1://#
+			case BOTH_JUMPFLIPSTABDOWN://#
+			case BOTH_JUMPATTACK6:
+			case BOTH_JUMPATTACK7:
+			case BOTH_SPINATTACK6:
+			case BOTH_SPINATTACK7:
+			case BOTH_FORCELONGLEAP_ATTACK:
+			case BOTH_VS_ATR_S:
+			case BOTH_VS_ATL_S:
+			case BOTH_VT_ATR_S:
+			case BOTH_VT_ATL_S:
+			case BOTH_A7_KICK_F:
+			case BOTH_KICK_F_MD:
+			case BOTH_A7_KICK_B:
+			case BOTH_SWEEP_KICK:
+			case BOTH_A7_KICK_R:
+			case BOTH_A7_KICK_L:
+			case BOTH_A7_KICK_S:
+			case BOTH_A7_KICK_BF:
+			case BOTH_A7_KICK_RL:
+			case BOTH_A7_KICK_F_AIR:
+			case BOTH_FLYING_KICK:
+			case BOTH_A7_KICK_B_AIR:
+			case BOTH_A7_KICK_R_AIR:
+			case BOTH_A7_KICK_L_AIR:
+			case BOTH_STABDOWN:
+			case BOTH_STABDOWN_STAFF:
+			case BOTH_STABDOWN_DUAL:
+			case BOTH_A6_SABERPROTECT:
+			case BOTH_A7_SOULCAL:
+			case BOTH_A1_SPECIAL:
+			case BOTH_A2_SPECIAL:
+			case BOTH_A3_SPECIAL:
+			case BOTH_FLIP_ATTACK7:
+			case BOTH_PULL_IMPALE_STAB:
+			case BOTH_PULL_IMPALE_SWING:
+			case BOTH_ALORA_SPIN_SLASH:
+			case BOTH_A6_FB:
+			case BOTH_A6_LR:
+			case BOTH_A7_HILT:
+			case BOTH_SLAP_L:
+			case BOTH_SLAP_R:
+			case BOTH_A7_SLAP_R:
+			case BOTH_A7_SLAP_L:
+			case BOTH_LK_S_DL_S_SB_1_W:
+			case BOTH_LK_S_DL_T_SB_1_W:
+			case BOTH_LK_S_ST_S_SB_1_W:
+			case BOTH_LK_S_ST_T_SB_1_W:
+			case BOTH_LK_S_S_S_SB_1_W:
+			case BOTH_LK_S_S_T_SB_1_W:
+			case BOTH_LK_DL_DL_S_SB_1_W:
+			case BOTH_LK_DL_DL_T_SB_1_W:
+			case BOTH_LK_DL_ST_S_SB_1_W:
+			case BOTH_LK_DL_ST_T_SB_1_W:
+			case BOTH_LK_DL_S_S_SB_1_W:
+			case BOTH_LK_DL_S_T_SB_1_W:
+			case BOTH_LK_ST_DL_S_SB_1_W:
+			case BOTH_LK_ST_DL_T_SB_1_W:
+			case BOTH_LK_ST_ST_S_SB_1_W:
+			case BOTH_LK_ST_ST_T_SB_1_W:
+			case BOTH_LK_ST_S_S_SB_1_W:
+			case BOTH_LK_ST_S_T_SB_1_W:
+			case BOTH_HANG_ATTACK:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_SaberInnonblockableAttack(int anim)
+		{
+			switch (anim)
+			{
+			case BOTH_ATTACK_BACK:
+			case BOTH_A2_STABBACK1:
+			case BOTH_CROUCHATTACKBACK1:
+			case BOTH_BUTTERFLY_LEFT:
+			case BOTH_BUTTERFLY_RIGHT:
+			case BOTH_BUTTERFLY_FL1:
+			case BOTH_BUTTERFLY_FR1:
+			case BOTH_FJSS_TR_BL:
+			case BOTH_FJSS_TL_BR:
+			case BOTH_FORCELEAP2_T__B_:
+			case BOTH_JUMPFLIPSLASHDOWN1://#
+			case BOTH_JUMPFLIPSTABDOWN://#
+			case BOTH_JUMPATTACK6:
+			case BOTH_JUMPATTACK7:
+			case BOTH_SPINATTACK6:
+			case BOTH_SPINATTACK7:
+			case BOTH_FORCELONGLEAP_ATTACK:
+			case BOTH_STABDOWN:
+			case BOTH_STABDOWN_STAFF:
+			case BOTH_STABDOWN_DUAL:
+			case BOTH_A6_SABERPROTECT:
+			case BOTH_A7_SOULCAL:
+			case BOTH_A1_SPECIAL:
+			case BOTH_A2_SPECIAL:
+			case BOTH_A3_SPECIAL:
+			case BOTH_FLIP_ATTACK7:
+			case BOTH_PULL_IMPALE_STAB:
+			case BOTH_PULL_IMPALE_SWING:
+			case BOTH_ALORA_SPIN_SLASH:
+			case BOTH_A6_FB:
+			case BOTH_A6_LR:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_BounceAnim(int anim)
+		{//check for saber bounce animation
+			if ((anim >= BOTH_B1_BR___ && anim <= BOTH_B1_BL___)
+				|| (anim >= BOTH_B2_BR___ && anim <= BOTH_B2_BL___)
+				|| (anim >= BOTH_B3_BR___ && anim <= BOTH_B3_BL___)
+				|| (anim >= BOTH_B4_BR___ && anim <= BOTH_B4_BL___)
+				|| (anim >= BOTH_B5_BR___ && anim <= BOTH_B5_BL___)
+				|| (anim >= BOTH_B6_BR___ && anim <= BOTH_B6_BL___)
+				|| (anim >= BOTH_B7_BR___ && anim <= BOTH_B7_BL___))
+			{
+				return true;
+			}
+
+			return false;
+		}
+
+		bool PM_SaberReturnAnim(int anim)
+		{
+			if ((anim >= BOTH_R1_B__S1 && anim <= BOTH_R1_TR_S1)
+				|| (anim >= BOTH_R2_B__S1 && anim <= BOTH_R2_TR_S1)
+				|| (anim >= BOTH_R3_B__S1 && anim <= BOTH_R3_TR_S1)
+				|| (anim >= BOTH_R4_B__S1 && anim <= BOTH_R4_TR_S1)
+				|| (anim >= BOTH_R5_B__S1 && anim <= BOTH_R5_TR_S1)
+				|| (anim >= BOTH_R6_B__S6 && anim <= BOTH_R6_TR_S6)
+				|| (anim >= BOTH_R7_B__S7 && anim <= BOTH_R7_TR_S7))
+			{
+				return true;
+			}
+			return false;
+		}
+
+		bool BG_HopAnim(int anim)
+		{//check to see if anim is a hop animation.
+
+			switch (anim)
+			{
+			case BOTH_HOP_F:
+			case BOTH_HOP_R:
+			case BOTH_HOP_L:
+			case BOTH_HOP_B:
+			case BOTH_DASH_F:
+			case BOTH_DASH_R:
+			case BOTH_DASH_L:
+			case BOTH_DASH_B:
+				return true;
+			}
+			return false;
+		}
+
+		bool PM_RollingAnim( int anim )
+		{
+			switch ( anim )
+			{
+			case BOTH_ROLL_F:			//# Roll forward
+			case BOTH_ROLL_B:			//# Roll backward
+			case BOTH_ROLL_L:			//# Roll left
+			case BOTH_ROLL_R:			//# Roll right
+			case BOTH_GETUP_BROLL_B:
+			case BOTH_GETUP_BROLL_F:
+			case BOTH_GETUP_BROLL_L:
+			case BOTH_GETUP_BROLL_R:
+			case BOTH_GETUP_FROLL_B:
+			case BOTH_GETUP_FROLL_F:
+			case BOTH_GETUP_FROLL_L:
+			case BOTH_GETUP_FROLL_R:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool BG_InKnockDown(int anim)
+		{
+			switch ((anim))
+			{
+			case BOTH_KNOCKDOWN1:
+			case BOTH_KNOCKDOWN2:
+			case BOTH_KNOCKDOWN3:
+			case BOTH_KNOCKDOWN4:
+			case BOTH_KNOCKDOWN5:
+			case BOTH_SLAPDOWNRIGHT:
+			case BOTH_SLAPDOWNLEFT:
+				return true;
+				break;
+			case BOTH_GETUP1:
+			case BOTH_GETUP2:
+			case BOTH_GETUP3:
+			case BOTH_GETUP4:
+			case BOTH_GETUP5:
+			case BOTH_FORCE_GETUP_F1:
+			case BOTH_FORCE_GETUP_F2:
+			case BOTH_FORCE_GETUP_B1:
+			case BOTH_FORCE_GETUP_B2:
+			case BOTH_FORCE_GETUP_B3:
+			case BOTH_FORCE_GETUP_B4:
+			case BOTH_FORCE_GETUP_B5:
+			case BOTH_GETUP_BROLL_B:
+			case BOTH_GETUP_BROLL_F:
+			case BOTH_GETUP_BROLL_L:
+			case BOTH_GETUP_BROLL_R:
+			case BOTH_GETUP_FROLL_B:
+			case BOTH_GETUP_FROLL_F:
+			case BOTH_GETUP_FROLL_L:
+			case BOTH_GETUP_FROLL_R:
+				return true;
+				break;
+			}
+			return false;
+		}
+
+		bool PM_InGetUp( playerState_t *ps )
+		{
+			switch ( ps->legsAnim )
+			{
+			case BOTH_GETUP1:
+			case BOTH_GETUP2:
+			case BOTH_GETUP3:
+			case BOTH_GETUP4:
+			case BOTH_GETUP5:
+			case BOTH_GETUP_CROUCH_F1:
+			case BOTH_GETUP_CROUCH_B1:
+			case BOTH_GETUP_BROLL_B:
+			case BOTH_GETUP_BROLL_F:
+			case BOTH_GETUP_BROLL_L:
+			case BOTH_GETUP_BROLL_R:
+			case BOTH_GETUP_FROLL_B:
+			case BOTH_GETUP_FROLL_F:
+			case BOTH_GETUP_FROLL_L:
+			case BOTH_GETUP_FROLL_R:
+				if ( ps->legsAnimTimer )
+				{
+					return true;
+				}
+				break;
+			default:
+				return inForceGetUp( ps );
+				break;
+			}
+			//what the hell, redundant, but...
+			return false;
+		}
+
+		bool PM_InKnockDown( playerState_t *ps )
+		{
+			switch ( ps->legsAnim )
+			{
+			case BOTH_KNOCKDOWN1:
+			case BOTH_KNOCKDOWN2:
+			case BOTH_KNOCKDOWN3:
+			case BOTH_KNOCKDOWN4:
+			case BOTH_KNOCKDOWN5:
+			case BOTH_SLAPDOWNRIGHT:
+			case BOTH_SLAPDOWNLEFT:
+			//special anims:
+			case BOTH_RELEASED:
+				return true;
+				break;
+			case BOTH_LK_DL_ST_T_SB_1_L:
+				if ( ps->legsAnimTimer < 550 )
+				{
+					return true;
+				}
+				break;
+			case BOTH_PLAYER_PA_3_FLY:
+				if ( ps->legsAnimTimer < 300 )
+				{
+					return true;
+				}
+				break;
+			default:
+				return PM_InGetUp( ps );
+				break;
+			}
+			return false;
+		}
+	}
+
+	struct ClassCheck
+	{
+		const char* name;
+		bool( *reference )( int );
+		std::uint32_t classes;
+	};
+
+	/// Every id with a few out of range ones on either side
+	template< typename Fn >
+	void forEachId( const int count, Fn fn )
+	{
+		for( int id = -2; id < count + 2; ++id )
+		{
+			fn( id );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( animclass )
+
+BOOST_AUTO_TEST_CASE( saber_moves_match_reference )
+{
+	const ClassCheck checks[] = {
+		{ "PM_SaberInAttack", reference::PM_SaberInAttack, SMC_ATTACK },
+		{ "PM_SaberInAttackPure", reference::PM_SaberInAttackPure, SMC_ATTACK_PURE },
+		{ "PM_SaberInDamageMove", reference::PM_SaberInDamageMove, SMC_DAMAGE },
+		{ "PM_SaberInTransition", reference::PM_SaberInTransition, SMC_TRANSITION },
+		{ "PM_SaberInStart", reference::PM_SaberInStart, SMC_START },
+		{ "PM_SaberInReturn", reference::PM_SaberInReturn, SMC_RETURN },
+		{ "PM_SaberInBounce", reference::PM_SaberInBounce, SMC_BOUNCE },
+		{ "PM_SaberInBrokenParry", reference::PM_SaberInBrokenParry, SMC_BROKEN_PARRY },
+		{ "PM_SaberInDeflect", reference::PM_SaberInDeflect, SMC_DEFLECT },
+		{ "PM_SaberInParry", reference::PM_SaberInParry, SMC_PARRY },
+		{ "PM_SaberInKnockaway", reference::PM_SaberInKnockaway, SMC_KNOCKAWAY },
+		{ "PM_SaberInReflect", reference::PM_SaberInReflect, SMC_REFLECT },
+		{ "PM_SaberInSpecial", reference::PM_SaberInSpecial, SMC_SPECIAL },
+		{ "PM_SaberInIdle", reference::PM_SaberInIdle, SMC_IDLE },
+		{ "PM_KickMove", reference::PM_KickMove, SMC_KICK },
+		{ "PM_SaberInTransitionAny", reference::PM_SaberInTransitionAny, SMC_START | SMC_TRANSITION | SMC_RETURN },
+	};
+	for( const ClassCheck& check : checks )
+	{
+		forEachId( LS_MOVE_MAX, [ &check ]( const int move ) {
+			BOOST_CHECK_MESSAGE( BG_SaberMoveInClasses( move, check.classes ) == check.reference( move ), check.name << "( " << move << " )" );
+		} );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( anims_match_reference )
+{
+	const ClassCheck checks[] = {
+		{ "PM_SaberDoDamageAnim", reference::PM_SaberDoDamageAnim, AC_SABER_DAMAGE },
+		{ "PM_SaberInSpecialAttack", reference::PM_SaberInSpecialAttack, AC_SABER_SPECIAL_ATTACK },
+		{ "PM_SaberInnonblockableAttack", reference::PM_SaberInnonblockableAttack, AC_SABER_NONBLOCKABLE },
+		{ "PM_BounceAnim", reference::PM_BounceAnim, AC_SABER_BOUNCE },
+		{ "PM_SaberReturnAnim", reference::PM_SaberReturnAnim, AC_SABER_RETURN },
+		{ "BG_HopAnim", reference::BG_HopAnim, AC_HOP },
+		{ "PM_RollingAnim", reference::PM_RollingAnim, AC_ROLLING },
+		{ "BG_InKnockDown", reference::BG_InKnockDown, AC_KNOCKDOWN },
+	};
+	for( const ClassCheck& check : checks )
+	{
+		forEachId( MAX_ANIMATIONS, [ &check ]( const int anim ) {
+			BOOST_CHECK_MESSAGE( BG_AnimInClasses( anim, check.classes ) == check.reference( anim ), check.name << "( " << anim << " )" );
+		} );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( knockdowns_match_reference )
+{
+	forEachId( MAX_ANIMATIONS, []( const int anim ) {
+		// the timer only matters for getups and the two timed knockdowns, which stay in the switch
+		playerState_t ps = { anim, 1000 };
+		BOOST_CHECK_MESSAGE( BG_AnimInClasses( anim, AC_GETUP ) == reference::PM_InGetUp( &ps ), "PM_InGetUp( " << anim << " )" );
+		const bool timed = anim == BOTH_LK_DL_ST_T_SB_1_L || anim == BOTH_PLAYER_PA_3_FLY;
+		if( !timed )
+		{
+			BOOST_CHECK_MESSAGE( BG_AnimInClasses( anim, AC_KNOCKED_DOWN | AC_GETUP ) == reference::PM_InKnockDown( &ps ), "PM_InKnockDown( " << anim << " )" );
+		}
+		BOOST_CHECK( !( timed && BG_AnimInClasses( anim, AC_KNOCKED_DOWN ) ) );
+
+		ps.legsAnimTimer = 0;
+		BOOST_CHECK( !reference::PM_InGetUp( &ps ) );
+	} );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
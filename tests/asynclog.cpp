@@ -0,0 +1,131 @@
+#include "qcommon/q_asynclog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	std::string readFile( const std::string& path )
+	{
+		std::ifstream in( path, std::ios::binary );
+		std::ostringstream contents;
+		contents << in.rdbuf();
+		return contents.str();
+	}
+
+	void removeLogs( const std::string& path, int rotated )
+	{
+		std::remove( path.c_str() );
+		for( int i = 1; i <= rotated; ++i )
+		{
+			std::remove( ( path + "." + std::to_string( i ) ).c_str() );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( asynclog )
+
+BOOST_AUTO_TEST_CASE( keeps_order_and_flushes )
+{
+	const std::string path = "asynclog_order.log";
+	removeLogs( path, 0 );
+	{
+		Q::AsyncLog log( std::fopen( path.c_str(), "wb" ), path, Q::AsyncLog::Options() );
+		std::string expected;
+		for( int i = 0; i < 1000; ++i )
+		{
+			const std::string line = std::to_string( i ) + "\n";
+			log.write( line.data(), line.size() );
+			expected += line;
+		}
+		log.flush();
+		BOOST_CHECK( readFile( path ) == expected );
+	}
+	removeLogs( path, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( drains_on_destruction )
+{
+	const std::string path = "asynclog_drain.log";
+	removeLogs( path, 0 );
+	{
+		Q::AsyncLog::Options options;
+		options.flushMilliseconds = 60 * 1000;
+		Q::AsyncLog log( std::fopen( path.c_str(), "wb" ), path, options );
+		log.write( "tail", 4 );
+	}
+	BOOST_CHECK_EQUAL( readFile( path ), "tail" );
+	removeLogs( path, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( multiple_producers )
+{
+	const std::string path = "asynclog_producers.log";
+	removeLogs( path, 0 );
+	const int threads = 4;
+	const int lines = 2000;
+	{
+		Q::AsyncLog::Options options;
+		options.flushBytes = 256;
+		Q::AsyncLog log( std::fopen( path.c_str(), "wb" ), path, options );
+		std::vector< std::thread > producers;
+		for( int t = 0; t < threads; ++t )
+		{
+			producers.emplace_back( [ &log, t ]
+			{
+				for( int i = 0; i < lines; ++i )
+				{
+					const std::string line = std::to_string( t ) + " " + std::to_string( i ) + "\n";
+					log.write( line.data(), line.size() );
+				}
+			} );
+		}
+		for( std::thread& producer : producers )
+		{
+			producer.join();
+		}
+	}
+
+	// every line arrives whole, and each thread's lines stay in order
+	std::istringstream in( readFile( path ) );
+	std::vector< int > next( threads, 0 );
+	int t, i, total = 0;
+	while( in >> t >> i )
+	{
+		BOOST_REQUIRE( t >= 0 && t < threads );
+		BOOST_CHECK_EQUAL( i, next[ t ] );
+		next[ t ] = i + 1;
+		++total;
+	}
+	BOOST_CHECK_EQUAL( total, threads * lines );
+	removeLogs( path, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( rotates_when_full )
+{
+	const std::string path = "asynclog_rotate.log";
+	removeLogs( path, 3 );
+	{
+		Q::AsyncLog::Options options;
+		options.rotateBytes = 10;
+		options.rotateCount = 2;
+		Q::AsyncLog log( std::fopen( path.c_str(), "wb" ), path, options );
+		for( char c : std::string( "abcd" ) )
+		{
+			log.write( std::string( 8, c ).data(), 8 );
+		}
+	}
+	BOOST_CHECK_EQUAL( readFile( path ), std::string( 8, 'd' ) );
+	BOOST_CHECK_EQUAL( readFile( path + ".1" ), std::string( 8, 'c' ) );
+	BOOST_CHECK_EQUAL( readFile( path + ".2" ), std::string( 8, 'b' ) );
+	BOOST_CHECK( !std::ifstream( path + ".3" ) );
+	removeLogs( path, 3 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
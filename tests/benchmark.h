@@ -0,0 +1,27 @@
+#pragma once
+
+#include <chrono>
+
+#include <boost/test/unit_test.hpp>
+
+/**
+Benchmarks aren't correctness checks, so they're disabled and only run when asked for by name, e.g.
+UnitTests --run_test=skinning/benchmark --log_level=message
+*/
+#define BENCHMARK_TEST_CASE( name ) BOOST_AUTO_TEST_CASE( name, *boost::unit_test::disabled() )
+
+namespace Benchmark
+{
+	/// How long calling f iterations times takes
+	template< typename F >
+	long long microseconds( int iterations, F&& f )
+	{
+		typedef std::chrono::steady_clock clock;
+		const auto start = clock::now();
+		for( int i = 0; i < iterations; ++i )
+		{
+			f();
+		}
+		return std::chrono::duration_cast< std::chrono::microseconds >( clock::now() - start ).count();
+	}
+}
@@ -0,0 +1,230 @@
+#include "qcommon/q_dlight.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	struct Scene
+	{
+		Scene( std::size_t numVertexes, std::size_t numLights ) : xyz( numVertexes ), lights( numLights ) {}
+
+		std::vector< float[ 4 ] > xyz;
+		std::vector< float[ 4 ] > lights;
+	};
+
+	Scene makeScene( std::size_t numVertexes, std::size_t numLights )
+	{
+		std::mt19937 random( 1234 );
+		std::uniform_real_distribution< float > coord( -256.0f, 256.0f );
+		std::uniform_real_distribution< float > radius( 16.0f, 200.0f );
+		Scene scene( numVertexes, numLights );
+		for( auto& v : scene.xyz )
+		{
+			v[ 0 ] = coord( random );
+			v[ 1 ] = coord( random );
+			v[ 2 ] = coord( random );
+			v[ 3 ] = 0.0f;
+		}
+		for( auto& l : scene.lights )
+		{
+			l[ 0 ] = coord( random );
+			l[ 1 ] = coord( random );
+			l[ 2 ] = coord( random );
+			l[ 3 ] = radius( random );
+		}
+		return scene;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( dlight )
+
+BOOST_AUTO_TEST_CASE( clip_codes_match_reference )
+{
+	for( std::size_t numLights = 0; numLights <= Q::DLIGHT_CLIP_MAX_LIGHTS; ++numLights )
+	{
+		Scene scene = makeScene( 97, numLights );
+		if( numLights > 1 )
+		{
+			// vertexes exactly on the edge of a light's box
+			scene.xyz[ 0 ][ 0 ] = scene.lights[ 1 ][ 0 ] + scene.lights[ 1 ][ 3 ];
+			scene.xyz[ 1 ][ 1 ] = scene.lights[ 1 ][ 1 ] - scene.lights[ 1 ][ 3 ];
+		}
+		const std::size_t stride = 100;
+		std::vector< std::uint8_t > reference( stride * numLights, 0xff ), simd( stride * numLights, 0xff );
+		const std::uint32_t referenceReached = Q::dlightClipCodesReference( scene.xyz.data(), scene.xyz.size(), scene.lights.data(), numLights, reference.data(), stride );
+		const std::uint32_t simdReached = Q::dlightClipCodes( scene.xyz.data(), scene.xyz.size(), scene.lights.data(), numLights, simd.data(), stride );
+		BOOST_CHECK_EQUAL( referenceReached, simdReached );
+		BOOST_CHECK( reference == simd );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( unreached_lights_are_dropped )
+{
+	Scene scene( 3, 2 );
+	const float triangle[ 3 ][ 3 ] = { { 0, 0, 0 }, { 10, 0, 0 }, { 0, 10, 0 } };
+	for( int v = 0; v < 3; ++v )
+	{
+		for( int k = 0; k < 3; ++k )
+		{
+			scene.xyz[ v ][ k ] = triangle[ v ][ k ];
+		}
+		scene.xyz[ v ][ 3 ] = 0;
+	}
+	// one light above the triangle, one too far away on x
+	const float lights[ 2 ][ 4 ] = { { 5, 5, 20, 32 }, { 100, 5, 0, 32 } };
+	for( int l = 0; l < 2; ++l )
+	{
+		for( int k = 0; k < 4; ++k )
+		{
+			scene.lights[ l ][ k ] = lights[ l ][ k ];
+		}
+	}
+	std::uint8_t codes[ 2 ][ 3 ];
+	BOOST_CHECK_EQUAL( Q::dlightClipCodes( scene.xyz.data(), 3, scene.lights.data(), 2, codes[ 0 ], 3 ), 1u );
+	BOOST_CHECK_EQUAL( codes[ 0 ][ 0 ], 0 );
+	BOOST_CHECK_EQUAL( codes[ 1 ][ 0 ], 2 );
+	BOOST_CHECK_EQUAL( codes[ 1 ][ 1 ], 2 );
+}
+
+namespace
+{
+	/// Looking down +x with a 90 degree field of view, left is +y and up is +z
+	Q::DlightClusterView makeView()
+	{
+		Q::DlightClusterView view = {
+			{ 0, 0, 0 },
+			{ { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } },
+			1.0f, 1.0f,
+			4.0f, 4096.0f
+		};
+		return view;
+	}
+
+	std::uint32_t boxBits( const Q::DlightClusters& clusters, float x0, float y0, float z0, float x1, float y1, float z1 )
+	{
+		const float mins[ 3 ] = { x0, y0, z0 };
+		const float maxs[ 3 ] = { x1, y1, z1 };
+		return Q::dlightClusterBits( clusters, mins, maxs );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( clusters_without_lights_are_empty )
+{
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), nullptr, 0 );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 100, -10, -10, 110, 10, 10 ), 0u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, -10, -10, -10, 10, 10, 10 ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( lights_behind_the_view_are_dropped )
+{
+	const float lights[ 1 ][ 4 ] = { { -100, 0, 0, 50 } };
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), lights, 1 );
+	for( int i = 0; i < Q::DLIGHT_CLUSTER_COLUMNS; ++i )
+	{
+		BOOST_CHECK_EQUAL( clusters.columns[ i ], 0u );
+	}
+	BOOST_CHECK_EQUAL( boxBits( clusters, 10, -10, -10, 20, 10, 10 ), 0u );
+	// boxes behind the view never get a light, even one that's there too
+	BOOST_CHECK_EQUAL( boxBits( clusters, -110, -10, -10, -90, 10, 10 ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( cells_between_lights_stay_empty )
+{
+	// one light far left, one far right
+	const float lights[ 2 ][ 4 ] = { { 100, 80, 0, 10 }, { 100, -80, 0, 10 } };
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), lights, 2 );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, -1, -1, 101, 1, 1 ), 0u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, 79, -1, 101, 81, 1 ), 1u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, -81, -1, 101, -79, 1 ), 2u );
+	// right direction, wrong depth
+	BOOST_CHECK_EQUAL( boxBits( clusters, 1000, 790, -10, 1010, 810, 10 ), 0u );
+	// a box across the view gets both
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, -81, -1, 101, 81, 1 ), 3u );
+}
+
+BOOST_AUTO_TEST_CASE( lights_on_cell_boundaries_reach_both_cells )
+{
+	// straight ahead, on the boundary of the middle columns and rows
+	const float lights[ 1 ][ 4 ] = { { 100, 0, 0, 1 } };
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), lights, 1 );
+	const int column = Q::DLIGHT_CLUSTER_COLUMNS / 2;
+	const int row = Q::DLIGHT_CLUSTER_ROWS / 2;
+	BOOST_CHECK_EQUAL( clusters.columns[ column - 1 ], 1u );
+	BOOST_CHECK_EQUAL( clusters.columns[ column ], 1u );
+	BOOST_CHECK_EQUAL( clusters.columns[ column + 1 ], 0u );
+	BOOST_CHECK_EQUAL( clusters.rows[ row - 1 ], 1u );
+	BOOST_CHECK_EQUAL( clusters.rows[ row ], 1u );
+	BOOST_CHECK_EQUAL( clusters.rows[ row + 1 ], 0u );
+
+	// boxes just on either side of the boundary, and one well away from it
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, 5, -1, 101, 6, 1 ), 1u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, -6, -1, 101, -5, 1 ), 1u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, 60, -1, 101, 61, 1 ), 0u );
+	// a box edge exactly on the boundary
+	BOOST_CHECK_EQUAL( boxBits( clusters, 99, 0, -1, 101, 0.5f, 1 ), 1u );
+
+	// a light whose depth range ends exactly where the next slice starts
+	const Q::DlightClusterView view = makeView();
+	const float sliceStart = view.zNear * std::pow( view.zFar / view.zNear, 8.0f / Q::DLIGHT_CLUSTER_SLICES );
+	const float deep[ 1 ][ 4 ] = { { sliceStart - 8, 0, 0, 8 } };
+	Q::dlightClustersSetup( clusters, view, deep, 1 );
+	BOOST_CHECK_EQUAL( boxBits( clusters, sliceStart, -1, -1, sliceStart + 1, 1, 1 ), 1u );
+}
+
+BOOST_AUTO_TEST_CASE( lights_around_the_viewer_cover_every_direction )
+{
+	const float lights[ 1 ][ 4 ] = { { 0, 0, 0, 20 } };
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), lights, 1 );
+	for( int i = 0; i < Q::DLIGHT_CLUSTER_COLUMNS; ++i )
+	{
+		BOOST_CHECK_EQUAL( clusters.columns[ i ], 1u );
+	}
+	for( int i = 0; i < Q::DLIGHT_CLUSTER_ROWS; ++i )
+	{
+		BOOST_CHECK_EQUAL( clusters.rows[ i ], 1u );
+	}
+	// right beside the viewer, the box's tangents are huge
+	BOOST_CHECK_EQUAL( boxBits( clusters, 0.01f, 10, -1, 1, 11, 1 ), 1u );
+	BOOST_CHECK_EQUAL( boxBits( clusters, 1000, 500, -1, 1001, 501, 1 ), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( boxes_around_lights_always_get_them )
+{
+	std::mt19937 random( 1234 );
+	std::uniform_real_distribution< float > coord( -2000.0f, 2000.0f );
+	std::uniform_real_distribution< float > radius( 16.0f, 300.0f );
+	float lights[ Q::DLIGHT_CLIP_MAX_LIGHTS ][ 4 ];
+	for( auto& l : lights )
+	{
+		l[ 0 ] = coord( random );
+		l[ 1 ] = coord( random );
+		l[ 2 ] = coord( random );
+		l[ 3 ] = radius( random );
+	}
+	Q::DlightClusters clusters;
+	Q::dlightClustersSetup( clusters, makeView(), lights, Q::DLIGHT_CLIP_MAX_LIGHTS );
+	for( std::size_t l = 0; l < Q::DLIGHT_CLIP_MAX_LIGHTS; ++l )
+	{
+		const float* light = lights[ l ];
+		if( light[ 0 ] + light[ 3 ] <= 0 )
+		{
+			continue;
+		}
+		// on the far side of the light, which is always in front of the view
+		const float x = light[ 0 ] + light[ 3 ] * 0.5f;
+		const std::uint32_t bits = boxBits( clusters, x - 1, light[ 1 ] - 1, light[ 2 ] - 1, x + 1, light[ 1 ] + 1, light[ 2 ] + 1 );
+		BOOST_CHECK( bits & ( 1u << l ) );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
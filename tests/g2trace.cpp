@@ -0,0 +1,385 @@
+#include "qcommon/q_g2trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	/// A transformed surface laid out like R_TransformEachSurface leaves it: vertexes, then trace bounds
+	struct Surface
+	{
+		std::vector< float > verts;
+		/// three vertex indexes per triangle
+		std::vector< std::int32_t > indexes;
+		std::vector< float > bounds;
+
+		std::size_t numVerts() const
+		{
+			return verts.size() / Q::G2_TRACE_VERTEX_FLOATS;
+		}
+
+		int numTriangles() const
+		{
+			return static_cast< int >( indexes.size() / 3 );
+		}
+
+		const std::int32_t* triangle( int j ) const
+		{
+			return indexes.data() + j * 3;
+		}
+
+		const float* vertex( int index ) const
+		{
+			return verts.data() + index * Q::G2_TRACE_VERTEX_FLOATS;
+		}
+
+		void buildBounds()
+		{
+			bounds.assign( Q::g2TraceBoundsSize( numTriangles() ), 0.0f );
+			Q::g2TraceBuildBounds( verts.data(), reinterpret_cast< const std::int32_t( * )[ 3 ] >( indexes.data() ), numTriangles(), bounds.data() );
+		}
+	};
+
+	/**
+	A bumpy tube about the size of a limb, made of rows x columns quads.
+	With shuffle the triangles come in a random order, so the bounds of runs overlap a lot;
+	without it neighbouring triangles share a run.
+	*/
+	Surface makeTube( int rows, int columns, bool shuffle, unsigned int seed )
+	{
+		std::mt19937 random( seed );
+		std::uniform_real_distribution< float > bump( -0.5f, 0.5f );
+		Surface surface;
+		for( int row = 0; row <= rows; ++row )
+		{
+			for( int column = 0; column < columns; ++column )
+			{
+				const float angle = column * 6.2831853f / columns;
+				const float radius = 4.0f + bump( random );
+				const float vertex[ Q::G2_TRACE_VERTEX_FLOATS ] = { radius * std::cos( angle ), radius * std::sin( angle ), row * 2.0f + bump( random ), 0.0f, 0.0f };
+				surface.verts.insert( surface.verts.end(), vertex, vertex + Q::G2_TRACE_VERTEX_FLOATS );
+			}
+		}
+		for( int row = 0; row < rows; ++row )
+		{
+			for( int column = 0; column < columns; ++column )
+			{
+				const std::int32_t a = row * columns + column;
+				const std::int32_t b = row * columns + ( column + 1 ) % columns;
+				const std::int32_t c = a + columns;
+				const std::int32_t d = b + columns;
+				const std::int32_t quad[ 6 ] = { a, b, c, b, d, c };
+				surface.indexes.insert( surface.indexes.end(), quad, quad + 6 );
+			}
+		}
+		if( shuffle )
+		{
+			std::vector< int > order( surface.numTriangles() );
+			for( std::size_t i = 0; i < order.size(); ++i )
+			{
+				order[ i ] = static_cast< int >( i );
+			}
+			std::shuffle( order.begin(), order.end(), random );
+			std::vector< std::int32_t > shuffled;
+			for( const int j : order )
+			{
+				shuffled.insert( shuffled.end(), surface.triangle( j ), surface.triangle( j ) + 3 );
+			}
+			surface.indexes.swap( shuffled );
+		}
+		surface.buildBounds();
+		return surface;
+	}
+
+	/// What G2_TracePolys puts in a collision record, less the parts worked out from these
+	struct Hit
+	{
+		int triangle;
+		float face;
+		float point[ 3 ];
+
+		bool operator==( const Hit& other ) const
+		{
+			return triangle == other.triangle && face == other.face
+				&& point[ 0 ] == other.point[ 0 ] && point[ 1 ] == other.point[ 1 ] && point[ 2 ] == other.point[ 2 ];
+		}
+
+		bool operator!=( const Hit& other ) const
+		{
+			return !( *this == other );
+		}
+	};
+
+	std::ostream& operator<<( std::ostream& stream, const Hit& hit )
+	{
+		return stream << "triangle " << hit.triangle << " at " << hit.point[ 0 ] << " " << hit.point[ 1 ] << " " << hit.point[ 2 ];
+	}
+
+	/// The triangles of G2_TracePolys in order, with or without skipping what the bounds rule out
+	std::vector< Hit > segmentTrace( const Surface& surface, const float* start, const float* end, bool cull )
+	{
+		std::vector< Hit > hits;
+		if( cull && !Q::g2SegmentTouchesBounds( start, end, surface.bounds.data() ) )
+		{
+			return hits;
+		}
+		for( int j = 0; j < surface.numTriangles(); ++j )
+		{
+			if( cull && !( j % Q::G2_TRACE_CHUNK_TRIS ) && !Q::g2SegmentTouchesBounds( start, end, &surface.bounds[ 6 + ( j / Q::G2_TRACE_CHUNK_TRIS ) * 6 ] ) )
+			{
+				j += Q::G2_TRACE_CHUNK_TRIS - 1;
+				continue;
+			}
+			Hit hit;
+			float normal[ 3 ];
+			const std::int32_t* triangle = surface.triangle( j );
+			if( Q::g2SegmentTriangleTest( start, end, surface.vertex( triangle[ 0 ] ), surface.vertex( triangle[ 1 ] ), surface.vertex( triangle[ 2 ] ), true, true, hit.point, normal, &hit.face ) )
+			{
+				hit.triangle = j;
+				hits.push_back( hit );
+			}
+		}
+		return hits;
+	}
+
+	/// The box of a radius trace, set up like G2_RadiusTracePolys does
+	struct RadiusTrace
+	{
+		float start[ 3 ];
+		float saxis[ 3 ];
+		float taxis[ 3 ];
+		float rayDir[ 3 ];
+
+		RadiusTrace( const float* rayStart, const float* rayEnd, float radius )
+		{
+			float dir[ 3 ] = { rayEnd[ 0 ] - rayStart[ 0 ], rayEnd[ 1 ] - rayStart[ 1 ], rayEnd[ 2 ] - rayStart[ 2 ] };
+			float basis1[ 3 ], basis2[ 3 ] = { 0.0f, 0.0f, 1.0f };
+			cross( dir, basis2, basis1 );
+			if( dot( basis1, basis1 ) < .1f )
+			{
+				basis2[ 1 ] = 1.0f;
+				basis2[ 2 ] = 0.0f;
+				cross( dir, basis2, basis1 );
+			}
+			cross( dir, basis1, basis2 );
+			normalize( basis1 );
+			normalize( basis2 );
+			const float f = dot( dir, dir );
+			for( int i = 0; i < 3; ++i )
+			{
+				start[ i ] = rayStart[ i ];
+				taxis[ i ] = basis1[ i ] * ( 0.5f / radius );
+				saxis[ i ] = basis2[ i ] * ( 0.5f / radius );
+				rayDir[ i ] = dir[ i ] / f;
+			}
+		}
+
+		static float dot( const float* a, const float* b )
+		{
+			return a[ 0 ] * b[ 0 ] + a[ 1 ] * b[ 1 ] + a[ 2 ] * b[ 2 ];
+		}
+
+		static void cross( const float* a, const float* b, float* out )
+		{
+			out[ 0 ] = a[ 1 ] * b[ 2 ] - a[ 2 ] * b[ 1 ];
+			out[ 1 ] = a[ 2 ] * b[ 0 ] - a[ 0 ] * b[ 2 ];
+			out[ 2 ] = a[ 0 ] * b[ 1 ] - a[ 1 ] * b[ 0 ];
+		}
+
+		static void normalize( float* v )
+		{
+			const float length = std::sqrt( dot( v, v ) );
+			for( int i = 0; i < 3; ++i )
+			{
+				v[ i ] /= length;
+			}
+		}
+	};
+
+	/// The triangles G2_RadiusTracePolys records, in order
+	std::vector< int > radiusTrace( const Surface& surface, const RadiusTrace& trace, bool cull )
+	{
+		std::vector< int > hits;
+		if( cull && Q::g2BoundsOutsideRadiusTrace( surface.bounds.data(), trace.start, trace.saxis, trace.taxis, trace.rayDir ) )
+		{
+			return hits;
+		}
+		std::vector< int > outside( surface.numVerts() );
+		for( std::size_t i = 0; i < outside.size(); ++i )
+		{
+			outside[ i ] = Q::g2RadiusTraceOutside( surface.vertex( static_cast< int >( i ) ), trace.start, trace.saxis, trace.taxis, trace.rayDir );
+		}
+		for( int j = 0; j < surface.numTriangles(); ++j )
+		{
+			if( cull && !( j % Q::G2_TRACE_CHUNK_TRIS ) && Q::g2BoundsOutsideRadiusTrace( &surface.bounds[ 6 + ( j / Q::G2_TRACE_CHUNK_TRIS ) * 6 ], trace.start, trace.saxis, trace.taxis, trace.rayDir ) )
+			{
+				j += Q::G2_TRACE_CHUNK_TRIS - 1;
+				continue;
+			}
+			const std::int32_t* triangle = surface.triangle( j );
+			if( !( 63 & outside[ triangle[ 0 ] ] & outside[ triangle[ 1 ] ] & outside[ triangle[ 2 ] ] ) )
+			{
+				hits.push_back( j );
+			}
+		}
+		return hits;
+	}
+
+	/// A segment through a point of a random triangle, often right on one of its edges or corners
+	void aimAtSurface( const Surface& surface, std::mt19937& random, float* start, float* end )
+	{
+		std::uniform_int_distribution< int > pickTriangle( 0, surface.numTriangles() - 1 );
+		std::uniform_real_distribution< float > unit( -1.0f, 1.0f );
+		std::uniform_int_distribution< int > onEdge( 0, 3 );
+		const std::int32_t* triangle = surface.triangle( pickTriangle( random ) );
+		float weights[ 3 ] = { std::fabs( unit( random ) ), std::fabs( unit( random ) ), std::fabs( unit( random ) ) };
+		const int edge = onEdge( random );
+		if( edge < 3 )
+		{
+			weights[ edge ] = 0.0f;
+		}
+		const float total = weights[ 0 ] + weights[ 1 ] + weights[ 2 ] + 1e-6f;
+		float target[ 3 ] = {};
+		for( int k = 0; k < 3; ++k )
+		{
+			for( int i = 0; i < 3; ++i )
+			{
+				target[ i ] += surface.vertex( triangle[ k ] )[ i ] * weights[ k ] / total;
+			}
+		}
+		// sometimes stopping short of the surface or just touching it
+		const float dir[ 3 ] = { unit( random ), unit( random ), unit( random ) };
+		const float before = 1.0f + 20.0f * std::fabs( unit( random ) );
+		const float after = onEdge( random ) ? 20.0f * unit( random ) : 0.0f;
+		for( int i = 0; i < 3; ++i )
+		{
+			start[ i ] = target[ i ] - dir[ i ] * before;
+			end[ i ] = target[ i ] + dir[ i ] * after;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( g2trace )
+
+BOOST_AUTO_TEST_CASE( bounds_hold_their_triangles )
+{
+	// one short run at the end
+	const Surface surface = makeTube( 7, 5, true, 1 );
+	BOOST_REQUIRE_EQUAL( surface.numTriangles() % Q::G2_TRACE_CHUNK_TRIS, 6 );
+	BOOST_REQUIRE_EQUAL( surface.bounds.size(), 6u * ( 1 + 5 ) );
+	for( int j = 0; j < surface.numTriangles(); ++j )
+	{
+		const float* chunk = &surface.bounds[ 6 + ( j / Q::G2_TRACE_CHUNK_TRIS ) * 6 ];
+		for( int k = 0; k < 3; ++k )
+		{
+			const float* vertex = surface.vertex( surface.triangle( j )[ k ] );
+			for( int i = 0; i < 3; ++i )
+			{
+				BOOST_CHECK( chunk[ i ] <= vertex[ i ] && vertex[ i ] <= chunk[ i + 3 ] );
+				BOOST_CHECK( surface.bounds[ i ] <= chunk[ i ] && chunk[ i + 3 ] <= surface.bounds[ i + 3 ] );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( culled_segment_traces_hit_the_same )
+{
+	std::mt19937 random( 42 );
+	std::uniform_real_distribution< float > anywhere( -30.0f, 30.0f );
+	std::size_t numHits = 0, numSkipped = 0;
+	for( const Surface& surface : { makeTube( 12, 10, true, 2 ), makeTube( 12, 10, false, 3 ), makeTube( 1, 3, false, 4 ) } )
+	{
+		for( int trace = 0; trace < 2000; ++trace )
+		{
+			float start[ 3 ], end[ 3 ];
+			if( trace % 4 )
+			{
+				aimAtSurface( surface, random, start, end );
+			}
+			else
+			{
+				for( int i = 0; i < 3; ++i )
+				{
+					start[ i ] = anywhere( random );
+					end[ i ] = anywhere( random );
+				}
+			}
+			const std::vector< Hit > all = segmentTrace( surface, start, end, false );
+			const std::vector< Hit > culled = segmentTrace( surface, start, end, true );
+			BOOST_CHECK_EQUAL_COLLECTIONS( culled.begin(), culled.end(), all.begin(), all.end() );
+			numHits += all.size();
+			numSkipped += all.empty() && !Q::g2SegmentTouchesBounds( start, end, surface.bounds.data() );
+		}
+	}
+	// both the hits and the culling got tried
+	BOOST_CHECK( numHits > 2000 );
+	BOOST_CHECK( numSkipped > 100 );
+}
+
+BOOST_AUTO_TEST_CASE( culled_radius_traces_hit_the_same )
+{
+	std::mt19937 random( 7 );
+	std::uniform_real_distribution< float > radius( 0.25f, 6.0f );
+	std::size_t numHits = 0, numMissed = 0;
+	for( const Surface& surface : { makeTube( 12, 10, true, 5 ), makeTube( 12, 10, false, 6 ) } )
+	{
+		for( int trace = 0; trace < 2000; ++trace )
+		{
+			float start[ 3 ], end[ 3 ];
+			aimAtSurface( surface, random, start, end );
+			if( start[ 0 ] == end[ 0 ] && start[ 1 ] == end[ 1 ] && start[ 2 ] == end[ 2 ] )
+			{
+				continue;
+			}
+			const RadiusTrace box( start, end, radius( random ) );
+			const std::vector< int > all = radiusTrace( surface, box, false );
+			const std::vector< int > culled = radiusTrace( surface, box, true );
+			BOOST_CHECK_EQUAL_COLLECTIONS( culled.begin(), culled.end(), all.begin(), all.end() );
+			numHits += all.size();
+			numMissed += all.empty();
+		}
+	}
+	BOOST_CHECK( numHits > 2000 );
+	BOOST_CHECK( numMissed > 0 );
+}
+
+BOOST_AUTO_TEST_CASE( triangle_test_faces_and_edges )
+{
+	const float a[ 3 ] = { 0.0f, 0.0f, 0.0f };
+	const float b[ 3 ] = { 0.0f, 4.0f, 0.0f };
+	const float c[ 3 ] = { 4.0f, 0.0f, 0.0f };
+	float point[ 3 ], normal[ 3 ], face;
+
+	// from above it's the front face
+	const float above[ 3 ] = { 1.0f, 1.0f, 5.0f };
+	const float below[ 3 ] = { 1.0f, 1.0f, -5.0f };
+	BOOST_REQUIRE( Q::g2SegmentTriangleTest( above, below, a, b, c, true, true, point, normal, &face ) );
+	BOOST_CHECK( face > 0 );
+	BOOST_CHECK_EQUAL( point[ 0 ], 1.0f );
+	BOOST_CHECK_EQUAL( point[ 1 ], 1.0f );
+	BOOST_CHECK_EQUAL( point[ 2 ], 0.0f );
+	// which backFaces drops, despite the name
+	BOOST_CHECK( !Q::g2SegmentTriangleTest( above, below, a, b, c, false, true, point, normal, &face ) );
+	BOOST_CHECK( Q::g2SegmentTriangleTest( below, above, a, b, c, false, true, point, normal, &face ) );
+	BOOST_CHECK( face < 0 );
+
+	// an edge counts, just past it doesn't, and neither does stopping short
+	const float onEdge[ 2 ][ 3 ] = { { 2.0f, 0.0f, 5.0f }, { 2.0f, 0.0f, -5.0f } };
+	BOOST_CHECK( Q::g2SegmentTriangleTest( onEdge[ 0 ], onEdge[ 1 ], a, b, c, true, true, point, normal, &face ) );
+	const float pastEdge[ 2 ][ 3 ] = { { 2.0f, -0.01f, 5.0f }, { 2.0f, -0.01f, -5.0f } };
+	BOOST_CHECK( !Q::g2SegmentTriangleTest( pastEdge[ 0 ], pastEdge[ 1 ], a, b, c, true, true, point, normal, &face ) );
+	const float shortOfIt[ 3 ] = { 1.0f, 1.0f, 0.5f };
+	BOOST_CHECK( !Q::g2SegmentTriangleTest( above, shortOfIt, a, b, c, true, true, point, normal, &face ) );
+
+	// nor does running alongside
+	const float along[ 2 ][ 3 ] = { { -1.0f, 1.0f, 0.0f }, { 5.0f, 1.0f, 0.0f } };
+	BOOST_CHECK( !Q::g2SegmentTriangleTest( along[ 0 ], along[ 1 ], a, b, c, true, true, point, normal, &face ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#include "qcommon/q_parallel.h"
+
+#include <atomic>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE( parallel )
+
+BOOST_AUTO_TEST_CASE( covers_every_index_once )
+{
+	for( std::size_t threads : { 1, 2, 4 } )
+	{
+		Q::setParallelThreadCount( threads );
+		std::vector< int > visits( 1000, 0 );
+		Q::parallelFor( visits.size(), 16, [ &visits ]( std::size_t begin, std::size_t end )
+		{
+			for( std::size_t i = begin; i < end; ++i )
+			{
+				++visits[ i ];
+			}
+		} );
+		for( int count : visits )
+		{
+			BOOST_CHECK_EQUAL( count, 1 );
+		}
+	}
+	Q::setParallelThreadCount( 0 );
+	Q::parallelShutdown();
+}
+
+BOOST_AUTO_TEST_CASE( respects_min_batch )
+{
+	Q::setParallelThreadCount( 4 );
+	std::atomic< std::size_t > smallBatches{ 0 };
+	Q::parallelFor( 100, 30, [ &smallBatches ]( std::size_t begin, std::size_t end )
+	{
+		// only the last batch may be cut short
+		if( end - begin < 30 && end != 100 )
+		{
+			++smallBatches;
+		}
+	} );
+	BOOST_CHECK_EQUAL( smallBatches, 0u );
+	Q::setParallelThreadCount( 0 );
+	Q::parallelShutdown();
+}
+
+BOOST_AUTO_TEST_CASE( nested_calls_run_inline )
+{
+	Q::setParallelThreadCount( 4 );
+	std::atomic< std::size_t > total{ 0 };
+	Q::parallelFor( 8, 1, [ &total ]( std::size_t begin, std::size_t end )
+	{
+		for( std::size_t i = begin; i < end; ++i )
+		{
+			Q::parallelFor( 10, 1, [ &total ]( std::size_t innerBegin, std::size_t innerEnd )
+			{
+				total += innerEnd - innerBegin;
+			} );
+		}
+	} );
+	BOOST_CHECK_EQUAL( total, 80u );
+	Q::setParallelThreadCount( 0 );
+	Q::parallelShutdown();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
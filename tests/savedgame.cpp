@@ -0,0 +1,415 @@
+#include "qcommon/ojk_saved_game.h"
+#include "qcommon/ojk_saved_game_helper.h"
+#include "qcommon/qcommon.h"
+#include "server/server.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+/*
+The parts of the engine SavedGame uses, with the file system kept in memory
+*/
+
+namespace
+{
+	struct OpenFile
+	{
+		std::string path;
+		std::size_t position;
+	};
+
+	std::map< std::string, std::vector< std::uint8_t > > files;
+	std::map< fileHandle_t, OpenFile > openFiles;
+	fileHandle_t nextHandle = 1;
+
+	/// How often each file was opened for reading
+	std::map< std::string, int > reads;
+
+	/// Writing more than failingSize bytes to this file or moving it fails, as on a full or write-protected disk
+	std::string failingPath;
+	std::size_t failingSize;
+
+	cvar_t testSave = {};
+	cvar_t compressSavedGames = {};
+}
+
+cvar_t* sv_testsave = &testSave;
+cvar_t* sv_compress_saved_games = &compressSavedGames;
+
+fileHandle_t FS_FOpenFileWrite( const char* qpath, qboolean safe )
+{
+	files[ qpath ].clear();
+	openFiles[ nextHandle ] = OpenFile{ qpath, 0 };
+	return nextHandle++;
+}
+
+long FS_FOpenFileRead( const char* qpath, fileHandle_t* file, qboolean uniqueFILE )
+{
+	++reads[ qpath ];
+	const auto it = files.find( qpath );
+	if( it == files.end() )
+	{
+		*file = 0;
+		return -1;
+	}
+	openFiles[ nextHandle ] = OpenFile{ qpath, 0 };
+	*file = nextHandle++;
+	return static_cast< long >( it->second.size() );
+}
+
+int FS_Write( const void* buffer, int len, fileHandle_t f )
+{
+	OpenFile& file = openFiles.at( f );
+	std::vector< std::uint8_t >& data = files[ file.path ];
+	if( file.path == failingPath && data.size() + len > failingSize )
+	{
+		return 0;
+	}
+	const std::uint8_t* bytes = static_cast< const std::uint8_t* >( buffer );
+	data.insert( data.end(), bytes, bytes + len );
+	file.position = data.size();
+	return len;
+}
+
+int FS_Read( void* buffer, int len, fileHandle_t f )
+{
+	OpenFile& file = openFiles.at( f );
+	const std::vector< std::uint8_t >& data = files[ file.path ];
+	const std::size_t count = std::min( static_cast< std::size_t >( len ), data.size() - file.position );
+	std::memcpy( buffer, data.data() + file.position, count );
+	file.position += count;
+	return static_cast< int >( count );
+}
+
+void FS_FCloseFile( fileHandle_t f )
+{
+	openFiles.erase( f );
+}
+
+int FS_FTell( fileHandle_t f )
+{
+	return static_cast< int >( openFiles.at( f ).position );
+}
+
+int FS_Seek( fileHandle_t f, long offset, int origin )
+{
+	BOOST_REQUIRE_EQUAL( origin, FS_SEEK_SET );
+	openFiles.at( f ).position = static_cast< std::size_t >( offset );
+	return 0;
+}
+
+void FS_DeleteUserGenFile( const char* filename )
+{
+	files.erase( filename );
+}
+
+qboolean FS_MoveUserGenFile( const char* filename_src, const char* filename_dst )
+{
+	const auto it = files.find( filename_src );
+	if( it == files.end() || filename_src == failingPath )
+	{
+		return qfalse;
+	}
+	files[ filename_dst ] = it->second;
+	files.erase( filename_src );
+	return qtrue;
+}
+
+void QDECL Com_Printf( const char* fmt, ... )
+{
+}
+
+void QDECL Com_DPrintf( const char* fmt, ... )
+{
+}
+
+void NORETURN QDECL Com_Error( int code, const char* fmt, ... )
+{
+	char message[ 1024 ];
+	va_list args;
+	va_start( args, fmt );
+	std::vsnprintf( message, sizeof( message ), fmt, args );
+	va_end( args );
+	throw std::runtime_error( message );
+}
+
+uint32_t Com_BlockChecksum( const void* buffer, int length )
+{
+	// FNV-1a; the real one is MD4 based, but only has to match itself here
+	const std::uint8_t* bytes = static_cast< const std::uint8_t* >( buffer );
+	std::uint32_t hash = 2166136261u;
+	for( int i = 0; i < length; ++i )
+	{
+		hash = ( hash ^ bytes[ i ] ) * 16777619u;
+	}
+	return hash;
+}
+
+namespace
+{
+	const std::uint32_t COMMENT = INT_ID( 'C', 'O', 'M', 'M' );
+	const std::uint32_t LEVEL = INT_ID( 'L', 'V', 'L', 'D' );
+	const std::uint32_t ENTITY = INT_ID( 'E', 'N', 'T', 'Y' );
+
+	typedef std::vector< std::int32_t > Chunk;
+
+	/// A saved game's chunks in order: the comment, one level chunk and several entities sharing a chunk id
+	struct Save
+	{
+		Chunk comment;
+		Chunk level;
+		std::vector< Chunk > entities;
+	};
+
+	Save makeSave( int entities )
+	{
+		Save save;
+		save.comment.assign( 8, 1 );
+		save.level.assign( 200, 0 );
+		for( int i = 0; i < 200; ++i )
+		{
+			save.level[ i ] = i * 31;
+		}
+		for( int e = 0; e < entities; ++e )
+		{
+			save.entities.push_back( Chunk( 50 + e, e ) );
+		}
+		return save;
+	}
+
+	void writeChunk( ojk::SavedGameHelper& helper, std::uint32_t id, const Chunk& chunk )
+	{
+		helper.reset_buffer();
+		for( const std::int32_t value : chunk )
+		{
+			helper.write< std::int32_t >( value );
+		}
+		helper.write_chunk( id );
+	}
+
+	/// Writes save as name, as a delta base, a delta on deltaBase or a plain saved game
+	void write( ojk::SavedGame& savedGame, const std::string& name, const Save& save, bool recordBase, const char* deltaBase )
+	{
+		BOOST_REQUIRE( savedGame.create( name ) );
+		if( deltaBase )
+		{
+			BOOST_REQUIRE( savedGame.begin_delta( deltaBase ) );
+		}
+		else if( recordBase )
+		{
+			savedGame.begin_delta_base();
+		}
+		ojk::SavedGameHelper helper( &savedGame );
+		writeChunk( helper, COMMENT, save.comment );
+		writeChunk( helper, LEVEL, save.level );
+		for( const Chunk& entity : save.entities )
+		{
+			writeChunk( helper, ENTITY, entity );
+		}
+		savedGame.close();
+	}
+
+	bool readChunk( ojk::SavedGame& savedGame, std::uint32_t id, Chunk& chunk )
+	{
+		if( !savedGame.read_chunk( id ) )
+		{
+			return false;
+		}
+		ojk::SavedGameHelper helper( &savedGame );
+		chunk.assign( static_cast< std::size_t >( helper.get_buffer_size() ) / sizeof( std::int32_t ), 0 );
+		for( std::int32_t& value : chunk )
+		{
+			if( !helper.try_read< std::int32_t >( value ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void checkReadsBack( const std::string& name, const Save& save )
+	{
+		ojk::SavedGame savedGame;
+		BOOST_REQUIRE( savedGame.open( name ) );
+		Chunk chunk;
+		BOOST_REQUIRE( readChunk( savedGame, COMMENT, chunk ) );
+		BOOST_CHECK( chunk == save.comment );
+		BOOST_REQUIRE( readChunk( savedGame, LEVEL, chunk ) );
+		BOOST_CHECK( chunk == save.level );
+		for( const Chunk& entity : save.entities )
+		{
+			BOOST_REQUIRE( readChunk( savedGame, ENTITY, chunk ) );
+			BOOST_CHECK( chunk == entity );
+		}
+	}
+
+	const std::string SAVE_PATH = "Saved-Missions-MovieDuels/quick.sav";
+	const std::string BASE_PATH = "Saved-Missions-MovieDuels/quick.sdb";
+	const std::string CURRENT_PATH = "Saved-Missions-MovieDuels/current.sav";
+
+	/// A full quicksave recorded as delta base
+	void writeBase( ojk::SavedGame& savedGame, const Save& base )
+	{
+		files.clear();
+		reads.clear();
+		write( savedGame, "quick", base, true, nullptr );
+		BOOST_REQUIRE( savedGame.has_delta_base() );
+	}
+
+	/// A delta quicksave on the full one, changed from it; written to "current" first like SG_WriteSavegame does
+	void writeDelta( ojk::SavedGame& savedGame, const Save& base, const Save& changed )
+	{
+		writeBase( savedGame, base );
+		write( savedGame, "current", changed, false, "quick" );
+		BOOST_REQUIRE( ojk::SavedGame::store_delta( "current", "quick" ) );
+	}
+
+	struct Fixture
+	{
+		Fixture()
+		{
+			testSave.integer = 0;
+			compressSavedGames.integer = 1;
+			failingPath.clear();
+			failingSize = 0;
+		}
+	};
+}
+
+BOOST_FIXTURE_TEST_SUITE( savedgame, Fixture )
+
+BOOST_AUTO_TEST_CASE( full_save_reads_back )
+{
+	files.clear();
+	ojk::SavedGame savedGame;
+	const Save save = makeSave( 5 );
+	write( savedGame, "full", save, false, nullptr );
+	checkReadsBack( "full", save );
+}
+
+BOOST_AUTO_TEST_CASE( delta_reads_back )
+{
+	ojk::SavedGame savedGame;
+	const Save base = makeSave( 5 );
+	Save changed = base;
+	changed.comment[ 0 ] = 2;
+	changed.entities[ 2 ][ 0 ] = -1;
+	// one more than the base has, so it can't be a reference
+	changed.entities.push_back( Chunk( 10, 7 ) );
+	writeDelta( savedGame, base, changed );
+
+	// unchanged chunks are just references
+	BOOST_REQUIRE( files.count( SAVE_PATH ) );
+	BOOST_REQUIRE( files.count( BASE_PATH ) );
+	BOOST_CHECK( files[ SAVE_PATH ].size() < files[ BASE_PATH ].size() );
+
+	checkReadsBack( "quick", changed );
+
+	// compressed or not, the references stay the same
+	compressSavedGames.integer = 0;
+	writeDelta( savedGame, base, changed );
+	checkReadsBack( "quick", changed );
+}
+
+BOOST_AUTO_TEST_CASE( delta_of_identical_save_reads_back )
+{
+	ojk::SavedGame savedGame;
+	const Save base = makeSave( 3 );
+	writeDelta( savedGame, base, base );
+	checkReadsBack( "quick", base );
+}
+
+BOOST_AUTO_TEST_CASE( comment_reads_without_the_base )
+{
+	ojk::SavedGame savedGame;
+	const Save base = makeSave( 3 );
+	Save changed = base;
+	changed.comment[ 0 ] = 2;
+	writeDelta( savedGame, base, changed );
+
+	// listing saved games only reads the comment, which changed, so the base isn't touched
+	Chunk chunk;
+	BOOST_REQUIRE( savedGame.open( "quick" ) );
+	BOOST_REQUIRE( readChunk( savedGame, COMMENT, chunk ) );
+	BOOST_CHECK( chunk == changed.comment );
+	savedGame.close();
+	BOOST_CHECK_EQUAL( reads[ BASE_PATH ], 0 );
+
+	// the first unchanged chunk loads it, once
+	BOOST_REQUIRE( savedGame.open( "quick" ) );
+	BOOST_REQUIRE( readChunk( savedGame, COMMENT, chunk ) );
+	BOOST_REQUIRE( readChunk( savedGame, LEVEL, chunk ) );
+	BOOST_CHECK( chunk == base.level );
+	BOOST_REQUIRE( readChunk( savedGame, ENTITY, chunk ) );
+	BOOST_CHECK_EQUAL( reads[ BASE_PATH ], 1 );
+	savedGame.close();
+}
+
+BOOST_AUTO_TEST_CASE( missing_or_different_base_fails_on_read )
+{
+	ojk::SavedGame savedGame;
+	const Save base = makeSave( 3 );
+	Save changed = base;
+	changed.comment[ 0 ] = 2;
+	writeDelta( savedGame, base, changed );
+	const std::vector< std::uint8_t > baseFile = files[ BASE_PATH ];
+
+	// without its base the delta still opens and shows its comment, but can't be loaded
+	files.erase( BASE_PATH );
+	Chunk chunk;
+	BOOST_REQUIRE( savedGame.open( "quick" ) );
+	BOOST_CHECK( readChunk( savedGame, COMMENT, chunk ) );
+	BOOST_CHECK( !readChunk( savedGame, LEVEL, chunk ) );
+	BOOST_CHECK( savedGame.is_failed() );
+	savedGame.close();
+
+	// a base from another save doesn't match the checksum in the delta header
+	Save other = base;
+	other.level[ 0 ] = 12345;
+	write( savedGame, "other", other, false, nullptr );
+	files[ BASE_PATH ] = files[ "Saved-Missions-MovieDuels/other.sav" ];
+	BOOST_REQUIRE( savedGame.open( "quick" ) );
+	BOOST_CHECK( readChunk( savedGame, COMMENT, chunk ) );
+	BOOST_CHECK( !readChunk( savedGame, LEVEL, chunk ) );
+	savedGame.close();
+
+	// and with the right one back it works again
+	files[ BASE_PATH ] = baseFile;
+	checkReadsBack( "quick", changed );
+}
+
+BOOST_AUTO_TEST_CASE( failed_delta_keeps_the_quicksave )
+{
+	ojk::SavedGame savedGame;
+	const Save base = makeSave( 3 );
+	Save changed = base;
+	changed.comment[ 0 ] = 2;
+	writeBase( savedGame, base );
+
+	// the disk fills up halfway through the delta, which drops out of SG_WriteSavegame before the quicksave is touched
+	failingPath = CURRENT_PATH;
+	failingSize = 100;
+	BOOST_CHECK_THROW( write( savedGame, "current", changed, false, "quick" ), std::runtime_error );
+	savedGame.close();
+	failingPath.clear();
+	BOOST_CHECK( !files.count( BASE_PATH ) );
+	checkReadsBack( "quick", base );
+
+	// the delta is written, but the quicksave can't be replaced by it
+	write( savedGame, "current", changed, false, "quick" );
+	failingPath = CURRENT_PATH;
+	BOOST_CHECK( !ojk::SavedGame::store_delta( "current", "quick" ) );
+	failingPath.clear();
+	BOOST_CHECK( !files.count( BASE_PATH ) );
+	checkReadsBack( "quick", base );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,356 @@
+#include "qcommon/q_shadecalc.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "benchmark.h"
+
+namespace
+{
+	const int TABLE_SIZE = 1024;
+	const int FOG_TABLE_SIZE = 256;
+
+	struct Tables
+	{
+		Tables() : sinTable( TABLE_SIZE ), fogTable( FOG_TABLE_SIZE )
+		{
+			for( int i = 0; i < TABLE_SIZE; ++i )
+			{
+				sinTable[ i ] = std::sin( i * 2 * 3.14159265358979323846 / TABLE_SIZE );
+			}
+			for( int i = 0; i < FOG_TABLE_SIZE; ++i )
+			{
+				fogTable[ i ] = std::sqrt( static_cast< float >( i ) / ( FOG_TABLE_SIZE - 1 ) );
+			}
+		}
+
+		std::vector< float > sinTable;
+		std::vector< float > fogTable;
+	};
+
+	struct Tess
+	{
+		explicit Tess( std::size_t numVertexes ) : xyz( numVertexes ), normal( numVertexes ), st( numVertexes ), colors( numVertexes ) {}
+
+		std::vector< float[ 4 ] > xyz;
+		std::vector< float[ 4 ] > normal;
+		std::vector< float[ 2 ] > st;
+		std::vector< std::uint8_t[ 4 ] > colors;
+	};
+
+	/// random positions, unit normals, texture coordinates spread over the fog ranges and colors
+	Tess makeTess( std::size_t numVertexes )
+	{
+		std::mt19937 random( 1234 );
+		std::uniform_real_distribution< float > coord( -512.0f, 512.0f );
+		std::uniform_real_distribution< float > unit( -1.0f, 1.0f );
+		std::uniform_real_distribution< float > texCoord( -0.25f, 1.25f );
+		std::uniform_int_distribution< int > byte( 0, 255 );
+		Tess tess( numVertexes );
+		for( std::size_t i = 0; i < numVertexes; ++i )
+		{
+			float n[ 3 ] = { unit( random ), unit( random ), unit( random ) };
+			const float length = std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] ) + 1e-3f;
+			for( int k = 0; k < 3; ++k )
+			{
+				tess.xyz[ i ][ k ] = coord( random );
+				tess.normal[ i ][ k ] = n[ k ] / length;
+			}
+			// the padding has to survive deforms
+			tess.xyz[ i ][ 3 ] = 1.0f;
+			tess.normal[ i ][ 3 ] = 0.0f;
+			tess.st[ i ][ 0 ] = texCoord( random );
+			tess.st[ i ][ 1 ] = texCoord( random );
+			for( int k = 0; k < 4; ++k )
+			{
+				tess.colors[ i ][ k ] = static_cast< std::uint8_t >( byte( random ) );
+			}
+		}
+		return tess;
+	}
+
+	template< typename T >
+	bool sameBits( const std::vector< T >& a, const std::vector< T >& b )
+	{
+		return a.size() == b.size() && std::memcmp( a.data(), b.data(), a.size() * sizeof( T ) ) == 0;
+	}
+
+	// odd so the scalar tail gets used too
+	const std::size_t NUM_VERTEXES = 203;
+}
+
+BOOST_AUTO_TEST_SUITE( shadecalc )
+
+BOOST_AUTO_TEST_CASE( deforms_match_reference )
+{
+	const Tables tables;
+	Tess reference = makeTess( NUM_VERTEXES );
+	Tess simd = makeTess( NUM_VERTEXES );
+
+	Q::deformVertexesReference( reference.xyz.data(), reference.normal.data(), NUM_VERTEXES, 3.5f );
+	Q::deformVertexes( simd.xyz.data(), simd.normal.data(), NUM_VERTEXES, 3.5f );
+	BOOST_CHECK( sameBits( reference.xyz, simd.xyz ) );
+
+	for( float now = 0.0f; now < 4.0f; now += 0.37f )
+	{
+		Q::deformVertexesWaveReference( reference.xyz.data(), reference.normal.data(), NUM_VERTEXES, tables.sinTable.data(), TABLE_SIZE, 1.0f, 4.0f, 0.25f, now, 0.01f );
+		Q::deformVertexesWave( simd.xyz.data(), simd.normal.data(), NUM_VERTEXES, tables.sinTable.data(), TABLE_SIZE, 1.0f, 4.0f, 0.25f, now, 0.01f );
+		BOOST_CHECK( sameBits( reference.xyz, simd.xyz ) );
+	}
+	BOOST_CHECK_EQUAL( simd.xyz[ 0 ][ 3 ], 1.0f );
+}
+
+BOOST_AUTO_TEST_CASE( fill_colors_matches_reference )
+{
+	for( std::size_t n = 0; n < 9; ++n )
+	{
+		std::vector< std::uint32_t > reference( 9, 0 ), simd( 9, 0 );
+		Q::fillColorsReference( reference.data(), n, 0x80ff4020u );
+		Q::fillColors( simd.data(), n, 0x80ff4020u );
+		BOOST_CHECK( reference == simd );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( fog_matches_reference )
+{
+	const Tables tables;
+	const Tess tess = makeTess( NUM_VERTEXES );
+	const float distanceVector[ 4 ] = { 0.001f, -0.002f, 0.0005f, 0.4f };
+	const float depthVector[ 4 ] = { 0.0f, 0.0f, 1.0f / 128, 0.5f };
+	for( const bool eyeOutside : { false, true } )
+	{
+		std::vector< float[ 2 ] > reference( NUM_VERTEXES ), simd( NUM_VERTEXES );
+		Q::fogTexCoordsReference( tess.xyz.data(), NUM_VERTEXES, distanceVector, depthVector, -2.0f, eyeOutside, reference.data() );
+		Q::fogTexCoords( tess.xyz.data(), NUM_VERTEXES, distanceVector, depthVector, -2.0f, eyeOutside, simd.data() );
+		BOOST_CHECK( sameBits( reference, simd ) );
+	}
+
+	// a NaN distance clears both coordinates
+	Tess nan = makeTess( 4 );
+	nan.xyz[ 2 ][ 0 ] = std::numeric_limits< float >::quiet_NaN();
+	std::vector< float[ 2 ] > st( 4 );
+	Q::fogTexCoords( nan.xyz.data(), 4, distanceVector, depthVector, -2.0f, true, st.data() );
+	BOOST_CHECK_EQUAL( st[ 2 ][ 0 ], 0.0f );
+	BOOST_CHECK_EQUAL( st[ 2 ][ 1 ], 0.0f );
+
+	for( const int channels : { 7, 8, 15 } )
+	{
+		Tess reference = makeTess( NUM_VERTEXES );
+		Tess simd = makeTess( NUM_VERTEXES );
+		Q::fogModulateColorsReference( reference.st.data(), NUM_VERTEXES, tables.fogTable.data(), FOG_TABLE_SIZE, channels, reference.colors.data() );
+		Q::fogModulateColors( simd.st.data(), NUM_VERTEXES, tables.fogTable.data(), FOG_TABLE_SIZE, channels, simd.colors.data() );
+		BOOST_CHECK( sameBits( reference.colors, simd.colors ) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( texcoords_match_reference )
+{
+	const Tables tables;
+	const Tess tess = makeTess( NUM_VERTEXES );
+	const float viewOrigin[ 3 ] = { 100.0f, -40.0f, 64.0f };
+	const float lightDir[ 3 ] = { 0.6f, 0.0f, 0.8f };
+
+	std::vector< float[ 2 ] > reference( NUM_VERTEXES ), simd( NUM_VERTEXES );
+	Q::environmentTexCoordsReference( tess.xyz.data(), tess.normal.data(), NUM_VERTEXES, viewOrigin, reference.data() );
+	Q::environmentTexCoords( tess.xyz.data(), tess.normal.data(), NUM_VERTEXES, viewOrigin, simd.data() );
+	BOOST_CHECK( sameBits( reference, simd ) );
+
+	Q::environmentTexCoordsFromLightReference( tess.normal.data(), NUM_VERTEXES, lightDir, reference.data() );
+	Q::environmentTexCoordsFromLight( tess.normal.data(), NUM_VERTEXES, lightDir, simd.data() );
+	BOOST_CHECK( sameBits( reference, simd ) );
+
+	Tess turbulentReference = makeTess( NUM_VERTEXES );
+	Tess turbulent = makeTess( NUM_VERTEXES );
+	for( float now = 0.1f; now < 40.0f; now *= 2.3f )
+	{
+		Q::turbulentTexCoordsReference( turbulentReference.xyz.data(), NUM_VERTEXES, tables.sinTable.data(), TABLE_SIZE, now, 0.05f, turbulentReference.st.data() );
+		Q::turbulentTexCoords( turbulent.xyz.data(), NUM_VERTEXES, tables.sinTable.data(), TABLE_SIZE, now, 0.05f, turbulent.st.data() );
+		BOOST_CHECK( sameBits( turbulentReference.st, turbulent.st ) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( diffuse_matches_reference )
+{
+	const Tess tess = makeTess( NUM_VERTEXES );
+	const float ambient[ 3 ] = { 40.0f, 32.5f, 90.0f };
+	const std::uint8_t ambientBytes[ 4 ] = { 40, 32, 90, 255 };
+	std::uint32_t ambientPacked;
+	std::memcpy( &ambientPacked, ambientBytes, sizeof( ambientPacked ) );
+	const float directed[ 3 ] = { 300.0f, 120.25f, 16.0f };
+	const float lightDir[ 3 ] = { 0.0f, 0.6f, -0.8f };
+
+	std::vector< std::uint8_t[ 4 ] > reference( NUM_VERTEXES ), simd( NUM_VERTEXES );
+	Q::diffuseColorsReference( tess.normal.data(), NUM_VERTEXES, ambient, ambientPacked, directed, lightDir, reference.data() );
+	Q::diffuseColors( tess.normal.data(), NUM_VERTEXES, ambient, ambientPacked, directed, lightDir, simd.data() );
+	BOOST_CHECK( sameBits( reference, simd ) );
+}
+
+BOOST_AUTO_TEST_CASE( fog_coordinates_are_clamped_to_the_fog_surface )
+{
+	// t is z / 128 + 0.5, so the fog surface is at z = 64
+	const float distanceVector[ 4 ] = { 0.0f, 0.0f, 0.0f, 0.25f };
+	const float depthVector[ 4 ] = { 0.0f, 0.0f, 1.0f / 128, 0.5f };
+	Tess tess = makeTess( 8 );
+	const float heights[ 8 ] = { -512, -64, -63, 0, 63, 64, 65, 512 };
+	for( int i = 0; i < 8; ++i )
+	{
+		tess.xyz[ i ][ 2 ] = heights[ i ];
+	}
+
+	for( const bool eyeOutside : { false, true } )
+	{
+		std::vector< float[ 2 ] > reference( 8 ), simd( 8 );
+		Q::fogTexCoordsReference( tess.xyz.data(), 8, distanceVector, depthVector, -2.0f, eyeOutside, reference.data() );
+		Q::fogTexCoords( tess.xyz.data(), 8, distanceVector, depthVector, -2.0f, eyeOutside, simd.data() );
+		BOOST_CHECK( sameBits( reference, simd ) );
+		for( int i = 0; i < 8; ++i )
+		{
+			const float t = heights[ i ] / 128 + 0.5f;
+			BOOST_CHECK_EQUAL( simd[ i ][ 0 ], 0.25f );
+			if( eyeOutside ? t < 1.0f : t < 0.0f )
+			{
+				// outside the fog
+				BOOST_CHECK_EQUAL( simd[ i ][ 1 ], 1.0f / 32 );
+			}
+			else if( eyeOutside )
+			{
+				// cut at the fog plane, never deeper than fully inside
+				BOOST_CHECK( simd[ i ][ 1 ] > 1.0f / 32 );
+				BOOST_CHECK( simd[ i ][ 1 ] <= 31.0f / 32 );
+			}
+			else
+			{
+				BOOST_CHECK_EQUAL( simd[ i ][ 1 ], 31.0f / 32 );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( fog_factor_is_clamped )
+{
+	const Tables tables;
+	const float st[ 6 ][ 2 ] = {
+		{ 0.0f, 1.0f },			// s within the bias, no fog
+		{ 1.0f / 512, 1.0f },	// exactly on the bias
+		{ 0.5f, 0.0f },			// t outside the fog
+		{ 0.5f, 1.0f / 64 },	// t just outside
+		{ 10.0f, 1.0f },		// far past the end of the table
+		{ 1000.0f, 31.0f / 32 },
+	};
+	const std::uint8_t expected[ 6 ] = { 200, 200, 200, 200, 0, 0 };
+	for( const int channels : { 7, 8, 15 } )
+	{
+		std::vector< std::uint8_t[ 4 ] > reference( 6 ), simd( 6 );
+		for( int i = 0; i < 6; ++i )
+		{
+			for( int k = 0; k < 4; ++k )
+			{
+				reference[ i ][ k ] = simd[ i ][ k ] = 200;
+			}
+		}
+		Q::fogModulateColorsReference( st, 6, tables.fogTable.data(), FOG_TABLE_SIZE, channels, reference.data() );
+		Q::fogModulateColors( st, 6, tables.fogTable.data(), FOG_TABLE_SIZE, channels, simd.data() );
+		BOOST_CHECK( sameBits( reference, simd ) );
+		for( int i = 0; i < 6; ++i )
+		{
+			for( int k = 0; k < 4; ++k )
+			{
+				BOOST_CHECK_EQUAL( simd[ i ][ k ], ( channels & ( 1 << k ) ) ? expected[ i ] : 200 );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( tables_wrap_around )
+{
+	const Tables tables;
+	// whole units so every table index is exact; x + z and y are one table period (1024 units) apart
+	Tess base = makeTess( 9 );
+	Tess shifted = makeTess( 9 );
+	for( int i = 0; i < 9; ++i )
+	{
+		base.xyz[ i ][ 0 ] = static_cast< float >( i * 97 - 400 );
+		base.xyz[ i ][ 1 ] = static_cast< float >( i * 131 - 600 );
+		base.xyz[ i ][ 2 ] = static_cast< float >( i * 3 );
+		shifted.xyz[ i ][ 0 ] = base.xyz[ i ][ 0 ] + ( i & 1 ? 1024 : -2048 );
+		shifted.xyz[ i ][ 1 ] = base.xyz[ i ][ 1 ] - 1024;
+		shifted.xyz[ i ][ 2 ] = base.xyz[ i ][ 2 ];
+		shifted.st[ i ][ 0 ] = base.st[ i ][ 0 ] = 0.5f;
+		shifted.st[ i ][ 1 ] = base.st[ i ][ 1 ] = 0.5f;
+	}
+	// positive and negative coordinates, one table period apart, wrap to the same entries
+	for( const float now : { 0.25f, 0.75f } )
+	{
+		std::vector< float[ 2 ] > a( 9 ), b( 9 ), c( 9 );
+		for( int i = 0; i < 9; ++i )
+		{
+			a[ i ][ 0 ] = b[ i ][ 0 ] = c[ i ][ 0 ] = 0.5f;
+			a[ i ][ 1 ] = b[ i ][ 1 ] = c[ i ][ 1 ] = 0.5f;
+		}
+		Q::turbulentTexCoords( base.xyz.data(), 9, tables.sinTable.data(), TABLE_SIZE, now, 0.25f, a.data() );
+		Q::turbulentTexCoords( shifted.xyz.data(), 9, tables.sinTable.data(), TABLE_SIZE, now, 0.25f, b.data() );
+		BOOST_CHECK( sameBits( a, b ) );
+		// so do times a whole number of periods apart
+		Q::turbulentTexCoordsReference( base.xyz.data(), 9, tables.sinTable.data(), TABLE_SIZE, now + 3, 0.25f, c.data() );
+		BOOST_CHECK( sameBits( a, c ) );
+	}
+
+	// the wave deform too, with the phase a whole period on
+	Tess wave = makeTess( 9 );
+	Tess wavePhased = makeTess( 9 );
+	for( int i = 0; i < 9; ++i )
+	{
+		for( int k = 0; k < 3; ++k )
+		{
+			wave.xyz[ i ][ k ] = wavePhased.xyz[ i ][ k ] = base.xyz[ i ][ k ];
+		}
+	}
+	Q::deformVertexesWave( wave.xyz.data(), wave.normal.data(), 9, tables.sinTable.data(), TABLE_SIZE, 1.0f, 4.0f, 0.25f, 0.5f, 1.0f / 1024 );
+	Q::deformVertexesWave( wavePhased.xyz.data(), wavePhased.normal.data(), 9, tables.sinTable.data(), TABLE_SIZE, 1.0f, 4.0f, 2.25f, 0.5f, 1.0f / 1024 );
+	BOOST_CHECK( sameBits( wave.xyz, wavePhased.xyz ) );
+}
+
+BENCHMARK_TEST_CASE( benchmark )
+{
+	// a full tess batch, as many times as a busy frame's worth of shader stages
+	const Tables tables;
+	const std::size_t numVertexes = 1000;
+	const int iterations = 5000;
+	Tess tess = makeTess( numVertexes );
+	std::vector< std::uint32_t > packed( numVertexes );
+	const float plane[ 4 ] = { 0.001f, -0.002f, 0.0005f, 0.4f };
+	const float depth[ 4 ] = { 0.0f, 0.0f, 1.0f / 128, 0.5f };
+	const float origin[ 3 ] = { 100.0f, -40.0f, 64.0f };
+	const float ambient[ 3 ] = { 40.0f, 32.0f, 90.0f };
+	const float directed[ 3 ] = { 300.0f, 120.0f, 16.0f };
+	const float lightDir[ 3 ] = { 0.0f, 0.6f, -0.8f };
+
+#define TIME_KERNEL( name, ... ) \
+	do \
+	{ \
+		const long long reference = Benchmark::microseconds( iterations, [ & ] { Q::name##Reference( __VA_ARGS__ ); } ); \
+		const long long simd = Benchmark::microseconds( iterations, [ & ] { Q::name( __VA_ARGS__ ); } ); \
+		BOOST_TEST_MESSAGE( #name " " << numVertexes << " vertexes x " << iterations << ": reference " << reference << "us, simd " << simd << "us" ); \
+	} while( 0 )
+
+	TIME_KERNEL( deformVertexes, tess.xyz.data(), tess.normal.data(), numVertexes, 1e-6f );
+	TIME_KERNEL( deformVertexesWave, tess.xyz.data(), tess.normal.data(), numVertexes, tables.sinTable.data(), TABLE_SIZE, 0.0f, 1e-6f, 0.25f, 1.5f, 0.01f );
+	TIME_KERNEL( fillColors, packed.data(), numVertexes, 0xffffffffu );
+	TIME_KERNEL( fogTexCoords, tess.xyz.data(), numVertexes, plane, depth, -2.0f, true, tess.st.data() );
+	TIME_KERNEL( fogModulateColors, tess.st.data(), numVertexes, tables.fogTable.data(), FOG_TABLE_SIZE, 15, tess.colors.data() );
+	TIME_KERNEL( environmentTexCoords, tess.xyz.data(), tess.normal.data(), numVertexes, origin, tess.st.data() );
+	TIME_KERNEL( environmentTexCoordsFromLight, tess.normal.data(), numVertexes, lightDir, tess.st.data() );
+	TIME_KERNEL( turbulentTexCoords, tess.xyz.data(), numVertexes, tables.sinTable.data(), TABLE_SIZE, 1.5f, 1e-6f, tess.st.data() );
+	TIME_KERNEL( diffuseColors, tess.normal.data(), numVertexes, ambient, 0xff405a20u, directed, lightDir, tess.colors.data() );
+
+#undef TIME_KERNEL
+	BOOST_CHECK( std::isfinite( tess.xyz[ 0 ][ 0 ] ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,239 @@
+#include "qcommon/q_shadowvolume.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	struct Mesh
+	{
+		explicit Mesh( std::size_t numVertices ) : xyz( numVertices ) {}
+
+		std::vector< float[ 4 ] > xyz;
+		std::vector< std::uint32_t > indices;
+	};
+
+	/// random triangles over a small vertex pool, so edges get shared like on a real model
+	Mesh makeMesh( std::size_t numVertices, std::size_t numTriangles )
+	{
+		std::mt19937 random( 1234 );
+		std::uniform_real_distribution< float > coord( -64.0f, 64.0f );
+		std::uniform_int_distribution< std::uint32_t > vertex( 0, static_cast< std::uint32_t >( numVertices - 1 ) );
+		Mesh mesh( numVertices );
+		for( auto& v : mesh.xyz )
+		{
+			v[ 0 ] = coord( random );
+			v[ 1 ] = coord( random );
+			v[ 2 ] = coord( random );
+			v[ 3 ] = 0.0f;
+		}
+		for( std::size_t i = 0; i < numTriangles * 3; ++i )
+		{
+			mesh.indices.push_back( vertex( random ) );
+		}
+		return mesh;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( shadowvolume )
+
+BOOST_AUTO_TEST_CASE( facing_matches_reference )
+{
+	// an odd count, so the scalar tail runs too
+	const Mesh mesh = makeMesh( 500, 1001 );
+	const std::size_t numTriangles = mesh.indices.size() / 3;
+	std::vector< std::uint8_t > facing( numTriangles ), expected( numTriangles );
+
+	const float lights[][ 3 ] = { { 0.0f, 0.0f, 1.0f }, { 0.3f, -0.3f, 1.0f }, { -0.7f, 0.2f, 0.1f } };
+	for( const float* light : lights )
+	{
+		Q::shadowFacing( mesh.xyz.data(), mesh.indices.data(), numTriangles, light, facing.data() );
+		Q::shadowFacingReference( mesh.xyz.data(), mesh.indices.data(), numTriangles, light, expected.data() );
+		BOOST_CHECK( facing == expected );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( edge_masks_cap_each_vertex )
+{
+	// a fan of 40 triangles around vertex 0, every one starts an edge there
+	std::vector< std::int32_t > indices;
+	for( int i = 0; i < 40; ++i )
+	{
+		indices.push_back( 0 );
+		indices.push_back( i + 1 );
+		indices.push_back( i + 2 );
+	}
+	std::vector< int > counts( 42 );
+	std::vector< std::uint8_t > masks( 40 );
+	BOOST_CHECK( Q::shadowEdgeMasks( indices.data(), 40, 0, 42, 32, counts.data(), masks.data() ) );
+	for( int i = 0; i < 40; ++i )
+	{
+		BOOST_CHECK_EQUAL( masks[ i ], i < 32 ? Q::SHADOW_EDGES_ALL : 6 );
+	}
+
+	// the same fan further along tess
+	std::vector< std::uint32_t > shifted( indices.begin(), indices.end() );
+	for( std::uint32_t& index : shifted )
+	{
+		index += 100;
+	}
+	std::vector< std::uint8_t > shiftedMasks( 40 );
+	Q::shadowEdgeMasks( shifted.data(), 40, 100, 42, 32, counts.data(), shiftedMasks.data() );
+	BOOST_CHECK( shiftedMasks == masks );
+
+	BOOST_CHECK( !Q::shadowEdgeMasks( indices.data(), 20, 0, 42, 32, counts.data(), masks.data() ) );
+}
+
+BOOST_AUTO_TEST_CASE( volume_of_one_triangle )
+{
+	const std::uint32_t indices[] = { 0, 1, 2, 3, 4, 5 };
+	const std::uint8_t facing[] = { 1, 0 };
+	const std::uint8_t masks[] = { 5, Q::SHADOW_EDGES_ALL };
+	std::uint32_t out[ 48 ];
+	const std::size_t count = Q::shadowVolumeIndices( indices, 2, facing, masks, 10, out );
+
+	// the edges from vertex 0 and 2, then both caps
+	const std::uint32_t expected[] = {
+		0, 10, 1, 1, 10, 11,
+		2, 12, 0, 0, 12, 10,
+		0, 1, 2, 12, 11, 10
+	};
+	BOOST_CHECK_EQUAL_COLLECTIONS( out, out + count, expected, expected + sizeof( expected ) / sizeof( expected[ 0 ] ) );
+}
+
+namespace
+{
+	/// Whether every edge of the volume's triangles is matched by one running the other way, so the stencil count can't leak
+	bool isClosed( const std::uint32_t* indices, std::size_t count )
+	{
+		std::map< std::pair< std::uint32_t, std::uint32_t >, int > edges;
+		for( std::size_t i = 0; i < count; i += 3 )
+		{
+			for( int k = 0; k < 3; ++k )
+			{
+				const std::uint32_t a = indices[ i + k ];
+				const std::uint32_t b = indices[ i + ( k + 1 ) % 3 ];
+				++edges[ std::make_pair( a, b ) ];
+				--edges[ std::make_pair( b, a ) ];
+			}
+		}
+		for( const auto& edge : edges )
+		{
+			if( edge.second != 0 )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Builds the volume of the mesh with every edge kept, the way it's drawn when no vertex runs out of edges
+	std::vector< std::uint32_t > volume( const Mesh& mesh, const float* lightDir )
+	{
+		const std::size_t numTriangles = mesh.indices.size() / 3;
+		std::vector< std::uint8_t > facing( numTriangles );
+		Q::shadowFacing( mesh.xyz.data(), mesh.indices.data(), numTriangles, lightDir, facing.data() );
+		const std::vector< std::uint8_t > masks( numTriangles, Q::SHADOW_EDGES_ALL );
+		std::vector< std::uint32_t > out( numTriangles * 24 );
+		out.resize( Q::shadowVolumeIndices( mesh.indices.data(), numTriangles, facing.data(), masks.data(), static_cast< std::uint32_t >( mesh.xyz.size() ), out.data() ) );
+		return out;
+	}
+
+	void setVertex( Mesh& mesh, std::size_t i, float x, float y, float z )
+	{
+		mesh.xyz[ i ][ 0 ] = x;
+		mesh.xyz[ i ][ 1 ] = y;
+		mesh.xyz[ i ][ 2 ] = z;
+		mesh.xyz[ i ][ 3 ] = 0.0f;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( degenerate_triangles_cast_nothing )
+{
+	Mesh mesh( 4 );
+	setVertex( mesh, 0, 0, 0, 0 );
+	setVertex( mesh, 1, 10, 0, 0 );
+	setVertex( mesh, 2, 20, 0, 0 );
+	setVertex( mesh, 3, 0, 10, 0 );
+	const std::uint32_t triangles[] = {
+		0, 0, 1,	// repeated vertex
+		1, 1, 1,	// a point
+		0, 1, 2,	// a line
+		0, 1, 3,	// a real one, facing up
+		0, 3, 1,	// the same facing down
+	};
+	mesh.indices.assign( triangles, triangles + 15 );
+	// twice over, so both the four wide and the scalar parts see them
+	mesh.indices.insert( mesh.indices.end(), triangles, triangles + 15 );
+	const std::size_t numTriangles = mesh.indices.size() / 3;
+
+	const float lights[][ 3 ] = { { 0, 0, 1 }, { 0.5f, -0.5f, 1 }, { 1, 0, 0 } };
+	const std::uint8_t expected[][ 5 ] = { { 0, 0, 0, 1, 0 }, { 0, 0, 0, 1, 0 }, { 0, 0, 0, 0, 0 } };
+	for( int l = 0; l < 3; ++l )
+	{
+		std::vector< std::uint8_t > facing( numTriangles ), reference( numTriangles );
+		Q::shadowFacing( mesh.xyz.data(), mesh.indices.data(), numTriangles, lights[ l ], facing.data() );
+		Q::shadowFacingReference( mesh.xyz.data(), mesh.indices.data(), numTriangles, lights[ l ], reference.data() );
+		BOOST_CHECK( facing == reference );
+		for( std::size_t t = 0; t < numTriangles; ++t )
+		{
+			// the last light lies in the real triangle's plane, so it's edge on and casts nothing either
+			BOOST_CHECK_EQUAL( facing[ t ], expected[ l ][ t % 5 ] );
+		}
+		const std::vector< std::uint32_t > out = volume( mesh, lights[ l ] );
+		BOOST_CHECK_EQUAL( out.size(), l < 2 ? 2u * ( 3 * 6 + 6 ) : 0u );
+		BOOST_CHECK( isClosed( out.data(), out.size() ) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( open_edges_close_the_volume )
+{
+	// a single quad: every outer edge is open
+	Mesh quad( 4 );
+	setVertex( quad, 0, 0, 0, 0 );
+	setVertex( quad, 1, 10, 0, 0 );
+	setVertex( quad, 2, 10, 10, 0 );
+	setVertex( quad, 3, 0, 10, 0 );
+	const std::uint32_t quadTriangles[] = { 0, 1, 2, 0, 2, 3 };
+	quad.indices.assign( quadTriangles, quadTriangles + 6 );
+	const float up[ 3 ] = { 0, 0, 1 };
+	const std::vector< std::uint32_t > quadVolume = volume( quad, up );
+	// both triangles face the light: three side quads and two caps each
+	BOOST_CHECK_EQUAL( quadVolume.size(), 2u * ( 3 * 6 + 6 ) );
+	BOOST_CHECK( isClosed( quadVolume.data(), quadVolume.size() ) );
+
+	// facing away, nothing at all
+	const float down[ 3 ] = { 0, 0, -1 };
+	BOOST_CHECK( volume( quad, down ).empty() );
+
+	// a folded strip where the silhouette runs along the fold, half of it facing the light
+	Mesh fold( 6 );
+	setVertex( fold, 0, 0, 0, 0 );
+	setVertex( fold, 1, 10, 0, 0 );
+	setVertex( fold, 2, 0, 10, 0 );
+	setVertex( fold, 3, 10, 10, 0 );
+	setVertex( fold, 4, 0, 10, 10 );
+	setVertex( fold, 5, 10, 10, 10 );
+	const std::uint32_t foldTriangles[] = { 0, 1, 3, 0, 3, 2, 2, 3, 5, 2, 5, 4 };
+	fold.indices.assign( foldTriangles, foldTriangles + 12 );
+	const std::vector< std::uint32_t > foldVolume = volume( fold, up );
+	BOOST_CHECK_EQUAL( foldVolume.size(), 2u * ( 3 * 6 + 6 ) );
+	BOOST_CHECK( isClosed( foldVolume.data(), foldVolume.size() ) );
+
+	// and random open, non manifold meshes
+	const Mesh mesh = makeMesh( 50, 201 );
+	const float lights[][ 3 ] = { { 0.0f, 0.0f, 1.0f }, { 0.3f, -0.3f, 1.0f }, { -0.7f, 0.2f, 0.1f } };
+	for( const float* light : lights )
+	{
+		const std::vector< std::uint32_t > out = volume( mesh, light );
+		BOOST_CHECK( !out.empty() );
+		BOOST_CHECK( isClosed( out.data(), out.size() ) );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
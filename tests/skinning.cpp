@@ -0,0 +1,278 @@
+#include "qcommon/q_skinning.h"
+#include "qcommon/q_parallel.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "benchmark.h"
+
+namespace
+{
+	const std::size_t NUM_BONES = 32;
+
+	/// a rotation around a random axis plus a translation, like an animated bone
+	Q::SkinBone makeBone( std::mt19937& random, float angle )
+	{
+		std::uniform_real_distribution< float > unit( -1.0f, 1.0f );
+		float axis[ 3 ] = { unit( random ), unit( random ), unit( random ) + 2.0f };
+		const float length = std::sqrt( axis[ 0 ] * axis[ 0 ] + axis[ 1 ] * axis[ 1 ] + axis[ 2 ] * axis[ 2 ] );
+		for( float& component : axis )
+		{
+			component /= length;
+		}
+		const float c = std::cos( angle );
+		const float s = std::sin( angle );
+		const float t = 1.0f - c;
+		const float x = axis[ 0 ], y = axis[ 1 ], z = axis[ 2 ];
+		Q::SkinBone bone = { {
+			{ t * x * x + c, t * x * y - s * z, t * x * z + s * y, 32.0f * unit( random ) },
+			{ t * x * y + s * z, t * y * y + c, t * y * z - s * x, 32.0f * unit( random ) },
+			{ t * x * z - s * y, t * y * z + s * x, t * z * z + c, 32.0f * unit( random ) },
+		} };
+		return bone;
+	}
+
+	std::vector< Q::SkinBone > makePose( unsigned int seed, float angle )
+	{
+		std::mt19937 random( seed );
+		std::vector< Q::SkinBone > palette;
+		for( std::size_t i = 0; i < NUM_BONES; ++i )
+		{
+			palette.push_back( makeBone( random, angle * ( 1.0f + i * 0.1f ) ) );
+		}
+		return palette;
+	}
+
+	/// a mesh with every weight count, encoded the way the Ghoul2 model compiler does it
+	std::vector< Q::SkinVertex > makeMesh( std::size_t count )
+	{
+		std::mt19937 random( 1234 );
+		std::uniform_real_distribution< float > coord( -64.0f, 64.0f );
+		std::uniform_int_distribution< int > bone( 0, NUM_BONES - 1 );
+		std::vector< Q::SkinVertex > vertices( count );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			Q::SkinVertex& vertex = vertices[ i ];
+			const int numWeights = static_cast< int >( i % 4 ) + 1;
+			for( int axis = 0; axis < 3; ++axis )
+			{
+				vertex.position[ axis ] = coord( random );
+			}
+			vertex.normal[ 0 ] = 0.0f;
+			vertex.normal[ 1 ] = 0.6f;
+			vertex.normal[ 2 ] = 0.8f;
+
+			// split 1023 between the weights
+			std::uint32_t packed = static_cast< std::uint32_t >( numWeights - 1 ) << 30;
+			int remaining = 1023;
+			for( int k = 0; k < 4; ++k )
+			{
+				packed |= static_cast< std::uint32_t >( bone( random ) ) << ( 5 * k );
+				const int weight = k < numWeights - 1 ? remaining / 2 : 0;
+				remaining -= weight;
+				vertex.boneWeights[ k ] = static_cast< std::uint8_t >( weight & 0xFF );
+				packed |= static_cast< std::uint32_t >( weight & 0x300 ) << ( 12 + 2 * k );
+			}
+			vertex.weightsAndBoneIndices = packed;
+		}
+		return vertices;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( skinning )
+
+BOOST_AUTO_TEST_CASE( matches_reference )
+{
+	const std::vector< Q::SkinVertex > mesh = makeMesh( 1001 );
+	std::vector< float[ 4 ] > xyz( mesh.size() ), normal( mesh.size() );
+	std::vector< float[ 4 ] > expectedXyz( mesh.size() ), expectedNormal( mesh.size() );
+
+	for( float angle : { 0.0f, 0.5f, 2.0f } )
+	{
+		const std::vector< Q::SkinBone > palette = makePose( 42, angle );
+		Q::skinVertices( mesh.data(), mesh.size(), palette.data(), xyz.data(), normal.data() );
+		Q::skinVerticesReference( mesh.data(), mesh.size(), palette.data(), expectedXyz.data(), expectedNormal.data() );
+		for( std::size_t i = 0; i < mesh.size(); ++i )
+		{
+			for( int axis = 0; axis < 3; ++axis )
+			{
+				BOOST_CHECK_SMALL( xyz[ i ][ axis ] - expectedXyz[ i ][ axis ], 1e-3f );
+				BOOST_CHECK_SMALL( normal[ i ][ axis ] - expectedNormal[ i ][ axis ], 1e-5f );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( leaves_fourth_component_alone )
+{
+	const std::vector< Q::SkinVertex > mesh = makeMesh( 8 );
+	const std::vector< Q::SkinBone > palette = makePose( 7, 1.0f );
+	std::vector< float[ 4 ] > xyz( mesh.size() ), normal( mesh.size() );
+	for( std::size_t i = 0; i < mesh.size(); ++i )
+	{
+		xyz[ i ][ 3 ] = 5.0f;
+		normal[ i ][ 3 ] = 6.0f;
+	}
+	Q::skinVertices( mesh.data(), mesh.size(), palette.data(), xyz.data(), normal.data() );
+	for( std::size_t i = 0; i < mesh.size(); ++i )
+	{
+		BOOST_CHECK_EQUAL( xyz[ i ][ 3 ], 5.0f );
+		BOOST_CHECK_EQUAL( normal[ i ][ 3 ], 6.0f );
+	}
+}
+
+namespace
+{
+	/// A vertex on up to 4 bones; the last weight isn't stored
+	Q::SkinVertex makeVertex( int numWeights, const int* bones, const int* weights )
+	{
+		Q::SkinVertex vertex = { { 0.0f, 0.6f, 0.8f }, { 12.0f, -20.0f, 36.0f }, 0, { 0, 0, 0, 0 } };
+		std::uint32_t packed = static_cast< std::uint32_t >( numWeights - 1 ) << 30;
+		for( int k = 0; k < numWeights; ++k )
+		{
+			packed |= static_cast< std::uint32_t >( bones[ k ] ) << ( 5 * k );
+			if( k < numWeights - 1 )
+			{
+				vertex.boneWeights[ k ] = static_cast< std::uint8_t >( weights[ k ] & 0xFF );
+				packed |= static_cast< std::uint32_t >( weights[ k ] & 0x300 ) << ( 12 + 2 * k );
+			}
+		}
+		vertex.weightsAndBoneIndices = packed;
+		return vertex;
+	}
+
+	void transform( const Q::SkinBone& bone, const float* v, float w, float* out )
+	{
+		for( int row = 0; row < 3; ++row )
+		{
+			out[ row ] = bone.matrix[ row ][ 0 ] * v[ 0 ] + bone.matrix[ row ][ 1 ] * v[ 1 ] + bone.matrix[ row ][ 2 ] * v[ 2 ] + bone.matrix[ row ][ 3 ] * w;
+		}
+	}
+
+	/// Checks both kernels put every vertex exactly on onBone and rotate its normal by its first bone
+	void checkOnBone( const std::vector< Q::SkinVertex >& mesh, const std::vector< Q::SkinBone >& palette, const int* onBone, const int* firstBone )
+	{
+		std::vector< float[ 4 ] > xyz( mesh.size() ), normal( mesh.size() );
+		for( int kernel = 0; kernel < 2; ++kernel )
+		{
+			if( kernel )
+			{
+				Q::skinVertices( mesh.data(), mesh.size(), palette.data(), xyz.data(), normal.data() );
+			}
+			else
+			{
+				Q::skinVerticesReference( mesh.data(), mesh.size(), palette.data(), xyz.data(), normal.data() );
+			}
+			for( std::size_t i = 0; i < mesh.size(); ++i )
+			{
+				float expectedXyz[ 3 ], expectedNormal[ 3 ];
+				transform( palette[ onBone[ i ] ], mesh[ i ].position, 1.0f, expectedXyz );
+				transform( palette[ firstBone[ i ] ], mesh[ i ].normal, 0.0f, expectedNormal );
+				for( int axis = 0; axis < 3; ++axis )
+				{
+					BOOST_CHECK_SMALL( xyz[ i ][ axis ] - expectedXyz[ axis ], 1e-3f );
+					BOOST_CHECK_SMALL( normal[ i ][ axis ] - expectedNormal[ axis ], 1e-5f );
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( single_weight_follows_its_bone )
+{
+	const std::vector< Q::SkinBone > palette = makePose( 42, 1.0f );
+	// the unused indices and weight bytes don't matter
+	std::vector< Q::SkinVertex > mesh;
+	int bones[ 5 ];
+	for( int bone = 0; bone < 5; ++bone )
+	{
+		const int indices[ 4 ] = { bone * 7, 31, 30, 29 };
+		const int weights[ 3 ] = { 1023, 512, 1 };
+		bones[ bone ] = indices[ 0 ];
+		Q::SkinVertex vertex = makeVertex( 4, indices, weights );
+		vertex.weightsAndBoneIndices &= ~( 3u << 30 );
+		mesh.push_back( vertex );
+	}
+	checkOnBone( mesh, palette, bones, bones );
+}
+
+BOOST_AUTO_TEST_CASE( zero_weights_leave_bones_out )
+{
+	std::vector< Q::SkinBone > palette = makePose( 42, 1.0f );
+	// bones nothing should be pulled towards
+	for( int bone = 20; bone < 24; ++bone )
+	{
+		for( int row = 0; row < 3; ++row )
+		{
+			palette[ bone ].matrix[ row ][ 3 ] = 1e6f;
+		}
+	}
+
+	std::vector< Q::SkinVertex > mesh;
+	std::vector< int > onBone, firstBone;
+	const struct
+	{
+		int numWeights;
+		int bones[ 4 ];
+		int weights[ 3 ];
+		int onBone;
+	} cases[] = {
+		// nothing stored, all on the implied last bone
+		{ 2, { 20, 3 }, { 0 }, 3 },
+		{ 3, { 20, 21, 4 }, { 0, 0 }, 4 },
+		{ 4, { 20, 21, 22, 5 }, { 0, 0, 0 }, 5 },
+		// everything on the first; the implied last weight is only 0 give or take rounding, so that bone is an ordinary one
+		{ 2, { 6, 9 }, { 1023 }, 6 },
+		{ 4, { 7, 20, 21, 10 }, { 1023, 0, 0 }, 7 },
+		// on a bone in the middle
+		{ 4, { 20, 8, 21, 11 }, { 0, 1023, 0 }, 8 },
+	};
+	for( const auto& c : cases )
+	{
+		mesh.push_back( makeVertex( c.numWeights, c.bones, c.weights ) );
+		onBone.push_back( c.onBone );
+		// normals only ever use the first bone, even with no weight
+		firstBone.push_back( c.bones[ 0 ] );
+	}
+	checkOnBone( mesh, palette, onBone.data(), firstBone.data() );
+}
+
+BENCHMARK_TEST_CASE( benchmark )
+{
+	// about the size of a player model's surfaces put together, in a few fixed poses
+	const std::vector< Q::SkinVertex > mesh = makeMesh( 4000 );
+	std::vector< float[ 4 ] > xyz( mesh.size() ), normal( mesh.size() );
+	std::vector< std::vector< Q::SkinBone > > poses;
+	for( int pose = 0; pose < 4; ++pose )
+	{
+		poses.push_back( makePose( 42 + pose, 0.25f * pose ) );
+	}
+	const int iterations = 200;
+
+	int pose = 0;
+	const long long reference = Benchmark::microseconds( iterations, [ & ] {
+		Q::skinVerticesReference( mesh.data(), mesh.size(), poses[ pose++ % poses.size() ].data(), xyz.data(), normal.data() );
+	} );
+	pose = 0;
+	const long long simd = Benchmark::microseconds( iterations, [ & ] {
+		Q::skinVertices( mesh.data(), mesh.size(), poses[ pose++ % poses.size() ].data(), xyz.data(), normal.data() );
+	} );
+	// split like RB_SurfaceGhoul does with GHOUL2_SKINNING_BATCH
+	pose = 0;
+	const long long threaded = Benchmark::microseconds( iterations, [ & ] {
+		const Q::SkinBone* palette = poses[ pose++ % poses.size() ].data();
+		Q::parallelFor( mesh.size(), 1024, [ & ]( std::size_t begin, std::size_t end ) {
+			Q::skinVertices( mesh.data() + begin, end - begin, palette, xyz.data() + begin, normal.data() + begin );
+		} );
+	} );
+
+	BOOST_CHECK( std::isfinite( xyz[ 0 ][ 0 ] ) );
+	BOOST_TEST_MESSAGE( "skinning " << mesh.size() << " vertices x " << iterations << ": reference " << reference
+		<< "us, skinVertices " << simd << "us, split across " << Q::parallelThreadCount() << " thread(s) " << threaded << "us" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
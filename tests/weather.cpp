@@ -0,0 +1,515 @@
+#include "qcommon/q_weather.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "benchmark.h"
+
+namespace
+{
+	struct Cloud
+	{
+		explicit Cloud( std::size_t count )
+			: x( count ), y( count ), z( count )
+			, vx( count ), vy( count ), vz( count )
+			, mass( count ), alpha( count ), flags( count )
+			, xyz( count * 4 * 3 ), colors( count * 4 * 4 )
+		{
+		}
+
+		Q::WeatherParticles particles()
+		{
+			Q::WeatherParticles p = { x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), mass.data(), alpha.data(), flags.data(), x.size() };
+			return p;
+		}
+
+		std::vector< float > x, y, z;
+		std::vector< float > vx, vy, vz;
+		std::vector< float > mass;
+		std::vector< float > alpha;
+		std::vector< std::uint8_t > flags;
+
+		/// Room for 4 vertexes per particle
+		std::vector< float > xyz;
+		std::vector< float > colors;
+
+		float( *vertexes() )[ 3 ]
+		{
+			return reinterpret_cast< float( * )[ 3 ] >( xyz.data() );
+		}
+		float( *vertexColors() )[ 4 ]
+		{
+			return reinterpret_cast< float( * )[ 4 ] >( colors.data() );
+		}
+	};
+
+	template< typename T >
+	bool sameBits( const std::vector< T >& a, const std::vector< T >& b )
+	{
+		return a.size() == b.size() && std::memcmp( a.data(), b.data(), a.size() * sizeof( T ) ) == 0;
+	}
+
+	bool sameState( const Cloud& a, const Cloud& b )
+	{
+		return sameBits( a.x, b.x ) && sameBits( a.y, b.y ) && sameBits( a.z, b.z )
+			&& sameBits( a.vx, b.vx ) && sameBits( a.vy, b.vy ) && sameBits( a.vz, b.vz )
+			&& sameBits( a.alpha, b.alpha ) && sameBits( a.flags, b.flags );
+	}
+
+	/// A map with one weather zone, partly covered, and a couple of local winds
+	struct World
+	{
+		World()
+			: cells( 64 * 64 )
+		{
+			std::mt19937 random( 4321 );
+			std::bernoulli_distribution covered( 0.3 );
+			for( auto& word : cells )
+			{
+				for( int bit = 0; bit < 32; ++bit )
+				{
+					if( covered( random ) )
+					{
+						word |= 1u << bit;
+					}
+				}
+			}
+			const Q::WeatherZone z = { { -1024, -1024, -512 }, { 1024, 1024, 512 }, { -32, -32, -16 }, 64, 64, 1, cells.data() };
+			zone = z;
+			const Q::WeatherWind w[ 2 ] = {
+				{ { -600, -600, -1000 }, { 0, 200, 1000 }, { 900, 0, 0 } },
+				{ { -200, -800, -1000 }, { 500, 0, 1000 }, { 0, -700, 40 } },
+			};
+			winds.assign( w, w + 2 );
+		}
+
+		std::vector< std::uint32_t > cells;
+		Q::WeatherZone zone;
+		std::vector< Q::WeatherWind > winds;
+	};
+
+	Q::WeatherStep makeStep( const World& world, int frame, bool wrap, int cellSpread, int bitSpread )
+	{
+		// the camera circles the middle of the zone, looking ahead
+		const float angle = frame * 0.01f;
+		Q::WeatherStep step;
+		const float force[ 3 ] = { 120.0f, -40.0f, wrap ? 0.0f : -300.0f };
+		const float origin[ 3 ] = { 400.0f * std::cos( angle ), 400.0f * std::sin( angle ), 64.0f };
+		const float forward[ 3 ] = { -std::sin( angle ), std::cos( angle ), 0.0f };
+		for( int k = 0; k < 3; ++k )
+		{
+			step.force[ k ] = force[ k ];
+			step.viewOrigin[ k ] = origin[ k ];
+			step.viewForward[ k ] = forward[ k ];
+			step.rangeMins[ k ] = origin[ k ] - 625.0f;
+			step.rangeMaxs[ k ] = origin[ k ] + 625.0f;
+		}
+		step.friction = 0.7f;
+		step.seconds = 1.0f / 60.0f;
+		step.fade = 10.0f * step.seconds;
+		step.maxAlpha = 0.8f;
+		step.wrap = wrap;
+		step.winds = world.winds.data();
+		step.numWinds = world.winds.size();
+		step.zones = &world.zone;
+		step.numZones = 1;
+		step.markedOutside = false;
+		step.cellSpread = cellSpread;
+		step.bitSpread = bitSpread;
+		return step;
+	}
+
+	Cloud makeCloud( std::size_t count, const Q::WeatherStep& step )
+	{
+		std::mt19937 random( 1234 );
+		std::uniform_real_distribution< float > mass( 5.0f, 10.0f );
+		Cloud cloud( count );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			cloud.x[ i ] = std::uniform_real_distribution< float >( step.rangeMins[ 0 ], step.rangeMaxs[ 0 ] )( random );
+			cloud.y[ i ] = std::uniform_real_distribution< float >( step.rangeMins[ 1 ], step.rangeMaxs[ 1 ] )( random );
+			cloud.z[ i ] = std::uniform_real_distribution< float >( step.rangeMins[ 2 ], step.rangeMaxs[ 2 ] )( random );
+			cloud.mass[ i ] = mass( random );
+		}
+		return cloud;
+	}
+
+	/// What the renderer does with WEATHER_RESPAWN, with its own random numbers
+	void respawn( Cloud& cloud, const Q::WeatherStep& step, std::mt19937& random )
+	{
+		for( std::size_t i = 0; i < cloud.flags.size(); ++i )
+		{
+			if( cloud.flags[ i ] & Q::WEATHER_RESPAWN )
+			{
+				cloud.x[ i ] = std::uniform_real_distribution< float >( step.rangeMins[ 0 ], step.rangeMaxs[ 0 ] )( random );
+				cloud.y[ i ] = std::uniform_real_distribution< float >( step.rangeMins[ 1 ], step.rangeMaxs[ 1 ] )( random );
+				cloud.z[ i ] = step.wrap ? std::uniform_real_distribution< float >( step.rangeMins[ 2 ], step.rangeMaxs[ 2 ] )( random ) : step.rangeMaxs[ 2 ] - 1.0f;
+			}
+		}
+	}
+
+	Q::WeatherSprite makeSprite( int vertexCount, bool orientWithVelocity, bool alphaOnly )
+	{
+		const Q::WeatherSprite sprite = { { 0.5f, 0.6f, 0.7f, 0.8f }, alphaOnly, vertexCount, { 0.0f, 1.2f, 0.0f }, { 0.0f, 0.0f, 80.0f }, orientWithVelocity, 80.0f };
+		return sprite;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( weather )
+
+BOOST_AUTO_TEST_CASE( step_matches_reference )
+{
+	const World world;
+	// rain on a spawn plane and wrapping dust, with thin and wide sprites; 1001 leaves a scalar tail
+	const struct
+	{
+		bool wrap;
+		int cellSpread;
+		int bitSpread;
+	} configs[] = { { false, 0, 0 }, { true, 0, 0 }, { true, 2, 2 }, { false, 1, 3 } };
+	for( const auto& config : configs )
+	{
+		Cloud reference = makeCloud( 1001, makeStep( world, 0, config.wrap, config.cellSpread, config.bitSpread ) );
+		Cloud simd = reference;
+		std::mt19937 referenceRandom( 99 ), simdRandom( 99 );
+		std::size_t rendered = 0;
+		for( int frame = 0; frame < 200; ++frame )
+		{
+			const Q::WeatherStep step = makeStep( world, frame, config.wrap, config.cellSpread, config.bitSpread );
+			const std::size_t referenceRendering = Q::weatherStepReference( reference.particles(), step );
+			const std::size_t simdRendering = Q::weatherStep( simd.particles(), step );
+			BOOST_REQUIRE_EQUAL( referenceRendering, simdRendering );
+			BOOST_REQUIRE( sameState( reference, simd ) );
+			respawn( reference, step, referenceRandom );
+			respawn( simd, step, simdRandom );
+			rendered += simdRendering;
+		}
+		BOOST_CHECK( rendered > 0 );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( vertexes_match_reference )
+{
+	const World world;
+	Cloud cloud = makeCloud( 1001, makeStep( world, 0, false, 0, 0 ) );
+	std::mt19937 random( 99 );
+	for( int frame = 0; frame < 30; ++frame )
+	{
+		const Q::WeatherStep step = makeStep( world, frame, false, 0, 0 );
+		Q::weatherStep( cloud.particles(), step );
+		respawn( cloud, step, random );
+	}
+	// one particle standing still, to normalize a zero velocity
+	cloud.vx[ 0 ] = cloud.vy[ 0 ] = cloud.vz[ 0 ] = 0.0f;
+	cloud.flags[ 0 ] |= Q::WEATHER_RENDER;
+
+	for( int vertexCount = 3; vertexCount <= 4; ++vertexCount )
+	{
+		for( int orient = 0; orient < 2; ++orient )
+		{
+			for( int alphaOnly = 0; alphaOnly < 2; ++alphaOnly )
+			{
+				const Q::WeatherSprite sprite = makeSprite( vertexCount, orient != 0, alphaOnly != 0 );
+				Cloud reference = cloud;
+				const std::size_t referenceVertexes = Q::weatherVertexesReference( reference.particles(), sprite, reference.vertexes(), reference.vertexColors() );
+				const std::size_t simdVertexes = Q::weatherVertexes( cloud.particles(), sprite, cloud.vertexes(), cloud.vertexColors() );
+				BOOST_REQUIRE_EQUAL( referenceVertexes, simdVertexes );
+				BOOST_CHECK( referenceVertexes > 0 );
+				BOOST_CHECK( std::memcmp( reference.xyz.data(), cloud.xyz.data(), referenceVertexes * 3 * sizeof( float ) ) == 0 );
+				BOOST_CHECK( std::memcmp( reference.colors.data(), cloud.colors.data(), referenceVertexes * 4 * sizeof( float ) ) == 0 );
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( covered_cells_hide_particles )
+{
+	// one zone of 4x1 cells, only the second one covered; particles hover in each, in front of the view
+	const std::uint32_t cells[ 4 ] = { 0, 1, 0, 0 };
+	const Q::WeatherZone zone = { { 0, 0, 0 }, { 128, 32, 32 }, { 0, 0, 0 }, 4, 1, 1, cells };
+	Q::WeatherStep step = {};
+	step.friction = 1.0f;
+	step.seconds = 0.1f;
+	step.fade = 0.25f;
+	step.maxAlpha = 1.0f;
+	const float rangeMins[ 3 ] = { -1000, -1000, -1000 };
+	const float rangeMaxs[ 3 ] = { 1000, 1000, 1000 };
+	const float forward[ 3 ] = { 1, 0, 0 };
+	const float origin[ 3 ] = { -16, 16, 16 };
+	for( int k = 0; k < 3; ++k )
+	{
+		step.rangeMins[ k ] = rangeMins[ k ];
+		step.rangeMaxs[ k ] = rangeMaxs[ k ];
+		step.viewForward[ k ] = forward[ k ];
+		step.viewOrigin[ k ] = origin[ k ];
+	}
+	step.zones = &zone;
+	step.numZones = 1;
+	step.markedOutside = false;
+
+	Cloud cloud( 5 );
+	for( std::size_t i = 0; i < 5; ++i )
+	{
+		cloud.x[ i ] = 16.0f + 32.0f * i;
+		cloud.y[ i ] = 16.0f;
+		cloud.z[ i ] = 16.0f;
+		cloud.mass[ i ] = 1.0f;
+	}
+	BOOST_CHECK_EQUAL( Q::weatherStep( cloud.particles(), step ), 4u );
+	const std::uint8_t expected[ 5 ] = { 1, 0, 1, 1, 1 };
+	for( std::size_t i = 0; i < 5; ++i )
+	{
+		BOOST_CHECK_EQUAL( ( cloud.flags[ i ] & Q::WEATHER_RENDER ) != 0, expected[ i ] != 0 );
+		BOOST_CHECK_EQUAL( cloud.alpha[ i ], expected[ i ] ? 0.25f : 0.0f );
+	}
+
+	// a sprite spreading a cell across also hides its neighbours
+	step.cellSpread = 1;
+	Cloud wide( 5 );
+	wide.x = cloud.x;
+	wide.y = cloud.y;
+	wide.z = cloud.z;
+	wide.mass = cloud.mass;
+	BOOST_CHECK_EQUAL( Q::weatherStep( wide.particles(), step ), 2u );
+	BOOST_CHECK( !( wide.flags[ 2 ] & Q::WEATHER_RENDER ) );
+	BOOST_CHECK( wide.flags[ 4 ] & Q::WEATHER_RENDER );
+}
+
+namespace
+{
+	/// No forces, a 200 unit range around the origin and a view from far behind it, so particles only move by their velocity
+	Q::WeatherStep makeBoxStep( bool wrap )
+	{
+		Q::WeatherStep step = {};
+		step.friction = 1.0f;
+		step.seconds = 1.0f;
+		step.fade = 0.25f;
+		step.maxAlpha = 1.0f;
+		step.wrap = wrap;
+		for( int k = 0; k < 3; ++k )
+		{
+			step.rangeMins[ k ] = -100.0f;
+			step.rangeMaxs[ k ] = 100.0f;
+		}
+		step.viewOrigin[ 0 ] = -1000.0f;
+		step.viewForward[ 0 ] = 1.0f;
+		return step;
+	}
+
+	struct Mover
+	{
+		float position[ 3 ];
+		float velocity[ 3 ];
+		bool rendering;
+	};
+
+	Cloud makeMovers( const Mover* movers, std::size_t count )
+	{
+		Cloud cloud( count );
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			cloud.x[ i ] = movers[ i ].position[ 0 ];
+			cloud.y[ i ] = movers[ i ].position[ 1 ];
+			cloud.z[ i ] = movers[ i ].position[ 2 ];
+			cloud.vx[ i ] = movers[ i ].velocity[ 0 ];
+			cloud.vy[ i ] = movers[ i ].velocity[ 1 ];
+			cloud.vz[ i ] = movers[ i ].velocity[ 2 ];
+			cloud.mass[ i ] = 1.0f;
+			cloud.alpha[ i ] = movers[ i ].rendering ? 1.0f : 0.0f;
+			cloud.flags[ i ] = movers[ i ].rendering ? Q::WEATHER_RENDER : 0;
+		}
+		return cloud;
+	}
+
+	// the last one goes through the scalar tail
+	const Mover LEAVING[ 9 ] = {
+		{ { 90, 0, 0 }, { 20, 0, 0 }, false },		// just past maxs
+		{ { -90, 0, 0 }, { -20, 0, 0 }, false },	// just past mins
+		{ { 0, 0, 90 }, { 0, 0, 700 }, false },		// too far out to wrap
+		{ { 0, 0, 0 }, { 0, 0, 0 }, false },		// staying
+		{ { 90, 0, 0 }, { 20, 0, 0 }, true },		// leaving while rendering
+		{ { 95, 0, 0 }, { 5, 0, 0 }, false },		// exactly on maxs
+		{ { 0, -90, 0 }, { 0, -15, 0 }, false },
+		{ { 90, 90, 0 }, { 20, 20, 0 }, false },	// out on two axes
+		{ { 90, 0, 0 }, { 20, 0, 0 }, false },
+	};
+}
+
+BOOST_AUTO_TEST_CASE( particles_leaving_the_range_wrap_around )
+{
+	const Q::WeatherStep step = makeBoxStep( true );
+	Cloud reference = makeMovers( LEAVING, 9 );
+	Cloud simd = reference;
+	const std::size_t referenceRendering = Q::weatherStepReference( reference.particles(), step );
+	BOOST_CHECK_EQUAL( Q::weatherStep( simd.particles(), step ), referenceRendering );
+	BOOST_REQUIRE( sameState( reference, simd ) );
+	BOOST_CHECK_EQUAL( referenceRendering, 2u );
+
+	const float expectedX[ 9 ] = { -90, 90, 0, 0, 110, -90, 0, -90, -90 };
+	const float expectedY[ 9 ] = { 0, 0, 0, 0, 0, 0, 90, -90, 0 };
+	for( std::size_t i = 0; i < 9; ++i )
+	{
+		BOOST_CHECK_EQUAL( simd.x[ i ], expectedX[ i ] );
+		BOOST_CHECK_EQUAL( simd.y[ i ], expectedY[ i ] );
+		BOOST_CHECK_EQUAL( ( simd.flags[ i ] & Q::WEATHER_RESPAWN ) != 0, i == 2 );
+		// whatever left the range without rendering stops
+		if( i != 3 && i != 4 )
+		{
+			BOOST_CHECK_EQUAL( simd.vx[ i ], 0.0f );
+			BOOST_CHECK_EQUAL( simd.vy[ i ], 0.0f );
+			BOOST_CHECK_EQUAL( simd.vz[ i ], 0.0f );
+		}
+	}
+	// the one too far out is left where it is for the caller to respawn
+	BOOST_CHECK_EQUAL( simd.z[ 2 ], 790.0f );
+	// a rendering particle fades out before it's moved
+	BOOST_CHECK_EQUAL( simd.vx[ 4 ], 20.0f );
+	BOOST_CHECK( simd.flags[ 4 ] & Q::WEATHER_FADE_OUT );
+	BOOST_CHECK_EQUAL( simd.alpha[ 4 ], 0.75f );
+	BOOST_CHECK( simd.flags[ 3 ] & Q::WEATHER_FADE_IN );
+}
+
+BOOST_AUTO_TEST_CASE( particles_leaving_the_range_respawn )
+{
+	const Q::WeatherStep step = makeBoxStep( false );
+	Cloud reference = makeMovers( LEAVING, 9 );
+	Cloud simd = reference;
+	BOOST_CHECK_EQUAL( Q::weatherStep( simd.particles(), step ), Q::weatherStepReference( reference.particles(), step ) );
+	BOOST_REQUIRE( sameState( reference, simd ) );
+
+	for( std::size_t i = 0; i < 9; ++i )
+	{
+		const bool leaves = i != 3 && i != 4;
+		BOOST_CHECK_EQUAL( ( simd.flags[ i ] & Q::WEATHER_RESPAWN ) != 0, leaves );
+		// not moved back, that's up to the caller
+		BOOST_CHECK_EQUAL( simd.x[ i ], LEAVING[ i ].position[ 0 ] + LEAVING[ i ].velocity[ 0 ] );
+	}
+
+	// once the caller has put them back, the flag goes away
+	for( std::size_t i = 0; i < 9; ++i )
+	{
+		if( simd.flags[ i ] & Q::WEATHER_RESPAWN )
+		{
+			simd.x[ i ] = simd.y[ i ] = simd.z[ i ] = 0.0f;
+		}
+	}
+	Q::weatherStep( simd.particles(), step );
+	for( std::size_t i = 0; i < 9; ++i )
+	{
+		BOOST_CHECK( !( simd.flags[ i ] & Q::WEATHER_RESPAWN ) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( clouds_draw_in_one_batch )
+{
+	// the renderer draws each cloud with a single glDrawArrays over weatherVertexes' output,
+	// so rendering particles have to come out packed, in order, vertexCount vertexes each
+	const Q::WeatherStep step = makeBoxStep( true );
+	const float alphas[ 10 ] = { 0.5f, 0.0f, 0.0f, 1.0f, 0.25f, 0.0f, 0.0f, 0.0f, 0.0f, 0.75f };
+	Cloud cloud( 10 );
+	for( std::size_t i = 0; i < 10; ++i )
+	{
+		cloud.x[ i ] = 8.0f * i;
+		cloud.y[ i ] = -4.0f * i;
+		cloud.z[ i ] = 2.0f;
+		cloud.alpha[ i ] = alphas[ i ];
+		cloud.flags[ i ] = alphas[ i ] > 0.0f ? Q::WEATHER_RENDER : 0;
+	}
+	const std::size_t drawn[ 4 ] = { 0, 3, 4, 9 };
+
+	for( int vertexCount = 3; vertexCount <= 4; ++vertexCount )
+	{
+		const Q::WeatherSprite sprite = { { 0.5f, 0.25f, 1.0f, 0.5f }, true, vertexCount, { 0.0f, 2.0f, 0.0f }, { 0.0f, 0.0f, 3.0f }, false, 0.0f };
+		Cloud reference = cloud;
+		const std::size_t numVertexes = Q::weatherVertexes( cloud.particles(), sprite, cloud.vertexes(), cloud.vertexColors() );
+		BOOST_REQUIRE_EQUAL( numVertexes, 4u * vertexCount );
+		BOOST_CHECK_EQUAL( Q::weatherVertexesReference( reference.particles(), sprite, reference.vertexes(), reference.vertexColors() ), numVertexes );
+		BOOST_CHECK( std::memcmp( reference.xyz.data(), cloud.xyz.data(), numVertexes * 3 * sizeof( float ) ) == 0 );
+
+		for( std::size_t p = 0; p < 4; ++p )
+		{
+			const std::size_t i = drawn[ p ];
+			const float position[ 3 ] = { cloud.x[ i ], cloud.y[ i ], cloud.z[ i ] };
+			float centroid[ 3 ] = {};
+			for( int v = 0; v < vertexCount; ++v )
+			{
+				const float* xyz = cloud.vertexes()[ p * vertexCount + v ];
+				const float* color = cloud.vertexColors()[ p * vertexCount + v ];
+				for( int k = 0; k < 3; ++k )
+				{
+					centroid[ k ] += xyz[ k ];
+				}
+				BOOST_CHECK_EQUAL( color[ 0 ], 0.5f );
+				BOOST_CHECK_EQUAL( color[ 3 ], alphas[ i ] );
+			}
+			if( vertexCount == 4 )
+			{
+				// quads are centered on their particle
+				for( int k = 0; k < 3; ++k )
+				{
+					BOOST_CHECK_EQUAL( centroid[ k ] / 4, position[ k ] );
+				}
+			}
+			else
+			{
+				// triangles start on it
+				const float* first = cloud.vertexes()[ p * vertexCount ];
+				for( int k = 0; k < 3; ++k )
+				{
+					BOOST_CHECK_EQUAL( first[ k ], position[ k ] );
+				}
+			}
+		}
+	}
+
+	// after a step the batch holds exactly the particles the step reported rendering
+	const std::size_t rendering = Q::weatherStep( cloud.particles(), step );
+	const Q::WeatherSprite sprite = makeSprite( 3, false, true );
+	BOOST_CHECK_EQUAL( Q::weatherVertexes( cloud.particles(), sprite, cloud.vertexes(), cloud.vertexColors() ), rendering * 3 );
+
+	// and a cloud with nothing showing has nothing to draw
+	Cloud hidden( 6 );
+	BOOST_CHECK_EQUAL( Q::weatherVertexes( hidden.particles(), sprite, hidden.vertexes(), hidden.vertexColors() ), 0u );
+}
+
+BENCHMARK_TEST_CASE( benchmark )
+{
+	// a heavy rain cloud, stepped and turned into triangles every frame
+	const World world;
+	const std::size_t count = 4000;
+	const int frames = 300;
+	const Q::WeatherSprite sprite = makeSprite( 3, false, true );
+	Cloud reference = makeCloud( count, makeStep( world, 0, false, 0, 0 ) );
+	Cloud simd = reference;
+	std::mt19937 random( 99 );
+	std::size_t referenceVertexes = 0, simdVertexes = 0;
+
+	int frame = 0;
+	const long long referenceTime = Benchmark::microseconds( frames, [ & ] {
+		const Q::WeatherStep step = makeStep( world, frame++, false, 0, 0 );
+		Q::weatherStepReference( reference.particles(), step );
+		respawn( reference, step, random );
+		referenceVertexes += Q::weatherVertexesReference( reference.particles(), sprite, reference.vertexes(), reference.vertexColors() );
+	} );
+
+	random.seed( 99 );
+	frame = 0;
+	const long long simdTime = Benchmark::microseconds( frames, [ & ] {
+		const Q::WeatherStep step = makeStep( world, frame++, false, 0, 0 );
+		Q::weatherStep( simd.particles(), step );
+		respawn( simd, step, random );
+		simdVertexes += Q::weatherVertexes( simd.particles(), sprite, simd.vertexes(), simd.vertexColors() );
+	} );
+
+	BOOST_CHECK_EQUAL( referenceVertexes, simdVertexes );
+	BOOST_CHECK( simdVertexes > 0 );
+	BOOST_TEST_MESSAGE( "weather cloud " << count << " particles x " << frames << " frames"
+		<< ": reference " << referenceTime << "us, weatherStep + weatherVertexes " << simdTime << "us" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()